@@ -0,0 +1,108 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/timer.hh>
+#include <spot/misc/random.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/randomgraph.hh>
+#include <spot/twaalgos/remfin.hh>
+#include <spot/twaalgos/sccinfo.hh>
+#include <spot/twaalgos/emptiness.hh>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+constexpr unsigned rounds = 20;
+
+static const char* algos[] =
+  { "Cou99", "Cou99new", "CVWY90", "GV04", "SE05", "Tau03_opt" };
+
+int
+main(int argc, char** argv)
+{
+  unsigned states_n = 2000;
+  if (argc > 1)
+    states_n = strtoul(argv[1], nullptr, 10);
+
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  auto ap = spot::create_atomic_prop_set(3);
+
+  std::vector<spot::emptiness_check_instantiator_ptr> ecs;
+  for (auto name: algos)
+    {
+      const char* err;
+      ecs.emplace_back(spot::make_emptiness_check_instantiator(name, &err));
+    }
+
+  std::cout << "algorithm,sets,states,seconds\n";
+  for (unsigned sets: {1, 2, 4, 8, 16, 24, 32})
+    {
+      std::vector<spot::twa_graph_ptr> auts;
+      for (unsigned i = 0; i < rounds; ++i)
+        {
+          spot::srand(sets * 1000 + i);
+          auts.emplace_back(spot::random_graph(states_n, 0.002, &ap, dict,
+                                               sets, 0.1, 0.5));
+        }
+
+      auto report = [&](const char* algo, double time)
+        {
+          std::cout << algo << ',' << sets << ',' << states_n << ','
+                    << time << '\n';
+        };
+
+      spot::stopwatch sw;
+      sw.start();
+      unsigned sccs = 0;
+      for (auto& a: auts)
+        sccs += spot::scc_info(a).scc_count();
+      report("scc_info", sw.stop());
+
+      // remove_fin() on generalized co-Büchi and Rabin-like
+      // acceptance conditions.
+      sw.start();
+      for (unsigned i = 0; i < rounds; ++i)
+        {
+          spot::srand(i);
+          auts[i]->set_acceptance(sets,
+                                  spot::acc_cond::acc_code::random(sets));
+          spot::remove_fin(auts[i]);
+        }
+      report("remove_fin", sw.stop());
+
+      for (auto& a: auts)
+        a->set_generalized_buchi(sets);
+      for (unsigned n = 0; n < ecs.size(); ++n)
+        {
+          if (sets < ecs[n]->min_sets() || sets > ecs[n]->max_sets())
+            continue;
+          sw.start();
+          for (auto& a: auts)
+            ecs[n]->instantiate(a)->check();
+          report(algos[n], sw.stop());
+        }
+
+      // Prevent the compiler from optimizing the scc_info loop away.
+      if (sccs == 0)
+        std::cerr << "no SCC found\n";
+    }
+  dict->unregister_all_my_variables(&ap);
+  return 0;
+}
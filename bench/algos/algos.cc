@@ -0,0 +1,254 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Time the main algorithms of the library on corpora of random
+// formulas and automata generated with fixed seeds, and output the
+// results as JSON so that they can be compared across versions with
+// compare.py.
+
+#include <spot/misc/random.hh>
+#include <spot/misc/timer.hh>
+#include <spot/misc/version.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/tl/randomltl.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/degen.hh>
+#include <spot/twaalgos/determinize.hh>
+#include <spot/twaalgos/emptiness.hh>
+#include <spot/twaalgos/ltl2tgba_fm.hh>
+#include <spot/twaalgos/postproc.hh>
+#include <spot/twaalgos/product.hh>
+#include <spot/twaalgos/randomgraph.hh>
+#include <spot/twaalgos/remfin.hh>
+#include <spot/twaalgos/sccinfo.hh>
+#include <spot/twaalgos/simulation.hh>
+#include <spot/twaalgos/translate.hh>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  struct result
+  {
+    unsigned inputs = 0;
+    // Sizes of the outputs.  These do not depend on the machine, so
+    // any change between two versions is worth looking at.
+    unsigned long states = 0;
+    unsigned long edges = 0;
+    // Algorithm-specific count (e.g., the number of non-empty
+    // automata for emptiness checks), output instead of the sizes.
+    unsigned long count = 0;
+  };
+
+  bool first_result = true;
+  unsigned repeat = 1;
+
+  // Run FUN REPEAT times, and output the best time.  If WHAT is
+  // given, it names result::count in the output.
+  void
+  bench(const std::string& name, std::function<result()> fun,
+        const char* what = nullptr)
+  {
+    double best = 0;
+    result r;
+    for (unsigned i = 0; i < repeat; ++i)
+      {
+        spot::stopwatch sw;
+        sw.start();
+        r = fun();
+        double t = sw.stop();
+        if (i == 0 || t < best)
+          best = t;
+      }
+    std::cout << (first_result ? "\n" : ",\n")
+              << "    { \"algorithm\": \"" << name
+              << "\", \"inputs\": " << r.inputs
+              << ", \"seconds\": " << best;
+    if (what)
+      std::cout << ", \"" << what << "\": " << r.count;
+    else
+      std::cout << ", \"states\": " << r.states
+                << ", \"edges\": " << r.edges;
+    std::cout << " }";
+    first_result = false;
+  }
+
+  void
+  count(result& r, const spot::const_twa_graph_ptr& aut)
+  {
+    ++r.inputs;
+    r.states += aut->num_states();
+    r.edges += aut->num_edges();
+  }
+
+  typedef std::vector<spot::twa_graph_ptr> corpus;
+
+  // Apply FUN to each automaton of C.
+  std::function<result()>
+  each(const corpus& c,
+       std::function<spot::twa_graph_ptr(const spot::twa_graph_ptr&)> fun)
+  {
+    return [&c, fun]()
+      {
+        result r;
+        for (auto& aut: c)
+          count(r, fun(aut));
+        return r;
+      };
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  unsigned nformulas = argc > 1 ? strtoul(argv[1], nullptr, 10) : 500;
+  unsigned nautomata = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200;
+  unsigned seed = argc > 3 ? strtoul(argv[3], nullptr, 10) : 0;
+  repeat = argc > 4 ? strtoul(argv[4], nullptr, 10) : 5;
+  if (repeat == 0)
+    repeat = 1;
+
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+
+  // The corpora.  Random formulas of size 15 over 3 atomic
+  // propositions (as "randltl -n N --seed S --tree-size=15 3" would
+  // do), and random automata with 20 states over 2 atomic
+  // propositions, with generalized Büchi acceptance (gba) or with a
+  // random acceptance condition using Fin (fin), as done by randaut.
+  std::vector<spot::formula> formulas;
+  {
+    spot::atomic_prop_set ap = spot::create_atomic_prop_set(3);
+    spot::srand(seed);
+    spot::random_ltl rl(&ap);
+    for (unsigned i = 0; i < nformulas; ++i)
+      formulas.push_back(rl.generate(15));
+  }
+  corpus gba;
+  corpus fin;
+  corpus small;
+  {
+    spot::atomic_prop_set ap = spot::create_atomic_prop_set(2);
+    spot::srand(seed);
+    for (unsigned i = 0; i < nautomata; ++i)
+      {
+        gba.push_back(spot::random_graph(20, 0.15, &ap, dict, 2, 0.1));
+        auto f = spot::random_graph(20, 0.15, &ap, dict, 3, 0.1);
+        f->set_acceptance(3, spot::acc_cond::acc_code::random(3));
+        fin.push_back(f);
+        // Determinization is exponential, so it gets smaller inputs.
+        small.push_back(spot::random_graph(6, 0.2, &ap, dict, 2, 0.2));
+      }
+  }
+  // Inputs for postprocessor::run() and the emptiness checks.  The
+  // latter are run on Büchi automata obtained from the translation of
+  // the formulas, and from the products of pairs of random automata.
+  corpus fm;
+  for (auto& f: formulas)
+    fm.push_back(spot::ltl_to_tgba_fm(f, dict));
+  corpus ba;
+  for (auto& aut: fm)
+    ba.push_back(spot::degeneralize(aut));
+  for (unsigned i = 0; i + 1 < gba.size(); i += 2)
+    ba.push_back(spot::degeneralize(spot::product(gba[i], gba[i + 1])));
+
+  std::cout << "{\n  \"version\": \"" << spot::version()
+            << "\",\n  \"seed\": " << seed
+            << ",\n  \"formulas\": " << nformulas
+            << ",\n  \"automata\": " << nautomata
+            << ",\n  \"repeat\": " << repeat
+            << ",\n  \"results\": [";
+
+  bench("translator::run", [&]()
+        {
+          result r;
+          spot::translator trans(dict);
+          for (auto& f: formulas)
+            count(r, trans.run(f));
+          return r;
+        });
+  bench("postprocessor::run", each(fm, [](const spot::twa_graph_ptr& aut)
+                                   {
+                                     spot::postprocessor post;
+                                     return post.run(aut);
+                                   }));
+  bench("simulation", each(gba, [](const spot::twa_graph_ptr& aut)
+                           {
+                             return spot::simulation(aut);
+                           }));
+  bench("degeneralize", each(gba, [](const spot::twa_graph_ptr& aut)
+                             {
+                               return spot::degeneralize(aut);
+                             }));
+  bench("tgba_determinize", each(small, [](const spot::twa_graph_ptr& aut)
+                                 {
+                                   return spot::tgba_determinize(aut);
+                                 }));
+  bench("remove_fin", each(fin, [](const spot::twa_graph_ptr& aut)
+                           {
+                             return spot::remove_fin(aut);
+                           }));
+  bench("scc_info", [&]()
+        {
+          result r;
+          for (auto& aut: gba)
+            {
+              spot::scc_info si(aut);
+              ++r.inputs;
+              r.count += si.scc_count();
+            }
+          return r;
+        }, "sccs");
+  bench("product", [&]()
+        {
+          result r;
+          for (unsigned i = 0; i + 1 < gba.size(); i += 2)
+            count(r, spot::product(gba[i], gba[i + 1]));
+          return r;
+        });
+
+  // Keep this in sync with ec_algos[] in spot/twaalgos/emptiness.cc.
+  const char* checks[] =
+    { "Cou99", "Cou99new", "Cou99abs", "CVWY90", "GV04", "SE05",
+      "Tau03", "Tau03_opt", "UFSCC" };
+  for (auto name: checks)
+    {
+      const char* err;
+      auto inst = spot::make_emptiness_check_instantiator(name, &err);
+      if (!inst)
+        {
+          std::cerr << "unknown emptiness check " << err << '\n';
+          return 2;
+        }
+      bench(std::string("emptiness:") + name, [&]()
+            {
+              result r;
+              for (auto& aut: ba)
+                {
+                  ++r.inputs;
+                  if (inst->instantiate(aut)->check())
+                    ++r.count;
+                }
+              return r;
+            }, "nonempty");
+    }
+  std::cout << "\n  ]\n}\n";
+  return 0;
+}
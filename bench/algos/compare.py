@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+## -*- coding: utf-8 -*-
+## Copyright (C) 2017 Laboratoire de Recherche et Développement de
+## l'Epita (LRDE).
+##
+## This file is part of Spot, a model checking library.
+##
+## Spot is free software; you can redistribute it and/or modify it
+## under the terms of the GNU General Public License as published by
+## the Free Software Foundation; either version 3 of the License, or
+## (at your option) any later version.
+##
+## Spot is distributed in the hope that it will be useful, but WITHOUT
+## ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+## or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+## License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Compare two JSON files output by the algos benchmark, typically
+# produced by two versions of Spot, and report the algorithms that
+# became slower, or whose outputs changed.
+
+import argparse
+import json
+import sys
+
+parser = argparse.ArgumentParser(description='Compare two runs of '
+                                 'bench/algos/algos.')
+parser.add_argument('old', help='JSON output of the reference version')
+parser.add_argument('new', help='JSON output of the version to check')
+parser.add_argument('--threshold', type=float, default=10,
+                    help='slowdown (in percent) considered as a '
+                    'regression (default: 10)')
+parser.add_argument('--min-seconds', type=float, default=0.01,
+                    help='do not report slowdowns of algorithms that '
+                    'run faster than this in the new version, as such '
+                    'timings are mostly noise (default: 0.01)')
+args = parser.parse_args()
+
+with open(args.old) as f:
+  old = json.load(f)
+with open(args.new) as f:
+  new = json.load(f)
+
+for key in ('seed', 'formulas', 'automata'):
+  if old[key] != new[key]:
+    sys.exit('{}: {} != {}, the corpora differ'.format(key, old[key],
+                                                         new[key]))
+
+oldres = dict((r['algorithm'], r) for r in old['results'])
+regressions = 0
+print('{:<22} {:>10} {:>10} {:>7}'.format('algorithm', old['version'],
+                                          new['version'], 'ratio'))
+for r in new['results']:
+  name = r['algorithm']
+  o = oldres.get(name)
+  if o is None:
+    print('{:<22} {:>10} {:>10.4f}'.format(name, '-', r['seconds']))
+    continue
+  ratio = r['seconds'] / o['seconds'] if o['seconds'] > 0 else 1
+  notes = []
+  if (ratio > 1 + args.threshold / 100
+      and r['seconds'] >= args.min_seconds):
+    notes.append('SLOWER')
+    regressions += 1
+  for key in sorted(r):
+    if key not in ('algorithm', 'seconds') and o.get(key) != r[key]:
+      notes.append('{} {} -> {}'.format(key, o.get(key), r[key]))
+  print('{:<22} {:>10.4f} {:>10.4f} {:>7.2f} {}'
+        .format(name, o['seconds'], r['seconds'], ratio,
+                ', '.join(notes)).rstrip())
+
+sys.exit(1 if regressions else 0)
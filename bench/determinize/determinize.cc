@@ -0,0 +1,82 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/optionmap.hh>
+#include <spot/misc/timer.hh>
+#include <spot/tl/randomltl.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/determinize.hh>
+#include <spot/twaalgos/isdet.hh>
+#include <spot/twaalgos/ltl2tgba_fm.hh>
+#include <spot/twaalgos/sccfilter.hh>
+#include <sys/resource.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Peak resident set size of the process, in MB.
+static double
+peak_rss()
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss / 1024.0;
+}
+
+int
+main(int argc, char** argv)
+{
+  unsigned count = argc > 1 ? atoi(argv[1]) : 200;
+  unsigned threads = argc > 2 ? atoi(argv[2]) : 1;
+
+  // Translate random LTL formulas, and keep the automata that are
+  // not deterministic and have 5 to 40 states.  (Larger automata
+  // may take too long to determinize.)
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  spot::option_map opts;
+  opts.set("tree_size_min", 20);
+  opts.set("tree_size_max", 30);
+  spot::randltlgenerator rg(4, opts);
+  std::vector<spot::twa_graph_ptr> auts;
+  unsigned in_states = 0;
+  while (auts.size() < count)
+    {
+      auto aut = spot::scc_filter(spot::ltl_to_tgba_fm(rg.next(), dict));
+      unsigned n = aut->num_states();
+      if (n < 5 || n > 40 || spot::is_deterministic(aut))
+        continue;
+      in_states += aut->num_states();
+      auts.push_back(aut);
+    }
+
+  unsigned out_states = 0;
+  spot::stopwatch sw;
+  sw.start();
+  for (auto& aut: auts)
+    out_states += spot::tgba_determinize(aut, false, true, true, true,
+                                         threads)->num_states();
+  double t = sw.stop();
+
+  std::cout << ("formulas,input states,output states,threads,seconds,"
+                "states/s,peak RSS (MB)\n")
+            << count << ',' << in_states << ',' << out_states << ','
+            << threads << ',' << t << ',' << (t > 0 ? out_states / t : 0)
+            << ',' << peak_rss() << '\n';
+  return 0;
+}
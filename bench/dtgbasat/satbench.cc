@@ -0,0 +1,157 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/satsolver.hh>
+#include <spot/misc/timer.hh>
+#include <spot/tl/parse.hh>
+#include <spot/tl/print.hh>
+#include <spot/twaalgos/dtwasat.hh>
+#include <spot/twaalgos/isdet.hh>
+#include <spot/twaalgos/translate.hh>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifdef HAVE_IPASIR
+extern "C"
+{
+  const char* ipasir_signature();
+  void* ipasir_init();
+  void ipasir_release(void* solver);
+  void ipasir_add(void* solver, int32_t lit_or_zero);
+  void ipasir_assume(void* solver, int32_t lit);
+  int ipasir_solve(void* solver);
+  int32_t ipasir_val(void* solver, int32_t lit);
+}
+#endif
+
+// The SAT-based minimization algorithms, as selected by the options
+// of sat_minimize().
+static const char* methods[][2] =
+  {
+    { "dichotomy", "" },
+    { "incr", "sat-incr=2" },
+    { "incr-naive", "sat-incr=2,sat-incr-steps=-1" },
+    { "assume", "sat-incr=1" },
+  };
+
+// The external solver given by SPOT_SATSOLVER, if any.  The
+// variable is only set while this solver is benchmarked.
+static std::string command;
+
+enum solver_kind { PICOSAT, IPASIR, COMMAND };
+
+static const char* solver_names[] = { "picosat", "ipasir", "command" };
+
+static void
+use_solver(solver_kind k)
+{
+  spot::set_sat_backend(nullptr);
+  unsetenv("SPOT_SATSOLVER");
+  switch (k)
+    {
+    case PICOSAT:
+      break;
+    case IPASIR:
+#ifdef HAVE_IPASIR
+      spot::set_sat_backend(spot::ipasir_interface{
+          ipasir_signature, ipasir_init, ipasir_release, ipasir_add,
+          ipasir_assume, ipasir_solve, ipasir_val});
+#endif
+      break;
+    case COMMAND:
+      setenv("SPOT_SATSOLVER", command.c_str(), 1);
+      break;
+    }
+}
+
+// Minimize \a aut with each method and each available solver, and
+// output one CSV line for each.
+static void
+bench(spot::formula f, const spot::twa_graph_ptr& aut)
+{
+  for (auto& m: methods)
+    for (solver_kind k: { PICOSAT, IPASIR, COMMAND })
+      {
+#ifndef HAVE_IPASIR
+        if (k == IPASIR)
+          continue;
+#endif
+        if (k == COMMAND && command.empty())
+          continue;
+        use_solver(k);
+        std::cout << '"';
+        spot::print_psl(std::cout, f);
+        std::cout << "\"," << solver_names[k] << ',' << m[0] << ','
+                  << aut->num_states() << ',';
+        spot::stopwatch sw;
+        sw.start();
+        try
+          {
+            auto res = spot::sat_minimize(aut, m[1]);
+            double t = sw.stop();
+            std::cout << (res ? res->num_states() : aut->num_states())
+                      << ',' << t << '\n';
+          }
+        catch (const std::runtime_error&)
+          {
+            // External solvers do not support assumptions.
+            std::cout << ",\n";
+          }
+      }
+}
+
+int
+main(int argc, char** argv)
+{
+  const char* input = argc > 1 ? argv[1] : "formulas";
+  unsigned max_states = argc > 2 ? atoi(argv[2]) : 10;
+  if (auto c = getenv("SPOT_SATSOLVER"))
+    command = c;
+
+  std::ifstream in(input);
+  if (!in)
+    {
+      std::cerr << "cannot open " << input << '\n';
+      return 2;
+    }
+  spot::translator trans;
+  trans.set_type(spot::postprocessor::TGBA);
+  trans.set_pref(spot::postprocessor::Deterministic);
+
+  std::cout << "formula,solver,method,states,min. states,seconds\n";
+  std::string line;
+  while (std::getline(in, line))
+    {
+      if (line.empty() || line[0] == '#')
+        continue;
+      auto pf = spot::parse_infix_psl(line);
+      if (pf.format_errors(std::cerr))
+        return 2;
+      auto aut = trans.run(pf.f);
+      // Skip the automata that are too large for the SAT-based
+      // minimization to finish in a reasonable time.
+      if (!spot::is_deterministic(aut) || aut->num_states() > max_states)
+        continue;
+      bench(pf.f, aut);
+    }
+  return 0;
+}
@@ -0,0 +1,93 @@
+#!/bin/sh
+# -*- coding: utf-8 -*-
+# Copyright (C) 2017 Laboratoire de Recherche et Développement de
+# l'Epita (LRDE).
+#
+# This file is part of Spot, a model checking library.
+#
+# Spot is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# Spot is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+# License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Compare the emptiness check of the product of an LTSmin model with
+# a formula when the model is explored as a kripke structure (one
+# spot::state per model state, Cou99 on the on-the-fly product) and
+# when using ltsmin_model::intersects(), which stores the states as
+# int vectors numbered on 32 bits.  Both are run with and without
+# state compression.
+#
+# This needs Spot to be configured with LTSmin support, and spins
+# (and divine for the BEEM model) in PATH.  The output is a CSV file
+# with one line per (model, formula, options) triplet.  The memory
+# column is the number of bytes used by the state stores for the -s
+# runs, and the size of the process after the emptiness check
+# otherwise.
+
+. ./defs
+set -e
+
+test -x "$MODELCHECK" || {
+  echo "$MODELCHECK not found, was Spot configured with LTSmin?" >&2
+  exit 77
+}
+
+# walltime OUTPUT COMMAND ARGS...
+# Run COMMAND with its standard output sent to OUTPUT, and print the
+# time it took.
+walltime()
+{
+  $PERL -MTime::HiRes=time -e \
+    '$o = shift; open(SAVE, ">&STDOUT"); open(STDOUT, ">", $o);
+     $t = time; system(@ARGV); open(STDOUT, ">&SAVE");
+     printf "%.3f", time - $t' \
+    -- "$@"
+}
+
+run()
+{
+  model=`basename $1`
+  while read formula; do
+    csvf=`echo "$formula" | sed 's/"/""/g'`
+    for opt in '' '-z' '-s' '-s -z'; do
+      t=`walltime out.$$ "$MODELCHECK" $opt -e "$1" "$formula"`
+      sed -n -e 's/^\([0-9]*\) unique states visited$/states=\1/p' \
+             -e 's/^\([0-9]*\) transitions explored$/trans=\1/p' \
+             -e 's/^\([0-9]*\) bytes used to store states$/mem=\1/p' \
+             -e 's/^\([0-9]*\) pages allocated.*$/pages=\1/p' \
+             <out.$$ >vars.$$
+      states=; trans=; mem=; pages=
+      . ./vars.$$
+      test -n "$mem$pages" && test -z "$mem" && mem=`expr $pages \* 4096`
+      echo "$model,\"$csvf\",$opt,$states,$trans,$mem,$t"
+    done
+  done
+  rm -f out.$$ vars.$$
+}
+
+echo "model,formula,options,states,transitions,memory,seconds"
+
+# Atomic propositions of LTSmin models are conditions on the state
+# variables, so expand the Promela macros used in eeaean.ltl.
+for model in eeaean1.pml eeaean2.pml; do
+  sed -e 's/noLeader/"nr_leaders==0"/g' \
+      -e 's/zeroLeads/("nr_leaders==1" \&\& "leader==0")/g' \
+      -e 's/oneLeads/("nr_leaders==1" \&\& "leader==1")/g' \
+      -e 's/twoLeads/("nr_leaders==1" \&\& "leader==2")/g' \
+      -e 's/threeLeads/("nr_leaders==1" \&\& "leader==3")/g' \
+      "$srcdir/models/eeaean.ltl" | run "$srcdir/models/$model"
+done
+
+run "$LTSMIN_MODELS/beem-peterson.4.dve" <<\EOF
+!GF(P_0.CS|P_1.CS|P_2.CS|P_3.CS)
+!G(P_0.wait -> F P_0.CS)
+!G("pos[1] < 3")
+EOF
@@ -0,0 +1,82 @@
+#!/bin/sh
+# -*- coding: utf-8 -*-
+# Copyright (C) 2017 Laboratoire de Recherche et Développement de
+# l'Epita (LRDE).
+#
+# This file is part of Spot, a model checking library.
+#
+# Spot is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# Spot is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+# License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Compare the coverage of the bit-state hashing variants of CVWY90
+# and SE05 against the memory they are given, on the products of
+# the eeaean models with the formulae of models/eeaean.ltl.  For
+# each product, the exact algorithm is run first to get the number
+# of states visited without bit-state hashing, then each
+# combination of heap size and number of hash functions is tried.
+#
+# The output is a CSV file.  The "states" column is the number of
+# states visited, "coverage" is the ratio of these to the states
+# visited by the exact algorithm, and "estimate" is the coverage
+# estimated by the algorithm itself.  Beware that the exact
+# algorithm may stop earlier than a bit-state hashing one when the
+# product is non-empty (when a collision hides the first
+# counterexample), so the coverage can exceed 1 in that case.
+
+. ./defs
+set -e
+
+SIZES=${SIZES-'4K 16K 64K 256K'}
+HASHES=${HASHES-'1 2 3 4'}
+
+FORMULAE=$srcdir/models/eeaean.ltl
+
+# run ALGO MODEL FORMULA
+# Run ALGO and define $states, $estimate, and $empty.
+run()
+{
+  "$LTL2TGBA" -e"$1" -Pmodels/$2 "$3" >out.$$ || :
+  sed -n -e 's/^\([0-9]*\) distinct nodes visited$/states=\1/p' \
+         -e 's/^\([0-9.e+-]*\)% estimated coverage$/estimate=\1/p' \
+         <out.$$ >vars.$$
+  states=; estimate=
+  . ./vars.$$
+  if grep -q '^no accepting run found' out.$$; then
+    empty=1
+  else
+    empty=0
+  fi
+}
+
+echo "model,formula,algorithm,size,k,empty,states,coverage,estimate"
+
+for model in eeaean1.tgba eeaean2.tgba eeaean1R.tgba eeaean2R.tgba
+do
+  cat "$FORMULAE" |
+  while read formula; do
+    csvf=`echo "$formula" | sed 's/"/""/g'`
+    for algo in CVWY90 SE05; do
+      run "$algo" $model "$formula"
+      exact=$states
+      echo "$model,\"$csvf\",$algo,,,$empty,$states,1,100"
+      for size in $SIZES; do
+        for k in $HASHES; do
+          run "$algo(bsh=$size,k=$k)" $model "$formula"
+          cov=`awk "BEGIN { printf \"%.3f\", $states / $exact }"`
+          echo "$model,\"$csvf\",$algo,$size,$k,$empty,$states,$cov,$estimate"
+        done
+      done
+    done
+  done
+done
+rm -f out.$$ vars.$$
@@ -0,0 +1,71 @@
+#!/bin/sh
+# -*- coding: utf-8 -*-
+# Copyright (C) 2017 Laboratoire de Recherche et Développement de
+# l'Epita (LRDE).
+#
+# This file is part of Spot, a model checking library.
+#
+# Spot is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# Spot is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+# License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Measure how the multi-threaded UFSCC emptiness check scales with
+# the number of threads, on all the models of this directory.
+#
+# Usage: ./pml-threads.sh [MAXTHREADS]
+#
+# MAXTHREADS defaults to the number of online processors.  The output
+# is a CSV file with one line per (model, formula, threads) triplet.
+# Times are wall-clock seconds for the whole ikwiad run, so they
+# include the translation of the formula and the construction of the
+# product, which do not depend on the number of threads.
+
+. ./defs
+set -e
+
+opts='-f -x -m'
+maxthreads=${1-`getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4`}
+
+walltime()
+{
+  $PERL -MTime::HiRes=time -e \
+    '$t = time; system(@ARGV) == 0 or exit 1; printf "%.3f", time - $t' \
+    -- "$@"
+}
+
+run()
+{
+  model=$1
+  formulae=$2
+  while read formula; do
+    threads=1
+    while test $threads -le $maxthreads; do
+      t=`walltime "$LTL2TGBA" -e"UFSCC(threads=$threads)" $opts \
+                              -Pmodels/$model "$formula" >/dev/null`
+      echo "$model,\"$formula\",$threads,$t"
+      threads=`expr $threads + 1`
+    done
+  done < "$formulae"
+}
+
+echo "model,formula,threads,seconds"
+for model in \
+  cl3serv1.tgba  cl3serv1fair.tgba  cl3serv3.tgba  cl3serv3fair.tgba \
+  cl3serv1R.tgba cl3serv1Rfair.tgba cl3serv3R.tgba cl3serv3Rfair.tgba
+do
+  run $model "$srcdir/models/clserv.ltl"
+done
+for model in \
+  eeaean1.tgba eeaean1R.tgba eeaean2.tgba eeaean2R.tgba
+do
+  run $model "$srcdir/models/eeaean.ltl"
+done
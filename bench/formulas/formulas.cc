@@ -0,0 +1,127 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/timer.hh>
+#include <spot/tl/formula.hh>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr unsigned rounds = 5;
+constexpr unsigned aps = 8;
+
+// Build a random LTL formula of depth at most DEPTH.
+static spot::formula
+random_formula(std::mt19937& gen, const std::vector<spot::formula>& ap,
+               unsigned depth)
+{
+  unsigned choice = depth ? gen() % 10 : 0;
+  switch (choice)
+    {
+    case 0:
+    case 1:
+      return ap[gen() % ap.size()];
+    case 2:
+      return spot::formula::Not(random_formula(gen, ap, depth - 1));
+    case 3:
+      return spot::formula::X(random_formula(gen, ap, depth - 1));
+    case 4:
+      return spot::formula::F(random_formula(gen, ap, depth - 1));
+    case 5:
+      return spot::formula::G(random_formula(gen, ap, depth - 1));
+    case 6:
+      return spot::formula::And({random_formula(gen, ap, depth - 1),
+                                 random_formula(gen, ap, depth - 1)});
+    case 7:
+      return spot::formula::Or({random_formula(gen, ap, depth - 1),
+                                random_formula(gen, ap, depth - 1)});
+    case 8:
+      return spot::formula::U(random_formula(gen, ap, depth - 1),
+                              random_formula(gen, ap, depth - 1));
+    default:
+      return spot::formula::R(random_formula(gen, ap, depth - 1),
+                              random_formula(gen, ap, depth - 1));
+    }
+}
+
+// Build COUNT formulas, keeping the last WINDOW ones alive so that
+// both lookups of existing formulas and insertions of new ones are
+// measured.
+static void
+work(unsigned seed, unsigned count)
+{
+  std::mt19937 gen(seed);
+  std::vector<spot::formula> ap;
+  for (unsigned i = 0; i < aps; ++i)
+    ap.emplace_back(spot::formula::ap("p" + std::to_string(i)));
+  const unsigned window = 1000;
+  std::vector<spot::formula> alive(window);
+  for (unsigned i = 0; i < count; ++i)
+    alive[i % window] = random_formula(gen, ap, 6);
+}
+
+int
+main(int argc, char** argv)
+{
+  unsigned max_threads = 1;
+  if (argc > 1)
+    max_threads = strtoul(argv[1], nullptr, 10);
+  unsigned count = 200000;
+  if (argc > 2)
+    count = strtoul(argv[2], nullptr, 10);
+
+#if !SPOT_CONCURRENT_FORMULAS
+  if (max_threads > 1)
+    {
+      std::cerr << "this build of Spot does not support formulas "
+                << "shared between threads;\nreconfigure with "
+                << "--enable-concurrent-formulas to use more than "
+                << "one thread\n";
+      return 2;
+    }
+  const char* build = "set";
+#else
+  const char* build = "sharded";
+#endif
+
+  std::cout << "table,threads,formulas,seconds,formulas/s\n";
+  for (unsigned threads = 1; threads <= max_threads; ++threads)
+    {
+      double total = 0;
+      for (unsigned r = 0; r < rounds; ++r)
+        {
+          spot::stopwatch sw;
+          sw.start();
+          std::vector<std::thread> ts;
+          for (unsigned t = 1; t < threads; ++t)
+            ts.emplace_back(work, r * 1000 + t, count);
+          work(r * 1000, count);
+          for (auto& t: ts)
+            t.join();
+          total += sw.stop();
+        }
+      unsigned long built = (unsigned long) count * threads * rounds;
+      std::cout << build << ',' << threads << ',' << built << ','
+                << total << ',' << built / total << '\n';
+    }
+  return 0;
+}
@@ -0,0 +1,149 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/random.hh>
+#include <spot/misc/timer.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twa/twagraph.hh>
+#include <spot/twaalgos/emptiness.hh>
+#include <spot/twaalgos/product.hh>
+#include <spot/twaalgos/sccinfo.hh>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+// Build an automaton with N states and K edges per state, created in
+// K passes over all states (as done when some algorithm adds edges to
+// existing states), so that the outgoing edges of each state are
+// scattered in the edge vector.
+static spot::twa_graph_ptr
+scattered(const spot::bdd_dict_ptr& dict, unsigned n, unsigned k)
+{
+  auto aut = spot::make_twa_graph(dict);
+  bdd ap[3];
+  for (unsigned i = 0; i < 3; ++i)
+    ap[i] = bdd_ithvar(aut->register_ap("p" + std::to_string(i)));
+  aut->set_generalized_buchi(2);
+  aut->set_init_state(aut->new_states(n));
+  for (unsigned pass = 0; pass < k; ++pass)
+    for (unsigned s = 0; s < n; ++s)
+      {
+        // Make sure all states are reachable.
+        unsigned dst = pass == 0 ? (s + 1) % n : spot::mrand(n);
+        bdd cond = bddtrue;
+        for (auto& p: ap)
+          switch (spot::mrand(3))
+            {
+            case 0:
+              cond &= p;
+              break;
+            case 1:
+              cond &= !p;
+              break;
+            }
+        aut->new_edge(s, dst, cond,
+                      spot::acc_cond::mark_t(spot::mrand(4)
+                                             & (pass == 0 ? 0U : 3U)));
+      }
+  return aut;
+}
+
+static unsigned long
+memory(const spot::const_twa_graph_ptr& aut)
+{
+  auto& g = aut->get_graph();
+  return (g.states().capacity() * sizeof(g.states()[0])
+          + g.edge_vector().capacity() * sizeof(g.edge_vector()[0]));
+}
+
+// Best time out of three runs.
+static double
+timeit(std::function<void()> f)
+{
+  double best = 0;
+  for (unsigned i = 0; i < 3; ++i)
+    {
+      spot::stopwatch sw;
+      sw.start();
+      f();
+      double t = sw.stop();
+      if (i == 0 || t < best)
+        best = t;
+    }
+  return best;
+}
+
+int
+main(int argc, char** argv)
+{
+  unsigned n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+  unsigned k = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4;
+
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  spot::srand(0);
+  auto aut = scattered(dict, n, k);
+  // A small automaton for the product: it alternates between two
+  // states, and accepts when p0 holds infinitely often.
+  auto small = spot::make_twa_graph(dict);
+  {
+    bdd p0 = bdd_ithvar(small->register_ap("p0"));
+    small->set_buchi();
+    small->new_states(2);
+    small->new_edge(0, 1, p0, {0});
+    small->new_edge(0, 1, !p0);
+    small->new_edge(1, 0, bddtrue);
+  }
+  const char* err;
+  auto ec = spot::make_emptiness_check_instantiator("Cou99", &err);
+
+  struct algo
+  {
+    const char* name;
+    std::function<void()> run;
+  };
+  const algo algos[] =
+    {
+      { "scc_info", [&]() { spot::scc_info si(aut); } },
+      { "product", [&]() { spot::product(aut, small); } },
+      { "Cou99", [&]() { ec->instantiate(aut)->check(); } },
+    };
+
+  std::cout << "algorithm,states,edges,seconds,frozen seconds,speedup\n";
+  double before[sizeof algos / sizeof *algos];
+  unsigned i = 0;
+  for (auto& a: algos)
+    before[i++] = timeit(a.run);
+  unsigned long mem = memory(aut);
+  spot::stopwatch sw;
+  sw.start();
+  aut->freeze();
+  double tfreeze = sw.stop();
+  i = 0;
+  for (auto& a: algos)
+    {
+      double after = timeit(a.run);
+      std::cout << a.name << ',' << n << ',' << aut->num_edges() << ','
+                << before[i] << ',' << after << ','
+                << before[i] / after << '\n';
+      ++i;
+    }
+  std::cerr << "freeze() took " << tfreeze << "s; memory: " << mem
+            << " bytes before, " << memory(aut) << " bytes after\n";
+  return 0;
+}
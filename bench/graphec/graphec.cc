@@ -0,0 +1,101 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/timer.hh>
+#include <spot/misc/random.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/randomgraph.hh>
+#include <spot/twaalgos/product.hh>
+#include <spot/twaalgos/emptiness.hh>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+constexpr unsigned rounds = 10;
+
+// Each algorithm is run twice on the same products: once as it is
+// (iterating over the edges of the twa_graph), and once with the
+// abstract interface.
+static const char* algos[][2] =
+  {
+    { "Cou99new", "Cou99abs" },
+    { "CVWY90", "CVWY90(graph=0)" },
+    { "GV04", "GV04(graph=0)" },
+    { "SE05", "SE05(graph=0)" },
+    { "Tau03", "Tau03(graph=0)" },
+  };
+
+int
+main(int argc, char** argv)
+{
+  unsigned model_n = 20000;
+  if (argc > 1)
+    model_n = strtoul(argv[1], nullptr, 10);
+
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  auto ap = spot::create_atomic_prop_set(3);
+
+  std::vector<spot::emptiness_check_instantiator_ptr> ecs[2];
+  for (auto& names: algos)
+    for (unsigned v = 0; v < 2; ++v)
+      {
+        const char* err;
+        ecs[v].emplace_back(spot::make_emptiness_check_instantiator(names[v],
+                                                                    &err));
+      }
+
+  std::cout << "algorithm,empty,states,abstract,graph,speedup\n";
+  for (bool empty: {true, false})
+    {
+      // The products of a random model with random properties.  When
+      // the properties have no accepting edge, the products are
+      // empty and the emptiness checks must explore them entirely.
+      std::vector<spot::twa_graph_ptr> prods;
+      unsigned states = 0;
+      for (unsigned i = 0; i < rounds; ++i)
+        {
+          spot::srand(i);
+          auto model = spot::random_graph(model_n, 4.0 / model_n, &ap, dict);
+          auto prop = spot::random_graph(10, 0.4, &ap, dict, 1,
+                                         empty ? 0.0 : 0.02);
+          prods.emplace_back(spot::product(model, prop));
+          states += prods.back()->num_states();
+        }
+
+      for (unsigned n = 0; n < ecs[0].size(); ++n)
+        {
+          double time[2];
+          for (unsigned v = 0; v < 2; ++v)
+            {
+              spot::stopwatch sw;
+              sw.start();
+              for (auto& p: prods)
+                ecs[v][n]->instantiate(p)->check();
+              time[v] = sw.stop();
+            }
+          std::cout << algos[n][0] << ',' << empty << ',' << states << ','
+                    << time[1] << ',' << time[0] << ','
+                    << (time[0] > 0 ? time[1] / time[0] : 0) << '\n';
+        }
+    }
+  dict->unregister_all_my_variables(&ap);
+  return 0;
+}
@@ -0,0 +1,160 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/timer.hh>
+#include <spot/misc/random.hh>
+#include <spot/parseaut/public.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/binary.hh>
+#include <spot/twaalgos/hoa.hh>
+#include <spot/twaalgos/randomgraph.hh>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Write \a count random automata with \a states states to \a file.
+static void
+generate(const std::string& file, unsigned count, unsigned states)
+{
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  auto ap = spot::create_atomic_prop_set(4);
+  std::ofstream out(file);
+  for (unsigned i = 0; i < count; ++i)
+    {
+      spot::srand(i);
+      auto aut = spot::random_graph(states, 4.0 / states, &ap, dict, 2);
+      spot::print_hoa(out, aut) << '\n';
+    }
+  dict->unregister_all_my_variables(&ap);
+}
+
+// Convert all the automata of \a file to the binary format, in
+// \a binfile.
+static void
+convert(const std::string& file, const std::string& binfile)
+{
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  spot::automaton_stream_parser p(file);
+  std::ofstream out(binfile, std::ios::binary);
+  for (;;)
+    {
+      auto pa = p.parse(dict);
+      if (pa->format_errors(std::cerr))
+        exit(2);
+      if (!pa->aut)
+        break;
+      spot::print_binary(out, pa->aut);
+    }
+}
+
+static double
+file_mb(const std::string& file)
+{
+  struct stat s;
+  if (stat(file.c_str(), &s) < 0)
+    {
+      std::cerr << "cannot stat " << file << '\n';
+      exit(2);
+    }
+  return s.st_size / 1e6;
+}
+
+// Parse all the automata of \a file, either by name (the file is
+// then mapped in memory), or through a file descriptor (read with
+// stdio).  Return the number of seconds spent.
+static double
+parse(const std::string& file, bool by_name, unsigned& count)
+{
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  int fd = -1;
+  if (!by_name)
+    {
+      fd = open(file.c_str(), O_RDONLY);
+      if (fd < 0)
+        {
+          std::cerr << "cannot open " << file << '\n';
+          exit(2);
+        }
+    }
+  spot::stopwatch sw;
+  sw.start();
+  count = 0;
+  {
+    std::unique_ptr<spot::automaton_stream_parser> p;
+    if (by_name)
+      p.reset(new spot::automaton_stream_parser(file));
+    else
+      p.reset(new spot::automaton_stream_parser(fd, file));
+    for (;;)
+      {
+        auto pa = p->parse(dict);
+        if (pa->format_errors(std::cerr))
+          exit(2);
+        if (!pa->aut)
+          break;
+        ++count;
+      }
+  }
+  double res = sw.stop();
+  if (fd >= 0)
+    close(fd);
+  return res;
+}
+
+int
+main(int argc, char** argv)
+{
+  std::string file;
+  if (argc > 1)
+    {
+      file = argv[1];
+    }
+  else
+    {
+      file = "hoaparse.hoa";
+      generate(file, 200, 2000);
+    }
+
+  double mb = file_mb(file);
+
+  std::cout << "input,automata,MB,seconds,MB/s\n";
+  for (bool by_name: {true, false})
+    {
+      unsigned count;
+      double t = parse(file, by_name, count);
+      std::cout << (by_name ? "mmap" : "stdio") << ',' << count << ','
+                << mb << ',' << t << ',' << (t > 0 ? mb / t : 0) << '\n';
+    }
+
+  // The same automata, in the binary format.
+  std::string binfile = "hoaparse.bin";
+  convert(file, binfile);
+  mb = file_mb(binfile);
+  unsigned count;
+  double t = parse(binfile, true, count);
+  std::cout << "binary," << count << ',' << mb << ',' << t << ','
+            << (t > 0 ? mb / t : 0) << '\n';
+  return 0;
+}
@@ -0,0 +1,104 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/timer.hh>
+#include <spot/misc/random.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twa/twagraph.hh>
+#include <spot/twaalgos/hoa.hh>
+#include <spot/twaalgos/randomgraph.hh>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int
+main(int argc, char** argv)
+{
+  unsigned count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20;
+  unsigned states = argc > 2 ? strtoul(argv[2], nullptr, 10) : 20000;
+  const char* file = "hoaprint.hoa";
+
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  auto ap = spot::create_atomic_prop_set(4);
+  std::vector<spot::twa_graph_ptr> auts;
+  for (unsigned i = 0; i < count; ++i)
+    {
+      spot::srand(i);
+      auts.push_back(spot::random_graph(states, 4.0 / states, &ap, dict, 2));
+    }
+
+  // Size of the output, as computed by the first output method.
+  double mb = 0;
+  std::cout << "output,automata,MB,seconds,MB/s\n";
+  for (const char* output: {"string", "ofstream", "fd"})
+    {
+      std::string o = output;
+      spot::stopwatch sw;
+      sw.start();
+      if (o == "string")
+        {
+          size_t size = 0;
+          for (auto& aut: auts)
+            {
+              std::ostringstream s;
+              spot::print_hoa(s, aut) << '\n';
+              size += s.str().size();
+            }
+          mb = size / 1e6;
+        }
+      else if (o == "ofstream")
+        {
+          std::ofstream out(file);
+          for (auto& aut: auts)
+            spot::print_hoa(out, aut) << '\n';
+        }
+      else
+        {
+          int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+          if (fd < 0)
+            {
+              std::cerr << "cannot open " << file << '\n';
+              return 2;
+            }
+          for (auto& aut: auts)
+            {
+              spot::print_hoa(fd, aut);
+              if (write(fd, "\n", 1) != 1)
+                {
+                  std::cerr << "cannot write " << file << '\n';
+                  return 2;
+                }
+            }
+          close(fd);
+        }
+      double t = sw.stop();
+      std::cout << output << ',' << count << ',' << mb << ','
+                << t << ',' << (t > 0 ? mb / t : 0) << '\n';
+    }
+  unlink(file);
+  auts.clear();
+  dict->unregister_all_my_variables(&ap);
+  return 0;
+}
@@ -0,0 +1,84 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/random.hh>
+#include <spot/misc/timer.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/tl/randomltl.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/sccinfo.hh>
+#include <spot/twaalgos/translate.hh>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+int
+main(int argc, char** argv)
+{
+  unsigned count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200;
+
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  spot::atomic_prop_set ap = spot::create_atomic_prop_set(3);
+  std::vector<spot::formula> formulas;
+  {
+    spot::srand(0);
+    spot::random_ltl rl(&ap);
+    for (unsigned i = 0; i < count; ++i)
+      formulas.push_back(rl.generate(15));
+  }
+
+  struct config
+  {
+    const char* name;
+    spot::postprocessor::output_type type;
+    int pref;
+  };
+  const config configs[] =
+    {
+      { "TGBA", spot::postprocessor::TGBA, spot::postprocessor::Small },
+      { "BA", spot::postprocessor::BA, spot::postprocessor::Small },
+      { "Monitor", spot::postprocessor::Monitor, spot::postprocessor::Small },
+      { "Generic-det", spot::postprocessor::Generic,
+        spot::postprocessor::Deterministic },
+    };
+  const char* levels[] = { "low", "medium", "high" };
+
+  std::cout << ("type,level,formulas,scc_info constructions,"
+                "constructions/formula,seconds\n");
+  for (auto& c: configs)
+    for (int level = 0; level < 3; ++level)
+      {
+        spot::translator trans(dict);
+        trans.set_type(c.type);
+        trans.set_pref(c.pref);
+        trans.set_level(level == 0 ? spot::postprocessor::Low
+                        : level == 1 ? spot::postprocessor::Medium
+                        : spot::postprocessor::High);
+        unsigned long before = spot::scc_info::constructions();
+        spot::stopwatch sw;
+        sw.start();
+        for (auto& f: formulas)
+          trans.run(f);
+        double t = sw.stop();
+        unsigned long n = spot::scc_info::constructions() - before;
+        std::cout << c.name << ',' << levels[level] << ',' << count << ','
+                  << n << ',' << double(n) / count << ',' << t << '\n';
+      }
+  return 0;
+}
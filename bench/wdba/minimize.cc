@@ -0,0 +1,117 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <spot/misc/timer.hh>
+#include <spot/misc/random.hh>
+#include <spot/tl/apcollect.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/twaalgos/minimize.hh>
+#include <spot/twaalgos/powerset.hh>
+#include <spot/twaalgos/randomgraph.hh>
+#include <cstdlib>
+#include <iostream>
+
+// A random deterministic automaton, obtained by determinizing a
+// random automaton with \a states states.
+static spot::twa_graph_ptr
+random_det(const spot::bdd_dict_ptr& dict, spot::atomic_prop_set* ap,
+           unsigned states)
+{
+  return spot::tgba_powerset(spot::random_graph(states, 1.5 / states,
+                                                ap, dict));
+}
+
+// A deterministic automaton with \a states states, in which state i
+// goes to state i+1 on p0, and stays on i otherwise.  The last state
+// has no successor, so states can only be distinguished by their
+// distance to the last state.  This is the worst case of a Moore-like
+// minimization, that needs one pass per state.
+static spot::twa_graph_ptr
+chain(const spot::bdd_dict_ptr& dict, spot::atomic_prop_set* ap,
+      unsigned states)
+{
+  auto aut = spot::make_twa_graph(dict);
+  bdd p0 = bdd_ithvar(aut->register_ap(*ap->begin()));
+  aut->new_states(states);
+  for (unsigned s = 0; s + 1 < states; ++s)
+    {
+      aut->new_edge(s, s + 1, p0);
+      aut->new_edge(s, s, !p0);
+    }
+  aut->set_init_state(0U);
+  return aut;
+}
+
+// Minimize \a count deterministic automata built by \a gen, using
+// minimize_monitor() if \a monitor is set, or minimize_wdba()
+// otherwise, and output one CSV line.  Because the input is
+// deterministic, the time spent by these functions to determinize
+// it again is negligible.
+static void
+bench(bool monitor, const char* input,
+      spot::twa_graph_ptr (*gen)(const spot::bdd_dict_ptr&,
+                                 spot::atomic_prop_set*, unsigned),
+      unsigned count, unsigned states)
+{
+  spot::bdd_dict_ptr dict = spot::make_bdd_dict();
+  auto ap = spot::create_atomic_prop_set(2);
+  unsigned det_states = 0;
+  unsigned min_states = 0;
+  double t = 0;
+  for (unsigned i = 0; i < count; ++i)
+    {
+      spot::srand(i);
+      auto det = gen(dict, &ap, states);
+      if (!monitor)
+        {
+          // Make one edge out of four accepting.
+          det->set_buchi();
+          for (auto& e: det->edges())
+            if (spot::rrand(0, 3) == 0)
+              e.acc = {0};
+        }
+      det_states += det->num_states();
+      spot::stopwatch sw;
+      sw.start();
+      auto res = monitor ? spot::minimize_monitor(det)
+        : spot::minimize_wdba(det);
+      t += sw.stop();
+      min_states += res->num_states();
+    }
+  std::cout << (monitor ? "monitor" : "wdba") << ',' << input << ','
+            << count << ',' << det_states << ',' << min_states << ','
+            << t << ',' << (t > 0 ? det_states / t : 0) << '\n';
+  dict->unregister_all_my_variables(&ap);
+}
+
+int
+main(int argc, char** argv)
+{
+  unsigned count = argc > 1 ? atoi(argv[1]) : 10;
+  std::cout << ("function,input,automata,states,min. states,"
+                "seconds,states/s\n");
+  for (bool monitor: {true, false})
+    {
+      for (unsigned states: {10, 20, 40, 80})
+        bench(monitor, "random", random_det, count, states);
+      for (unsigned states: {250, 500, 1000, 2000})
+        bench(monitor, "chain", chain, count, states);
+    }
+  return 0;
+}
@@ -39,6 +39,7 @@
 #include "common_post.hh"
 #include "common_conv.hh"
 #include "common_hoaread.hh"
+#include "common_jobs.hh"
 
 #include <spot/twaalgos/product.hh>
 #include <spot/twaalgos/isdet.hh>
@@ -363,6 +364,7 @@ static const struct argp_child children[] =
     { &aoutput_argp, 0, nullptr, 0 },
     { &aoutput_io_format_argp, 0, nullptr, 4 },
     { &post_argp_disabled, 0, nullptr, 0 },
+    { &jobs_argp, 0, nullptr, -1 },
     { &misc_argp, 0, nullptr, -1 },
     { nullptr, 0, nullptr, 0 }
   };
@@ -732,7 +734,7 @@ parse_opt(int key, char* arg, struct argp_state*)
               error(2, 0, "acceptance sets should be non-negative:"
                     " --mask-acc=%ld", res);
             if (static_cast<unsigned long>(res)
-                > sizeof(spot::acc_cond::mark_t::value_t))
+                >= spot::acc_cond::mark_t::max_accsets())
               error(2, 0, "this implementation does not support that many"
                     " acceptance sets: --mask-acc=%ld", res);
             opt_mask_acc.set(res);
@@ -903,6 +905,49 @@ namespace
     {
     }
 
+    // With --jobs, the automata are read by the main process, and
+    // sent in the HOA format to worker processes that run
+    // process_automaton() on them.  The input location is sent
+    // along, for --stats.
+    void
+    start_jobs() override
+    {
+      auto work = [this](const std::string& task, unsigned& outputs)
+        {
+          std::istringstream is(task);
+          std::string filename;
+          std::getline(is, filename, '\0');
+          spot::location loc;
+          is >> loc.begin.line >> loc.begin.column
+             >> loc.end.line >> loc.end.column;
+          is.get();
+          size_t pos = is.tellg();
+          spot::automaton_stream_parser
+            hp(task.c_str() + pos, filename.c_str());
+          auto haut = hp.parse(opt->dict);
+          assert(haut->aut && haut->errors.empty());
+          haut->loc = loc;
+          long int before = match_count;
+          int res = process_automaton(haut, filename.c_str());
+          outputs += match_count - before;
+          return res;
+        };
+      auto output = [this](const job_pool::result& r)
+        {
+          // Stop at --max-count, even if workers have already
+          // processed the next automata.
+          if (abort_run)
+            return;
+          std::cout << r.out;
+          std::cerr << r.err;
+          flush_cout();
+          match_count += r.outputs;
+          if (opt_max_count >= 0 && match_count >= opt_max_count)
+            abort_run = true;
+        };
+      pool.reset(new job_pool(opt_jobs, work, output));
+    }
+
     int
     process_formula(spot::formula, const char*, int) override
     {
@@ -983,15 +1028,35 @@ namespace
           if (haut->format_errors(std::cerr))
             err = 2;
           if (!haut->aut)
-            error(2, 0, "failed to read automaton from %s", filename);
+            {
+              // Output the automata that have been read so far.
+              finish_jobs();
+              error(2, 0, "failed to read automaton from %s", filename);
+            }
           else if (haut->aborted)
             err = std::max(err, aborted(haut, filename));
+          else if (pool)
+            submit_automaton(haut, filename);
           else
             process_automaton(haut, filename);
         }
       return err;
     }
 
+    void
+    submit_automaton(const spot::const_parsed_aut_ptr& haut,
+                     const char* filename)
+    {
+      std::ostringstream os;
+      os << filename << '\0'
+         << haut->loc.begin.line << ' ' << haut->loc.begin.column << ' '
+         << haut->loc.end.line << ' ' << haut->loc.end.column << '\n';
+      // Version 1.1 of the format preserves the highlighted states
+      // and edges, and the negated properties.
+      spot::print_hoa(os, haut->aut, "1.1");
+      pool->submit(os.str());
+    }
+
 
     int
     process_automaton(const spot::const_parsed_aut_ptr& haut,
@@ -1300,6 +1365,16 @@ main(int argc, char** argv)
       post.set_level(level);
 
       hoa_processor processor(post);
+      if (opt_jobs > 1)
+        {
+          // These options need to see the automata in input order,
+          // or to write to files.
+          if (opt->uniq || randomize_st || randomize_tr || opt_output)
+            std::cerr << "warning: --jobs is ignored with --unique, "
+                      << "--randomize, and --output" << std::endl;
+          else
+            processor.start_jobs();
+        }
       if (processor.run())
         return 2;
 
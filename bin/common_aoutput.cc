@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2014, 2015, 2016 Laboratoire de Recherche
-// et Développement de l'Epita (LRDE).
+// Copyright (C) 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// Recherche et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -27,6 +27,7 @@
 #include <unistd.h>
 #include <ctime>
 #include <spot/twa/bddprint.hh>
+#include <spot/twaalgos/binary.hh>
 #include <spot/twaalgos/dot.hh>
 #include <spot/twaalgos/hoa.hh>
 #include <spot/twaalgos/isunamb.hh>
@@ -39,7 +40,7 @@
 automaton_format_t automaton_format = Hoa;
 static const char* automaton_format_opt = nullptr;
 const char* opt_name = nullptr;
-static const char* opt_output = nullptr;
+const char* opt_output = nullptr;
 static const char* stats = "";
 enum check_type
   {
@@ -78,12 +79,16 @@ enum {
   OPT_NAME,
   OPT_STATS,
   OPT_CHECK,
+  OPT_BINARY,
 };
 
 static const argp_option options[] =
   {
     /**************************************************/
     { nullptr, 0, nullptr, 0, "Output format:", 3 },
+    { "binary", OPT_BINARY, nullptr, 0,
+      "Spot's binary format, faster to load than HOA, but only readable "
+      "by Spot on a machine with the same byte order", 0 },
     { "dot", 'd',
       "1|a|b|B|c|C(COLOR)|e|f(FONT)|h|k|n|N|o|r|R|s|t|v|y|+INT|<INT|#",
       OPTION_ARG_OPTIONAL,
@@ -287,6 +292,9 @@ int parse_opt_aoutput(int key, char* arg, struct argp_state*)
         type = spot::postprocessor::BA;
       automaton_format_opt = arg;
       break;
+    case OPT_BINARY:
+      automaton_format = Binary;
+      break;
     case OPT_CHECK:
       automaton_format = Hoa;
       if (arg)
@@ -564,6 +572,9 @@ automaton_printer::print(const spot::twa_graph_ptr& aut,
     case Quiet:
       // Do not output anything.
       break;
+    case Binary:
+      spot::print_binary(*out, aut);
+      break;
     case Dot:
       spot::print_dot(*out, aut, automaton_format_opt);
       break;
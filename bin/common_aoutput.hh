@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -42,12 +42,15 @@ enum automaton_format_t {
   Hoa,
   Quiet,
   Count,
+  Binary,
 };
 
 // The format to use in output_automaton()
 extern automaton_format_t automaton_format;
 // Set to the argument of --name, else nullptr.
 extern const char* opt_name;
+// Set to the argument of --output, else nullptr.
+extern const char* opt_output;
 // Output options
 extern const struct argp aoutput_argp;
 
@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2014, 2015, 2016 Laboratoire de Recherche
-// et Développement de l'Epita (LRDE).
+// Copyright (C) 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// Recherche et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -19,10 +19,12 @@
 
 #include "common_finput.hh"
 #include "common_setup.hh"
+#include "common_cout.hh"
 #include "error.h"
 
 #include <fstream>
 #include <cstring>
+#include <sstream>
 #include <unistd.h>
 
 enum {
@@ -145,7 +147,7 @@ job_processor::process_stream(std::istream& is,
       {
         if (col_to_read == 0)
           {
-            error |= process_string(line, filename, linenum++);
+            error |= dispatch_string(line, filename, linenum++);
           }
         else // We are reading column COL_TO_READ in a CSV file.
           {
@@ -272,7 +274,7 @@ job_processor::process_stream(std::istream& is,
                     field[dst++] = *coln_start;
                 field.resize(dst);
               }
-            error |= process_string(field, filename, linenum);
+            error |= dispatch_string(field, filename, linenum);
             linenum += csvlines;
             if (prefix)
               {
@@ -346,13 +348,93 @@ job_processor::run()
   for (auto& j: jobs)
     {
       if (!j.file_p)
-        error |= process_string(j.str);
+        error |= dispatch_string(j.str);
       else
         error |= process_file(j.str);
       if (abort_run)
         break;
     }
-  return error;
+  return error | finish_jobs();
+}
+
+// A task sent to a worker is made of three flags telling whether
+// FILENAME, PREFIX, and SUFFIX are set, the line number, and then
+// these strings and the formula, separated by null characters.
+int
+job_processor::dispatch_string(const std::string& input,
+                               const char* filename, int linenum)
+{
+  if (!pool)
+    return process_string(input, filename, linenum);
+  std::ostringstream os;
+  os << !!filename << !!prefix << !!suffix << linenum << '\0';
+  const char* strs[] = { filename, prefix, suffix };
+  for (const char* s: strs)
+    if (s)
+      os << s << '\0';
+  os << input;
+  pool->submit(os.str());
+  return 0;
+}
+
+void
+job_processor::start_jobs()
+{
+  auto work = [this](const std::string& task, unsigned& outputs)
+    {
+      std::istringstream is(task);
+      bool has[3];
+      for (bool& b: has)
+        b = is.get() == '1';
+      int linenum;
+      is >> linenum;
+      is.get();
+      std::string str[3];
+      for (unsigned i = 0; i < 3; ++i)
+        if (has[i])
+          std::getline(is, str[i], '\0');
+      prefix = has[1] ? strdup(str[1].c_str()) : nullptr;
+      suffix = has[2] ? strdup(str[2].c_str()) : nullptr;
+      std::string input(task, is.tellg());
+      int res = process_job(input, has[0] ? str[0].c_str() : nullptr,
+                            linenum, outputs);
+      free(prefix);
+      free(suffix);
+      prefix = suffix = nullptr;
+      return res;
+    };
+  auto output = [this](const job_pool::result& r)
+    {
+      output_job(r);
+    };
+  pool.reset(new job_pool(opt_jobs, work, output));
+}
+
+int
+job_processor::finish_jobs()
+{
+  if (!pool)
+    return 0;
+  int res = pool->finish();
+  if (opt_jobs_timings)
+    pool->print_timings(std::cerr);
+  pool = nullptr;
+  return res;
+}
+
+int
+job_processor::process_job(const std::string& input,
+                           const char* filename, int linenum, unsigned&)
+{
+  return process_string(input, filename, linenum);
+}
+
+void
+job_processor::output_job(const job_pool::result& r)
+{
+  std::cout << r.out;
+  std::cerr << r.err;
+  flush_cout();
 }
 
 void check_no_formula()
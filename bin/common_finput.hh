@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2015, 2016 Laboratoire de Recherche et
-// Développement de l'Epita (LRDE).
+// Copyright (C) 2012, 2013, 2015, 2016, 2017 Laboratoire de Recherche
+// et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -20,8 +20,10 @@
 #pragma once
 
 #include "common_sys.hh"
+#include "common_jobs.hh"
 
 #include <argp.h>
+#include <memory>
 #include <vector>
 #include <spot/tl/parse.hh>
 
@@ -51,6 +53,20 @@ class job_processor
 {
 protected:
   bool abort_run;  // Set to true in process_formula() to abort run().
+
+  // With --jobs, the worker processes started by start_jobs().
+  std::unique_ptr<job_pool> pool;
+
+  // Called in a worker to process a formula read by the main
+  // process.  The number of items output should be added to OUTPUTS.
+  virtual int
+  process_job(const std::string& str, const char* filename, int linenum,
+              unsigned& outputs);
+
+  // Called by the main process, in input order, to output the
+  // result of process_job().
+  virtual void
+  output_job(const job_pool::result& r);
 public:
   job_processor();
 
@@ -72,10 +88,28 @@ public:
   virtual int
   run();
 
+  // Start opt_jobs worker processes.  The formulas read by run() are
+  // then sent to process_job() in the workers, instead of being
+  // processed by process_string().
+  virtual void
+  start_jobs();
+
+  // Wait for the workers started by start_jobs(), and output the
+  // remaining results.  This is called by run(), and returns the
+  // largest status of the workers.
+  int
+  finish_jobs();
+
   char* real_filename;
   long int col_to_read;
   char* prefix;
   char* suffix;
+
+private:
+  // Call process_string(), or send the string to a worker.
+  int
+  dispatch_string(const std::string& str,
+                  const char* filename = nullptr, int linenum = 0);
 };
 
 // Report and error message or add a default job depending on whether
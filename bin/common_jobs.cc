@@ -0,0 +1,473 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "common_jobs.hh"
+#include "common_conv.hh"
+#include "common_cout.hh"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "error.h"
+
+enum {
+  OPT_JOBS = 1,
+  OPT_JOBS_TIMINGS,
+};
+
+static const argp_option options[] =
+{
+  { "jobs", OPT_JOBS, "N", 0,
+    "process the input with N worker processes, while the results are "
+    "output in input order (default: 1)", 0 },
+  { "jobs-timings", OPT_JOBS_TIMINGS, nullptr, 0,
+    "with --jobs, report the time spent reading the input, processing "
+    "it, and writing the output on standard error", 0 },
+  { nullptr, 0, nullptr, 0, nullptr, 0 }
+};
+
+unsigned opt_jobs = 1;
+bool opt_jobs_timings = false;
+
+static int
+parse_opt_jobs(int key, char* arg, struct argp_state*)
+{
+  // This switch is alphabetically-ordered.
+  switch (key)
+    {
+    case OPT_JOBS:
+      opt_jobs = to_pos_int(arg);
+      if (opt_jobs == 0)
+        error(2, 0, "--jobs expects a positive number");
+      break;
+    case OPT_JOBS_TIMINGS:
+      opt_jobs_timings = true;
+      break;
+    default:
+      return ARGP_ERR_UNKNOWN;
+    }
+  return 0;
+}
+
+const struct argp jobs_argp = { options, parse_opt_jobs,
+                                nullptr, nullptr, nullptr,
+                                nullptr, nullptr };
+
+namespace
+{
+  // Header of the messages sent by the workers.  Tasks are simply
+  // preceded by their size.
+  struct result_header
+  {
+    int32_t status;
+    uint32_t outputs;
+    double time;
+    uint64_t out_size;
+    uint64_t err_size;
+  };
+
+  // Blocking I/O, used by the workers.
+  static void
+  write_all(int fd, const char* data, size_t size)
+  {
+    while (size)
+      {
+        ssize_t n = write(fd, data, size);
+        if (n < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            // The main process has died.
+            _exit(2);
+          }
+        data += n;
+        size -= n;
+      }
+  }
+
+  // Return false on end of file.
+  static bool
+  read_all(int fd, char* data, size_t size)
+  {
+    while (size)
+      {
+        ssize_t n = read(fd, data, size);
+        if (n < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            _exit(2);
+          }
+        if (n == 0)
+          return false;
+        data += n;
+        size -= n;
+      }
+    return true;
+  }
+}
+
+job_pool::job_pool(unsigned workers, worker_fn work, output_fn output)
+  : work_(work), output_(output)
+{
+  // Anything buffered would otherwise be output by each worker.
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(nullptr);
+
+  workers_.reserve(workers);
+  for (unsigned i = 0; i < workers; ++i)
+    {
+      int tasks[2];
+      int results[2];
+      if (pipe(tasks) < 0 || pipe(results) < 0)
+        error(2, errno, "failed to create pipes for workers");
+      pid_t pid = fork();
+      if (pid < 0)
+        error(2, errno, "failed to fork a worker");
+      if (pid == 0)
+        {
+          close(tasks[1]);
+          close(results[0]);
+          // Do not keep the other workers alive.
+          for (auto& w: workers_)
+            {
+              close(w.to);
+              close(w.from);
+            }
+          run_worker(tasks[0], results[1]);
+        }
+      close(tasks[0]);
+      close(results[1]);
+      // Tasks are written without blocking, so that results can be
+      // read from all workers while a large task is being sent.
+      fcntl(tasks[1], F_SETFL, fcntl(tasks[1], F_GETFL) | O_NONBLOCK);
+      workers_.push_back({pid, tasks[1], results[0], false, {}, {}});
+    }
+  read_sw_.start();
+}
+
+job_pool::~job_pool()
+{
+  if (finished_)
+    return;
+  for (auto& w: workers_)
+    {
+      close(w.to);
+      close(w.from);
+      if (w.dead)
+        continue;
+      kill(w.pid, SIGTERM);
+      waitpid(w.pid, nullptr, 0);
+    }
+}
+
+void
+job_pool::run_worker(int from, int to)
+{
+  std::string task;
+  for (;;)
+    {
+      uint64_t size;
+      if (!read_all(from, reinterpret_cast<char*>(&size), sizeof size))
+        break;
+      task.resize(size);
+      if (size && !read_all(from, &task[0], size))
+        break;
+
+      std::ostringstream out;
+      std::ostringstream err;
+      auto old_out = std::cout.rdbuf(out.rdbuf());
+      auto old_err = std::cerr.rdbuf(err.rdbuf());
+      unsigned outputs = 0;
+      spot::stopwatch sw;
+      sw.start();
+      int status = 2;
+      try
+        {
+          status = work_(task, outputs);
+        }
+      catch (const std::exception& e)
+        {
+          std::cout.rdbuf(old_out);
+          std::cerr.rdbuf(old_err);
+          std::cout << out.str() << std::flush;
+          std::cerr << err.str() << std::flush;
+          error(2, 0, "%s", e.what());
+        }
+      double time = sw.stop();
+      std::cout.rdbuf(old_out);
+      std::cerr.rdbuf(old_err);
+
+      std::string o = out.str();
+      std::string e = err.str();
+      result_header h = { status, outputs, time, o.size(), e.size() };
+      write_all(to, reinterpret_cast<char*>(&h), sizeof h);
+      write_all(to, o.data(), o.size());
+      write_all(to, e.data(), e.size());
+    }
+  _exit(0);
+}
+
+void
+job_pool::read_results(worker& w)
+{
+  char buf[65536];
+  ssize_t n = read(w.from, buf, sizeof buf);
+  if (n < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        return;
+      error(2, errno, "failed to read from a worker");
+    }
+  if (n == 0)
+    {
+      // The worker died while processing a task, presumably after
+      // reporting an error, or was killed by a signal.  Output the
+      // results of the previous tasks, and then exit with its
+      // status (or report the signal), as the tool would have done
+      // without --jobs.
+      int wstatus;
+      waitpid(w.pid, &wstatus, 0);
+      w.dead = true;
+      if (w.pending.front() < died_task_)
+        {
+          died_task_ = w.pending.front();
+          died_status_ = (WIFEXITED(wstatus) && WEXITSTATUS(wstatus))
+            ? WEXITSTATUS(wstatus) : 2;
+          died_signal_ = WIFSIGNALED(wstatus) ? WTERMSIG(wstatus) : 0;
+        }
+      return;
+    }
+  w.buf.append(buf, n);
+
+  // Extract all complete results.
+  size_t pos = 0;
+  for (;;)
+    {
+      if (w.buf.size() - pos < sizeof(result_header))
+        break;
+      result_header h;
+      memcpy(&h, w.buf.data() + pos, sizeof h);
+      size_t size = sizeof h + h.out_size + h.err_size;
+      if (w.buf.size() - pos < size)
+        break;
+      result& r = ready_[w.pending.front()];
+      w.pending.pop_front();
+      r.status = h.status;
+      r.outputs = h.outputs;
+      r.time = h.time;
+      const char* data = w.buf.data() + pos + sizeof h;
+      r.out.assign(data, h.out_size);
+      r.err.assign(data + h.out_size, h.err_size);
+      pos += size;
+    }
+  w.buf.erase(0, pos);
+}
+
+void
+job_pool::poll_results(worker* writer)
+{
+  std::vector<pollfd> fds;
+  for (auto& w: workers_)
+    if (!w.pending.empty() && !w.dead)
+      fds.push_back({w.from, POLLIN, 0});
+  if (writer)
+    fds.push_back({writer->to, POLLOUT, 0});
+  if (fds.empty())
+    {
+      output_ready();
+      return;
+    }
+  if (poll(fds.data(), fds.size(), -1) < 0)
+    {
+      if (errno == EINTR)
+        return;
+      error(2, errno, "poll() failed");
+    }
+  unsigned i = 0;
+  for (auto& w: workers_)
+    if (!w.pending.empty() && !w.dead)
+      if (fds[i++].revents)
+        read_results(w);
+  output_ready();
+}
+
+void
+job_pool::output_ready()
+{
+  for (;;)
+    {
+      if (output_next_ == died_task_)
+        {
+          flush_cout();
+          if (died_signal_)
+            error(2, 0, "a worker process was killed by signal %d",
+                  died_signal_);
+          exit(died_status_);
+        }
+      auto i = ready_.find(output_next_);
+      if (i == ready_.end())
+        return;
+      spot::stopwatch sw;
+      sw.start();
+      status_ = std::max(status_, i->second.status);
+      process_time_ += i->second.time;
+      output_(i->second);
+      write_time_ += sw.stop();
+      ready_.erase(i);
+      ++output_next_;
+    }
+}
+
+namespace
+{
+  // Write to a worker without raising SIGPIPE if it has exited: the
+  // handler installed by setup() would kill the main process before
+  // it outputs the results of the previous tasks.  SIGPIPE is only
+  // blocked during the call, so that writing to a closed standard
+  // output still stops the tool as usual.
+  static ssize_t
+  write_to_worker(int fd, const char* data, size_t size)
+  {
+    sigset_t pipe_set;
+    sigset_t old_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    sigprocmask(SIG_BLOCK, &pipe_set, &old_set);
+    ssize_t n = write(fd, data, size);
+    int err = errno;
+    if (n < 0 && err == EPIPE && !sigismember(&old_set, SIGPIPE))
+      {
+        // Discard the SIGPIPE raised by this write.
+        sigset_t pending;
+        int sig;
+        if (sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE))
+          sigwait(&pipe_set, &sig);
+      }
+    sigprocmask(SIG_SETMASK, &old_set, nullptr);
+    errno = err;
+    return n;
+  }
+}
+
+void
+job_pool::send(worker& w, const std::string& msg)
+{
+  size_t pos = 0;
+  while (pos < msg.size())
+    {
+      ssize_t n = write_to_worker(w.to, msg.data() + pos, msg.size() - pos);
+      if (n > 0)
+        {
+          pos += n;
+          continue;
+        }
+      if (n < 0 && errno == EPIPE)
+        {
+          // The worker has exited, presumably after reporting an
+          // error.  Read its last results until the end of its
+          // output, so that read_results() marks it as dead, and
+          // its exit status is reported after the results of the
+          // previous tasks.  The task being sent stays pending
+          // after the task it died on.
+          while (!w.dead)
+            read_results(w);
+          return;
+        }
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        error(2, errno, "failed to send a task to a worker");
+      // The pipe is full: read results (possibly from this same
+      // worker) until it can be written to again.
+      poll_results(&w);
+    }
+}
+
+void
+job_pool::submit(const std::string& task)
+{
+  read_time_ += read_sw_.stop();
+
+  // Keep at most two tasks per worker: the one being processed, and
+  // the next one, so that workers do not wait for the main process
+  // to read the input.
+  spot::stopwatch sw;
+  sw.start();
+  worker* best;
+  for (;;)
+    {
+      best = nullptr;
+      for (auto& w: workers_)
+        if (!w.dead && (!best || w.pending.size() < best->pending.size()))
+          best = &w;
+      if (best && best->pending.size() < 2)
+        break;
+      poll_results(nullptr);
+    }
+  wait_time_ += sw.stop();
+
+  uint64_t size = task.size();
+  std::string msg(reinterpret_cast<char*>(&size), sizeof size);
+  msg += task;
+  best->pending.push_back(submitted_++);
+  send(*best, msg);
+  output_ready();
+  read_sw_.start();
+}
+
+int
+job_pool::finish()
+{
+  read_time_ += read_sw_.stop();
+  spot::stopwatch sw;
+  sw.start();
+  while (output_next_ < submitted_)
+    poll_results(nullptr);
+  wait_time_ += sw.stop();
+  for (auto& w: workers_)
+    {
+      close(w.to);
+      close(w.from);
+      if (!w.dead)
+        waitpid(w.pid, nullptr, 0);
+    }
+  finished_ = true;
+  return status_;
+}
+
+void
+job_pool::print_timings(std::ostream& os) const
+{
+  auto flags = os.flags();
+  os << std::fixed << std::setprecision(3)
+     << workers_.size() << " workers processed " << submitted_
+     << " tasks\n"
+     << "  read:    " << read_time_ << "s\n"
+     << "  process: " << process_time_ << "s (all workers)\n"
+     << "  write:   " << write_time_ << "s\n"
+     << "  wait:    " << wait_time_ << "s\n";
+  os.flags(flags);
+}
@@ -0,0 +1,124 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "common_sys.hh"
+#include <argp.h>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <spot/misc/timer.hh>
+
+extern const struct argp jobs_argp;
+// Number of worker processes (--jobs).  1 means that the input is
+// processed by the main process, as usual.
+extern unsigned opt_jobs;
+// Whether to report the time spent in each stage (--jobs-timings).
+extern bool opt_jobs_timings;
+
+// A pool of worker processes that process independent tasks, while
+// the main process reads the input and outputs the results in input
+// order.
+//
+// The workers are forked by the constructor, so they inherit the
+// whole state of the tool at that point (options, automata loaded
+// from the command line, etc.), and then each of them has its own
+// bdd_dict, BDD package, and caches.  Tasks and results therefore
+// have to be encoded as strings: automata are passed in the HOA
+// format, and the results are what the worker printed on std::cout
+// and std::cerr while processing the task.
+class job_pool final
+{
+public:
+  struct result
+  {
+    int status = 0;             // Returned by the worker function.
+    unsigned outputs = 0;       // Number of items output.
+    double time = 0;            // Seconds spent by the worker.
+    std::string out;            // Printed on std::cout.
+    std::string err;            // Printed on std::cerr.
+  };
+
+  // Process a task in a worker.  Anything printed on std::cout and
+  // std::cerr is captured.  The function should add the number of
+  // items it output to its second argument, and return an exit
+  // status as job_processor's methods do.
+  typedef std::function<int(const std::string&, unsigned&)> worker_fn;
+  // Called by the main process, in input order, for each result.
+  typedef std::function<void(const result&)> output_fn;
+
+  job_pool(unsigned workers, worker_fn work, output_fn output);
+  ~job_pool();
+
+  job_pool(const job_pool&) = delete;
+  job_pool& operator=(const job_pool&) = delete;
+
+  // Send a task to a worker.  This may wait for a worker to be
+  // available, and outputs the results that are ready.
+  void submit(const std::string& task);
+
+  // Wait for all submitted tasks, output their results, and stop the
+  // workers.  Return the largest status returned by the workers.
+  int finish();
+
+  // Report the time spent reading the input, processing tasks (in
+  // all workers), writing results, and waiting for workers.
+  void print_timings(std::ostream& os) const;
+
+private:
+  struct worker
+  {
+    pid_t pid;
+    int to;                     // Tasks are written here.
+    int from;                   // Results are read from here.
+    bool dead;
+    std::deque<unsigned long> pending;
+    std::string buf;            // Partially read results.
+  };
+
+  void run_worker(int from, int to);
+  void send(worker& w, const std::string& msg);
+  void poll_results(worker* writer);
+  void read_results(worker& w);
+  void output_ready();
+
+  worker_fn work_;
+  output_fn output_;
+  std::vector<worker> workers_;
+  std::map<unsigned long, result> ready_;
+  unsigned long submitted_ = 0;
+  unsigned long output_next_ = 0;
+  int status_ = 0;
+  // The first task whose worker died, and the exit status of that
+  // worker, or the signal that killed it.
+  unsigned long died_task_ = -1UL;
+  int died_status_ = 0;
+  int died_signal_ = 0;
+  bool finished_ = false;
+  double read_time_ = 0;
+  double process_time_ = 0;
+  double write_time_ = 0;
+  double wait_time_ = 0;
+  spot::stopwatch read_sw_;
+};
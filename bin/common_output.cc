@@ -388,3 +388,9 @@ output_formula_checked(spot::formula f,
   // (like disk full or broken pipe with SIGPIPE ignored).
   check_cout();
 }
+
+bool
+output_to_files()
+{
+  return outputnamer != nullptr;
+}
@@ -63,6 +63,9 @@ void output_formula_checked(spot::formula f,
                             const char* prefix = nullptr,
                             const char* suffix = nullptr);
 
+// Whether formulas are output to files (--output).
+bool output_to_files();
+
 
 class printable_formula:
   public spot::printable_value<spot::formula>
@@ -21,6 +21,9 @@
 #include <cstring>
 #include <cstdlib>
 #include <cassert>
+#include <cmath>
+#include <ctime>
+#include <deque>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/wait.h>
@@ -241,6 +244,13 @@ void printable_result_filename::cleanup()
   val_ = nullptr;
 }
 
+spot::temporary_file* printable_result_filename::release()
+{
+  spot::temporary_file* res = val_;
+  val_ = nullptr;
+  return res;
+}
+
 void
 printable_result_filename::print(std::ostream& os, const char*) const
 {
@@ -272,9 +282,25 @@ filed_formula::string_to_tmp(const std::string str, unsigned n) const
       || write(fd, "\n", 1) != 1)
     error(2, errno, "failed to write into %s", tmpname.c_str());
   tmpfile->close();
+  files_.push_back(tmpfile);
   return tmpname;
 }
 
+std::vector<spot::temporary_file*>
+filed_formula::release_files()
+{
+  std::vector<spot::temporary_file*> res;
+  std::swap(res, files_);
+  return res;
+}
+
+exec_job::~exec_job()
+{
+  delete output;
+  for (auto* f: inputs)
+    delete f;
+}
+
 translator_runner::translator_runner(spot::bdd_dict_ptr dict,
                                      bool no_output_allowed)
   : dict(dict)
@@ -342,63 +368,215 @@ translator_runner::round_formula(spot::formula f, unsigned serial)
   filename_formula.new_round(serial);
 }
 
-volatile bool timed_out = false;
+void
+translator_runner::prepare_job(unsigned translator_num, exec_job& job)
+{
+  output.reset(translator_num);
+
+  std::ostringstream command;
+  format(command, translators[translator_num].cmd);
+
+  job.cmd = command.str();
+  job.output = output.release();
+  job.inputs = filename_formula.release_files();
+}
+
 unsigned timeout_count = 0;
+unsigned parallel_jobs = 1;
 
 static unsigned timeout = 0;
 #if ENABLE_TIMEOUT
-static volatile int alarm_on = 0;
-static int child_pid = -1;
+namespace
+{
+  // A command being run.  There is one slot per command that may
+  // run at the same time.  The signal handlers read and update
+  // these slots, so the rest of the code only touches them while
+  // the signals are blocked.
+  struct child_slot
+  {
+    exec_job* job = nullptr;    // nullptr if the slot is free
+    pid_t pid = 0;
+    bool finished = false;      // set once the child has been reaped
+    int status = 0;
+    bool timed_out = false;
+    // Number of signals to send once the deadline is reached.
+    int kills = 0;
+    double start = 0.0;
+    double deadline = 0.0;
+    double end = 0.0;
+    clock_t cutime = 0;
+    clock_t cstime = 0;
+  };
+
+  // A timer holding the CPU time of a terminated child.
+  struct child_timer final: public spot::timer
+  {
+    child_timer(clock_t cutime, clock_t cstime)
+    {
+      total_.cutime = cutime;
+      total_.cstime = cstime;
+    }
+  };
+}
+
+static std::vector<child_slot> slots;
+static std::deque<exec_job*> job_queue;
+static volatile sig_atomic_t in_child = 0;
+// The signals we handle, and the signal mask to restore when we
+// unblock them.
+static sigset_t handled_signals;
+static sigset_t unblocked_mask;
+
+static double
+monotonic_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Schedule a SIGALRM for the earliest deadline of the running
+// children.
+static void
+arm_alarm(double now)
+{
+  double next = 0.0;
+  for (auto& s: slots)
+    if (s.job && !s.finished && s.kills
+        && (next == 0.0 || s.deadline < next))
+      next = s.deadline;
+  if (next == 0.0)
+    alarm(0);
+  else if (next <= now)
+    alarm(1);
+  else
+    alarm(static_cast<unsigned>(ceil(next - now)));
+}
+
+// Reap the children that have terminated.
+static void
+reap_children()
+{
+  for (auto& s: slots)
+    if (s.job && !s.finished)
+      {
+#ifdef SPOT_HAVE_TIMES
+        struct tms before;
+        times(&before);
+#endif
+        int status;
+        if (waitpid(s.pid, &status, WNOHANG) != s.pid)
+          continue;
+        s.end = monotonic_now();
+#ifdef SPOT_HAVE_TIMES
+        // Only this child has been reaped in between, so the
+        // difference is its own CPU time.
+        struct tms after;
+        times(&after);
+        s.cutime = after.tms_cutime - before.tms_cutime;
+        s.cstime = after.tms_cstime - before.tms_cstime;
+#endif
+        s.status = status;
+        s.finished = true;
+      }
+}
+
+// Signal the children that have exceeded their deadline.  Each of
+// them receives up to 3 signals: SIGTERM, SIGTERM, SIGKILL.
+static void
+kill_late_children()
+{
+  double now = monotonic_now();
+  for (auto& s: slots)
+    if (s.job && !s.finished && s.kills && s.deadline <= now)
+      {
+        s.timed_out = true;
+        if (--s.kills)
+          {
+            // Send SIGTERM to children.
+            kill(-s.pid, SIGTERM);
+            // Try again later if it didn't work.
+            s.deadline = now + 2;
+          }
+        else
+          {
+            // After a few gentle tries, really kill that child.
+            kill(-s.pid, SIGKILL);
+          }
+      }
+  arm_alarm(now);
+}
 
 static void
 sig_handler(int sig)
 {
-  if (child_pid == 0)
+  if (in_child)
     error(2, 0, "received signal %d before starting child", sig);
 
-  if (sig == SIGALRM && alarm_on)
+  int saved_errno = errno;
+  if (sig == SIGCHLD)
     {
-      timed_out = true;
-      if (--alarm_on)
-        {
-          // Send SIGTERM to children.
-          kill(-child_pid, SIGTERM);
-          // Try again later if it didn't work.  (alarm() will be reset
-          // if it did work and the call to wait() returns)
-          alarm(2);
-        }
-      else
-        {
-          // After a few gentle tries, really kill that child.
-          kill(-child_pid, SIGKILL);
-        }
+      reap_children();
+    }
+  else if (sig == SIGALRM)
+    {
+      kill_late_children();
     }
   else
     {
       // forward signal
-      kill(-child_pid, sig);
+      for (auto& s: slots)
+        if (s.job && !s.finished)
+          kill(-s.pid, sig);
       // cleanup files
       spot::cleanup_tmpfiles();
       // and die verbosely
       error(2, 0, "received signal %d", sig);
     }
+  errno = saved_errno;
 }
 
 void
 setup_sig_handler()
 {
+  slots.resize(parallel_jobs);
+
+  sigemptyset(&handled_signals);
+  sigaddset(&handled_signals, SIGALRM);
+  sigaddset(&handled_signals, SIGCHLD);
+  sigaddset(&handled_signals, SIGHUP);
+  sigaddset(&handled_signals, SIGINT);
+  sigaddset(&handled_signals, SIGQUIT);
+  sigaddset(&handled_signals, SIGTERM);
+
   struct sigaction sa;
   sa.sa_handler = sig_handler;
-  sigemptyset(&sa.sa_mask);
-  sa.sa_flags = SA_RESTART; // So that wait() doesn't get aborted by SIGALRM.
+  // Handlers should not interrupt each other, as they all access
+  // the slots.
+  sa.sa_mask = handled_signals;
+  // So that system calls are not aborted by SIGALRM or SIGCHLD.
+  sa.sa_flags = SA_RESTART;
   sigaction(SIGALRM, &sa, nullptr);
-  // Catch termination signals, so we can kill the subprocess.
+  // Catch termination signals, so we can kill the subprocesses.
   sigaction(SIGHUP, &sa, nullptr);
   sigaction(SIGINT, &sa, nullptr);
   sigaction(SIGQUIT, &sa, nullptr);
   sigaction(SIGTERM, &sa, nullptr);
+  sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  sigaction(SIGCHLD, &sa, nullptr);
 }
 
+static void
+block_signals()
+{
+  sigprocmask(SIG_BLOCK, &handled_signals, &unblocked_mask);
+}
+
+static void
+unblock_signals()
+{
+  sigprocmask(SIG_SETMASK, &unblocked_mask, nullptr);
+}
 
 static char*
 get_arg(const char*& cmd)
@@ -585,45 +763,114 @@ exec_command(const char* cmd)
   return;
 }
 
-int
-exec_with_timeout(const char* cmd)
+// Start JOB in the free slot S.  Signals must be blocked.
+static void
+start_child(child_slot& s, exec_job* job)
 {
-  int status;
-
-  timed_out = false;
-
-  child_pid = fork();
-  if (child_pid == -1)
+  pid_t pid = fork();
+  if (pid == -1)
     error(2, errno, "failed to fork()");
 
-  if (child_pid == 0)
+  if (pid == 0)
     {
+      in_child = 1;
       setpgid(0, 0);
-      exec_command(cmd);
+      sigprocmask(SIG_SETMASK, &unblocked_mask, nullptr);
+      exec_command(job->cmd.c_str());
       // never reached
-      return -1;
+      return;
     }
-  else
+  // Also done by the child, but we need the process group to exist
+  // before we attempt to kill it.
+  setpgid(pid, pid);
+
+  s.job = job;
+  s.pid = pid;
+  s.finished = false;
+  s.timed_out = false;
+  s.kills = timeout ? 3 : 0;
+  s.start = monotonic_now();
+  s.deadline = s.start + timeout;
+  arm_alarm(s.start);
+}
+
+// Collect the children that have terminated, and start queued jobs
+// in the free slots.  Signals must be blocked.
+static void
+dispatch_jobs()
+{
+  for (auto& s: slots)
     {
-      alarm(timeout);
-      // Upon SIGALRM, the child will receive up to 3
-      // signals: SIGTERM, SIGTERM, SIGKILL.
-      alarm_on = 3;
-      int w = waitpid(child_pid, &status, 0);
-      alarm_on = 0;
+      if (s.job && s.finished)
+        {
+          exec_job* job = s.job;
+          job->status = s.status;
+          job->timed_out = s.timed_out;
+          job->time = s.end - s.start;
+          job->cpu = child_timer(s.cutime, s.cstime);
+          job->done = true;
+          s.job = nullptr;
+        }
+      if (!s.job && !job_queue.empty())
+        {
+          start_child(s, job_queue.front());
+          job_queue.pop_front();
+        }
+    }
+}
 
-      if (w == -1)
-        error(2, errno, "error during wait()");
+void
+exec_start(exec_job* job)
+{
+  assert(!slots.empty());
+  job->done = false;
+  block_signals();
+  job_queue.push_back(job);
+  dispatch_jobs();
+  unblock_signals();
+}
 
-      alarm(0);
+void
+exec_wait(exec_job* job)
+{
+  block_signals();
+  for (;;)
+    {
+      dispatch_jobs();
+      if (job->done)
+        break;
+      // Sleep until some child terminates or some deadline expires.
+      sigsuspend(&unblocked_mask);
     }
-  return status;
+  unblock_signals();
+}
+#else // !ENABLE_TIMEOUT
+
+void
+exec_start(exec_job* job)
+{
+  // Without kill() and alarm(), commands are run one at a time as
+  // soon as they are queued.
+  spot::stopwatch sw;
+  sw.start();
+  job->cpu.start();
+  job->status = system(job->cmd.c_str());
+  job->cpu.stop();
+  job->time = sw.stop();
+  job->timed_out = false;
+  job->done = true;
+}
+
+void
+exec_wait(exec_job*)
+{
 }
-#endif // ENABLE_TIMEOUT
+#endif // !ENABLE_TIMEOUT
 
 enum {
   OPT_LIST = 1,
   OPT_RELABEL = 2,
+  OPT_PARALLEL = 3,
 };
 static const argp_option options[] =
 {
@@ -632,6 +879,8 @@ static const argp_option options[] =
     { "translator", 't', "COMMANDFMT", 0,
       "register one translator to call", 0 },
     { "timeout", 'T', "NUMBER", 0, "kill translators after NUMBER seconds", 0 },
+    { "parallel", OPT_PARALLEL, "N", 0,
+      "run up to N translators at the same time (default: 1)", 0 },
     { "list-shorthands", OPT_LIST, nullptr, 0,
       "list availabled shorthands to use in COMMANDFMT", 0},
     { "relabel", OPT_RELABEL, nullptr, 0,
@@ -687,6 +936,16 @@ static int parse_opt_trans(int key, char* arg, struct argp_state*)
     case OPT_RELABEL:
       opt_relabel = true;
       break;
+    case OPT_PARALLEL:
+      parallel_jobs = to_pos_int(arg);
+      if (parallel_jobs == 0)
+        error(2, 0, "--parallel expects a positive number");
+#if !ENABLE_TIMEOUT
+      if (parallel_jobs > 1)
+        std::cerr << "warning: running translators in parallel is not "
+                  << "supported on your platform" << std::endl;
+#endif
+      break;
     default:
       return ARGP_ERR_UNKNOWN;
     }
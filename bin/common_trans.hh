@@ -24,12 +24,15 @@
 #include <argp.h>
 
 #include <spot/misc/formater.hh>
+#include <spot/misc/timer.hh>
 #include <spot/misc/tmpfile.hh>
 #include <spot/twa/twagraph.hh>
 
 
 extern const struct argp trans_argp;
 extern bool opt_relabel;
+// Maximum number of translators to run at the same time (--parallel).
+extern unsigned parallel_jobs;
 
 struct translator_spec
 {
@@ -77,9 +80,14 @@ struct filed_formula final: public spot::printable
     serial_ = serial;
   }
 
+  // Transfer the ownership of the files created by print() since
+  // the last call.
+  std::vector<spot::temporary_file*> release_files();
+
  private:
   const quoted_formula& f_;
   unsigned serial_;
+  mutable std::vector<spot::temporary_file*> files_;
   std::string string_to_tmp(const std::string str, unsigned n) const;
 };
 
@@ -92,11 +100,35 @@ struct printable_result_filename final:
   ~printable_result_filename();
   void reset(unsigned n);
   void cleanup();
+  // Transfer the ownership of the current output file.
+  spot::temporary_file* release();
 
   void print(std::ostream& os, const char* pos) const override;
 };
 
 
+// A command to run, with the files it reads and writes.  The
+// result fields are filled once the command has terminated.
+struct exec_job
+{
+  std::string cmd;
+  // Output file (%O) of the command, if any.
+  spot::temporary_file* output = nullptr;
+  // Input files (%F, %S, %L, %W) of the command.
+  std::vector<spot::temporary_file*> inputs;
+
+  bool done = false;
+  int status = 0;               // as returned by waitpid()
+  bool timed_out = false;
+  double time = 0.0;            // wall-clock time, in seconds
+  spot::timer cpu;              // CPU time of the child process
+
+  exec_job() = default;
+  exec_job(const exec_job&) = delete;
+  exec_job& operator=(const exec_job&) = delete;
+  ~exec_job();
+};
+
 class translator_runner: protected spot::formater
 {
 protected:
@@ -115,6 +147,9 @@ public:
                     bool no_output_allowed = false);
   std::string formula() const;
   void round_formula(spot::formula f, unsigned serial);
+  // Prepare JOB to run translator TRANSLATOR_NUM on the current
+  // formula.  JOB takes ownership of the temporary files involved.
+  void prepare_job(unsigned translator_num, exec_job& job);
 };
 
 
@@ -126,12 +161,17 @@ public:
 # define ENABLE_TIMEOUT 0
 #endif
 
-extern volatile bool timed_out;
 extern unsigned timeout_count;
 #if ENABLE_TIMEOUT
 void setup_sig_handler();
-int exec_with_timeout(const char* cmd);
 #else // !ENABLE_TIMEOUT
-#define exec_with_timeout(cmd) system(cmd)
 #define setup_sig_handler() while (0);
 #endif // !ENABLE_TIMEOUT
+
+// Queue JOB for execution.  Up to parallel_jobs commands are run
+// at the same time, each with its own timeout.  JOB must stay alive
+// until it has been passed to exec_wait().
+void exec_start(exec_job* job);
+// Wait until JOB has terminated.  Queued jobs are started as the
+// running ones terminate.
+void exec_wait(exec_job* job);
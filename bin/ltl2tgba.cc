@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2014, 2015, 2016 Laboratoire de Recherche
-// et Développement de l'Epita (LRDE).
+// Copyright (C) 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// Recherche et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -21,6 +21,7 @@
 
 #include <string>
 #include <iostream>
+#include <memory>
 
 #include <argp.h>
 #include "error.h"
@@ -32,10 +33,12 @@
 #include "common_output.hh"
 #include "common_aoutput.hh"
 #include "common_post.hh"
+#include "common_jobs.hh"
 
 #include <spot/tl/formula.hh>
 #include <spot/tl/print.hh>
 #include <spot/twaalgos/translate.hh>
+#include <spot/twaalgos/transcache.hh>
 #include <spot/misc/optionmap.hh>
 #include <spot/misc/timer.hh>
 
@@ -47,6 +50,11 @@ in GraphViz's format.\n\
 If multiple formulas are supplied, several automata will be output.";
 
 
+enum {
+  OPT_CACHE = 1,
+  OPT_CACHE_STATS,
+};
+
 static const argp_option options[] =
   {
     /**************************************************/
@@ -61,6 +69,13 @@ static const argp_option options[] =
     /**************************************************/
     { "unambiguous", 'U', nullptr, 0, "output unambiguous automata", 2 },
     { nullptr, 0, nullptr, 0, "Miscellaneous options:", -1 },
+    { "cache", OPT_CACHE, "DIR", 0,
+      "store the output automata in directory DIR, and reuse them when "
+      "the same formula (up to the names of its atomic propositions) is "
+      "translated again with the same options, possibly by another "
+      "process", 0 },
+    { "cache-stats", OPT_CACHE_STATS, nullptr, 0,
+      "with --cache, report cache hits and misses on standard error", 0 },
     { "extra-options", 'x', "OPTS", 0,
       "fine-tuning options (see spot-x (7))", 0 },
     { nullptr, 0, nullptr, 0, nullptr, 0 }
@@ -72,12 +87,15 @@ const struct argp_child children[] =
     { &aoutput_argp, 0, nullptr, 0 },
     { &aoutput_o_format_argp, 0, nullptr, 0 },
     { &post_argp, 0, nullptr, 0 },
+    { &jobs_argp, 0, nullptr, -1 },
     { &misc_argp, 0, nullptr, -1 },
     { nullptr, 0, nullptr, 0 }
   };
 
 static spot::option_map extra_options;
 static spot::postprocessor::output_pref unambig = 0;
+static const char* opt_cache = nullptr;
+static bool opt_cache_stats = false;
 
 static int
 parse_opt(int key, char* arg, struct argp_state*)
@@ -95,6 +113,12 @@ parse_opt(int key, char* arg, struct argp_state*)
           error(2, 0, "failed to parse --options near '%s'", opt);
       }
       break;
+    case OPT_CACHE:
+      opt_cache = arg;
+      break;
+    case OPT_CACHE_STATS:
+      opt_cache_stats = true;
+      break;
     case ARGP_KEY_ARG:
       // FIXME: use stat() to distinguish filename from string?
       if (*arg == '-' && !arg[1])
@@ -176,9 +200,32 @@ main(int argc, char** argv)
       trans.set_type(type);
       trans.set_level(level);
 
+      std::unique_ptr<spot::translation_cache> cache;
+      if (opt_cache)
+        {
+          cache.reset(new spot::translation_cache(opt_cache));
+          trans.set_cache(cache.get());
+        }
+
       trans_processor processor(trans);
+      if (opt_jobs > 1)
+        {
+          // Workers would write to the same files concurrently.
+          if (opt_output)
+            std::cerr << "warning: --jobs is ignored with --output"
+                      << std::endl;
+          else
+            processor.start_jobs();
+        }
+      // Each worker uses its own copy of the cache, so the main
+      // process has no statistics to report.
+      if (opt_cache_stats && opt_jobs > 1 && !opt_output)
+        std::cerr << "warning: --cache-stats is ignored with --jobs"
+                  << std::endl;
       if (processor.run())
         return 2;
+      if (cache && opt_cache_stats && (opt_jobs == 1 || opt_output))
+        cache->print_stats(std::cerr) << std::endl;
 
       // Diagnose unused -x options
       extra_options.report_unused_options();
@@ -23,6 +23,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <deque>
 #include <cstdlib>
 #include <cstdio>
 #include <argp.h>
@@ -544,26 +545,20 @@ namespace
     {
     }
 
+    // Wait for JOB, which runs translator TRANSLATOR_NUM, and read
+    // the automaton it produced.
     spot::twa_graph_ptr
-    translate(unsigned int translator_num, char l, statistics_formula* fstats,
-              bool& problem)
+    translate(unsigned int translator_num, char l, exec_job& job,
+              statistics_formula* fstats, bool& problem)
     {
-      output.reset(translator_num);
-
-      std::ostringstream command;
-      format(command, translators[translator_num].cmd);
-
-      std::string cmd = command.str();
       std::cerr << "Running [" << l << translator_num << "]: "
-                << cmd << std::endl;
-      process_timer timer;
-      timer.start();
-      int es = exec_with_timeout(cmd.c_str());
-      timer.stop();
+                << job.cmd << std::endl;
+      exec_wait(&job);
+      int es = job.status;
       const char* status_str = nullptr;
 
       spot::twa_graph_ptr res = nullptr;
-      if (timed_out)
+      if (job.timed_out)
         {
           // This is not considered to be a global error.
           std::cerr << "warning: timeout during execution of command\n";
@@ -606,7 +601,7 @@ namespace
           problem = false;
           es = 0;
 
-          auto aut = spot::parse_aut(output.val()->name(), dict,
+          auto aut = spot::parse_aut(job.output->name(), dict,
                                      spot::default_environment::instance(),
                                      opt_parse);
           if (!aut->errors.empty())
@@ -640,7 +635,7 @@ namespace
           statistics* st = &(*fstats)[translator_num];
           st->status_str = status_str;
           st->status_code = es;
-          st->time = timer.get_lap_sw();
+          st->time = job.time;
 
           // Compute statistics.
           if (res)
@@ -692,7 +687,6 @@ namespace
                 }
             }
         }
-      output.cleanup();
       return res;
     }
   };
@@ -703,7 +697,7 @@ namespace
                    size_t i, size_t j, bool icomp, bool jcomp)
   {
     if (aut_i->num_sets() + aut_j->num_sets()
-        > 8 * sizeof(spot::acc_cond::mark_t::value_t))
+        > spot::acc_cond::mark_t::max_accsets())
       {
         // Report the skipped test if both automata are not
         // complemented, or the --verbose option is used,
@@ -874,14 +868,40 @@ namespace
   typedef
   std::unordered_set<spot::formula> fset_t;
 
+  // A formula whose translations have been started, but not yet
+  // checked.
+  struct pending_formula
+  {
+    std::string input;          // as read, for --save-bogus and --grind
+    spot::formula input_f;
+    spot::formula f;            // possibly relabeled
+    std::string fstr;
+    std::string nfstr;
+    std::string filename;
+    bool has_filename = false;
+    int linenum = 0;
+    bool dup = false;
+    // The translations of the positive formula, followed by those
+    // of the negative formula.
+    std::vector<exec_job> jobs;
+  };
+
   class processor final: public job_processor
   {
     spot::bdd_dict_ptr dict = spot::make_bdd_dict();
     xtranslator_runner runner;
     fset_t unique_set;
+    unsigned round = 0;
+    // With --parallel, the translations of the next formulas are
+    // started before the current one is checked, so that the
+    // translators keep running during the checks.  --grind needs
+    // each formula to be checked before the next one is read.
+    std::deque<pending_formula> pending;
+    unsigned lookahead;
   public:
     processor():
-      runner(dict)
+      runner(dict),
+      lookahead((parallel_jobs > 1 && !grind_output) ? parallel_jobs : 0)
     {
     }
 
@@ -898,9 +918,52 @@ namespace
           pf.format_errors(std::cerr);
           return 1;
         }
-      auto f = pf.f;
 
-      int res = process_formula(f, filename, linenum);
+      pending.emplace_back();
+      pending.back().input = input;
+      pending.back().input_f = pf.f;
+      start_formula(pf.f, filename, linenum, pending.back());
+      while (pending.size() > lookahead)
+        check_pending();
+      return 0;
+    }
+
+    int
+    run() override
+    {
+      int res = job_processor::run();
+      while (!pending.empty())
+        check_pending();
+      return res;
+    }
+
+    int
+    process_formula(spot::formula f,
+                    const char* filename = nullptr, int linenum = 0) override
+    {
+      pending_formula pf;
+      start_formula(f, filename, linenum, pf);
+      return check_formula(pf);
+    }
+
+    // Check the oldest pending formula.
+    void
+    check_pending()
+    {
+      pending_formula& pf = pending.front();
+      if (abort_run)
+        {
+          // An error occurred in a previous formula, and
+          // --stop-on-error was given.
+          for (auto& job: pf.jobs)
+            exec_wait(&job);
+          pending.pop_front();
+          return;
+        }
+      std::string input = pf.input;
+      spot::formula f = pf.input_f;
+      int res = check_formula(pf);
+      pending.pop_front();
 
       if (res && bogus_output)
         bogus_output->ostream() << input << std::endl;
@@ -959,7 +1022,6 @@ namespace
           std::cerr << ".\n\n";
           grind_output->ostream() << bogus << std::endl;
         }
-      return 0;
     }
 
     void product_stats(statistics_formula* stats, unsigned i,
@@ -988,12 +1050,11 @@ namespace
         }
     }
 
-    int
-    process_formula(spot::formula f,
-                    const char* filename = nullptr, int linenum = 0) override
+    // Start the translations of F without waiting for them.
+    void
+    start_formula(spot::formula f, const char* filename, int linenum,
+                  pending_formula& pf)
     {
-      static unsigned round = 0;
-
       if (opt_relabel
           // If we need LBT atomic proposition in any of the input or
           // output, relabel the formula.
@@ -1004,40 +1065,89 @@ namespace
               (runner.has('s') || runner.has('S'))))
         f = spot::relabel(f, spot::Pnn);
 
+      pf.f = f;
+      pf.has_filename = filename;
+      if (filename)
+        pf.filename = filename;
+      pf.linenum = linenum;
+
       // ---------- Positive Formula ----------
 
       runner.round_formula(f, round);
 
       // Call formula() before printing anything else, in case it
       // complains.
-      std::string fstr = runner.formula();
-      if (filename)
-        std::cerr << filename << ':';
-      if (linenum)
-        std::cerr << linenum << ':';
-      if (filename || linenum)
+      pf.fstr = runner.formula();
+
+      // Make sure we do not translate the same formula twice.
+      if (!allow_dups && !unique_set.insert(f).second)
+        {
+          pf.dup = true;
+          return;
+        }
+
+      size_t m = translators.size();
+      pf.jobs = std::vector<exec_job>(no_checks ? m : 2 * m);
+      for (size_t n = 0; n < m; ++n)
+        runner.prepare_job(n, pf.jobs[n]);
+
+      // ---------- Negative Formula ----------
+
+      // The negative formula is only needed when checks are
+      // activated.
+      if (!no_checks)
+        {
+          spot::formula nf = spot::formula::Not(f);
+
+          if (!allow_dups)
+            {
+              bool res = unique_set.insert(nf).second;
+              // It is not possible to discover that nf has already been
+              // translated, otherwise that would mean that f had been
+              // translated too and we would have caught it before.
+              assert(res);
+              (void) res;
+            }
+
+          runner.round_formula(nf, round);
+          pf.nfstr = runner.formula();
+
+          for (size_t n = 0; n < m; ++n)
+            runner.prepare_job(n, pf.jobs[m + n]);
+        }
+      ++round;
+
+      for (auto& job: pf.jobs)
+        exec_start(&job);
+    }
+
+    // Collect the translations of PF, and check them.
+    int
+    check_formula(pending_formula& pf)
+    {
+      if (pf.has_filename)
+        std::cerr << pf.filename << ':';
+      if (pf.linenum)
+        std::cerr << pf.linenum << ':';
+      if (pf.has_filename || pf.linenum)
         std::cerr << ' ';
       if (color_opt)
         std::cerr << bold;
-      std::cerr << fstr << '\n';
+      std::cerr << pf.fstr << '\n';
       if (color_opt)
         std::cerr << reset_color;
 
-      // Make sure we do not translate the same formula twice.
-      if (!allow_dups)
+      if (pf.dup)
         {
-          if (!unique_set.insert(f).second)
-            {
-              std::cerr
-                << ("warning: This formula or its negation has already"
-                    " been checked.\n         Use --allow-dups if it "
-                    "should not be ignored.\n")
-                << std::endl;
-              return 0;
-            }
+          std::cerr
+            << ("warning: This formula or its negation has already"
+                " been checked.\n         Use --allow-dups if it "
+                "should not be ignored.\n")
+            << std::endl;
+          return 0;
         }
 
-
+      spot::formula f = pf.f;
       int problems = 0;
 
       // These store the result of the translation of the positive and
@@ -1056,50 +1166,30 @@ namespace
       statistics_formula* pstats = &vstats[n];
       statistics_formula* nstats = nullptr;
       pstats->resize(m);
-      formulas.push_back(fstr);
+      formulas.push_back(pf.fstr);
 
       for (size_t n = 0; n < m; ++n)
         {
           bool prob;
-          pos[n] = runner.translate(n, 'P', pstats, prob);
+          pos[n] = runner.translate(n, 'P', pf.jobs[n], pstats, prob);
           problems += prob;
         }
 
-      // ---------- Negative Formula ----------
-
-      // The negative formula is only needed when checks are
-      // activated.
       if (!no_checks)
         {
           nstats = &vstats[n + 1];
           nstats->resize(m);
-
-          spot::formula nf = spot::formula::Not(f);
-
-          if (!allow_dups)
-            {
-              bool res = unique_set.insert(nf).second;
-              // It is not possible to discover that nf has already been
-              // translated, otherwise that would mean that f had been
-              // translated too and we would have caught it before.
-              assert(res);
-              (void) res;
-            }
-
-          runner.round_formula(nf, round);
-          formulas.push_back(runner.formula());
+          formulas.push_back(pf.nfstr);
 
           for (size_t n = 0; n < m; ++n)
             {
               bool prob;
-              neg[n] = runner.translate(n, 'N', nstats, prob);
+              neg[n] = runner.translate(n, 'N', pf.jobs[m + n], nstats,
+                                        prob);
               problems += prob;
             }
         }
 
-      spot::cleanup_tmpfiles();
-      ++round;
-
       auto printsize = [](const spot::const_twa_graph_ptr& aut)
         {
           std::cerr << aut->num_states() << " st.,"
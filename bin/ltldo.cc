@@ -22,6 +22,8 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <deque>
+#include <memory>
 #include <fstream>
 #include <sys/wait.h>
 
@@ -37,6 +39,7 @@
 #include "common_trans.hh"
 #include "common_hoaread.hh"
 
+#include <spot/tl/print.hh>
 #include <spot/tl/relabel.hh>
 #include <spot/misc/bareword.hh>
 #include <spot/misc/timer.hh>
@@ -189,24 +192,17 @@ namespace
     {
     }
 
+    // Wait for JOB and read the automaton it produced.
     spot::twa_graph_ptr
-    translate(unsigned int translator_num, bool& problem, process_timer& timer)
+    translate(exec_job& job, bool& problem)
     {
-      output.reset(translator_num);
-
-      std::ostringstream command;
-      format(command, translators[translator_num].cmd);
-
-      std::string cmd = command.str();
-      //std::cerr << "Running [" << l << translator_num << "]: "
-      // << cmd << std::endl;
-      timer.start();
-      int es = exec_with_timeout(cmd.c_str());
-      timer.stop();
+      exec_wait(&job);
+      const std::string& cmd = job.cmd;
+      int es = job.status;
 
       spot::twa_graph_ptr res = nullptr;
       problem = false;
-      if (timed_out)
+      if (job.timed_out)
         {
           // A timeout is considered benign
           std::cerr << "warning: timeout during execution of command \""
@@ -233,9 +229,9 @@ namespace
                         << "\" returned exit code " << es << ".\n";
             }
         }
-      else if (output.val())
+      else if (job.output)
         {
-          auto aut = spot::parse_aut(output.val()->name(), dict,
+          auto aut = spot::parse_aut(job.output->name(), dict,
                                      spot::default_environment::instance(),
                                      opt_parse);
           if (!aut->errors.empty() && errors_opt != errors_ignore)
@@ -263,12 +259,30 @@ namespace
           problem = false;
           res = nullptr;
         }
-      output.cleanup();
       return res;
     }
   };
 
 
+  // A formula whose translations have been started, but whose
+  // automata have not been output yet.
+  struct pending_formula
+  {
+    std::string input;
+    spot::formula f;            // possibly relabeled
+    std::unique_ptr<spot::relabeling_map> relmap;
+    unsigned round = 0;
+    std::string filename;
+    bool has_filename = false;
+    int linenum = 0;
+    // The parts of the CSV line around the formula, for %< and %>.
+    std::string prefix;
+    bool has_prefix = false;
+    std::string suffix;
+    bool has_suffix = false;
+    std::vector<exec_job> jobs;
+  };
+
   class processor final: public job_processor
   {
     spot::bdd_dict_ptr dict = spot::make_bdd_dict();
@@ -280,10 +294,16 @@ namespace
     spot::printable_value<std::string> cmdname;
     spot::printable_value<unsigned> roundval;
     spot::printable_value<std::string> inputf;
+    unsigned round = 1;
+    // With --parallel, the translations of the next formulas are
+    // started before the automata of the current one are output.
+    std::deque<pending_formula> pending;
+    unsigned lookahead;
 
   public:
     processor(spot::postprocessor& post)
-      : runner(dict), best_printer(best_stream, best_format), post(post)
+      : runner(dict), best_printer(best_stream, best_format), post(post),
+        lookahead(parallel_jobs > 1 ? parallel_jobs : 0)
     {
       printer.add_stat('T', &cmdname);
       printer.add_stat('#', &roundval);
@@ -312,18 +332,45 @@ namespace
           return 1;
         }
 
-      inputf = input;
-      process_formula(pf.f, filename, linenum);
+      pending.emplace_back();
+      pending.back().input = input;
+      start_formula(pf.f, filename, linenum, pending.back());
+      while (pending.size() > lookahead)
+        {
+          output_formula(pending.front());
+          pending.pop_front();
+        }
       return 0;
     }
 
+    int
+    run() override
+    {
+      int res = job_processor::run();
+      while (!pending.empty())
+        {
+          output_formula(pending.front());
+          pending.pop_front();
+        }
+      return res;
+    }
 
     int
     process_formula(spot::formula f,
                     const char* filename = nullptr, int linenum = 0) override
     {
-      std::unique_ptr<spot::relabeling_map> relmap;
+      pending_formula pf;
+      pf.input = spot::str_psl(f);
+      start_formula(f, filename, linenum, pf);
+      output_formula(pf);
+      return 0;
+    }
 
+    // Start the translations of F without waiting for them.
+    void
+    start_formula(spot::formula f, const char* filename, int linenum,
+                  pending_formula& pf)
+    {
       // If atomic propositions are incompatible with one of the
       // output, relabel the formula.
       if (opt_relabel
@@ -332,12 +379,44 @@ namespace
           || (!f.has_spin_atomic_props() &&
               (runner.has('s') || runner.has('S'))))
         {
-          relmap.reset(new spot::relabeling_map);
-          f = spot::relabel(f, spot::Pnn, relmap.get());
+          pf.relmap.reset(new spot::relabeling_map);
+          f = spot::relabel(f, spot::Pnn, pf.relmap.get());
         }
 
-      static unsigned round = 1;
+      pf.f = f;
+      pf.round = round;
+      pf.has_filename = filename;
+      if (filename)
+        pf.filename = filename;
+      pf.linenum = linenum;
+      pf.has_prefix = prefix;
+      if (prefix)
+        pf.prefix = prefix;
+      pf.has_suffix = suffix;
+      if (suffix)
+        pf.suffix = suffix;
+
       runner.round_formula(f, round);
+      ++round;
+
+      unsigned ts = translators.size();
+      pf.jobs = std::vector<exec_job>(ts);
+      for (unsigned t = 0; t < ts; ++t)
+        {
+          runner.prepare_job(t, pf.jobs[t]);
+          exec_start(&pf.jobs[t]);
+        }
+    }
+
+    // Collect the translations of PF, and output the automata.
+    void
+    output_formula(pending_formula& pf)
+    {
+      spot::formula f = pf.f;
+      const char* filename = pf.has_filename ? pf.filename.c_str() : nullptr;
+      int linenum = pf.linenum;
+      const char* csv_prefix = pf.has_prefix ? pf.prefix.c_str() : nullptr;
+      const char* csv_suffix = pf.has_suffix ? pf.suffix.c_str() : nullptr;
 
       unsigned ts = translators.size();
       spot::twa_graph_ptr best_aut = nullptr;
@@ -345,12 +424,15 @@ namespace
       std::string best_cmdname;
       process_timer best_timer;
 
-      roundval = round;
+      inputf = pf.input;
+      roundval = pf.round;
       for (unsigned t = 0; t < ts; ++t)
         {
           bool problem;
+          auto aut = runner.translate(pf.jobs[t], problem);
           process_timer timer;
-          auto aut = runner.translate(t, problem, timer);
+          timer.dt = pf.jobs[t].cpu;
+          timer.sw_lap_ = pf.jobs[t].time;
           if (problem)
             {
               if (errors_opt == errors_abort)
@@ -361,15 +443,15 @@ namespace
             }
           if (aut)
             {
-              if (relmap)
-                relabel_here(aut, relmap.get());
+              if (pf.relmap)
+                relabel_here(aut, pf.relmap.get());
 
               cmdname = translators[t].name;
               aut = post.run(aut, f);
               if (best_type)
                 {
                   best_printer.print(nullptr, aut, f, filename, linenum, timer,
-                                     prefix, suffix);
+                                     csv_prefix, csv_suffix);
                   std::string aut_stats = best_stream.str();
                   if (!best_aut ||
                       (strverscmp(best_stats.c_str(), aut_stats.c_str())
@@ -385,7 +467,7 @@ namespace
               else
                 {
                   printer.print(aut, timer, f, filename, linenum,
-                                nullptr, prefix, suffix);
+                                nullptr, csv_prefix, csv_suffix);
                 }
             }
         }
@@ -394,12 +476,8 @@ namespace
           cmdname = best_cmdname;
           printer.print(best_aut, best_timer,
                         f, filename, linenum,
-                        nullptr, prefix, suffix);
+                        nullptr, csv_prefix, csv_suffix);
         }
-
-      spot::cleanup_tmpfiles();
-      ++round;
-      return 0;
     }
   };
 }
@@ -31,6 +31,7 @@
 #include "common_finput.hh"
 #include "common_output.hh"
 #include "common_cout.hh"
+#include "common_jobs.hh"
 #include "common_conv.hh"
 #include "common_r.hh"
 #include "common_range.hh"
@@ -254,6 +255,7 @@ const struct argp_child children[] =
   {
     { &finput_argp, 0, nullptr, 1 },
     { &output_argp, 0, nullptr, -20 },
+    { &jobs_argp, 0, nullptr, -1 },
     { &misc_argp, 0, nullptr, -1 },
     { nullptr, 0, nullptr, 0 }
   };
@@ -574,6 +576,32 @@ namespace
         }
     }
 
+    int
+    process_job(const std::string& input, const char* filename,
+                int linenum, unsigned& outputs) override
+    {
+      // Workers only count the matches of their current formula, so
+      // that --max-count is enforced by the main process.
+      match_count = 0;
+      int res = process_string(input, filename, linenum);
+      outputs += match_count;
+      return res;
+    }
+
+    void
+    output_job(const job_pool::result& r) override
+    {
+      // Stop at --max-count, even if workers have already processed
+      // the next formulas.
+      if (opt_max_count >= 0 && match_count >= opt_max_count)
+        abort_run = true;
+      if (abort_run)
+        return;
+      job_processor::output_job(r);
+      match_count += r.outputs;
+      one_match |= r.outputs > 0;
+    }
+
     int
     process_formula(spot::formula f,
                     const char* filename = nullptr, int linenum = 0) override
@@ -826,6 +854,16 @@ main(int argc, char** argv)
       spot::tl_simplifier simpl(tlopt, opt->dict);
 
       ltl_processor processor(simpl);
+      if (opt_jobs > 1)
+        {
+          // These options need to see the formulas in input order,
+          // or to write to files.
+          if (unique || opt->output_define || output_to_files())
+            std::cerr << "warning: --jobs is ignored with --unique, "
+                      << "--define, and --output" << std::endl;
+          else
+            processor.start_jobs();
+        }
       if (processor.run())
         return 2;
     }
@@ -103,7 +103,11 @@ The escape sequences \f(CW%I\fR and \f(CW%O\fR respectively
 denote the names of the input and output files.  These temporary files
 are created in the directory specified by \fBSPOT_TMPDIR\fR or
 \fBTMPDIR\fR (see below). The SAT\-solver should follow the convention
-of the SAT Competition for its input and output format.
+of the SAT Competition for its input and output format.  External
+SAT\-solvers are restarted from scratch at each step, and cannot be
+used with \fBsat\-minimize=2\fR; programs that link an
+incremental solver with Spot (see \f(CWspot::set_sat_backend()\fR)
+do not have these limitations.
 
 .TP
 \fBSPOT_STREETT_CONV_MIN\fR
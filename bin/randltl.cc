@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2014, 2015, 2016 Laboratoire de Recherche
-// et Développement de l'Epita (LRDE).
+// Copyright (C) 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// Recherche et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -32,8 +32,12 @@
 #include "common_r.hh"
 #include "common_conv.hh"
 #include "common_cout.hh"
+#include "common_jobs.hh"
 
+#include <memory>
 #include <sstream>
+#include <spot/tl/parse.hh>
+#include <spot/tl/print.hh>
 #include <spot/tl/randomltl.hh>
 #include <spot/tl/simplify.hh>
 #include <spot/misc/random.hh>
@@ -128,6 +132,7 @@ static const argp_option options[] =
 const struct argp_child children[] =
   {
     { &output_argp, 0, nullptr, -20 },
+    { &jobs_argp, 0, nullptr, -1 },
     { &misc_argp, 0, nullptr, -1 },
     { nullptr, 0, nullptr, 0 }
   };
@@ -231,6 +236,29 @@ parse_opt(int key, char* arg, struct argp_state* as)
   return 0;
 }
 
+// With --jobs, the workers receive the serial number of a formula,
+// followed by a null character and the formula.
+static int
+print_job(const std::string& task, unsigned& outputs)
+{
+  int count = std::stoi(task);
+  std::string str = task.substr(task.find('\0') + 1);
+  auto pf = output == OUTPUTSERE
+    ? spot::parse_infix_sere(str) : spot::parse_infix_psl(str);
+  assert(pf.f && pf.errors.empty());
+  output_formula_checked(pf.f, nullptr, count);
+  ++outputs;
+  return 0;
+}
+
+static void
+output_job(const job_pool::result& r)
+{
+  std::cout << r.out;
+  std::cerr << r.err;
+  check_cout();
+}
+
 int
 main(int argc, char** argv)
 {
@@ -305,20 +333,51 @@ main(int argc, char** argv)
           exit(0);
         }
 
+      // With --jobs, the formulas are still generated by the main
+      // process, because each of them depends on the random numbers
+      // and on the formulas generated before (for uniqueness).  The
+      // workers only print them, which can be costly with --format
+      // escapes such as %h.
+      std::unique_ptr<job_pool> pool;
+      if (opt_jobs > 1)
+        {
+          if (output_to_files())
+            std::cerr << "warning: --jobs is ignored with --output"
+                      << std::endl;
+          else
+            pool.reset(new job_pool(opt_jobs, print_job, output_job));
+        }
+
       while (opt_formulas < 0 || opt_formulas--)
         {
           static int count = 0;
           spot::formula f = rg.next();
           if (!f)
             {
+              if (pool)
+                pool->finish();
               error(2, 0, "failed to generate a new unique formula after %d " \
                     "trials", MAX_TRIALS);
             }
+          else if (pool)
+            {
+              std::string task = std::to_string(++count);
+              task += '\0';
+              task += output == OUTPUTSERE
+                ? spot::str_sere(f) : spot::str_psl(f);
+              pool->submit(task);
+            }
           else
             {
               output_formula_checked(f, nullptr, ++count);
             }
         };
+      if (pool)
+        {
+          pool->finish();
+          if (opt_jobs_timings)
+            pool->print_timings(std::cerr);
+        }
     }
   catch (const std::runtime_error& e)
     {
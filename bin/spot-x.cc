@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013, 2014, 2015, 2016 Laboratoire de Recherche et
-// Développement de l'Epita (LRDE).
+// Copyright (C) 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche
+// et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -42,6 +42,13 @@ static const argp_option options[] =
 as described in our SPIN'13 paper (see Bibliography below).  Set to 2, \
 to build only the skeleton TGBA without composing it.  Set to 0 (the \
 default) to disable.") },
+    { DOC("fm-context", "Set to N>0 to keep the translations of \
+subformulas from one formula to the next, so that the subformulas \
+shared by several input formulas are only translated once.  The saved \
+translations are discarded whenever there are more than N of them.  \
+The automata produced may be numbered differently than without this \
+option.  Set to 0 (the default) to translate each formula \
+independently.") },
     { DOC("early-susp", "When set to 1, start compositional suspension on \
 the transitions that enter accepting SCCs, and not only on the transitions \
 inside accepting SCCs.  This option defaults to 0, and is only used when \
@@ -97,6 +104,10 @@ the determinization algorithm.") },
 the determinization algorithm.") },
     { DOC("det-stutter", "Set to 0 to disable optimizations based on \
 the stutter-invariance in the determinization algorithm.") },
+    { DOC("det-threads", "Number of threads used by the determinization \
+algorithm to compute successors.  The default is 1.  Set to 0 to use \
+one thread per hardware thread.  The output does not depend on this \
+number.") },
     { DOC("simul", "Set to 0 to disable simulation-based reductions. \
 Set to 1 to use only direct simulation. Set to 2 to use only reverse \
 simulation. Set to 3 to iterate both direct and reverse simulations. \
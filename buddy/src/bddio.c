@@ -125,6 +125,7 @@ void bdd_printall(void)
 void bdd_fprintall(FILE *ofile)
 {
    int n;
+   BDD_OPERATION;
 
    for (n=0 ; n<bddnodesize ; n++)
    {
@@ -170,6 +171,7 @@ void bdd_fprinttable(FILE *ofile, BDD r)
 {
    BddNode *node;
    int n;
+   BDD_OPERATION;
 
    fprintf(ofile, "ROOT: %d\n", r);
    if (r < 2)
@@ -179,11 +181,11 @@ void bdd_fprinttable(FILE *ofile, BDD r)
 
    for (n=0 ; n<bddnodesize ; n++)
    {
-      if (LEVEL(n) & MARKON)
+      if (MARKED(n))
       {
 	 node = &bddnodes[n];
 
-	 LEVELp(node) &= MARKOFF;
+	 UNMARKp(node);
 
 	 fprintf(ofile, "[%5d] ", n);
 	 if (filehandler)
@@ -232,6 +234,7 @@ void bdd_printset(BDD r)
 void bdd_fprintset(FILE *ofile, BDD r)
 {
    int *set;
+   BDD_OPERATION;
 
    if (r < 2)
    {
@@ -328,6 +331,8 @@ int bdd_fnprintdot(char *fname, BDD r)
 
 void bdd_fprintdot(FILE* ofile, BDD r)
 {
+   BDD_OPERATION;
+
    fprintf(ofile, "digraph G {\n");
    fprintf(ofile, "0 [shape=box, label=\"0\", style=filled, shape=box, height=0.3, width=0.3];\n");
    fprintf(ofile, "1 [shape=box, label=\"1\", style=filled, shape=box, height=0.3, width=0.3];\n");
@@ -395,6 +400,7 @@ int bdd_fnsave(char *fname, BDD r)
 int bdd_save(FILE *ofile, BDD r)
 {
    int err, n=0;
+   BDD_OPERATION;
 
    if (r < 2)
    {
@@ -425,9 +431,9 @@ static int bdd_save_rec(FILE *ofile, int root)
    if (root < 2)
       return 0;
 
-   if (LEVELp(node) & MARKON)
+   if (MARKEDp(node))
       return 0;
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
 
    if ((err=bdd_save_rec(ofile, LOWp(node))) < 0)
       return err;
@@ -489,6 +495,7 @@ int bdd_fnload(char *fname, BDD *root)
 int bdd_load(FILE *ifile, BDD *root)
 {
    int n, vnum, tmproot;
+   BDD_EXCLUSIVE;
 
    if (fscanf(ifile, "%d %d", &lh_nodenum, &vnum) != 2)
       return bdd_error(BDD_FORMAT);
@@ -92,39 +92,53 @@ static int oprres[OPERATOR_NUM][4] =
 };
 
 
-   /* Variables needed for the operators */
-static int applyop;                 /* Current operator for apply */
-static int appexop;                 /* Current operator for appex */
-static int appexid;                 /* Current cache id for appex */
-static int quantid;                 /* Current cache id for quantifications */
-static int *quantvarset;            /* Current variable set for quant. */
-static int quantvarsetcomp;         /* Should quantvarset be complemented?  */
-static int quantvarsetID;           /* Current id used in quantvarset */
-static int quantlast;               /* Current last variable to be quant. */
-static int replaceid;               /* Current cache id for replace */
-static int *replacepair;            /* Current replace pair */
-static int replacelast;             /* Current last var. level to replace */
-static int composelevel;            /* Current variable used for compose */
-static int miscid;                  /* Current cache id for other results */
-static int *varprofile;             /* Current variable profile */
-static int supportID;               /* Current ID (true value) for support */
-static int supportMin;              /* Min. used level in support calc. */
-static int supportMax;              /* Max. used level in support calc. */
-static int* supportSet;             /* The found support set */
-static BddCache applycache;         /* Cache for apply results */
-static BddCache itecache;           /* Cache for ITE results */
-static BddCache quantcache;         /* Cache for exist/forall results */
-static BddCache appexcache;         /* Cache for appex/appall results */
-static BddCache replacecache;       /* Cache for replace results */
-static BddCache misccache;          /* Cache for other results */
+   /* Variables needed for the operators.  When BuDDy is built with
+      --enable-threads, each thread has its own copy of them, and thus
+      its own operator caches. */
+#define THREADSTATIC static BDD_THREADLOCAL
+
+THREADSTATIC int applyop;           /* Current operator for apply */
+THREADSTATIC int appexop;           /* Current operator for appex */
+THREADSTATIC int appexid;           /* Current cache id for appex */
+THREADSTATIC int quantid;           /* Current cache id for quantifications */
+THREADSTATIC int *quantvarset;      /* Current variable set for quant. */
+THREADSTATIC int quantvarsetcomp;   /* Should quantvarset be complemented?  */
+THREADSTATIC int quantvarsetID;     /* Current id used in quantvarset */
+THREADSTATIC int quantlast;         /* Current last variable to be quant. */
+THREADSTATIC int replaceid;         /* Current cache id for replace */
+THREADSTATIC int *replacepair;      /* Current replace pair */
+THREADSTATIC int replacelast;       /* Current last var. level to replace */
+THREADSTATIC int composelevel;      /* Current variable used for compose */
+THREADSTATIC int miscid;            /* Current cache id for other results */
+THREADSTATIC int *varprofile;       /* Current variable profile */
+THREADSTATIC int supportID;         /* Current ID (true value) for support */
+THREADSTATIC int supportMin;        /* Min. used level in support calc. */
+THREADSTATIC int supportMax;        /* Max. used level in support calc. */
+THREADSTATIC int* supportSet;       /* The found support set */
+THREADSTATIC int supportSize;       /* Number of entries in supportSet */
+THREADSTATIC BddCache applycache;   /* Cache for apply results */
+THREADSTATIC BddCache itecache;     /* Cache for ITE results */
+THREADSTATIC BddCache quantcache;   /* Cache for exist/forall results */
+THREADSTATIC BddCache appexcache;   /* Cache for appex/appall results */
+THREADSTATIC BddCache replacecache; /* Cache for replace results */
+THREADSTATIC BddCache misccache;    /* Cache for other results */
 static int cacheratio;
-static BDD satPolarity;
-static int firstReorder;            /* Used instead of local variable in order
+THREADSTATIC BDD satPolarity;
+THREADSTATIC int firstReorder;      /* Used instead of local variable in order
 				       to avoid compiler warning about 'first'
 				       being clobbered by setjmp */
 
-static char*            allsatProfile; /* Variable profile for bdd_allsat() */
-static bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
+THREADSTATIC char*            allsatProfile; /* Variable profile for bdd_allsat() */
+THREADSTATIC bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
+
+#ifdef BUDDY_THREADS
+static int opcachesize;             /* Cache size given to bdd_init() */
+static int opgeneration;            /* Number of calls to bdd_init() */
+THREADSTATIC int opgenerationseen;  /* opgeneration when caches were made */
+THREADSTATIC int quantvarsetsize;   /* Number of entries in quantvarset */
+THREADSTATIC int cachenodesize;     /* bddnodesize when caches were sized */
+THREADSTATIC int cacheratioseen;    /* cacheratio when caches were sized */
+#endif
 
 extern bddCacheStat bddcachestats;
 
@@ -189,6 +203,14 @@ static int    varset2svartable(BDD);
 
 int bdd_operator_init(int cachesize)
 {
+#ifdef BUDDY_THREADS
+      /* The caches of each thread are created by
+	 bdd_operator_thread_enter(). */
+   opcachesize = cachesize;
+   __atomic_add_fetch(&opgeneration, 1, __ATOMIC_RELAXED);
+   cacheratio = 0;
+   return 0;
+#else
    if (BddCache_init(&applycache,cachesize) < 0)
       return bdd_error(BDD_MEMORY);
 
@@ -211,8 +233,10 @@ int bdd_operator_init(int cachesize)
    quantvarset = NULL;
    cacheratio = 0;
    supportSet = NULL;
+   supportSize = 0;
 
    return 0;
+#endif
 }
 
 
@@ -254,6 +278,9 @@ void bdd_operator_varresize(void)
    else
      memset(quantvarset, 0, sizeof(int)*bddvarnum);
    quantvarsetID = 0;
+#ifdef BUDDY_THREADS
+   quantvarsetsize = quantvarset ? bddvarnum : 0;
+#endif
 }
 
 
@@ -270,9 +297,73 @@ static void bdd_operator_noderesize(void)
       BddCache_resize(&replacecache, newcachesize);
       BddCache_resize(&misccache, newcachesize);
    }
+
+#ifdef BUDDY_THREADS
+   cachenodesize = bddnodesize;
+   cacheratioseen = cacheratio;
+#endif
+}
+
+
+#ifdef BUDDY_THREADS
+static void bdd_operator_cacheinit(void)
+{
+   int size = cacheratio > 0 ? bddnodesize / cacheratio : opcachesize;
+
+   BddCache_init(&applycache, size);
+   BddCache_init(&itecache, size);
+   BddCache_init(&quantcache, size);
+   BddCache_init(&appexcache, size);
+   BddCache_init(&replacecache, size);
+   BddCache_init(&misccache, size);
+
+   opgenerationseen = __atomic_load_n(&opgeneration, __ATOMIC_RELAXED);
+   cachenodesize = bddnodesize;
+   cacheratioseen = cacheratio;
+}
+
+
+   /* Called by bdd_thread_enter() each time a thread starts using the
+      package: create the caches of this thread, and resize them or
+      quantvarset if the node table or the number of variables has
+      changed since it last ran an operation. */
+void bdd_operator_thread_enter(void)
+{
+   if (__unlikely(opgenerationseen
+		  != __atomic_load_n(&opgeneration, __ATOMIC_RELAXED)))
+   {
+      bdd_operator_thread_done();
+      bdd_operator_cacheinit();
+   }
+   else if (__unlikely(cacheratioseen != cacheratio
+		       || (cacheratio > 0  &&  cachenodesize != bddnodesize)))
+      bdd_operator_noderesize();
+
+   if (__unlikely(quantvarsetsize < bddvarnum))
+      bdd_operator_varresize();
+}
+
+
+void bdd_operator_thread_done(void)
+{
+   bdd_operator_done();
+   quantvarset = NULL;
+   quantvarsetsize = 0;
+   supportSet = NULL;
+   supportSize = 0;
+   opgenerationseen = 0;
 }
 
 
+   /* Make every thread discard its caches before its next operation. */
+void bdd_operator_flush(void)
+{
+   opgenerationseen = __atomic_add_fetch(&opgeneration, 1, __ATOMIC_RELAXED);
+   bdd_operator_reset();
+}
+#endif
+
+
 /*************************************************************************
   Other
 *************************************************************************/
@@ -295,7 +386,11 @@ ALSO    {* bdd\_init *}
 */
 int bdd_setcacheratio(int r)
 {
-   int old = cacheratio;
+   int old;
+   BDD_EXCLUSIVE;
+   BDD_OPERATION;
+
+   old = cacheratio;
 
    if (r <= 0)
       return bdd_error(BDD_RANGE);
@@ -314,9 +409,13 @@ int bdd_setcacheratio(int r)
 
 static void checkresize(void)
 {
+#ifndef BUDDY_THREADS
    if (bddresized)
       bdd_operator_noderesize();
    bddresized = 0;
+#else
+      /* Node table resizes are noticed by bdd_operator_thread_enter(). */
+#endif
 }
 
 
@@ -347,6 +446,7 @@ BDD bdd_buildcube(int value, int width, BDD *variables)
 {
    BDD result = BDDONE;
    int z;
+   BDD_OPERATION;
 
    for (z=0 ; z<width ; z++, value>>=1)
    {
@@ -374,6 +474,7 @@ BDD bdd_ibuildcube(int value, int width, int *variables)
 {
    BDD result = BDDONE;
    int z;
+   BDD_OPERATION;
 
    for (z=0 ; z<width ; z++, value>>=1)
    {
@@ -411,6 +512,7 @@ RETURN  {* The negated bdd. *}
 BDD bdd_not(BDD r)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
    CHECKa(r, bddfalse);
 
@@ -440,7 +542,7 @@ BDD bdd_not(BDD r)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -521,6 +623,7 @@ DESCR   {* The {\tt bdd\_apply} function performs all of the basic
 BDD bdd_apply(BDD l, BDD r, int op)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(l, bddfalse);
@@ -562,7 +665,7 @@ BDD bdd_apply(BDD l, BDD r, int op)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -824,6 +927,7 @@ BDD bdd_setxor(BDD l, BDD r)
 {
   BddCacheData *entry;
   BDD res;
+  BDD_OPERATION;
 
   if (ISONE(l))
     return r;
@@ -836,7 +940,7 @@ BDD bdd_setxor(BDD l, BDD r)
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
-      return entry->i.res;
+      return KEEPREF(entry->i.res);
    }
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
@@ -905,7 +1009,7 @@ BDD bdd_setxor(BDD l, BDD r)
   entry->i.b = r;
   entry->i.res = res;
 
-  return res;
+  return KEEPREF(res);
 }
 
 
@@ -923,6 +1027,7 @@ int bdd_implies(BDD l, BDD r)
 {
   BddCacheData *entry;
   int res;
+  BDD_OPERATION;
 
   if ((l == r) || ISZERO(l) || ISONE(r))
     return 1;
@@ -998,6 +1103,7 @@ ALSO    {* bdd\_apply *}
 BDD bdd_ite(BDD f, BDD g, BDD h)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(f, bddfalse);
@@ -1031,7 +1137,7 @@ BDD bdd_ite(BDD f, BDD g, BDD h)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1173,6 +1279,7 @@ ALSO    {* bdd\_makeset, bdd\_exist, bdd\_forall *}
 BDD bdd_restrict(BDD r, BDD var)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(r,bddfalse);
@@ -1212,7 +1319,7 @@ BDD bdd_restrict(BDD r, BDD var)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1274,6 +1381,7 @@ ALSO    {* bdd\_restrict, bdd\_simplify *}
 BDD bdd_constrain(BDD f, BDD c)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(f,bddfalse);
@@ -1307,7 +1415,7 @@ BDD bdd_constrain(BDD f, BDD c)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1401,6 +1509,7 @@ RETURN {* The result of the operation. *}
 BDD bdd_replace(BDD r, bddPair *pair)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(r, bddfalse);
@@ -1435,7 +1544,7 @@ BDD bdd_replace(BDD r, bddPair *pair)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1528,6 +1637,7 @@ ALSO    {* bdd\_veccompose, bdd\_replace, bdd\_restrict *}
 BDD bdd_compose(BDD f, BDD g, int var)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(f, bddfalse);
@@ -1570,7 +1680,7 @@ BDD bdd_compose(BDD f, BDD g, int var)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1655,6 +1765,7 @@ ALSO    {* bdd\_compose, bdd\_replace, bdd\_restrict *}
 BDD bdd_veccompose(BDD f, bddPair *pair)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(f, bddfalse);
@@ -1689,7 +1800,7 @@ BDD bdd_veccompose(BDD f, bddPair *pair)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1743,6 +1854,7 @@ RETURN  {* The simplified BDD *}
 BDD bdd_simplify(BDD f, BDD d)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(f, bddfalse);
@@ -1776,7 +1888,7 @@ BDD bdd_simplify(BDD f, BDD d)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -1850,6 +1962,7 @@ static BDD simplify_rec(BDD f, BDD d)
 static BDD quantify(BDD r, BDD var, int op, int comp, int id)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(r, bddfalse);
@@ -1890,7 +2003,7 @@ static BDD quantify(BDD r, BDD var, int op, int comp, int id)
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 /*
@@ -2033,6 +2146,7 @@ static BDD appquantify(BDD l, BDD r, int opr, BDD var,
 		       int qop, int comp, int qid)
 {
    BDD res;
+   BDD_OPERATION;
    firstReorder = 1;
 
    CHECKa(l, bddfalse);
@@ -2084,7 +2198,7 @@ static BDD appquantify(BDD l, BDD r, int opr, BDD var,
    }
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 /*
@@ -2312,9 +2426,9 @@ RETURN  {* A BDD variable set. *}
 BDD bdd_support(BDD r)
 {
    BddCacheData *entry;
-   static int  supportSize = 0;
    int n;
    int res=1;
+   BDD_OPERATION;
 
    CHECKa(r, bddfalse);
 
@@ -2328,7 +2442,7 @@ BDD bdd_support(BDD r)
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
-      return entry->i.res;
+      return KEEPREF(entry->i.res);
    }
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
@@ -2386,7 +2500,7 @@ BDD bdd_support(BDD r)
    entry->i.c = CACHEID_SUPPORT;
    entry->i.res = res;
 
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -2398,7 +2512,7 @@ static void support_rec(int r, int* support)
       return;
 
    node = &bddnodes[r];
-   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
+   if (MARKEDp(node)  ||  LOWp(node) == -1)
       return;
 
    support[LEVELp(node)] = supportID;
@@ -2406,7 +2520,7 @@ static void support_rec(int r, int* support)
    if (LEVELp(node) > supportMax)
      supportMax = LEVELp(node);
 
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
 
    support_rec(LOWp(node), support);
    support_rec(HIGHp(node), support);
@@ -2429,6 +2543,7 @@ RETURN  {* The result of the operation. *}
 BDD bdd_satone(BDD r)
 {
    BDD res;
+   BDD_OPERATION;
 
    CHECKa(r, bddfalse);
    if (r < 2)
@@ -2442,7 +2557,7 @@ BDD bdd_satone(BDD r)
    bdd_enable_reorder();
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -2478,6 +2593,7 @@ RETURN  {* The result of the operation. *}
 BDD bdd_satprefix(BDD* r)
 {
    BDD res;
+   BDD_OPERATION;
 
    CHECKa(*r, bddfalse);
    if (__unlikely(*r < 2))
@@ -2491,7 +2607,7 @@ BDD bdd_satprefix(BDD* r)
    bdd_enable_reorder();
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 
 }
 
@@ -2536,6 +2652,7 @@ RETURN  {* The result of the operation. *}
 BDD bdd_satoneset(BDD r, BDD var, BDD pol)
 {
    BDD res;
+   BDD_OPERATION;
 
    CHECKa(r, bddfalse);
    if (ISZERO(r))
@@ -2556,7 +2673,7 @@ BDD bdd_satoneset(BDD r, BDD var, BDD pol)
    bdd_enable_reorder();
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -2620,6 +2737,7 @@ BDD bdd_fullsatone(BDD r)
 {
    BDD res;
    int v;
+   BDD_OPERATION;
 
    CHECKa(r, bddfalse);
    if (r == 0)
@@ -2638,7 +2756,7 @@ BDD bdd_fullsatone(BDD r)
    bdd_enable_reorder();
 
    checkresize();
-   return res;
+   return KEEPREF(res);
 }
 
 
@@ -2711,6 +2829,7 @@ ALSO    {* bdd\_satone bdd\_satoneset, bdd\_fullsatone, bdd\_satcount, bdd\_satc
 void bdd_allsat(BDD r, bddallsathandler handler)
 {
    int v;
+   BDD_OPERATION;
 
    CHECKn(r);
 
@@ -2794,6 +2913,7 @@ RETURN  {* The number of possible assignments. *}
 double bdd_satcount(BDD r)
 {
    double size=1;
+   BDD_OPERATION;
 
    CHECKa(r, 0.0);
 
@@ -2808,6 +2928,7 @@ double bdd_satcountset(BDD r, BDD varset)
 {
    double unused = bddvarnum;
    BDD n;
+   BDD_OPERATION;
 
    if (ISCONST(varset)  ||  ISZERO(r)) /* empty set */
       return 0.0;
@@ -2875,6 +2996,7 @@ RETURN {* The logarithm of the number of possible assignments. *} */
 double bdd_satcountln(BDD r)
 {
    double size;
+   BDD_OPERATION;
 
    CHECKa(r, 0.0);
 
@@ -2892,6 +3014,7 @@ double bdd_satcountlnset(BDD r, BDD varset)
 {
    double unused = bddvarnum;
    BDD n;
+   BDD_OPERATION;
 
    if (ISCONST(varset)) /* empty set */
       return 0.0;
@@ -2962,6 +3085,7 @@ ALSO    {* bdd\_pathcount, bdd\_satcount, bdd\_anodecount *}
 int bdd_nodecount(BDD r)
 {
    int num=0;
+   BDD_OPERATION;
 
    CHECK(r);
 
@@ -2988,6 +3112,7 @@ int bdd_anodecount(BDD *r, int num)
 {
    int n;
    int cou=0;
+   BDD_OPERATION;
 
    for (n=0 ; n<num ; n++)
       bdd_markcount(r[n], &cou);
@@ -3016,6 +3141,8 @@ RETURN  {* A pointer to an integer array with the profile or NULL if an
 */
 int *bdd_varprofile(BDD r)
 {
+   BDD_OPERATION;
+
    CHECKa(r, NULL);
 
    if (__unlikely((varprofile=(int*)malloc(sizeof(int)*bddvarnum)) == NULL))
@@ -3039,11 +3166,11 @@ static void varprofile_rec(int r)
       return;
 
    node = &bddnodes[r];
-   if (LEVELp(node) & MARKON)
+   if (MARKEDp(node))
       return;
 
    varprofile[bddlevel2var[LEVELp(node)]]++;
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
 
    varprofile_rec(LOWp(node));
    varprofile_rec(HIGHp(node));
@@ -3064,6 +3191,8 @@ ALSO    {* bdd\_nodecount, bdd\_satcount *}
 */
 double bdd_pathcount(BDD r)
 {
+   BDD_OPERATION;
+
    CHECKa(r, 0.0);
 
    miscid = CACHEID_PATHCOU;
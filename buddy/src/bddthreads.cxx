@@ -0,0 +1,185 @@
+/*========================================================================
+	       Copyright (C) 1996-2002 by Jorn Lind-Nielsen
+			    All rights reserved
+
+    Permission is hereby granted, without written agreement and without
+    license or royalty fees, to use, reproduce, prepare derivative
+    works, distribute, and display this software and its documentation
+    for any purpose, provided that (1) the above copyright notice and
+    the following two paragraphs appear in all copies of the source code
+    and (2) redistributions, including without limitation binaries,
+    reproduce these notices in the supporting documentation. Substantial
+    modifications to this software may be copyrighted by their authors
+    and need not follow the licensing terms described here, provided
+    that the new terms are clearly indicated in all files where they apply.
+
+    IN NO EVENT SHALL JORN LIND-NIELSEN, OR DISTRIBUTORS OF THIS
+    SOFTWARE BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL,
+    INCIDENTAL, OR CONSEQUENTIAL DAMAGES ARISING OUT OF THE USE OF THIS
+    SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE AUTHORS OR ANY OF THE
+    ABOVE PARTIES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    JORN LIND-NIELSEN SPECIFICALLY DISCLAIM ANY WARRANTIES, INCLUDING,
+    BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS
+    ON AN "AS IS" BASIS, AND THE AUTHORS AND DISTRIBUTORS HAVE NO
+    OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR
+    MODIFICATIONS.
+========================================================================*/
+
+/* Run the same BDD operations from several threads at once, and
+   compare their results to those computed by a single thread.  The
+   node table is kept small so that the threads trigger many garbage
+   collections and resizes while the others are working. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <string>
+#include <cstdlib>
+#include <vector>
+#ifdef BUDDY_THREADS
+# include <thread>
+#endif
+#include "bddx.h"
+
+using namespace std;
+
+
+#ifdef BUDDY_THREADS
+
+#define ERROR(msg) fail(msg, __FILE__, __LINE__)
+
+static void fail(const string msg, const char* file, int lineNum)
+{
+  cout << "Error in " << file << "(" << lineNum << "): " << msg << endl;
+  exit(1);
+}
+
+static const int varnum = 16;
+static const int formulas = 200;
+static const int nthreads = 4;
+static const int rounds = 5;
+
+static bddPair* shift_pair;     // Shifts the lower half of the variables
+static bdd upper_vars;          // The upper half of the variables
+
+
+// A pseudo-random BDD that only depends on SEED.
+static bdd random_bdd(unsigned seed, int depth)
+{
+  seed = seed * 1103515245U + 12345U;
+  unsigned r = (seed >> 16) % 9;
+
+  if (depth == 0 || r == 0)
+    return bdd_ithvar((seed >> 8) % varnum);
+
+  bdd l = random_bdd(seed ^ 0x5bd1e995U, depth - 1);
+  bdd h = random_bdd(seed + 0x9e3779b9U, depth - 1);
+  switch (r)
+    {
+    case 1:
+      return !l;
+    case 2:
+    case 3:
+      return l & h;
+    case 4:
+    case 5:
+      return l | h;
+    case 6:
+      return l ^ h;
+    case 7:
+      return bdd_exist(l >> h, upper_vars);
+    default:
+      return bdd_replace(bdd_exist(bdd_ite(l, h, !h), upper_vars),
+                         shift_pair);
+    }
+}
+
+
+struct result
+{
+  bdd f;
+  double satcount;
+  int nodecount;
+  bdd support;
+};
+
+
+static result compute(int i)
+{
+  result res;
+  res.f = random_bdd(i, 10);
+  res.satcount = bdd_satcount(res.f);
+  res.nodecount = bdd_nodecount(res.f);
+  res.support = bdd_support(res.f);
+  return res;
+}
+
+
+static void check(int i, const result& got, const result& expected)
+{
+  if (got.f != expected.f)
+    ERROR("BDD " + to_string(i) + " differs");
+  if (got.satcount != expected.satcount)
+    ERROR("satcount of BDD " + to_string(i) + " differs");
+  if (got.nodecount != expected.nodecount)
+    ERROR("nodecount of BDD " + to_string(i) + " differs");
+  if (got.support != expected.support)
+    ERROR("support of BDD " + to_string(i) + " differs");
+}
+
+
+int main()
+{
+  bdd_init(500, 100);
+  bdd_gbc_hook(nullptr);
+  bdd_setvarnum(varnum);
+  bdd_setcacheratio(4);
+
+  shift_pair = bdd_newpair();
+  upper_vars = bddtrue;
+  for (int v = 0; v < varnum / 2; ++v)
+    {
+      bdd_setpair(shift_pair, v, v + varnum / 2);
+      upper_vars &= bdd_ithvar(v + varnum / 2);
+    }
+
+  vector<result> expected;
+  expected.reserve(formulas);
+  for (int i = 0; i < formulas; ++i)
+    expected.push_back(compute(i));
+
+  for (int round = 0; round < rounds; ++round)
+    {
+      vector<thread> workers;
+      for (int t = 0; t < nthreads; ++t)
+        workers.emplace_back([t, &expected]()
+                             {
+                               // Each thread uses its own order.
+                               for (int j = 0; j < formulas; ++j)
+                                 {
+                                   int i = (j * (2 * t + 1) + t) % formulas;
+                                   check(i, compute(i), expected[i]);
+                                 }
+                             });
+      for (auto& w: workers)
+        w.join();
+    }
+
+  bdd_freepair(shift_pair);
+  upper_vars = bddfalse;
+  expected.clear();
+  bdd_done();
+  return 0;
+}
+
+#else
+
+int main()
+{
+  cout << "BuDDy was not configured with --enable-threads\n";
+  return 77;
+}
+
+#endif
@@ -279,6 +279,7 @@ BUDDY_API void     bdd_done(void);
 BUDDY_API int      bdd_setvarnum(int);
 BUDDY_API int      bdd_extvarnum(int);
 BUDDY_API int      bdd_isrunning(void) __purefn;
+BUDDY_API int      bdd_isthreadsafe(void) __constfn;
 BUDDY_API int      bdd_setmaxnodenum(int);
 BUDDY_API int      bdd_setmaxincrease(int);
 BUDDY_API int      bdd_setminfreenodes(int);
@@ -183,6 +183,8 @@ bddstrmhandler bdd_strm_hook(bddstrmhandler handler)
 
 ostream &operator<<(ostream &o, const bdd &r)
 {
+   BDD_OPERATION;
+
    if (bdd_ioformat::curformat == IOFORMAT_SET)
    {
       if (r.root < 2)
@@ -213,11 +215,11 @@ ostream &operator<<(ostream &o, const bdd &r)
 
       for (int n=0 ; n<bddnodesize ; n++)
       {
-	 if (LEVEL(n) & MARKON)
+	 if (MARKED(n))
 	 {
 	    BddNode *node = &bddnodes[n];
 
-	    LEVELp(node) &= MARKOFF;
+	    UNMARKp(node);
 
 	    o << "[" << setw(5) << n << "] ";
 	    if (strmhandler_bdd)
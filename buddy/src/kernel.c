@@ -43,6 +43,10 @@
 #include <math.h>
 #include <time.h>
 #include <assert.h>
+#ifdef BUDDY_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "kernel.h"
 #include "cache.h"
@@ -95,11 +99,11 @@ int          bddfreepos;        /* First free node */
 int          bddfreenum;        /* Number of free nodes */
 long int     bddproduced;       /* Number of new nodes ever produced */
 int          bddvarnum;         /* Number of defined BDD variables */
-int*         bddrefstack;       /* Internal node reference stack */
-int*         bddrefstacktop;    /* Internal node reference stack top */
+BDD_THREADLOCAL int* bddrefstack;    /* Internal node reference stack */
+BDD_THREADLOCAL int* bddrefstacktop; /* Internal node reference stack top */
 int*         bddvar2level;      /* Variable -> level table */
 int*         bddlevel2var;      /* Level -> variable table */
-jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
+BDD_THREADLOCAL jmp_buf bddexception; /* Long-jump point for interrupting calc. */
 int          bddresized;        /* Flag indicating a resize of the nodetable */
 
 bddCacheStat bddcachestats;
@@ -117,6 +121,254 @@ static bddgbchandler  gbc_handler;     /* Garbage collection handler */
 static bdd2inthandler resize_handler;  /* Node-table-resize handler */
 
 
+/*=== THREADS ==========================================================*/
+
+#ifdef BUDDY_THREADS
+/* When BuDDy is configured with --enable-threads, several threads may
+   run BDD operations at once.
+
+   - The node table is shared.  Threads look nodes up without locking,
+     and insert new nodes while holding a lock on a stripe of the
+     unicity hash table.  Each thread takes free nodes from the shared
+     free list by chunks of BDDFREECHUNK, so that the lock protecting
+     that list is seldom taken.
+
+   - Each thread has its own operator caches, its own reference stack,
+     and its own bitmap of marked nodes (see bddop.c and kernel.h).
+
+   - Garbage collection stops the world: the thread that runs out of
+     free nodes waits until every other thread has either left the
+     package, or is waiting in bdd_makenode().  The collection then
+     marks the nodes referenced from the reference stacks of all
+     threads.  Threads discard their caches and their chunk of free
+     nodes when they resume.
+
+   Variable reordering is not supported in this mode, and functions
+   that change the number of variables, or load BDDs from files, stop
+   the world while they run.  bdd_init() and bdd_done() must be called
+   while no other thread uses the package.  */
+
+typedef struct s_BddThread
+{
+   int **refstack;            /* Address of the thread's bddrefstack */
+   int **refstacktop;         /* Address of the thread's bddrefstacktop */
+   int active;                /* Thread uses the node table (atomic) */
+   struct s_BddThread *next;
+} BddThread;
+
+#define BDDFREECHUNK 256    /* Free nodes taken at once by a thread */
+#define BDDSTRIPES   1024   /* Number of locks on the unicity table */
+
+static BddThread*      bddthreads;       /* All registered threads */
+static pthread_mutex_t bddthreadsmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t bddworldmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t bddfreemutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t   bddthreadkey;
+static pthread_once_t  bddthreadonce = PTHREAD_ONCE_INIT;
+static int             bddstopping;      /* The world is stopped (atomic) */
+static int             bddepoch;         /* Collections and bdd_init() calls */
+static int             bddstripes[BDDSTRIPES]; /* Spin locks */
+
+static __thread BddThread* bddself;      /* This thread */
+static __thread int  bdddepth;           /* Nesting of BDD_OPERATION */
+static __thread int  bddowner;           /* Nesting of BDD_EXCLUSIVE */
+static __thread int  bddseenepoch;       /* bddepoch when last active */
+static __thread int  bddlocalfree;       /* Chunk of free nodes */
+static __thread int  bddrefstacksize;
+static __thread int  bddmarksize;        /* Number of nodes in bddmarks */
+__thread unsigned int* bddmarks;
+
+static void bdd_thread_unregister(void *data)
+{
+   BddThread **t;
+
+   pthread_mutex_lock(&bddthreadsmutex);
+   for (t=&bddthreads ; *t!=data ; t=&(*t)->next)
+      continue;
+   *t = (*t)->next;
+   pthread_mutex_unlock(&bddthreadsmutex);
+
+   free(data);
+   free(bddrefstack);
+   free(bddmarks);
+   bddself = NULL;
+   bddrefstack = bddrefstacktop = NULL;
+   bddrefstacksize = 0;
+   bddmarks = NULL;
+   bddmarksize = 0;
+   bdd_operator_thread_done();
+}
+
+
+static void bdd_thread_key_init(void)
+{
+   pthread_key_create(&bddthreadkey, bdd_thread_unregister);
+}
+
+
+static void bdd_thread_register(void)
+{
+   BddThread *t;
+
+   pthread_once(&bddthreadonce, bdd_thread_key_init);
+   if ((t=NEW(BddThread,1)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      abort();
+   }
+   t->refstack = &bddrefstack;
+   t->refstacktop = &bddrefstacktop;
+   t->active = 0;
+
+   pthread_mutex_lock(&bddthreadsmutex);
+   t->next = bddthreads;
+   bddthreads = t;
+   pthread_mutex_unlock(&bddthreadsmutex);
+
+   pthread_setspecific(bddthreadkey, t);
+   bddself = t;
+   bddseenepoch = bddepoch;
+}
+
+
+   /* Mark this thread as using the node table, waiting first for any
+      thread that has stopped the world.  */
+static void bdd_thread_activate(void)
+{
+   if (__unlikely(bddself == NULL))
+      bdd_thread_register();
+
+   for (;;)
+   {
+      __atomic_store_n(&bddself->active, 1, __ATOMIC_SEQ_CST);
+      if (__likely(!__atomic_load_n(&bddstopping, __ATOMIC_SEQ_CST)))
+	 break;
+      __atomic_store_n(&bddself->active, 0, __ATOMIC_RELEASE);
+      pthread_mutex_lock(&bddworldmutex);
+      pthread_mutex_unlock(&bddworldmutex);
+   }
+
+   if (__unlikely(bddseenepoch != bddepoch))
+   {
+	 /* The caches may refer to collected nodes, and the free nodes
+	    of this thread went back to the shared free list. */
+      bddseenepoch = bddepoch;
+      bddlocalfree = 0;
+      bdd_operator_reset();
+   }
+}
+
+
+   /* Let another thread stop the world.  */
+static void bdd_thread_yield(void)
+{
+   __atomic_store_n(&bddself->active, 0, __ATOMIC_RELEASE);
+   bdd_thread_activate();
+}
+
+
+   /* Resize the tables of this thread that depend on the number of
+      variables or on the size of the node table.  */
+static void bdd_thread_prepare(void)
+{
+   int size = bddvarnum*2+4;
+
+   if (__unlikely(bddrefstacksize < size))
+   {
+      free(bddrefstack);
+      if ((bddrefstack=NEW(int,size)) == NULL)
+      {
+	 bdd_error(BDD_MEMORY);
+	 abort();
+      }
+      bddrefstacktop = bddrefstack;
+      bddrefstacksize = size;
+   }
+
+   bdd_operator_thread_enter();
+}
+
+
+int bdd_thread_enter(void)
+{
+   if (bdddepth++ == 0)
+   {
+      if (!bddowner)
+	 bdd_thread_activate();
+      bdd_thread_prepare();
+   }
+
+   if (__unlikely(bddmarksize < bddnodesize))
+   {
+	 /* realloc() keeps the marks of a traversal in progress. */
+      int words = (bddnodesize+31) / 32;
+      unsigned int *m = (unsigned int*)realloc(bddmarks,
+					       sizeof(unsigned int)*words);
+      if (m == NULL)
+      {
+	 bdd_error(BDD_MEMORY);
+	 abort();
+      }
+      memset(m + (bddmarksize+31) / 32, 0,
+	     sizeof(unsigned int)*(words - (bddmarksize+31) / 32));
+      bddmarks = m;
+      bddmarksize = words*32;
+   }
+
+   return 0;
+}
+
+
+void bdd_thread_leave(int *unused)
+{
+   (void)unused;
+   if (--bdddepth == 0  &&  !bddowner)
+      __atomic_store_n(&bddself->active, 0, __ATOMIC_RELEASE);
+}
+
+
+int bdd_world_stop(void)
+{
+   BddThread *t;
+
+   if (bddowner++ > 0)
+      return 0;
+
+   if (__unlikely(bddself == NULL))
+      bdd_thread_register();
+   if (bdddepth > 0)
+      __atomic_store_n(&bddself->active, 0, __ATOMIC_RELEASE);
+
+   pthread_mutex_lock(&bddworldmutex);
+   pthread_mutex_lock(&bddthreadsmutex);
+   __atomic_store_n(&bddstopping, 1, __ATOMIC_SEQ_CST);
+
+      /* Threads that are using the node table will either leave the
+	 package or notice bddstopping in bdd_makenode(). */
+   for (t=bddthreads ; t!=NULL ; t=t->next)
+      while (t != bddself  &&  __atomic_load_n(&t->active, __ATOMIC_SEQ_CST))
+	 sched_yield();
+
+   return 0;
+}
+
+
+void bdd_world_start(int *unused)
+{
+   (void)unused;
+   if (--bddowner > 0)
+      return;
+
+   __atomic_store_n(&bddstopping, 0, __ATOMIC_SEQ_CST);
+   pthread_mutex_unlock(&bddthreadsmutex);
+   pthread_mutex_unlock(&bddworldmutex);
+
+   if (bdddepth > 0)
+      bdd_thread_activate();
+}
+#endif /* BUDDY_THREADS */
+
+
    /* Strings for all error mesages */
 static const char *errorstrings[BDD_ERRNUM] =
 { "Out of memory", "Unknown variable", "Value out of range",
@@ -200,6 +452,9 @@ int bdd_init(int initnodesize, int cs)
      for (n=0 ; n<sz ; n++)
        {
          b[n].z = 0;
+#ifdef BUDDY_THREADS
+         b[n].level = 0;
+#endif
          b[n].low = -1;
          /* Initializing HIGH is useless in BuDDy, but it helps the
             compiler vectorizing the code, and it helps the processor
@@ -224,6 +479,10 @@ int bdd_init(int initnodesize, int cs)
    bddrunning = 1;
    bddvarnum = 0;
    gbcollectnum = 0;
+#ifdef BUDDY_THREADS
+   bddseenepoch = ++bddepoch;
+   bddlocalfree = 0;
+#endif
    gbcclock = 0;
    cachesize = cs;
    usednodes_nextreorder = bddnodesize;
@@ -278,8 +537,15 @@ void bdd_done(void)
    bddnodes = NULL;
    bddrefstack = NULL;
    bddvarset = NULL;
-
+#ifdef BUDDY_THREADS
+   bddrefstacksize = 0;
+   free(bddmarks);
+   bddmarks = NULL;
+   bddmarksize = 0;
+   bdd_operator_thread_done();
+#else
    bdd_operator_done();
+#endif
 
    bddrunning = 0;
    bddnodesize = 0;
@@ -309,6 +575,8 @@ int bdd_setvarnum(int num)
 {
    int bdv;
    int oldbddvarnum = bddvarnum;
+   BDD_EXCLUSIVE;
+   BDD_OPERATION;
 
    bdd_disable_reorder();
 
@@ -369,9 +637,16 @@ int bdd_setvarnum(int num)
      }
    }
 
+#ifdef BUDDY_THREADS
+   /* Each thread resizes its own reference stack when it next enters
+      the package.  The one of this thread has room for the node
+      pushed below. */
+   bddrefstacktop = bddrefstack;
+#else
    if (__likely(bddrefstack != NULL))
       free(bddrefstack);
    bddrefstack = bddrefstacktop = (int*)malloc(sizeof(int)*(num*2+4));
+#endif
 
    for(bdv=bddvarnum ; bddvarnum < num; bddvarnum++)
    {
@@ -686,6 +961,27 @@ int bdd_isrunning(void)
 }
 
 
+/*
+NAME    {* bdd\_isthreadsafe *}
+SECTION {* kernel *}
+SHORT   {* test whether several threads may run BDD operations *}
+PROTO   {* int bdd_isthreadsafe(void) *}
+DESCR   {* This function tells whether the package was configured with
+	   {\tt --enable-threads}, in which case BDD operations may be
+	   run from several threads at once. *}
+RETURN  {* 1 (true) if the package is thread-safe, otherwise 0. *}
+ALSO    {* bdd\_isrunning *}
+*/
+int bdd_isthreadsafe(void)
+{
+#ifdef BUDDY_THREADS
+   return 1;
+#else
+   return 0;
+#endif
+}
+
+
 /*
 NAME    {* bdd\_versionstr *}
 SECTION {* kernel *}
@@ -901,6 +1197,8 @@ RETURN  {* The I'th variable on succes, otherwise the constant false bdd *}
 ALSO {* bdd\_setvarnum, bdd\_nithvar, bddtrue, bddfalse *} */
 BDD bdd_ithvar(int var)
 {
+   BDD_OPERATION;
+
 #ifndef NDEBUG
    if (var < 0  ||  var >= bddvarnum)
    {
@@ -929,6 +1227,8 @@ ALSO    {* bdd\_setvarnum, bdd\_ithvar, bddtrue, bddfalse *}
 */
 BDD bdd_nithvar(int var)
 {
+   BDD_OPERATION;
+
 #ifndef NDEBUG
    if (var < 0  ||  var >= bddvarnum)
    {
@@ -967,6 +1267,8 @@ RETURN  {* The variable number. *}
 */
 int bdd_var(BDD root)
 {
+   BDD_OPERATION;
+
    CHECK(root);
    CHECKnc(root);
    return bddlevel2var[LEVEL(root)];
@@ -984,6 +1286,8 @@ ALSO    {* bdd\_high *}
 */
 BDD bdd_low(BDD root)
 {
+   BDD_OPERATION;
+
    CHECK(root);
    CHECKnc(root);
    return LOW(root);
@@ -1001,6 +1305,8 @@ ALSO    {* bdd\_low *}
 */
 BDD bdd_high(BDD root)
 {
+   BDD_OPERATION;
+
    CHECK(root);
    CHECKnc(root);
    return HIGH(root);
@@ -1012,6 +1318,29 @@ BDD bdd_high(BDD root)
   Garbage collection and node referencing
 *************************************************************************/
 
+#ifdef BUDDY_THREADS
+   /* Unlike bdd_mark(), this marks nodes in the node table itself. */
+static void bdd_gbc_mark(int i)
+{
+   BddNode *node;
+
+   if (__unlikely(i < 2))
+      return;
+
+   node = &bddnodes[i];
+   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
+      return;
+
+   LEVELp(node) |= MARKON;
+
+   bdd_gbc_mark(LOWp(node));
+   bdd_gbc_mark(HIGHp(node));
+}
+#else
+#define bdd_gbc_mark bdd_mark
+#endif
+
+
 void bdd_default_gbchandler(int pre, bddGbcStat *s)
 {
    if (!pre)
@@ -1059,6 +1388,7 @@ void bdd_gbc(void)
    int *r;
    int n;
    long int c2, c1 = clock();
+   BDD_EXCLUSIVE;
 
    if (gbc_handler != NULL)
    {
@@ -1071,13 +1401,22 @@ void bdd_gbc(void)
       gbc_handler(1, &s);
    }
 
+#ifdef BUDDY_THREADS
+   {
+      BddThread *t;
+      for (t=bddthreads ; t!=NULL ; t=t->next)
+	 for (r=*t->refstack ; r<*t->refstacktop ; r++)
+	    bdd_gbc_mark(*r);
+   }
+#else
    for (r=bddrefstack ; r<bddrefstacktop ; r++)
-      bdd_mark(*r);
+      bdd_gbc_mark(*r);
+#endif
 
    for (n=0 ; n<bddnodesize ; n++)
    {
       if (bddnodes[n].refcou > 0)
-	 bdd_mark(n);
+	 bdd_gbc_mark(n);
    }
 
    memset(bddhash, 0, bddnodesize*sizeof(*bddhash));
@@ -1112,6 +1451,10 @@ void bdd_gbc(void)
    c2 = clock();
    gbcclock += c2-c1;
    gbcollectnum++;
+#ifdef BUDDY_THREADS
+   bddseenepoch = ++bddepoch;
+   bddlocalfree = 0;
+#endif
 
    if (gbc_handler != NULL)
    {
@@ -1128,6 +1471,8 @@ void bdd_gbc(void)
 
 BDD bdd_addref_nc(BDD root)
 {
+   BDD_OPERATION;
+
 #ifndef NDEBUG
    if (!bddrunning)
       return root;
@@ -1154,6 +1499,8 @@ RETURN  {* The BDD node {\tt r}. *}
 */
 BDD bdd_addref(BDD root)
 {
+   BDD_OPERATION;
+
 #if NDEBUG
    if (root < 2)
       return root;
@@ -1172,6 +1519,8 @@ BDD bdd_addref(BDD root)
 /* Non constant version */
 BDD bdd_delref_nc(BDD root)
 {
+   BDD_OPERATION;
+
 #ifndef NDEBUG
    if (!bddrunning)
       return root;
@@ -1201,6 +1550,8 @@ RETURN  {* The BDD node {\tt r}. *}
 */
 BDD bdd_delref(BDD root)
 {
+   BDD_OPERATION;
+
 #if NDEBUG
    if (root < 2)
       return root;
@@ -1230,10 +1581,10 @@ void bdd_mark(int i)
       return;
 
    node = &bddnodes[i];
-   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
+   if (MARKEDp(node)  ||  LOWp(node) == -1)
       return;
 
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
 
    bdd_mark(LOWp(node));
    bdd_mark(HIGHp(node));
@@ -1321,6 +1672,7 @@ void bdd_unmark_upto(int i, int level)
   Unique node table functions
 *************************************************************************/
 
+#ifndef BUDDY_THREADS
 int bdd_makenode(unsigned int level, int low, int high)
 {
    register BddNode *node;
@@ -1407,6 +1759,130 @@ int bdd_makenode(unsigned int level, int low, int high)
 
    return res;
 }
+#else /* BUDDY_THREADS */
+   /* Move a chunk of nodes from the shared free list to the free list
+      of this thread, collecting garbage if needed.  Returns 0 on
+      success, 1 if the node table has been collected or resized (so
+      that the caller must start its lookup again), or -1 if no node
+      could be allocated. */
+static int bdd_refill(void)
+{
+   int n, last;
+
+   pthread_mutex_lock(&bddfreemutex);
+   if (__likely(bddfreepos != 0))
+   {
+      bddlocalfree = last = bddfreepos;
+      for (n=1 ; n<BDDFREECHUNK && bddnodes[last].next != 0 ; n++)
+	 last = bddnodes[last].next;
+      bddfreepos = bddnodes[last].next;
+      bddnodes[last].next = 0;
+      bddfreenum -= n;
+      bddproduced += n;
+      pthread_mutex_unlock(&bddfreemutex);
+      return 0;
+   }
+   pthread_mutex_unlock(&bddfreemutex);
+
+   if (bdderrorcond)
+      return -1;
+
+   bdd_world_stop();
+
+      /* Another thread may have collected while we were waiting. */
+   if (bddfreepos == 0)
+   {
+      bdd_gbc();
+
+      if ((bddfreenum*100) / bddnodesize <= minfreenodes)
+	 bdd_noderesize(1);
+
+	 /* Panic if that is not possible */
+      if (bddfreepos == 0)
+      {
+	 bdd_error(BDD_NODENUM);
+	 bdderrorcond = abs(BDD_NODENUM);
+	 bdd_world_start(NULL);
+	 return -1;
+      }
+   }
+
+   bdd_world_start(NULL);
+   return 1;
+}
+
+
+int bdd_makenode(unsigned int level, int low, int high)
+{
+   register BddNode *node;
+   register unsigned int hash;
+   register int res;
+   int head;
+   int *lock;
+
+      /* check whether childs are equal */
+   if (low == high)
+      return low;
+
+   if (__unlikely(__atomic_load_n(&bddstopping, __ATOMIC_RELAXED))
+       && !bddowner)
+      bdd_thread_yield();
+
+ again:
+      /* Try to find an existing node of this kind, without locking:
+	 nodes are completely initialized before being published, and
+	 are never removed from the chains but by the garbage
+	 collector. */
+   hash = NODEHASH(level, low, high);
+   head = __atomic_load_n(&bddhash[hash], __ATOMIC_ACQUIRE);
+
+   for (res=head ; res!=0 ; res=bddnodes[res].next)
+      if (LEVEL(res) == (int)level  &&  LOW(res) == low  &&  HIGH(res) == high)
+	 return res;
+
+      /* Any free nodes to use ?  Do this before taking the lock, since
+	 it may have to wait for the other threads. */
+   if (bddlocalfree == 0)
+      switch (bdd_refill())
+      {
+      case 0:
+	 break;
+      case 1:
+	 goto again;
+      default:
+	 return 0;
+      }
+
+   lock = &bddstripes[hash % BDDSTRIPES];
+   while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+      while (__atomic_load_n(lock, __ATOMIC_RELAXED))
+	 continue;
+
+      /* Check the nodes inserted since we looked. */
+   for (res=bddhash[hash] ; res!=head ; res=bddnodes[res].next)
+      if (LEVEL(res) == (int)level  &&  LOW(res) == low  &&  HIGH(res) == high)
+      {
+	 __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+	 return res;
+      }
+
+      /* Build new node */
+   res = bddlocalfree;
+   node = &bddnodes[res];
+   bddlocalfree = node->next;
+
+   LEVELp(node) = level;
+   LOWp(node) = low;
+   HIGHp(node) = high;
+
+      /* Insert node */
+   node->next = bddhash[hash];
+   __atomic_store_n(&bddhash[hash], res, __ATOMIC_RELEASE);
+
+   __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+   return res;
+}
+#endif /* BUDDY_THREADS */
 
 
 int bdd_noderesize(int doRehash)
@@ -1461,6 +1937,9 @@ int bdd_noderesize(int doRehash)
      for (n=oldsize ; n<sz ; n++)
        {
          b[n].z = 0;
+#ifdef BUDDY_THREADS
+         b[n].level = 0;
+#endif
          b[n].low = -1;
          b[n].high = 0;
          b[n].next = n+1;
@@ -1516,6 +1995,7 @@ RETURN  {* Zero on success, otherwise a negative error code. *}
 int bdd_scanset(BDD r, int **varset, int *varnum)
 {
    int n, num;
+   BDD_OPERATION;
 
    CHECK(r);
    if (r < 2)
@@ -1559,6 +2039,7 @@ RETURN {* A BDD variable set. *} */
 BDD bdd_makeset(int *varset, int varnum)
 {
    int v, res=1;
+   BDD_OPERATION;
 
    for (v=varnum-1 ; v>=0 ; v--)
    {
@@ -86,14 +86,28 @@
    if (root < 2) \
       return bdd_error(BDD_ILLBDD)
 
+#endif
+
+   /* Variables that each thread has its own copy of */
+#ifdef BUDDY_THREADS
+#define BDD_THREADLOCAL __thread
+#else
+#define BDD_THREADLOCAL
 #endif
 
 /*=== SEMI-INTERNAL TYPES ==============================================*/
 
 typedef struct s_BddNode /* Node table entry */
 {
+#ifdef BUDDY_THREADS
+   /* The reference count is updated atomically, so it cannot share
+      a word with the level. */
+   unsigned int refcou;
+   int level;
+#else
    unsigned int refcou : 10;
    unsigned int level  : 22;
+#endif
    int low;
    int high;
    int next;
@@ -104,6 +118,9 @@ typedef struct s_BddNode /* Node table entry */
 typedef struct s_BddNodeInit
 {
    int z;
+#ifdef BUDDY_THREADS
+   int level;
+#endif
    int low;
    int high;
    int next;
@@ -123,14 +140,17 @@ extern int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
 extern BddNode*  bddnodes;           /* All of the bdd nodes */
 extern int*      bddhash;            /* Unicity hash table */
 extern int       bddvarnum;          /* Number of defined BDD variables */
-extern int*      bddrefstack;        /* Internal node reference stack */
-extern int*      bddrefstacktop;     /* Internal node reference stack top */
+extern BDD_THREADLOCAL int* bddrefstack;    /* Internal node reference stack */
+extern BDD_THREADLOCAL int* bddrefstacktop; /* Internal node reference stack top */
 extern int*      bddvar2level;
 extern int*      bddlevel2var;
-extern jmp_buf   bddexception;
+extern BDD_THREADLOCAL jmp_buf bddexception;
 extern int       bddreorderdisabled;
 extern int       bddresized;
 extern bddCacheStat bddcachestats;
+#ifdef BUDDY_THREADS
+extern __thread unsigned int* bddmarks; /* Nodes marked by this thread */
+#endif
 
   /* from reorder.c */
 extern int bddreordermethod;
@@ -146,22 +166,58 @@ extern int bddreordermethod;
 #define MAXREF 0x3FF
 
    /* Reference counting */
+#ifdef BUDDY_THREADS
+static inline void bdd_incref_atomic(BddNode *node)
+{
+   unsigned int r = __atomic_load_n(&node->refcou, __ATOMIC_RELAXED);
+   while (r < MAXREF
+	  && !__atomic_compare_exchange_n(&node->refcou, &r, r+1, 1,
+					  __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      continue;
+}
+static inline void bdd_decref_atomic(BddNode *node)
+{
+   unsigned int r = __atomic_load_n(&node->refcou, __ATOMIC_RELAXED);
+   while (r != MAXREF && r > 0
+	  && !__atomic_compare_exchange_n(&node->refcou, &r, r-1, 1,
+					  __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      continue;
+}
+#define DECREF(n) bdd_decref_atomic(&bddnodes[n])
+#define INCREF(n) bdd_incref_atomic(&bddnodes[n])
+#define DECREFp(n) bdd_decref_atomic(n)
+#define INCREFp(n) bdd_incref_atomic(n)
+#define HASREF(n) (__atomic_load_n(&bddnodes[n].refcou, __ATOMIC_RELAXED) > 0)
+#else
 #define DECREF(n) if (bddnodes[n].refcou!=MAXREF && bddnodes[n].refcou>0) bddnodes[n].refcou--
 #define INCREF(n) if (bddnodes[n].refcou<MAXREF) bddnodes[n].refcou++
 #define DECREFp(n) if (n->refcou!=MAXREF && n->refcou>0) n->refcou--
 #define INCREFp(n) if (n->refcou<MAXREF) n->refcou++
 #define HASREF(n) (bddnodes[n].refcou > 0)
+#endif
 
    /* Marking BDD nodes */
 #define MARKON   0x200000    /* Bit used to mark a node (1) */
 #define MARKOFF  0x1FFFFF    /* - unmark */
 #define MARKHIDE 0x1FFFFF
+#ifdef BUDDY_THREADS
+   /* Several threads may traverse the same nodes at once, so each
+      thread marks nodes in its own bitmap.  Only the garbage collector,
+      which runs while all other threads are stopped, uses MARKON. */
+#define SETMARK(n)  (bddmarks[(n) >> 5] |= 1U << ((n) & 31))
+#define UNMARK(n)   (bddmarks[(n) >> 5] &= ~(1U << ((n) & 31)))
+#define MARKED(n)   (bddmarks[(n) >> 5] & (1U << ((n) & 31)))
+#define SETMARKp(p) SETMARK((p) - bddnodes)
+#define UNMARKp(p)  UNMARK((p) - bddnodes)
+#define MARKEDp(p)  MARKED((p) - bddnodes)
+#else
 #define SETMARK(n)  (bddnodes[n].level |= MARKON)
 #define UNMARK(n)   (bddnodes[n].level &= MARKOFF)
 #define MARKED(n)   (bddnodes[n].level & MARKON)
 #define SETMARKp(p) (node->level |= MARKON)
 #define UNMARKp(p)  (node->level &= MARKOFF)
 #define MARKEDp(p)  (node->level & MARKON)
+#endif
 
    /* Hashfunctions */
 
@@ -212,6 +268,16 @@ static inline int PUSHREF(int a)
 #define READREF(a) *(bddrefstacktop-(a))
 #define POPREF(a)  bddrefstacktop -= (a)
 
+#ifdef BUDDY_THREADS
+   /* Leave the result of an operation on the reference stack, where
+      the garbage collector sees it until the thread starts another
+      operation.  Otherwise another thread could collect it before the
+      caller gets a chance to call bdd_addref(). */
+#define KEEPREF(a) (INITREF, PUSHREF(a))
+#else
+#define KEEPREF(a) (a)
+#endif
+
 #define BDDONE 1
 #define BDDZERO 0
 
@@ -271,10 +337,46 @@ extern int    bdd_reorder_varup(int);
 
 extern void   bdd_cpp_init(void);
 
+#ifdef BUDDY_THREADS
+extern int    bdd_thread_enter(void);
+extern void   bdd_thread_leave(int*);
+extern int    bdd_world_stop(void);
+extern void   bdd_world_start(int*);
+extern void   bdd_operator_thread_enter(void);
+extern void   bdd_operator_thread_done(void);
+extern void   bdd_operator_flush(void);
+#endif
+
 #ifdef CPLUSPLUS
 }
 #endif
 
+
+/*=== THREADS ==========================================================*/
+
+#ifdef BUDDY_THREADS
+   /* Every function that reads or creates nodes, or uses the
+      thread-local variables of the package, starts with BDD_OPERATION.
+      Garbage collections only happen while no other thread is inside
+      such a function, or while they all wait in bdd_makenode().
+
+      Functions that reallocate tables read by the other threads (the
+      variable tables, for instance) start with BDD_EXCLUSIVE instead,
+      which waits until all other threads are stopped.
+
+      Both can be nested, and are left automatically when the function
+      returns. */
+#define BDD_OPERATION \
+   int bdd_operation_ __attribute__((__cleanup__(bdd_thread_leave))) \
+      = bdd_thread_enter()
+#define BDD_EXCLUSIVE \
+   int bdd_exclusive_ __attribute__((__cleanup__(bdd_world_start))) \
+      = bdd_world_stop()
+#else
+#define BDD_OPERATION (void)0
+#define BDD_EXCLUSIVE (void)0
+#endif
+
 #endif /* _KERNEL_H */
 
 
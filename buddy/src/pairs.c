@@ -38,12 +38,26 @@
 #include <limits.h>
 #include <assert.h>
 #include "kernel.h"
+#ifdef BUDDY_THREADS
+#include <pthread.h>
+#endif
 
 /*======================================================================*/
 
 static int      pairsid;            /* Pair identifier */
 static bddPair* pairs;              /* List of all replacement pairs in use */
 
+#ifdef BUDDY_THREADS
+   /* Protects pairsid and the list of pairs.  It is never held while
+      nodes are created, so it cannot delay a garbage collection. */
+static pthread_mutex_t pairsmutex = PTHREAD_MUTEX_INITIALIZER;
+#define PAIRS_LOCK   pthread_mutex_lock(&pairsmutex)
+#define PAIRS_UNLOCK pthread_mutex_unlock(&pairsmutex)
+#else
+#define PAIRS_LOCK   (void)0
+#define PAIRS_UNLOCK (void)0
+#endif
+
 
 /*************************************************************************
 *************************************************************************/
@@ -74,6 +88,9 @@ void bdd_pairs_done(void)
 
 static int update_pairsid(void)
 {
+   int id;
+
+   PAIRS_LOCK;
    pairsid++;
 
    if (pairsid == (INT_MAX >> 2))
@@ -82,17 +99,25 @@ static int update_pairsid(void)
       pairsid = 0;
       for (p=pairs ; p!=NULL ; p=p->next)
 	 p->id = pairsid++;
+#ifdef BUDDY_THREADS
+      bdd_operator_flush();
+#else
       bdd_operator_reset();
+#endif
    }
 
-   return pairsid;
+   id = pairsid;
+   PAIRS_UNLOCK;
+   return id;
 }
 
 
 void bdd_register_pair(bddPair *p)
 {
+   PAIRS_LOCK;
    p->next = pairs;
    pairs = p;
+   PAIRS_UNLOCK;
 }
 
 
@@ -167,6 +192,7 @@ bddPair *bdd_newpair(void)
 {
    int n;
    bddPair *p;
+   BDD_OPERATION;
 
    p = bdd_pairalloc();
    if (p == NULL)
@@ -198,6 +224,7 @@ bddPair *bdd_copypair(bddPair *from)
 {
    int n;
    bddPair *p;
+   BDD_OPERATION;
 
    p = bdd_pairalloc();
    if (p == NULL)
@@ -232,6 +259,7 @@ bddPair *bdd_mergepairs(bddPair *left, bddPair *right)
 {
    int n;
    bddPair *p;
+   BDD_OPERATION;
 
    p = bdd_copypair(left);
    if (p == NULL)
@@ -290,6 +318,8 @@ ALSO    {* bdd\_newpair, bdd\_setpairs, bdd\_resetpair, bdd\_replace, bdd\_compo
 */
 int bdd_setpair(bddPair *pair, int oldvar, int newvar)
 {
+   BDD_OPERATION;
+
    if (pair == NULL)
       return 0;
 
@@ -312,6 +342,7 @@ int bdd_setpair(bddPair *pair, int oldvar, int newvar)
 int bdd_setbddpair(bddPair *pair, int oldvar, BDD newvar)
 {
    int oldlevel;
+   BDD_OPERATION;
 
    if (pair == NULL)
       return 0;
@@ -347,6 +378,7 @@ ALSO    {* bdd\_newpair, bdd\_setpair, bdd\_replace, bdd\_compose *}
 int bdd_setpairs(bddPair *pair, int *oldvar, int *newvar, int size)
 {
    int n,e;
+   BDD_OPERATION;
    if (pair == NULL)
       return 0;
 
@@ -361,6 +393,7 @@ int bdd_setpairs(bddPair *pair, int *oldvar, int *newvar, int size)
 int bdd_setbddpairs(bddPair *pair, int *oldvar, BDD *newvar, int size)
 {
    int n,e;
+   BDD_OPERATION;
    if (pair == NULL)
       return 0;
 
@@ -384,10 +417,12 @@ ALSO    {* bdd\_replace, bdd\_newpair, bdd\_setpair, bdd\_resetpair *}
 void bdd_freepair(bddPair *p)
 {
    int n;
+   BDD_OPERATION;
 
    if (p == NULL)
       return;
 
+   PAIRS_LOCK;
    if (pairs != p)
    {
       bddPair *bp = pairs;
@@ -399,6 +434,7 @@ void bdd_freepair(bddPair *p)
    }
    else
       pairs = p->next;
+   PAIRS_UNLOCK;
 
    for (n=0 ; n<bddvarnum ; n++)
       bdd_delref( p->result[n] );
@@ -419,6 +455,7 @@ ALSO    {* bdd\_newpair, bdd\_setpair, bdd\_freepair *}
 void bdd_resetpair(bddPair *p)
 {
    int n;
+   BDD_OPERATION;
 
    for (n=0 ; n<bddvarnum ; n++)
       p->result[n] = bdd_ithvar(n);
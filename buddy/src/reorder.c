@@ -67,7 +67,7 @@ int bddreordermethod;
 static int bddreordertimes;
 
    /* Flag for disabling reordering temporarily */
-static int reorderdisabled;
+static BDD_THREADLOCAL int reorderdisabled;
 
    /* Store for the variable relationships */
 static BddTree *vartree;
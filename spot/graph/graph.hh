@@ -1134,6 +1134,69 @@ namespace spot
       //dump_storage(std::cerr);
     }
 
+    /// \brief Store the outgoing edges of each state contiguously
+    ///
+    /// Renumber the edges so that the outgoing edges of each state
+    /// are consecutive in the edge vector, in the order in which
+    /// out() lists them, and states are ordered by increasing
+    /// numbers.  Dead edges are removed, and the memory reserved for
+    /// future states and edges is released.  Afterwards, the edges
+    /// leaving \c s are numbered from <code>states()[s].succ</code> to
+    /// <code>states()[s].succ_tail</code>: the edge vector is a
+    /// compressed sparse row representation of the graph, and
+    /// iterating over out() or edges() reads memory sequentially.
+    ///
+    /// The graph can still be modified afterwards, but new edges are
+    /// appended to the edge vector as usual.
+    ///
+    /// \return true iff some edges have been renumbered.
+    bool freeze()
+    {
+      // Do nothing if the chains already follow the edge vector.
+      // (Dead edges are not part of any chain.)
+      bool in_order = true;
+      edge expected = 1;
+      for (auto& s: states_)
+        {
+          for (edge t = s.succ; t && in_order; t = edges_[t].next_succ)
+            in_order = t == expected++;
+          if (!in_order)
+            break;
+        }
+      if (in_order && expected == edges_.size())
+        {
+          states_.shrink_to_fit();
+          edges_.shrink_to_fit();
+          dests_.shrink_to_fit();
+          return false;
+        }
+      edge_vector_t csr;
+      csr.reserve(num_edges() + 1);
+      csr.emplace_back(std::move(edges_[0]));
+      for (auto& s: states_)
+        {
+          edge t = s.succ;
+          if (!t)
+            continue;
+          s.succ = csr.size();
+          do
+            {
+              edge next = edges_[t].next_succ;
+              csr.emplace_back(std::move(edges_[t]));
+              csr.back().next_succ = csr.size();
+              t = next;
+            }
+          while (t);
+          s.succ_tail = csr.size() - 1;
+          csr.back().next_succ = 0;
+        }
+      edges_.swap(csr);
+      killed_edge_ = 0;
+      states_.shrink_to_fit();
+      dests_.shrink_to_fit();
+      return true;
+    }
+
     /// \brief Rename all the states in the edge vector.
     ///
     /// The edges_ vector is left in a state that is incorrect and
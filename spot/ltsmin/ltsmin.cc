@@ -36,6 +36,7 @@
 #include <spot/misc/mspool.hh>
 #include <spot/misc/intvcomp.hh>
 #include <spot/misc/intvcmp2.hh>
+#include <spot/twa/twagraph.hh>
 
 namespace spot
 {
@@ -68,6 +69,15 @@ namespace spot
     const char* (*get_type_name)(int type);
     int (*get_type_value_count)(int type);
     const char* (*get_type_value_name)(int type, int value);
+    // The following are only needed for partial-order reduction, and
+    // may be null if the model does not provide them.
+    int (*get_transition_count)();
+    const int* (*get_transition_read_dependencies)(int group);
+    const int* (*get_transition_write_dependencies)(int group);
+    int (*get_guard_count)();
+    const int* (*get_guards)(int group);
+    const int* (*get_guard_matrix)(int guard);
+    int (*get_guard)(void* m, int guard, int* src);
 
     ~spins_interface()
     {
@@ -219,6 +229,10 @@ namespace spot
       void* pool;
       int* compressed;
       void (*compress)(const int*, size_t, int*, size_t&);
+      // If RECORD_GROUPS is set, GROUPS[i] is the transition group
+      // of the ith element of TRANSITIONS.
+      bool record_groups;
+      std::vector<int> groups;
 
       ~callback_context()
       {
@@ -227,9 +241,11 @@ namespace spot
       }
     };
 
-    void transition_callback(void* arg, transition_info_t*, int *dst)
+    void transition_callback(void* arg, transition_info_t* ti, int *dst)
     {
       callback_context* ctx = static_cast<callback_context*>(arg);
+      if (ctx->record_groups)
+        ctx->groups.push_back(ti ? ti->group : -1);
       fixed_size_pool* p = static_cast<fixed_size_pool*>(ctx->pool);
       spins_state* out =
         new(p->allocate()) spins_state(ctx->state_size, p);
@@ -238,9 +254,12 @@ namespace spot
       ctx->transitions.emplace_back(out);
     }
 
-    void transition_callback_compress(void* arg, transition_info_t*, int *dst)
+    void transition_callback_compress(void* arg, transition_info_t* ti,
+                                      int *dst)
     {
       callback_context* ctx = static_cast<callback_context*>(arg);
+      if (ctx->record_groups)
+        ctx->groups.push_back(ti ? ti->group : -1);
       multiple_size_pool* p = static_cast<multiple_size_pool*>(ctx->pool);
 
       size_t csize = ctx->state_size * 2;
@@ -330,10 +349,13 @@ namespace spot
     };
 
 
+    // Register the propositions of APS (except DEAD) for OWNER in
+    // DICT, and record how to evaluate them in OUT.
     void
     convert_aps(const atomic_prop_set* aps,
                 spins_interface_ptr d,
                 bdd_dict_ptr dict,
+                const void* owner,
                 formula dead,
                 prop_set& out)
     {
@@ -460,7 +482,7 @@ namespace spot
                 }
 
               // Record that X.Y must be equal to Z.
-              int v = dict->register_proposition(*ap, d.get());
+              int v = dict->register_proposition(*ap, owner);
               one_prop p = { ni->second.num, OP_EQ, ei->second, v };
               out.emplace_back(p);
               free(name);
@@ -471,7 +493,7 @@ namespace spot
 
           if (!*s)                // No operator?  Assume "!= 0".
             {
-              int v = dict->register_proposition(*ap, d);
+              int v = dict->register_proposition(*ap, owner);
               one_prop p = { var_num, OP_NE, 0, v };
               out.emplace_back(p);
               free(name);
@@ -589,7 +611,7 @@ namespace spot
             }
 
 
-          int v = dict->register_proposition(*ap, d);
+          int v = dict->register_proposition(*ap, owner);
           one_prop p = { var_num, op, val, v };
           out.emplace_back(p);
         }
@@ -598,6 +620,210 @@ namespace spot
         throw std::runtime_error(err.str());
     }
 
+    // The conjunction of all propositions of PS, as evaluated in the
+    // state VARS.
+    bdd
+    evaluate_props(const prop_set& ps, const int* vars)
+    {
+      bdd res = bddtrue;
+      for (auto& i: ps)
+        {
+          int l = vars[i.var_num];
+          int r = i.val;
+
+          bool cond = false;
+          switch (i.op)
+            {
+            case OP_EQ:
+              cond = (l == r);
+              break;
+            case OP_NE:
+              cond = (l != r);
+              break;
+            case OP_LT:
+              cond = (l < r);
+              break;
+            case OP_GT:
+              cond = (l > r);
+              break;
+            case OP_LE:
+              cond = (l <= r);
+              break;
+            case OP_GE:
+              cond = (l >= r);
+              break;
+            }
+
+          if (cond)
+            res &= bdd_ithvar(i.bddvar);
+          else
+            res &= bdd_nithvar(i.bddvar);
+        }
+      return res;
+    }
+
+    // Register the "dead" proposition.  There are three cases to
+    // consider:
+    //  * If DEAD is "false", it means we are not interested in finite
+    //    sequences of the system.
+    //  * If DEAD is "true", we want to check finite sequences as well
+    //    as infinite sequences, but do not need to distinguish them.
+    //  * If DEAD is any other string, this is the name a property
+    //    that should be true when looping on a dead state, and false
+    //    otherwise.
+    // We handle these three cases by setting ALIVE_PROP and DEAD_PROP
+    // appropriately.  ALIVE_PROP is the bdd that should be ANDed
+    // to all transitions leaving a live state, while DEAD_PROP should
+    // be ANDed to all transitions leaving a dead state.
+    void
+    convert_dead(formula dead, const bdd_dict_ptr& dict, const void* owner,
+                 bdd& alive_prop, bdd& dead_prop)
+    {
+      if (dead.is_ff())
+        {
+          alive_prop = bddtrue;
+          dead_prop = bddfalse;
+        }
+      else if (dead.is_tt())
+        {
+          alive_prop = bddtrue;
+          dead_prop = bddtrue;
+        }
+      else
+        {
+          int var = dict->register_proposition(dead, owner);
+          dead_prop = bdd_ithvar(var);
+          alive_prop = bdd_nithvar(var);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // PARTIAL ORDER REDUCTION
+
+    // Static information about the transition groups of a model,
+    // derived from its read and write dependency matrices.
+    struct por_info
+    {
+      // For each group T, the other groups that do not commute with
+      // T, or that may disable T or be disabled by it.
+      std::vector<std::vector<unsigned>> dependent;
+      // For each group T, the groups that may enable T.
+      std::vector<std::vector<unsigned>> enablers;
+      // If the model describes the guards of its groups, GUARDS[T]
+      // lists the guards of group T, and GUARD_ENABLERS[G] the groups
+      // that may change the value of guard G.  A disabled group then
+      // only needs the enablers of one of its false guards.
+      std::vector<std::vector<unsigned>> guards;
+      std::vector<std::vector<unsigned>> guard_enablers;
+      // Whether each group may change the value of a proposition.
+      std::vector<bool> visible;
+    };
+
+    por_info*
+    make_por_info(spins_interface_ptr d, const prop_set& ps)
+    {
+      if (!d->get_transition_count
+          || !d->get_transition_read_dependencies
+          || !d->get_transition_write_dependencies)
+        throw std::runtime_error("Partial-order reduction requires a "
+                                 "model that provides dependency "
+                                 "matrices.");
+
+      int state_size = d->get_state_size();
+      unsigned groups = d->get_transition_count();
+      std::vector<std::vector<unsigned>> reads(groups);
+      std::vector<std::vector<unsigned>> writes(groups);
+      std::vector<std::vector<unsigned>> readers(state_size);
+      std::vector<std::vector<unsigned>> writers(state_size);
+      for (unsigned t = 0; t < groups; ++t)
+        {
+          const int* r = d->get_transition_read_dependencies(t);
+          const int* w = d->get_transition_write_dependencies(t);
+          for (int v = 0; v < state_size; ++v)
+            {
+              if (r[v])
+                {
+                  reads[t].push_back(v);
+                  readers[v].push_back(t);
+                }
+              if (w[v])
+                {
+                  writes[t].push_back(v);
+                  writers[v].push_back(t);
+                }
+            }
+        }
+
+      std::vector<bool> observed(state_size, false);
+      for (auto& p: ps)
+        observed[p.var_num] = true;
+
+      por_info* res = new por_info;
+      res->dependent.resize(groups);
+      res->enablers.resize(groups);
+      res->visible.resize(groups, false);
+      std::vector<unsigned> seen(groups, -1U);
+      std::vector<unsigned> seen_enabler(groups, -1U);
+      for (unsigned t = 0; t < groups; ++t)
+        {
+          auto add = [&](unsigned u)
+            {
+              if (u != t && seen[u] != t)
+                {
+                  seen[u] = t;
+                  res->dependent[t].push_back(u);
+                }
+            };
+          for (unsigned v: writes[t])
+            {
+              if (observed[v])
+                res->visible[t] = true;
+              for (unsigned u: readers[v])
+                add(u);
+              for (unsigned u: writers[v])
+                add(u);
+            }
+          for (unsigned v: reads[t])
+            for (unsigned u: writers[v])
+              {
+                add(u);
+                if (u != t && seen_enabler[u] != t)
+                  {
+                    seen_enabler[u] = t;
+                    res->enablers[t].push_back(u);
+                  }
+              }
+        }
+
+      if (d->get_guard_count && d->get_guards && d->get_guard_matrix
+          && d->get_guard)
+        {
+          unsigned guard_count = d->get_guard_count();
+          res->guards.resize(groups);
+          res->guard_enablers.resize(guard_count);
+          for (unsigned t = 0; t < groups; ++t)
+            {
+              // The first element is the number of guards.
+              const int* g = d->get_guards(t);
+              res->guards[t].assign(g + 1, g + 1 + g[0]);
+            }
+          seen.assign(groups, -1U);
+          for (unsigned g = 0; g < guard_count; ++g)
+            {
+              const int* r = d->get_guard_matrix(g);
+              for (int v = 0; v < state_size; ++v)
+                if (r[v])
+                  for (unsigned u: writers[v])
+                    if (seen[u] != g)
+                      {
+                        seen[u] = g;
+                        res->guard_enablers[g].push_back(u);
+                      }
+            }
+        }
+      return res;
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // KRIPKE
 
@@ -607,11 +833,12 @@ namespace spot
 
       spins_kripke(spins_interface_ptr d, const bdd_dict_ptr& dict,
                    const spot::prop_set* ps, formula dead,
-                   int compress)
+                   int compress, const por_info* por)
         : kripke(dict),
           d_(d),
           state_size_(d_->get_state_size()),
           ps_(ps),
+          por_(por),
           compress_(compress == 0 ? nullptr
                     : compress == 1 ? int_array_array_compress
                     : int_array_array_compress2),
@@ -641,35 +868,7 @@ namespace spot
               (d->get_type_value_count(type) != 1);
           }
 
-        // Register the "dead" proposition.  There are three cases to
-        // consider:
-        //  * If DEAD is "false", it means we are not interested in finite
-        //    sequences of the system.
-        //  * If DEAD is "true", we want to check finite sequences as well
-        //    as infinite sequences, but do not need to distinguish them.
-        //  * If DEAD is any other string, this is the name a property
-        //    that should be true when looping on a dead state, and false
-        //    otherwise.
-        // We handle these three cases by setting ALIVE_PROP and DEAD_PROP
-        // appropriately.  ALIVE_PROP is the bdd that should be ANDed
-        // to all transitions leaving a live state, while DEAD_PROP should
-        // be ANDed to all transitions leaving a dead state.
-        if (dead.is_ff())
-          {
-            alive_prop = bddtrue;
-            dead_prop = bddfalse;
-          }
-        else if (dead.is_tt())
-          {
-            alive_prop = bddtrue;
-            dead_prop = bddtrue;
-          }
-        else
-          {
-            int var = dict->register_proposition(dead, d_);
-            dead_prop = bdd_ithvar(var);
-            alive_prop = bdd_nithvar(var);
-          }
+        convert_dead(dead, dict, d_.get(), alive_prop, dead_prop);
       }
 
       ~spins_kripke()
@@ -689,6 +888,7 @@ namespace spot
         dict_->unregister_all_my_variables(d_.get());
 
         delete ps_;
+        delete por_;
 
         if (state_condition_last_state_)
           state_condition_last_state_->destroy();
@@ -727,46 +927,16 @@ namespace spot
       bdd
       compute_state_condition_aux(const int* vars) const
       {
-        bdd res = bddtrue;
-        for (auto& i: *ps_)
-          {
-            int l = vars[i.var_num];
-            int r = i.val;
-
-            bool cond = false;
-            switch (i.op)
-              {
-              case OP_EQ:
-                cond = (l == r);
-                break;
-              case OP_NE:
-                cond = (l != r);
-                break;
-              case OP_LT:
-                cond = (l < r);
-                break;
-              case OP_GT:
-                cond = (l > r);
-                break;
-              case OP_LE:
-                cond = (l <= r);
-                break;
-              case OP_GE:
-                cond = (l >= r);
-                break;
-              }
-
-            if (cond)
-              res &= bdd_ithvar(i.bddvar);
-            else
-              res &= bdd_nithvar(i.bddvar);
-          }
-        return res;
+        return evaluate_props(*ps_, vars);
       }
 
-      callback_context* build_cc(const int* vars, int& t) const
+      // Compute the successors of ST, whose variables are VARS.  T
+      // is set to the number of successors before any reduction.
+      callback_context* build_cc(const state* st, const int* vars,
+                                 int& t) const
       {
         callback_context* cc = new callback_context;
+        cc->record_groups = por_ != nullptr;
         cc->state_size = state_size_;
         cc->pool =
           const_cast<void*>(compress_
@@ -780,9 +950,126 @@ namespace spot
                                : transition_callback,
                                cc);
         assert((unsigned)t == cc->transitions.size());
+        if (por_)
+          reduce(st, vars, cc);
         return cc;
       }
 
+      // Keep only the successors of ST that are reached by the
+      // enabled groups of a stubborn set.  The set is grown from each
+      // enabled group in turn, and the smallest one is kept among
+      // those that
+      //  - contain no enabled visible group (visibility proviso), and
+      //  - lead only to states greater than ST (cycle proviso:
+      //    on any cycle, the greatest state is then fully expanded).
+      void reduce(const state* st, const int* vars,
+                  callback_context* cc) const
+      {
+        unsigned groups = por_->visible.size();
+        // 0: disabled, 1: enabled, 2: enabled but leading to a state
+        // that is not greater than ST.
+        std::vector<char> enabled(groups, 0);
+        unsigned n = 0;
+        auto gi = cc->groups.begin();
+        for (auto dst: cc->transitions)
+          {
+            int g = *gi++;
+            if (g < 0 || (unsigned) g >= groups)
+              return;           // Unknown group: do not reduce.
+            if (!enabled[g])
+              {
+                ++n;
+                enabled[g] = 1;
+              }
+            if (dst->compare(st) <= 0)
+              enabled[g] = 2;
+          }
+        if (n <= 1)
+          return;
+
+        // Value of each guard in VARS: 0 if false, 1 if true, -1
+        // if not yet evaluated.
+        std::vector<signed char> guard_val(por_->guard_enablers.size(), -1);
+        int* v = const_cast<int*>(vars);
+        auto disabled_enablers = [&](unsigned t)
+          -> const std::vector<unsigned>*
+          {
+            const std::vector<unsigned>* res = &por_->enablers[t];
+            if (!por_->guards.empty())
+              for (unsigned g: por_->guards[t])
+                {
+                  if (guard_val[g] < 0)
+                    guard_val[g] = !!d_->get_guard(nullptr, g, v);
+                  if (!guard_val[g]
+                      && por_->guard_enablers[g].size() < res->size())
+                    res = &por_->guard_enablers[g];
+                }
+            return res;
+          };
+
+        std::vector<char> in_set(groups);
+        std::vector<char> best;
+        std::vector<unsigned> todo;
+        unsigned best_n = n;
+        for (unsigned seed = 0; seed < groups && best_n > 1; ++seed)
+          {
+            if (enabled[seed] != 1 || por_->visible[seed])
+              continue;
+            std::fill(in_set.begin(), in_set.end(), 0);
+            in_set[seed] = 1;
+            todo.assign(1, seed);
+            unsigned m = 0;
+            bool ok = true;
+            while (!todo.empty())
+              {
+                unsigned t = todo.back();
+                todo.pop_back();
+                const std::vector<unsigned>* next;
+                if (enabled[t])
+                  {
+                    if (enabled[t] == 2 || por_->visible[t]
+                        || ++m >= best_n)
+                      {
+                        ok = false;
+                        break;
+                      }
+                    next = &por_->dependent[t];
+                  }
+                else
+                  {
+                    next = disabled_enablers(t);
+                  }
+                for (unsigned u: *next)
+                  if (!in_set[u])
+                    {
+                      in_set[u] = 1;
+                      todo.push_back(u);
+                    }
+              }
+            if (ok)
+              {
+                std::swap(best, in_set);
+                in_set.resize(groups);
+                best_n = m;
+              }
+          }
+        if (best_n == n)
+          return;
+
+        gi = cc->groups.begin();
+        for (auto it = cc->transitions.begin();
+             it != cc->transitions.end(); ++gi)
+          if (best[*gi])
+            {
+              ++it;
+            }
+          else
+            {
+              (*it)->destroy();
+              it = cc->transitions.erase(it);
+            }
+      }
+
       bdd
       compute_state_condition(const state* st) const
       {
@@ -801,7 +1088,7 @@ namespace spot
 
         bdd res = compute_state_condition_aux(vars);
         int t;
-        callback_context* cc = build_cc(vars, t);
+        callback_context* cc = build_cc(st, vars, t);
 
         if (t)
           {
@@ -859,7 +1146,7 @@ namespace spot
         else
           {
             int t;
-            cc = build_cc(get_vars(st), t);
+            cc = build_cc(st, get_vars(st), t);
 
             // Add a self-loop to dead-states if we care about these.
             if (t == 0 && scond != bddfalse)
@@ -918,6 +1205,7 @@ namespace spot
       const char** vname_;
       bool* format_filter_;
       const spot::prop_set* ps_;
+      const por_info* por_;
       bdd alive_prop;
       bdd dead_prop;
       void (*compress_)(const int*, size_t, int*, size_t&);
@@ -938,6 +1226,342 @@ namespace spot
     };
 
 
+    //////////////////////////////////////////////////////////////////////////
+    // COMPACT STATE STORE
+
+    // A set of int vectors, each one identified by a 32-bit number
+    // (its insertion rank).  The vectors are stored one after the
+    // other in a single array, and found back using an
+    // open-addressing hash table of identifiers, so that storing a
+    // state costs its size plus about two ints.  If all vectors have
+    // the same size, their offsets in the array are not stored.
+    class int_vector_store final
+    {
+    public:
+      // SIZE is the size of all vectors, or 0 if vectors of different
+      // sizes will be stored.
+      int_vector_store(unsigned size)
+        : size_(size), count_(0), table_(1024, -1U)
+      {
+        if (!size)
+          offsets_.push_back(0);
+      }
+
+      // Return the identifier of VEC, storing it if needed.
+      unsigned insert(const int* vec, unsigned size, bool& inserted)
+      {
+        assert(!size_ || size == size_);
+        size_t mask = table_.size() - 1;
+        size_t pos = hash(vec, size) & mask;
+        for (;;)
+          {
+            unsigned id = table_[pos];
+            if (id == -1U)
+              break;
+            if (size_of(id) == size
+                && !memcmp(get(id), vec, size * sizeof(*vec)))
+              {
+                inserted = false;
+                return id;
+              }
+            pos = (pos + 1) & mask;
+          }
+
+        if (count_ == -1U - 1)
+          throw std::runtime_error("Too many states to be numbered "
+                                   "on 32 bits.");
+        inserted = true;
+        unsigned id = count_++;
+        table_[pos] = id;
+        data_.insert(data_.end(), vec, vec + size);
+        if (!size_)
+          offsets_.push_back(data_.size());
+        // Keep the table at most half full.
+        if (2 * size_t(count_) > table_.size())
+          grow();
+        return id;
+      }
+
+      const int* get(unsigned id) const
+      {
+        return data_.data() + (size_ ? size_t(id) * size_ : offsets_[id]);
+      }
+
+      unsigned size_of(unsigned id) const
+      {
+        return size_ ? size_ : offsets_[id + 1] - offsets_[id];
+      }
+
+      unsigned count() const
+      {
+        return count_;
+      }
+
+      size_t memory() const
+      {
+        return table_.capacity() * sizeof(unsigned)
+          + data_.capacity() * sizeof(int)
+          + offsets_.capacity() * sizeof(size_t);
+      }
+
+    private:
+      // Same hash function as for spins_state.
+      static size_t hash(const int* vec, unsigned size)
+      {
+        size_t res = 0;
+        for (unsigned i = 0; i < size; ++i)
+          res = wang32_hash(res ^ vec[i]);
+        return res;
+      }
+
+      void grow()
+      {
+        std::vector<unsigned> table(2 * table_.size(), -1U);
+        size_t mask = table.size() - 1;
+        for (unsigned id = 0; id < count_; ++id)
+          {
+            size_t pos = hash(get(id), size_of(id)) & mask;
+            while (table[pos] != -1U)
+              pos = (pos + 1) & mask;
+            table[pos] = id;
+          }
+        std::swap(table, table_);
+      }
+
+      unsigned size_;
+      unsigned count_;
+      std::vector<unsigned> table_;
+      std::vector<int> data_;
+      std::vector<size_t> offsets_;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    // EMPTINESS CHECK ON STATE NUMBERS
+
+    struct store_context
+    {
+      int_vector_store* store;
+      std::vector<unsigned>* succs;
+      int state_size;
+      int* compressed;
+      void (*compress)(const int*, size_t, int*, size_t&);
+    };
+
+    void store_callback(void* arg, transition_info_t*, int *dst)
+    {
+      store_context* ctx = static_cast<store_context*>(arg);
+      const int* vars = dst;
+      size_t size = ctx->state_size;
+      if (ctx->compress)
+        {
+          size = ctx->state_size * 2;
+          ctx->compress(dst, ctx->state_size, ctx->compressed, size);
+          vars = ctx->compressed;
+        }
+      bool inserted;
+      ctx->succs->push_back(ctx->store->insert(vars, size, inserted));
+    }
+
+    // Couvreur's SCC-based emptiness check, running directly on the
+    // product of the model with PROP.  The model states are numbered
+    // in one int_vector_store, and the product states, i.e., pairs
+    // (model state number, automaton state), in another one.
+    // Product states are numbered in the order they are discovered,
+    // so their number also serves as DFS number.
+    class spins_intersection final
+    {
+    public:
+      spins_intersection(spins_interface_ptr d, const const_twa_graph_ptr& prop,
+                         const prop_set& ps, bdd alive_prop, bdd dead_prop,
+                         int compress)
+        : d_(d), prop_(prop), ps_(ps),
+          alive_prop_(alive_prop), dead_prop_(dead_prop),
+          state_size_(d_->get_state_size()),
+          compress_(compress == 0 ? nullptr
+                    : compress == 1 ? int_array_array_compress
+                    : int_array_array_compress2),
+          decompress_(compress == 0 ? nullptr
+                      : compress == 1 ? int_array_array_decompress
+                      : int_array_array_decompress2),
+          vars_(state_size_ + 30),
+          compressed_(state_size_ * 2),
+          model_(compress ? 0 : state_size_),
+          product_(2),
+          transitions_(0)
+      {
+      }
+
+      bool check()
+      {
+        {
+          d_->get_initial_state(vars_.data());
+          std::vector<unsigned> init;
+          store_context ctx = { &model_, &init, state_size_,
+                                compressed_.data(), compress_ };
+          store_callback(&ctx, nullptr, vars_.data());
+          unsigned q = prop_->get_init_state_number();
+          int pair[2] = { static_cast<int>(init[0]), static_cast<int>(q) };
+          bool inserted;
+          push(product_.insert(pair, 2, inserted), init[0], q, 0U);
+        }
+
+        const auto& acc = prop_->acc();
+        while (!todo_.empty())
+          {
+            frame& f = todo_.back();
+            if (f.msucc == f.mend)
+              {
+                ++f.edge;
+                f.msucc = f.mbegin;
+              }
+            if (f.edge == f.eend || f.mbegin == f.mend)
+              {
+                unsigned p = f.p;
+                msuccs_.resize(f.mbegin);
+                edges_.resize(f.ebegin);
+                todo_.pop_back();
+                if (roots_.back().p == p)
+                  {
+                    roots_.pop_back();
+                    // All states discovered since P that are not dead
+                    // belong to its SCC.
+                    while (!live_.empty() && live_.back() >= p)
+                      {
+                        dead_[live_.back()] = true;
+                        live_.pop_back();
+                      }
+                  }
+                continue;
+              }
+
+            unsigned m = msuccs_[f.msucc++];
+            auto& e = prop_->get_graph().edge_storage(edges_[f.edge]);
+            ++transitions_;
+            int pair[2] = { static_cast<int>(m), static_cast<int>(e.dst) };
+            bool inserted;
+            unsigned dst = product_.insert(pair, 2, inserted);
+            if (inserted)
+              {
+                // This invalidates F.
+                push(dst, m, e.dst, e.acc);
+                continue;
+              }
+            if (dead_[dst])
+              continue;
+
+            // DST is on the stack: merge all SCCs above it.
+            acc_cond::mark_t a = e.acc;
+            while (roots_.back().p > dst)
+              {
+                a |= roots_.back().acc | roots_.back().in;
+                roots_.pop_back();
+              }
+            roots_.back().acc |= a;
+            if (acc.accepting(roots_.back().acc))
+              return true;
+          }
+        return false;
+      }
+
+      void stats(ltsmin_check_stats& s) const
+      {
+        s.model_states = model_.count();
+        s.product_states = product_.count();
+        s.transitions = transitions_;
+        s.memory = model_.memory() + product_.memory()
+          + dead_.capacity() / 8;
+      }
+
+    private:
+      // Push the new product state P = (M, Q), entered with marks IN.
+      void push(unsigned p, unsigned m, unsigned q, acc_cond::mark_t in)
+      {
+        dead_.push_back(false);
+        live_.push_back(p);
+        roots_.push_back({ p, 0U, in });
+
+        // Compute the successors of M, and its label.  Copy its
+        // variables first, because inserting the successors in the
+        // store may move them.
+        const int* vars = model_.get(m);
+        if (compress_)
+          {
+            decompress_(vars, model_.size_of(m), vars_.data(), state_size_);
+          }
+        else
+          {
+            memcpy(vars_.data(), vars, state_size_ * sizeof(int));
+          }
+        bdd label = evaluate_props(ps_, vars_.data());
+        unsigned mbegin = msuccs_.size();
+        store_context ctx = { &model_, &msuccs_, state_size_,
+                              compressed_.data(), compress_ };
+        int t = d_->get_successors(nullptr, vars_.data(), store_callback,
+                                   &ctx);
+        if (t)
+          {
+            label &= alive_prop_;
+          }
+        else
+          {
+            label &= dead_prop_;
+            // Add a self-loop to dead-states if we care about these.
+            if (label != bddfalse)
+              msuccs_.push_back(m);
+          }
+
+        unsigned ebegin = edges_.size();
+        for (auto& e: prop_->out(q))
+          if ((e.cond & label) != bddfalse)
+            edges_.push_back(prop_->get_graph().index_of_edge(e));
+
+        todo_.push_back({ p, mbegin, mbegin,
+                          static_cast<unsigned>(msuccs_.size()),
+                          ebegin, ebegin,
+                          static_cast<unsigned>(edges_.size()) });
+      }
+
+      struct root
+      {
+        unsigned p;                // Number of the root.
+        acc_cond::mark_t acc;      // Marks seen in the SCC.
+        acc_cond::mark_t in;       // Marks on the edge entering P.
+      };
+
+      struct frame
+      {
+        unsigned p;
+        // Successors of the model state in msuccs_[mbegin..mend), and
+        // compatible edges of the automaton in edges_[ebegin..eend).
+        unsigned mbegin;
+        unsigned msucc;
+        unsigned mend;
+        unsigned ebegin;
+        unsigned edge;
+        unsigned eend;
+      };
+
+      spins_interface_ptr d_;
+      const_twa_graph_ptr prop_;
+      const prop_set& ps_;
+      bdd alive_prop_;
+      bdd dead_prop_;
+      int state_size_;
+      void (*compress_)(const int*, size_t, int*, size_t&);
+      void (*decompress_)(const int*, size_t, int*, size_t);
+      std::vector<int> vars_;
+      std::vector<int> compressed_;
+      int_vector_store model_;
+      int_vector_store product_;
+      std::vector<bool> dead_;
+      std::vector<unsigned> live_;
+      std::vector<root> roots_;
+      std::vector<frame> todo_;
+      std::vector<unsigned> msuccs_;
+      std::vector<unsigned> edges_;
+      size_t transitions_;
+    };
+
     //////////////////////////////////////////////////////////////////////////
     // LOADER
 
@@ -1068,6 +1692,20 @@ namespace spot
           sym("spins_get_type_value_count");
         d->get_type_value_name = (const char* (*)(int, int))
           sym("spins_get_type_value_name");
+        *reinterpret_cast<void**>(&d->get_transition_count) =
+          lt_dlsym(h, "spins_get_transition_groups");
+        *reinterpret_cast<void**>(&d->get_transition_read_dependencies) =
+          lt_dlsym(h, "spins_get_transition_read_dependencies");
+        *reinterpret_cast<void**>(&d->get_transition_write_dependencies) =
+          lt_dlsym(h, "spins_get_transition_write_dependencies");
+        *reinterpret_cast<void**>(&d->get_guard_count) =
+          lt_dlsym(h, "spins_get_guard_count");
+        *reinterpret_cast<void**>(&d->get_guards) =
+          lt_dlsym(h, "spins_get_guards");
+        *reinterpret_cast<void**>(&d->get_guard_matrix) =
+          lt_dlsym(h, "spins_get_guard_matrix");
+        *reinterpret_cast<void**>(&d->get_guard) =
+          lt_dlsym(h, "spins_get_guard");
       }
     // dve2 and gal2C interfaces.
     else
@@ -1092,6 +1730,20 @@ namespace spot
           sym("get_state_variable_type_value_count");
         d->get_type_value_name = (const char* (*)(int, int))
           sym("get_state_variable_type_value");
+        *reinterpret_cast<void**>(&d->get_transition_count) =
+          lt_dlsym(h, "get_transition_count");
+        *reinterpret_cast<void**>(&d->get_transition_read_dependencies) =
+          lt_dlsym(h, "get_transition_read_dependencies");
+        *reinterpret_cast<void**>(&d->get_transition_write_dependencies) =
+          lt_dlsym(h, "get_transition_write_dependencies");
+        *reinterpret_cast<void**>(&d->get_guard_count) =
+          lt_dlsym(h, "get_guard_count");
+        *reinterpret_cast<void**>(&d->get_guards) =
+          lt_dlsym(h, "get_guards");
+        *reinterpret_cast<void**>(&d->get_guard_matrix) =
+          lt_dlsym(h, "get_guard_matrix");
+        *reinterpret_cast<void**>(&d->get_guard) =
+          lt_dlsym(h, "get_guard");
       }
 
     if (d->have_property && d->have_property())
@@ -1105,12 +1757,15 @@ namespace spot
   kripke_ptr
   ltsmin_model::kripke(const atomic_prop_set* to_observe,
                        bdd_dict_ptr dict,
-                       const formula dead, int compress) const
+                       const formula dead, int compress, bool por) const
   {
     spot::prop_set* ps = new spot::prop_set;
+    por_info* pi = nullptr;
     try
       {
-        convert_aps(to_observe, iface, dict, dead, *ps);
+        convert_aps(to_observe, iface, dict, iface.get(), dead, *ps);
+        if (por)
+          pi = make_por_info(iface, *ps);
       }
     catch (std::runtime_error)
       {
@@ -1118,7 +1773,8 @@ namespace spot
         dict->unregister_all_my_variables(iface.get());
         throw;
       }
-    auto res = std::make_shared<spins_kripke>(iface, dict, ps, dead, compress);
+    auto res = std::make_shared<spins_kripke>(iface, dict, ps, dead,
+                                              compress, pi);
     // All atomic propositions have been registered to the bdd_dict
     // for iface, but we also need to add them to the automaton so
     // twa::ap() works.
@@ -1129,6 +1785,42 @@ namespace spot
     return res;
   }
 
+  bool
+  ltsmin_model::intersects(const const_twa_graph_ptr& prop,
+                           const formula dead, int compress,
+                           ltsmin_check_stats* stats) const
+  {
+    if (prop->acc().uses_fin_acceptance())
+      throw std::runtime_error("ltsmin_model::intersects() does not "
+                               "support Fin acceptance.");
+
+    atomic_prop_set aps;
+    for (auto ap: prop->ap())
+      aps.insert(ap);
+    auto dict = prop->get_dict();
+    prop_set ps;
+    bool res;
+    try
+      {
+        convert_aps(&aps, iface, dict, &ps, dead, ps);
+        bdd alive_prop;
+        bdd dead_prop;
+        convert_dead(dead, dict, &ps, alive_prop, dead_prop);
+        spins_intersection si(iface, prop, ps, alive_prop, dead_prop,
+                              compress);
+        res = si.check();
+        if (stats)
+          si.stats(*stats);
+      }
+    catch (...)
+      {
+        dict->unregister_all_my_variables(&ps);
+        throw;
+      }
+    dict->unregister_all_my_variables(&ps);
+    return res;
+  }
+
   ltsmin_model::~ltsmin_model()
   {
   }
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2013, 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2011, 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Developpement de l'Epita (LRDE)
 //
 // This file is part of Spot, a model checking library.
@@ -21,11 +21,26 @@
 
 #include <spot/kripke/kripke.hh>
 #include <spot/tl/apcollect.hh>
+#include <spot/twa/fwd.hh>
 
 namespace spot
 {
   struct spins_interface;
 
+  /// \brief Statistics about a call to ltsmin_model::intersects().
+  struct SPOT_API ltsmin_check_stats
+  {
+    /// Number of distinct states of the model that were stored.
+    size_t model_states = 0;
+    /// Number of states of the product that were visited.
+    size_t product_states = 0;
+    /// Number of transitions of the product that were explored.
+    size_t transitions = 0;
+    /// Memory used to store the states of the model and of the
+    /// product, in bytes.
+    size_t memory = 0;
+  };
+
   class SPOT_API ltsmin_model final
   {
   public:
@@ -66,10 +81,44 @@ namespace spot
     // \a compress whether to compress the states.  Use 0 to disable, 1
     // to enable compression, 2 to enable a faster compression that only
     // work if all variables are smaller than 2^28.
+    // \a por whether to apply a partial-order reduction.  The
+    // successors of each state are then restricted to those of a
+    // stubborn set of transition groups, computed from the
+    // dependency matrices of the model.  The reduced Kripke
+    // structure is only equivalent to the original one with respect
+    // to stutter-invariant properties over \a to_observe, so the
+    // caller should check the property with is_stutter_invariant()
+    // first.  An std::runtime_error is thrown if the model does not
+    // provide dependency matrices.
     kripke_ptr kripke(const atomic_prop_set* to_observe,
                       bdd_dict_ptr dict,
                       formula dead = formula::tt(),
-                      int compress = 0) const;
+                      int compress = 0,
+                      bool por = false) const;
+
+    // \brief Check whether the model has a run accepted by \a prop.
+    //
+    // This is equivalent to running an emptiness check on the
+    // product of kripke() with \a prop, but uses much less memory.
+    // The states of the model are kept as int vectors in a
+    // hash table, and referred to by their 32-bit index in that
+    // table.  The product is explored with Couvreur's SCC-based
+    // algorithm directly on pairs of such indices and states of \a
+    // prop, without allocating any spot::state.  No counterexample
+    // is computed.
+    //
+    // \a prop should use a Fin-less acceptance condition, and the
+    // atomic propositions it uses should be conditions on the
+    // variables of the model (as for kripke()).  \a dead and \a
+    // compress have the same meaning as for kripke().  If \a stats
+    // is non-null, it is filled with statistics about the search.
+    //
+    // This function throws std::runtime_error if \a prop cannot be
+    // checked against this model.
+    bool intersects(const const_twa_graph_ptr& prop,
+                    formula dead = formula::tt(),
+                    int compress = 0,
+                    ltsmin_check_stats* stats = nullptr) const;
 
     /// Number of variables in a state
     int state_size() const;
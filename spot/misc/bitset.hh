@@ -0,0 +1,318 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <spot/misc/common.hh>
+
+namespace spot
+{
+  namespace internal
+  {
+    /// \brief A fixed-size set of bits.
+    ///
+    /// This is the storage used by acc_cond::mark_t when Spot is
+    /// configured with more than 32 acceptance sets.  The number of
+    /// words is a compile-time constant, so every loop below has a
+    /// fixed trip count: the compiler unrolls them and uses vector
+    /// instructions for the bitwise operations when NB_WORDS is large
+    /// enough.
+    ///
+    /// Word 0 holds the least significant bits, and comparison
+    /// operators order bitsets as if they were large integers.
+    template<unsigned NB_WORDS>
+    class bitset
+    {
+    public:
+      typedef unsigned word_t;
+
+    private:
+      static_assert(NB_WORDS > 0, "a bitset needs at least one word");
+      static constexpr unsigned wbits = 8 * sizeof(word_t);
+
+      word_t data[NB_WORDS];
+
+      static unsigned popcount(word_t w)
+      {
+#ifdef __GNUC__
+        return __builtin_popcount(w);
+#else
+        unsigned c = 0U;
+        while (w)
+          {
+            ++c;
+            w &= w - 1;
+          }
+        return c;
+#endif
+      }
+
+      // Number of the highest bit set, plus one.  (0 if w == 0.)
+      static unsigned width(word_t w)
+      {
+#ifdef __GNUC__
+        return w ? wbits - __builtin_clz(w) : 0;
+#else
+        unsigned res = 0;
+        while (w)
+          {
+            ++res;
+            w >>= 1;
+          }
+        return res;
+#endif
+      }
+
+    public:
+      bitset() = default;
+
+      /// Construct a bitset whose lowest word is \a low.
+      bitset(word_t low) noexcept
+      {
+        data[0] = low;
+        for (unsigned i = 1; i < NB_WORDS; ++i)
+          data[i] = 0;
+      }
+
+      /// The number of bits that can be stored.
+      static constexpr unsigned size()
+      {
+        return NB_WORDS * wbits;
+      }
+
+      word_t word(unsigned i) const
+      {
+        return data[i];
+      }
+
+      bool operator==(const bitset& o) const
+      {
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          if (data[i] != o.data[i])
+            return false;
+        return true;
+      }
+
+      bool operator!=(const bitset& o) const
+      {
+        return !(*this == o);
+      }
+
+      bool operator<(const bitset& o) const
+      {
+        for (unsigned i = NB_WORDS; i > 0; --i)
+          if (data[i - 1] != o.data[i - 1])
+            return data[i - 1] < o.data[i - 1];
+        return false;
+      }
+
+      bool operator<=(const bitset& o) const
+      {
+        return !(o < *this);
+      }
+
+      bool operator>(const bitset& o) const
+      {
+        return o < *this;
+      }
+
+      bool operator>=(const bitset& o) const
+      {
+        return !(*this < o);
+      }
+
+      explicit operator bool() const
+      {
+        word_t any = 0;
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          any |= data[i];
+        return any;
+      }
+
+      bool has(unsigned b) const
+      {
+        SPOT_ASSERT(b < size());
+        return data[b / wbits] & (1U << (b % wbits));
+      }
+
+      void set(unsigned b)
+      {
+        SPOT_ASSERT(b < size());
+        data[b / wbits] |= 1U << (b % wbits);
+      }
+
+      void clear(unsigned b)
+      {
+        SPOT_ASSERT(b < size());
+        data[b / wbits] &= ~(1U << (b % wbits));
+      }
+
+      bitset& operator&=(const bitset& o)
+      {
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          data[i] &= o.data[i];
+        return *this;
+      }
+
+      bitset& operator|=(const bitset& o)
+      {
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          data[i] |= o.data[i];
+        return *this;
+      }
+
+      bitset& operator^=(const bitset& o)
+      {
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          data[i] ^= o.data[i];
+        return *this;
+      }
+
+      bitset operator&(const bitset& o) const
+      {
+        bitset res = *this;
+        return res &= o;
+      }
+
+      bitset operator|(const bitset& o) const
+      {
+        bitset res = *this;
+        return res |= o;
+      }
+
+      bitset operator^(const bitset& o) const
+      {
+        bitset res = *this;
+        return res ^= o;
+      }
+
+      bitset operator~() const
+      {
+        bitset res;
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          res.data[i] = ~data[i];
+        return res;
+      }
+
+      bitset& operator<<=(unsigned n)
+      {
+        if (n >= size())
+          return *this = bitset(0U);
+        unsigned ws = n / wbits;
+        unsigned bs = n % wbits;
+        for (unsigned i = NB_WORDS; i > ws; --i)
+          {
+            unsigned src = i - 1 - ws;
+            word_t w = data[src] << bs;
+            if (bs && src > 0)
+              w |= data[src - 1] >> (wbits - bs);
+            data[i - 1] = w;
+          }
+        for (unsigned i = 0; i < ws; ++i)
+          data[i] = 0;
+        return *this;
+      }
+
+      bitset& operator>>=(unsigned n)
+      {
+        if (n >= size())
+          return *this = bitset(0U);
+        unsigned ws = n / wbits;
+        unsigned bs = n % wbits;
+        for (unsigned i = 0; i + ws < NB_WORDS; ++i)
+          {
+            unsigned src = i + ws;
+            word_t w = data[src] >> bs;
+            if (bs && src + 1 < NB_WORDS)
+              w |= data[src + 1] << (wbits - bs);
+            data[i] = w;
+          }
+        for (unsigned i = NB_WORDS - ws; i < NB_WORDS; ++i)
+          data[i] = 0;
+        return *this;
+      }
+
+      bitset operator<<(unsigned n) const
+      {
+        bitset res = *this;
+        return res <<= n;
+      }
+
+      bitset operator>>(unsigned n) const
+      {
+        bitset res = *this;
+        return res >>= n;
+      }
+
+      /// Number of bits set.
+      unsigned count() const
+      {
+        unsigned c = 0;
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          c += popcount(data[i]);
+        return c;
+      }
+
+      /// Number of the highest bit set, plus one.
+      unsigned highest() const
+      {
+        for (unsigned i = NB_WORDS; i > 0; --i)
+          if (data[i - 1])
+            return (i - 1) * wbits + width(data[i - 1]);
+        return 0;
+      }
+
+      /// A bitset with only the lowest bit of this one.
+      bitset lowest() const
+      {
+        bitset res(0U);
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          if (data[i])
+            {
+              res.data[i] = data[i] & -data[i];
+              break;
+            }
+        return res;
+      }
+
+      /// Clear the lowest bit set.
+      bitset& clear_lowest()
+      {
+        for (unsigned i = 0; i < NB_WORDS; ++i)
+          if (data[i])
+            {
+              data[i] &= data[i] - 1;
+              break;
+            }
+        return *this;
+      }
+
+      size_t hash() const
+      {
+        std::hash<word_t> h;
+        size_t res = h(data[0]);
+        for (unsigned i = 1; i < NB_WORDS; ++i)
+          res ^= h(data[i]) + 0x9e3779b9 + (res << 6) + (res >> 2);
+        return res;
+      }
+    };
+  }
+}
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013, 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Développement de l'Epita.
 //
 // This file is part of Spot, a model checking library.
@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include <spot/misc/formater.hh>
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 #include <stdexcept>
@@ -31,6 +32,136 @@
 
 namespace spot
 {
+  sat_backend::~sat_backend()
+  {
+  }
+
+  void sat_backend::reserve(int)
+  {
+  }
+
+  namespace
+  {
+    class picosat_backend final: public sat_backend
+    {
+      PicoSAT* psat_;
+
+    public:
+      picosat_backend()
+        : psat_(picosat_init())
+      {
+        picosat_set_seed(psat_, 0);
+      }
+
+      ~picosat_backend()
+      {
+        picosat_reset(psat_);
+      }
+
+      std::string signature() const override
+      {
+        return "picosat";
+      }
+
+      void reserve(int nvars) override
+      {
+        picosat_adjust(psat_, nvars);
+      }
+
+      void add(int lit) override
+      {
+        picosat_add(psat_, lit);
+      }
+
+      void assume(int lit) override
+      {
+        picosat_assume(psat_, lit);
+      }
+
+      int solve() override
+      {
+        // -1: no limit (number of decisions).
+        return picosat_sat(psat_, -1);
+      }
+
+      int val(int var) override
+      {
+        return picosat_deref(psat_, var) > 0 ? var : -var;
+      }
+    };
+
+    class ipasir_backend final: public sat_backend
+    {
+      ipasir_interface ipasir_;
+      void* solver_;
+      // IPASIR solvers need not know the variables that do not
+      // appear in any clause.
+      int maxvar_ = 0;
+
+    public:
+      ipasir_backend(const ipasir_interface& ipasir)
+        : ipasir_(ipasir), solver_(ipasir.init())
+      {
+        if (!solver_)
+          throw std::runtime_error("failed to initialize IPASIR solver");
+      }
+
+      ~ipasir_backend()
+      {
+        ipasir_.release(solver_);
+      }
+
+      std::string signature() const override
+      {
+        return ipasir_.signature();
+      }
+
+      void add(int lit) override
+      {
+        ipasir_.add(solver_, lit);
+        maxvar_ = std::max(maxvar_, std::abs(lit));
+      }
+
+      void assume(int lit) override
+      {
+        ipasir_.assume(solver_, lit);
+        maxvar_ = std::max(maxvar_, std::abs(lit));
+      }
+
+      int solve() override
+      {
+        return ipasir_.solve(solver_);
+      }
+
+      int val(int var) override
+      {
+        if (var > maxvar_)
+          return -var;
+        return ipasir_.val(solver_, var) > 0 ? var : -var;
+      }
+    };
+
+    static sat_backend_factory backend_factory;
+  }
+
+  std::unique_ptr<sat_backend> make_picosat_backend()
+  {
+    return std::unique_ptr<sat_backend>(new picosat_backend);
+  }
+
+  void set_sat_backend(sat_backend_factory factory)
+  {
+    backend_factory = factory;
+  }
+
+  void set_sat_backend(const ipasir_interface& ipasir)
+  {
+    backend_factory = [ipasir]()
+      {
+        return std::unique_ptr<sat_backend>(new ipasir_backend(ipasir));
+      };
+  }
+
   std::vector<int>
   satsolver_get_solution(const char* filename)
   {
@@ -71,10 +202,10 @@ namespace spot
   }
 
   // In other functions, command_given() won't be called anymore as it is more
-  // easy to check if psat_ was initialized or not.
+  // easy to check if backend_ was initialized or not.
   satsolver::satsolver()
     : cnf_tmp_(nullptr), cnf_stream_(nullptr), nclauses_(0), nvars_(0),
-    nassumptions_vars_(0), nsols_(0), psat_(nullptr), xcnf_tmp_(nullptr),
+    nassumptions_vars_(0), nsols_(0), xcnf_tmp_(nullptr),
     xcnf_stream_(nullptr), path_("")
   {
     // Check SPOT_XCNF env var.
@@ -100,19 +231,16 @@ namespace spot
     }
     else
     {
-      psat_ = picosat_init();
-      picosat_set_seed(psat_, 0);
+      if (backend_factory)
+        backend_ = backend_factory();
+      if (!backend_)
+        backend_ = make_picosat_backend();
     }
   }
 
   satsolver::~satsolver()
   {
-    if (psat_)
-    {
-      picosat_reset(psat_);
-      psat_ = nullptr;
-    }
-    else
+    if (!backend_)
     {
       delete cnf_tmp_;
       delete cnf_stream_;
@@ -153,14 +281,15 @@ namespace spot
     }
   }
 
-  // Must be called only when SPOT_SATSOLVER is given
   void satsolver::end_clause()
   {
-    *cnf_stream_ << '\n';
     nclauses_ += 1;
     if (nclauses_ < 0)
       throw std::runtime_error(": too many SAT clauses (more than INT_MAX).");
+    if (backend_)
+      return;
 
+    *cnf_stream_ << '\n';
     if (xcnf_mode())
       *xcnf_tmp_ << '\n';
   }
@@ -170,9 +299,10 @@ namespace spot
     if (nvars < 0)
       throw std::runtime_error("variable number must be at least 0");
 
-    if (psat_)
+    if (backend_)
     {
-      picosat_adjust(psat_, nvars + nassumptions_vars_);
+      backend_->reserve(nvars + nassumptions_vars_);
+      nvars_ = std::max(nvars_, nvars + nassumptions_vars_);
     }
     else
     {
@@ -194,31 +324,14 @@ namespace spot
   void satsolver::add(std::initializer_list<int> values)
   {
     for (auto& v : values)
-    {
-      if (psat_)
-      {
-        picosat_add(psat_, v);
-      }
-      else
-      {
-        if (xcnf_mode())
-          *xcnf_tmp_ << v << ' ';
-
-        *cnf_stream_ << v << ' ';
-        if (!v) // ..., 0)
-          end_clause();
-
-        if (nvars_ < v)
-          nvars_ = v;
-      }
-    }
+      add(v);
   }
 
   void satsolver::add(int v)
   {
-    if (psat_)
+    if (backend_)
     {
-      picosat_add(psat_, v);
+      backend_->add(v);
     }
     else
     {
@@ -226,25 +339,21 @@ namespace spot
         *xcnf_tmp_ << v << ' ';
 
       *cnf_stream_ << v << ' ';
-      if (!v) // 0
-        end_clause();
-
-      if (v && nvars_ < v)
-        nvars_ = v;
     }
+
+    if (!v) // 0
+      end_clause();
+    else if (nvars_ < std::abs(v))
+      nvars_ = std::abs(v);
   }
 
   int satsolver::get_nb_clauses() const
   {
-    if (psat_)
-      return picosat_added_original_clauses(psat_);
     return nclauses_;
   }
 
   int satsolver::get_nb_vars() const
   {
-    if (psat_)
-      return picosat_variables(psat_);
     return nvars_;
   }
 
@@ -255,13 +364,20 @@ namespace spot
 
   void satsolver::assume(int lit)
   {
-    if (psat_)
-      picosat_assume(psat_, lit);
+    if (backend_)
+      backend_->assume(lit);
     else
       throw std::runtime_error(
           "satsolver::assume(...) can not be used with an external satsolver");
   }
 
+  std::string satsolver::signature() const
+  {
+    if (backend_)
+      return backend_->signature();
+    return cmd_.command();
+  }
+
   satsolver::solution
   spot::satsolver::satsolver_get_sol(const char* filename)
   {
@@ -311,12 +427,12 @@ namespace spot
   }
 
   satsolver::solution
-  satsolver::picosat_get_sol(int res)
+  satsolver::backend_get_sol(int res)
   {
     satsolver::solution sol;
-    if (res == PICOSAT_SATISFIABLE)
+    if (res == 10) // Satisfiable.
       for (int lit = 1; lit <= nsols_; ++lit)
-        sol.push_back(picosat_deref(psat_, lit) > 0);
+        sol.push_back(backend_->val(lit) > 0);
     return sol;
   }
 
@@ -324,11 +440,10 @@ namespace spot
   satsolver::get_solution()
   {
     solution_pair p;
-    if (psat_)
+    if (backend_)
     {
       p.first = 0; // A subprocess was not executed so nothing failed.
-      int res = picosat_sat(psat_, -1); // -1: no limit (number of decisions).
-      p.second = picosat_get_sol(res);
+      p.second = backend_get_sol(backend_->solve());
     }
     else
     {
@@ -392,6 +507,12 @@ namespace spot
     return satsolver != nullptr;
   }
 
+  std::string
+  satsolver_command::command() const
+  {
+    return satsolver ? satsolver : "";
+  }
+
   int
   satsolver_command::run(printable* in, printable* out)
   {
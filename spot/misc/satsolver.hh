@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013 Laboratoire de Recherche et Développement
+// Copyright (C) 2013, 2017 Laboratoire de Recherche et Développement
 // de l'Epita.
 //
 // This file is part of Spot, a model checking library.
@@ -25,13 +25,99 @@
 #include <stdexcept>
 #include <iosfwd>
 #include <initializer_list>
-
-struct PicoSAT; // forward
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <string>
 
 namespace spot
 {
   class printable;
 
+  /// \brief Interface with an incremental SAT solver running in the
+  /// same process.
+  ///
+  /// This follows the IPASIR interface of the incremental track of
+  /// the SAT competitions: clauses are given literal by literal,
+  /// each clause being terminated by 0, and literals can be assumed
+  /// for the next call to solve() only.  The clauses, as well as
+  /// those learned by the solver, are kept from one call to solve()
+  /// to the next, and more clauses may be added between calls.
+  ///
+  /// Spot uses the PicoSAT library it is distributed with through
+  /// this interface, unless another solver is installed with
+  /// set_sat_backend().
+  class SPOT_API sat_backend
+  {
+  public:
+    virtual ~sat_backend();
+
+    /// \brief Name and version of the solver.
+    virtual std::string signature() const = 0;
+
+    /// \brief Declare that variables up to \a nvars will be used.
+    ///
+    /// This is only a hint, that does nothing by default.
+    virtual void reserve(int nvars);
+
+    /// \brief Add \a lit to the current clause, or terminate this
+    /// clause if \a lit is 0.
+    virtual void add(int lit) = 0;
+
+    /// \brief Assume \a lit during the next call to solve().
+    virtual void assume(int lit) = 0;
+
+    /// \brief Solve the clauses added so far under the current
+    /// assumptions, and forget these assumptions.
+    ///
+    /// Return 10 if the problem is satisfiable, 20 if it is not, or 0
+    /// if the solver gave up.
+    virtual int solve() = 0;
+
+    /// \brief After solve() has returned 10, return \a var if this
+    /// variable is true in the model, or -\a var otherwise.
+    virtual int val(int var) = 0;
+  };
+
+  /// \brief The functions of an IPASIR solver.
+  ///
+  /// A solver that implements IPASIR can be linked with a program,
+  /// and used by Spot after
+  /// \code
+  /// spot::set_sat_backend(spot::ipasir_interface{
+  ///   ipasir_signature, ipasir_init, ipasir_release, ipasir_add,
+  ///   ipasir_assume, ipasir_solve, ipasir_val});
+  /// \endcode
+  struct SPOT_API ipasir_interface
+  {
+    const char* (*signature)();
+    void* (*init)();
+    void (*release)(void*);
+    void (*add)(void*, int32_t);
+    void (*assume)(void*, int32_t);
+    int (*solve)(void*);
+    int32_t (*val)(void*, int32_t);
+  };
+
+  /// \brief Create an instance of the PicoSAT library distributed
+  /// with Spot.
+  SPOT_API std::unique_ptr<sat_backend> make_picosat_backend();
+
+  typedef std::function<std::unique_ptr<sat_backend>()> sat_backend_factory;
+
+  /// \brief Change the solver used by the satsolver instances created
+  /// afterwards.
+  ///
+  /// \a factory is called each time a solver is needed.  An empty
+  /// \a factory (or one that returns nullptr) restores the default
+  /// use of PicoSAT.  In any case, <code>SPOT_SATSOLVER</code> takes
+  /// precedence if it is set.
+  SPOT_API void set_sat_backend(sat_backend_factory factory);
+
+  /// \brief Use the IPASIR solver \a ipasir in the satsolver
+  /// instances created afterwards.
+  SPOT_API void set_sat_backend(const ipasir_interface& ipasir);
+
   /// \brief Interface with a given sat solver.
   ///
   /// When created, it checks if SPOT_SATSOLVER env var is set. If so,
@@ -51,6 +137,9 @@ namespace spot
     /// \brief Return true if a satsolver is given, false otherwise.
     bool command_given();
 
+    /// \brief The command given, or an empty string.
+    std::string command() const;
+
     /// \brief Run the given satsolver.
     int run(printable* in, printable* out);
 
@@ -59,14 +148,20 @@ namespace spot
   /// \brief Interface with a SAT solver.
   ///
   /// This class provides the necessary functions to add clauses, comments.
-  /// Depending on SPOT_SATSOLVER, it will use either picosat solver (default)
-  /// or the given satsolver.
+  /// Depending on SPOT_SATSOLVER, it will use either an in-process solver
+  /// (PicoSAT by default, see set_sat_backend()) or the given satsolver.
   ///
   /// Now that spot is distributed with a satsolver (PicoSAT), it is used by
   /// default. But another satsolver can be configured via the
   /// <code>SPOT_SATSOLVER</code> environment variable. It must be set following
   /// this: "satsolver [options] %I > %O"
   /// where %I and %O are replaced by input and output files.
+  ///
+  /// Clauses are streamed directly to an in-process solver, which can
+  /// be called several times, with different assumptions, while
+  /// keeping what it has learned.  An external solver is given a
+  /// temporary file containing all the clauses at each call, and does
+  /// not support assumptions.
   class SPOT_API satsolver
   {
   public:
@@ -118,9 +213,12 @@ namespace spot
     void comment(T first, Args... args);
 
     /// \brief Assume a litteral value.
-    /// Must only be used with distributed picolib.
+    /// Must only be used with an in-process solver.
     void assume(int lit);
 
+    /// \brief Name of the solver used.
+    std::string signature() const;
+
     typedef std::vector<bool> solution;
     typedef std::pair<int, solution> solution_pair;
 
@@ -134,10 +232,10 @@ namespace spot
     /// \brief End the current clause and increment the counter.
     void end_clause();
 
-    /// \brief Extract the solution of Picosat output.
+    /// \brief Extract the solution of an in-process solver.
     /// Must be called only if SPOT_SATSOLVER env variable is not set.
     satsolver::solution
-    picosat_get_sol(int res);
+    backend_get_sol(int res);
 
     /// \brief Extract the solution of a SAT solver output.
     satsolver::solution
@@ -163,8 +261,8 @@ namespace spot
     /// (without assuming litterals).
     int nsols_;
 
-    /// \brief Picosat satsolver instance.
-    PicoSAT* psat_;
+    /// \brief In-process solver, if SPOT_SATSOLVER is not given.
+    std::unique_ptr<sat_backend> backend_;
 
     // The next 2 pointers will be initialized if SPOT_XCNF env var
     // is set. This recquires SPOT_SATSOLVER to be set as well.
@@ -184,7 +282,7 @@ namespace spot
   void
   satsolver::comment_rec(T single)
   {
-    if (!psat_)
+    if (!backend_)
       *cnf_stream_ << ' ' << single;
   }
 
@@ -192,7 +290,7 @@ namespace spot
   void
   satsolver::comment_rec(T first, Args... args)
   {
-    if (!psat_)
+    if (!backend_)
     {
       *cnf_stream_ << ' ' << first;
       comment_rec(args...);
@@ -203,7 +301,7 @@ namespace spot
   void
   satsolver::comment(T single)
   {
-    if (!psat_)
+    if (!backend_)
       *cnf_stream_ << "c " << single;
   }
 
@@ -211,7 +309,7 @@ namespace spot
   void
   satsolver::comment(T first, Args... args)
   {
-    if (!psat_)
+    if (!backend_)
     {
       *cnf_stream_ << "c " << first;
       comment_rec(args...);
@@ -41,6 +41,7 @@
 #include "spot/priv/accmap.hh"
 #include <spot/tl/parse.hh>
 #include <spot/twaalgos/alternation.hh>
+#include <spot/twaalgos/binary.hh>
 
 #ifndef HAVE_STRVERSCMP
 // If the libc does not have this, a version is compiled in lib/.
@@ -60,7 +61,7 @@ extern "C" int strverscmp(const char *s1, const char *s2);
        over and over, and to register all their atomic_propositions in
        the bdd_dict.  Keep the bdd result around so we can reuse
        it.  */
-    typedef std::map<std::string, bdd> formula_cache;
+    typedef std::unordered_map<std::string, bdd> formula_cache;
 
     typedef std::pair<int, std::string*> pair;
     typedef spot::twa_graph::namer<std::string> named_tgba_t;
@@ -89,6 +90,8 @@ extern "C" int strverscmp(const char *s1, const char *s2);
       spot::location format_version_loc;
       spot::environment* env;
       formula_cache fcache;
+      // Same for the HOA labels read as a single LABEL token.
+      std::unordered_map<std::string, bdd> label_cache;
       named_tgba_t* namer = nullptr;
       spot::acc_mapper_int* acc_mapper = nullptr;
       std::vector<int> ap;
@@ -121,6 +124,11 @@ extern "C" int strverscmp(const char *s1, const char *s2);
       std::vector<std::string>* state_names = nullptr;
       std::map<unsigned, unsigned>* highlight_edges = nullptr;
       std::map<unsigned, unsigned>* highlight_states = nullptr;
+      // LBTT state numbers smaller than the number of declared
+      // states are used as is, and marked in states_seen.  Larger
+      // numbers are mapped to new states in states_map.
+      std::vector<bool> states_seen;
+      unsigned states_seen_count = 0;
       std::map<unsigned, unsigned> states_map;
       std::set<int> ap_set;
       unsigned cur_state;
@@ -151,6 +159,23 @@ extern "C" int strverscmp(const char *s1, const char *s2);
 
       std::map<std::string, spot::location> labels;
 
+      unsigned lbtt_state(unsigned n)
+      {
+	if (n < (unsigned) states)
+	  {
+	    if (!states_seen[n])
+	      {
+		states_seen[n] = true;
+		++states_seen_count;
+	      }
+	    return n;
+	  }
+	auto p = states_map.emplace(n, 0);
+	if (p.second)
+	  p.first->second = h->aut->new_state();
+	return p.first->second;
+      }
+
       prop_info prop_is_true(const std::string& p)
       {
 	auto i = props.find(p);
@@ -196,6 +221,7 @@ extern "C" int strverscmp(const char *s1, const char *s2);
 %code
 {
 #include <sstream>
+#include <sys/stat.h>
 
   /* parseaut.hh and parsedecl.hh include each other recursively.
    We must ensure that YYSTYPE is declared (by the above %union)
@@ -203,6 +229,8 @@ extern "C" int strverscmp(const char *s1, const char *s2);
 #include <spot/parseaut/parsedecl.hh>
 
   static void fill_guards(result_& res);
+  static bdd label_to_bdd(const result_& res, const std::string& label,
+			  std::vector<std::pair<unsigned, unsigned>>& bad);
 }
 
 /**** HOA tokens ****/
@@ -226,6 +254,7 @@ extern "C" int strverscmp(const char *s1, const char *s2);
 %token <str> ANAME "alias name";
 %token <str> STRING "string";
 %token <num> INT "integer";
+%token <str> LABEL "label";
 %token ENDOFFILE 0 "end of file"
 
 %token DRA "DRA"
@@ -693,7 +722,7 @@ header-item: "States:" INT
 			  "acceptance condition...");
 		    error(res.accset_loc, "... previously defined here.");
 		  }
-		else if ($2 > 8 * sizeof(spot::acc_cond::mark_t::value_t))
+		else if ($2 > spot::acc_cond::mark_t::max_accsets())
 		  {
 		    error(@1 + @2,
 			  "this implementation cannot support such a large "
@@ -1199,6 +1228,35 @@ label: '[' label-expr ']'
              res.cur_label = bdd_from_int($2);
              bdd_delref($2);
 	   }
+     | LABEL
+           {
+	     auto i = res.label_cache.find(*$1);
+	     if (i != res.label_cache.end())
+	       {
+		 res.cur_label = i->second;
+	       }
+	     else
+	       {
+		 std::vector<std::pair<unsigned, unsigned>> bad;
+		 res.cur_label = label_to_bdd(res, *$1, bad);
+		 // Report the errors of the '[' label-expr ']' rule,
+		 // and do not cache the label so that they are
+		 // reported again on the next occurrence.
+		 for (auto& b: bad)
+		   {
+		     spot::location here = @1;
+		     here.begin.column += b.first;
+		     here.end = here.begin;
+		     here.end.column += b.second;
+		     error(here,
+			   "AP number is larger than the number of APs...");
+		     error(res.ap_loc, "... declared here");
+		   }
+		 if (bad.empty())
+		   res.label_cache.emplace(std::move(*$1), res.cur_label);
+	       }
+	     delete $1;
+	   }
      | '[' error ']'
            {
 	     error(@$, "ignoring this invalid label");
@@ -1857,8 +1915,8 @@ lbtt: lbtt-header lbtt-body ENDAUT
 	unsigned num = acc.num_sets();
 	res.h->aut->set_generalized_buchi(num);
 	res.pos_acc_sets = acc.all_sets();
-	assert(!res.states_map.empty());
-	auto n = res.states_map.size();
+	auto n = res.states_seen_count + res.states_map.size();
+	assert(n > 0);
 	if (n != (unsigned) res.states)
 	  {
 	    std::ostringstream err;
@@ -1866,7 +1924,7 @@ lbtt: lbtt-header lbtt-body ENDAUT
 		<< n << " different state numbers have been used";
 	    error(@$, err.str());
 	  }
-	if (res.states_map.rbegin()->first > (unsigned) res.states)
+	if (!res.states_map.empty())
 	  {
 	    // We have seen numbers larger that the total number of
 	    // states in the automaton.  Usually this happens when the
@@ -1880,6 +1938,9 @@ lbtt: lbtt-header lbtt-body ENDAUT
 	    // states we allocated.
 	    std::vector<unsigned> rename(res.h->aut->num_states(), -1U);
 	    unsigned s = 0;
+	    for (unsigned i = 0; i < (unsigned) res.states; ++i)
+	      if (res.states_seen[i])
+		rename[i] = s++;
 	    for (auto& i: res.states_map)
 	      rename[i.second] = s++;
 	    assert(s == (unsigned) res.states);
@@ -1909,6 +1970,7 @@ lbtt-header-states: LBTT
 		      }
 		    res.states = $1;
 		    res.states_loc = @1;
+		    res.states_seen.resize($1);
 		    res.h->aut->new_states($1);
 		  }
 lbtt-header: lbtt-header-states INT_S
@@ -1927,18 +1989,7 @@ lbtt-states:
 
 lbtt-state: STATE_NUM INT lbtt-acc
           {
-	    if ($1 >= (unsigned) res.states)
-	      {
-		auto p = res.states_map.emplace($1, 0);
-		if (p.second)
-		  p.first->second = res.h->aut->new_state();
-		res.cur_state = p.first->second;
-	      }
-	    else
-	      {
-		res.states_map.emplace($1, $1);
-		res.cur_state = $1;
-	      }
+	    res.cur_state = res.lbtt_state($1);
 	    if ($2)
 	      res.start.emplace_back(@1 + @2,
                                      std::vector<unsigned>{res.cur_state});
@@ -1956,31 +2007,36 @@ lbtt-acc:               { $$ = 0U; }
 	}
 lbtt-guard: STRING
           {
-	    auto pf = spot::parse_prefix_ltl(*$1, *res.env);
-	    if (!pf.f || !pf.errors.empty())
+	    auto i = res.fcache.find(*$1);
+	    if (i != res.fcache.end())
 	      {
-		std::string s = "failed to parse guard: ";
-		s += *$1;
-		error(@$, s);
-	      }
-	    if (!pf.errors.empty())
-	      for (auto& j: pf.errors)
-		{
-		  // Adjust the diagnostic to the current position.
-		  spot::location here = @1;
-		  here.end.line = here.begin.line + j.first.end.line - 1;
-		  here.end.column = here.begin.column + j.first.end.column - 1;
-		  here.begin.line += j.first.begin.line - 1;
-		  here.begin.column += j.first.begin.column - 1;
-		  res.h->errors.emplace_back(here, j.second);
-		}
-	    if (!pf.f)
-	      {
-		res.cur_label = bddtrue;
+		res.cur_label = i->second;
 	      }
 	    else
 	      {
-		if (!pf.f.is_boolean())
+		auto pf = spot::parse_prefix_ltl(*$1, *res.env);
+		if (!pf.f || !pf.errors.empty())
+		  {
+		    std::string s = "failed to parse guard: ";
+		    s += *$1;
+		    error(@$, s);
+		  }
+		for (auto& j: pf.errors)
+		  {
+		    // Adjust the diagnostic to the current position.
+		    spot::location here = @1;
+		    here.end.line = here.begin.line + j.first.end.line - 1;
+		    here.end.column =
+		      here.begin.column + j.first.end.column - 1;
+		    here.begin.line += j.first.begin.line - 1;
+		    here.begin.column += j.first.begin.column - 1;
+		    res.h->errors.emplace_back(here, j.second);
+		  }
+		if (!pf.f)
+		  {
+		    res.cur_label = bddtrue;
+		  }
+		else if (!pf.f.is_boolean())
 		  {
 		    error(@$,
 			  "non-Boolean transition label (replaced by true)");
@@ -1988,8 +2044,13 @@ lbtt-guard: STRING
 		  }
 		else
 		  {
-		    res.cur_label =
-		      formula_to_bdd(pf.f, res.h->aut->get_dict(), res.h->aut);
+		    res.cur_label = formula_to_bdd(pf.f,
+						   res.h->aut->get_dict(),
+						   res.h->aut);
+		    // Guards that produced diagnostics are not cached,
+		    // so that these are reported at each occurrence.
+		    if (pf.errors.empty())
+		      res.fcache.emplace(*$1, res.cur_label);
 		  }
 	      }
 	    delete $1;
@@ -1997,18 +2058,7 @@ lbtt-guard: STRING
 lbtt-transitions:
                 | lbtt-transitions DEST_NUM lbtt-acc lbtt-guard
                 {
-		  unsigned dst = $2;
-		  if (dst >= (unsigned) res.states)
-		    {
-		      auto p = res.states_map.emplace(dst, 0);
-		      if (p.second)
-			p.first->second = res.h->aut->new_state();
-		      dst = p.first->second;
-		    }
-		  else
-		    {
-		      res.states_map.emplace(dst, dst);
-		    }
+		  unsigned dst = res.lbtt_state($2);
 		  res.h->aut->new_edge(res.cur_state, dst,
 				       res.cur_label,
 				       res.acc_state | $3);
@@ -2016,6 +2066,77 @@ lbtt-transitions:
 
 %%
 
+// Compile a label read as a LABEL token, i.e., a disjunction of
+// conjunctions of "t", "f", or possibly negated AP numbers, with
+// optional spaces.  This gives the same result as the label-expr
+// rules.  The offset and length of each AP number that is too large
+// is appended to BAD.
+static bdd label_to_bdd(const result_& r, const std::string& label,
+			std::vector<std::pair<unsigned, unsigned>>& bad)
+{
+  const char* b = label.c_str();
+  const char* s = b + 1;	// Skip '['.
+  bdd res = bddfalse;
+  bdd conj = bddtrue;
+  for (;;)
+    {
+      while (*s == ' ' || *s == '\t')
+	++s;
+      bool neg = false;
+      if (*s == '!')
+	{
+	  neg = true;
+	  ++s;
+	  while (*s == ' ' || *s == '\t')
+	    ++s;
+	}
+      bdd lit;
+      if (*s == 't')
+	{
+	  lit = bddtrue;
+	  ++s;
+	}
+      else if (*s == 'f')
+	{
+	  lit = bddfalse;
+	  ++s;
+	}
+      else
+	{
+	  const char* start = s;
+	  unsigned n = 0;
+	  while (*s >= '0' && *s <= '9')
+	    n = n * 10 + (*s++ - '0');
+	  if (n >= r.ap.size())
+	    {
+	      bad.emplace_back(start - b, s - start);
+	      lit = bddtrue;
+	    }
+	  else
+	    {
+	      lit = bdd_ithvar(r.ap[n]);
+	    }
+	}
+      if (neg)
+	lit = !lit;
+      conj &= lit;
+      while (*s == ' ' || *s == '\t')
+	++s;
+      if (*s == '&')
+	{
+	  ++s;
+	  continue;
+	}
+      res |= conj;
+      if (*s != '|')
+	break;
+      ++s;
+      conj = bddtrue;
+    }
+  assert(*s == ']');
+  return res;
+}
+
 static void fill_guards(result_& r)
 {
   unsigned nap = r.ap.size();
@@ -2338,12 +2459,52 @@ static void check_version(const result_& r)
 
 namespace spot
 {
+  // Whether \a name is a regular file that starts like an automaton
+  // output by print_binary().  Other files are not even opened, as
+  // reading from a pipe would consume its input, and opening a fifo
+  // would wake up its writer.
+  static bool is_binary_file(const std::string& name)
+  {
+    struct stat s;
+    if (name == "-" || stat(name.c_str(), &s) < 0 || !S_ISREG(s.st_mode))
+      return false;
+    FILE* f = fopen(name.c_str(), "r");
+    if (!f)
+      return false;
+    char buf[8];
+    size_t n = fread(buf, 1, sizeof buf, f);
+    fclose(f);
+    return is_binary_automaton(buf, n);
+  }
+
   automaton_stream_parser::automaton_stream_parser(const std::string& name,
 						   automaton_parser_options opt)
     : filename_(name), opts_(opt)
   {
+    if (is_binary_file(name))
+      {
+	bin_.reset(new binary_aut_reader(name));
+	return;
+      }
     if (hoayyopen(name))
       throw std::runtime_error(std::string("Cannot open file ") + name);
+    // Standard input and pipes are read by the scanner through
+    // stdio, so their format is checked on their first byte, which
+    // is then pushed back.  Binary input is then read from the same
+    // stream, one automaton at a time.
+    if (FILE* f = hoayyfile())
+      {
+	int c = getc(f);
+	if (c == EOF)
+	  return;
+	ungetc(c, f);
+	if (c != 0x89)
+	  return;
+	bool close;
+	f = hoayydetach(close);
+	bin_.reset(new binary_aut_reader(f, name == "-" ?
+					 "standard input" : name, close));
+      }
   }
 
   automaton_stream_parser::automaton_stream_parser(int fd,
@@ -2365,7 +2526,8 @@ namespace spot
 
   automaton_stream_parser::~automaton_stream_parser()
   {
-    hoayyclose();
+    if (!bin_)
+      hoayyclose();
   }
 
   static void raise_parse_error(const parsed_aut_ptr& pa)
@@ -2386,6 +2548,26 @@ namespace spot
   automaton_stream_parser::parse(const bdd_dict_ptr& dict,
 				 environment& env)
   {
+    if (bin_)
+      {
+	auto h = std::make_shared<spot::parsed_aut>(filename_);
+	h->type = parsed_aut_type::Binary;
+	if (opts_.want_kripke)
+	  h->errors.emplace_back(last_loc, "cannot read a Kripke structure "
+				 "from an automaton in binary format");
+	else
+	  try
+	    {
+	      h->aut = bin_->next(dict);
+	    }
+	  catch (const std::runtime_error& e)
+	    {
+	      h->errors.emplace_back(last_loc, e.what());
+	    }
+	if (opts_.raise_errors)
+	  raise_parse_error(h);
+	return h;
+      }
   restart:
     result_ r;
     r.opts = opts_;
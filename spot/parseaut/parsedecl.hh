@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2014, 2015 Laboratoire de Recherche et Développement
+// Copyright (C) 2014, 2015, 2017 Laboratoire de Recherche et Développement
 // de l'EPITA.
 //
 // This file is part of Spot, a model checking library.
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstdio>
 #include <string>
 #include <spot/parseaut/parseaut.hh>
 #include <spot/misc/location.hh>
@@ -35,6 +36,8 @@ namespace spot
   int hoayyopen(const std::string& name);
   int hoayyopen(int fd);
   int hoayystring(const char* data);
+  FILE* hoayyfile();
+  FILE* hoayydetach(bool& close);
   void hoayyclose();
 
   // This exception is thrown by the lexer when it reads "--ABORT--".
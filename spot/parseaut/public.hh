@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013, 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <spot/twa/twagraph.hh>
+#include <spot/twaalgos/binary.hh>
 #include <spot/kripke/kripkegraph.hh>
 #include <spot/misc/location.hh>
 #include <spot/tl/defaultenv.hh>
@@ -27,6 +28,7 @@
 #include <list>
 #include <utility>
 #include <iosfwd>
+#include <memory>
 #include <spot/misc/bitvect.hh>
 
 namespace spot
@@ -44,7 +46,8 @@ namespace spot
   struct parse_aut_error_list {};
 #endif
 
-  enum class parsed_aut_type { HOA, NeverClaim, LBTT, DRA, DSA, Unknown };
+  enum class parsed_aut_type { HOA, NeverClaim, LBTT, DRA, DSA, Binary,
+                               Unknown };
 
   /// \brief Result of the automaton parser
   struct SPOT_API parsed_aut final
@@ -122,9 +125,14 @@ namespace spot
     spot::location last_loc;
     std::string filename_;
     automaton_parser_options opts_;
+    std::unique_ptr<binary_aut_reader> bin_;
   public:
     /// \brief Parse from a file.
     ///
+    /// Files (or standard input if \a filename is "-") that start
+    /// with an automaton output by print_binary() are read with
+    /// binary_aut_reader instead of the parser.
+    ///
     /// \param filename The file to read from.
     /// \param opts Parser options.
     automaton_stream_parser(const std::string& filename,
@@ -1,6 +1,6 @@
 /* -*- coding: utf-8 -*-
-** Copyright (C) 2014, 2015, 2016 Laboratoire de Recherche et Développement
-** de l'Epita (LRDE).
+** Copyright (C) 2014, 2015, 2016, 2017 Laboratoire de Recherche et
+** Développement de l'Epita (LRDE).
 **
 ** This file is part of Spot, a model checking library.
 **
@@ -25,6 +25,9 @@
 %{
 #include <string>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <spot/parseaut/parsedecl.hh>
 #include "spot/priv/trim.hh"
 
@@ -39,6 +42,13 @@ static bool lbtt_s = false;
 static bool lbtt_t = false;
 static unsigned lbtt_states = 0;
 static bool yyin_close = true;
+// When reading a regular file, the file is mapped in memory and
+// scanned in place.
+static YY_BUFFER_STATE map_buf = nullptr;
+static char* map_base = nullptr;
+static size_t map_len = 0;
+static char* map_dropped = nullptr;
+static void map_drop_consumed(const char* pos);
 
 %}
 
@@ -46,6 +56,8 @@ eol         \n+|\r+
 eol2        (\n\r)+|(\r\n)+
 eols        ({eol}|{eol2})*
 identifier  [[:alpha:]_][[:alnum:]_.-]*
+blank       [ \t]
+literal     ("!"{blank}*)?([0-9]{1,9}|t|f)
 
 %x in_COMMENT in_STRING in_NEVER_PAR
 %s in_HOA in_NEVER in_LBTT_HEADER
@@ -122,8 +134,20 @@ identifier  [[:alpha:]_][[:alnum:]_.-]*
   "spot.highlight.states:" return token::SPOT_HIGHLIGHT_STATES;
   "spot.highlight.edges:"  return token::SPOT_HIGHLIGHT_EDGES;
   "--BODY--"		return token::BODY;
-  "--END--"		BEGIN(INITIAL); return token::END;
+  "--END--"		{
+			  BEGIN(INITIAL);
+			  map_drop_consumed(yytext);
+			  return token::END;
+			}
   "State:"		return token::STATE;
+  /* Labels made only of AP numbers, t, f, !, &, and | are by far the
+     most frequent ones.  Return them as a single token, so that the
+     parser can compile them at once, and cache the result.  Other
+     labels are returned token by token. */
+  "["{blank}*{literal}({blank}*[&|]{blank}*{literal})*{blank}*"]" {
+			   yylval->str = new std::string(yytext, yyleng);
+			   return token::LABEL;
+			}
   [tf{}()\[\]&|!]	return *yytext;
 
   {identifier}          {
@@ -384,6 +408,87 @@ identifier  [[:alpha:]_][[:alnum:]_.-]*
 
 %%
 
+// Map the regular file NAME in memory, followed by the two NUL
+// bytes that flex expects at the end of a buffer.  The mapping is
+// private and writable because flex temporarily modifies the
+// buffer while scanning it.  Return false if the file cannot be
+// mapped, so that it is read using stdio instead.
+static bool
+map_file(const std::string& name)
+{
+  int fd = open(name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat s;
+  if (fstat(fd, &s) < 0 || !S_ISREG(s.st_mode) || s.st_size == 0)
+    {
+      close(fd);
+      return false;
+    }
+  size_t size = s.st_size;
+  size_t len = size + 2;
+  // Reserve enough (zeroed) memory for the file and the two NUL
+  // bytes, then map the file at the start of this area.
+  void* base = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    {
+      close(fd);
+      return false;
+    }
+  void* f = mmap(base, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_FIXED, fd, 0);
+  close(fd);
+  if (f == MAP_FAILED)
+    {
+      munmap(base, len);
+      return false;
+    }
+#ifdef MADV_SEQUENTIAL
+  madvise(base, size, MADV_SEQUENTIAL);
+#endif
+  map_base = map_dropped = static_cast<char*>(base);
+  map_len = len;
+  // yy_scan_buffer() makes the new buffer current without freeing
+  // the buffer of a previous file.
+  yy_delete_buffer(YY_CURRENT_BUFFER);
+  map_buf = yy_scan_buffer(map_base, len);
+  return true;
+}
+
+static void
+map_drop_consumed(const char* pos)
+{
+#ifdef MADV_DONTNEED
+  // When reading large streams of automata, give back the pages
+  // that have been scanned (and modified) to the system.
+  // Otherwise the entire file would eventually be copied in
+  // memory.
+  static const size_t chunk = 1 << 24;
+  if (!map_buf || YY_CURRENT_BUFFER != map_buf
+      || (size_t)(pos - map_dropped) < 2 * chunk)
+    return;
+  static const size_t page = sysconf(_SC_PAGESIZE);
+  size_t n = (pos - map_dropped - chunk) / page * page;
+  madvise(map_dropped, n, MADV_DONTNEED);
+  map_dropped += n;
+#else
+  (void) pos;
+#endif
+}
+
+static void
+unmap_file()
+{
+  if (!map_base)
+    return;
+  yy_delete_buffer(map_buf);
+  munmap(map_base, map_len);
+  map_buf = nullptr;
+  map_base = map_dropped = nullptr;
+  map_len = 0;
+}
+
 namespace spot
 {
   void
@@ -414,6 +519,13 @@ namespace spot
         yyin = stdin;
         yyin_close = false;
       }
+    else if (map_file(name))
+      {
+        yyin = nullptr;
+        yyin_close = false;
+        hoayyreset();
+        return 0;
+      }
     else
       {
         yyin = fopen(name.c_str(), "r");
@@ -467,9 +579,30 @@ namespace spot
     return 0;
   }
 
+  // The stream opened by hoayyopen(), or nullptr if the file has
+  // been mapped.
+  FILE*
+  hoayyfile()
+  {
+    return map_base ? nullptr : yyin;
+  }
+
+  // Give the stream returned by hoayyfile() to the caller, who
+  // should close it if \a close is set.  The scanner is then closed.
+  FILE*
+  hoayydetach(bool& close)
+  {
+    FILE* f = yyin;
+    close = yyin_close;
+    yyin = nullptr;
+    yyin_close = false;
+    return f;
+  }
+
   void
   hoayyclose()
   {
+    unmap_file();
     if (yyin)
       {
         if (yyin_close)
@@ -28,6 +28,11 @@
 #include <algorithm>
 #include <spot/misc/bareword.hh>
 #include <spot/tl/print.hh>
+#if SPOT_CONCURRENT_FORMULAS
+#include <mutex>
+#include <unordered_set>
+#include <spot/misc/hashfunc.hh>
+#endif
 
 #ifndef HAVE_STRVERSCMP
 // If the libc does not have this, a version is compiled in lib/.
@@ -86,12 +91,91 @@ namespace spot
       }
     };
 
+#if SPOT_CONCURRENT_FORMULAS
+    // Hash a formula by looking at its operator and children, for
+    // the same purpose as formula_cmp.
+    struct formula_hash
+    {
+      size_t operator()(const fnode* f) const
+      {
+        size_t h = static_cast<size_t>(f->kind());
+        if (SPOT_UNLIKELY(f->is(op::Star) || f->is(op::FStar)))
+          h ^= (f->min() << 8 | f->max()) << 8;
+        for (auto c: *f)
+          h = wang32_hash(h ^ c->id());
+        return h;
+      }
+    };
+
+    struct formula_eq
+    {
+      bool operator()(const fnode* l, const fnode* r) const
+      {
+        if (l->kind() != r->kind() || l->size() != r->size())
+          return false;
+        if (SPOT_UNLIKELY(l->is(op::Star) || l->is(op::FStar))
+            && (l->min() != r->min() || l->max() != r->max()))
+          return false;
+        return std::equal(l->begin(), l->end(), r->begin());
+      }
+    };
+
+    // The table of all formulas, split into independently locked
+    // shards so that threads building unrelated formulas seldom
+    // wait for each other.
+    class unique_table final
+    {
+    public:
+      struct shard
+      {
+        std::mutex mutex;
+        std::unordered_set<const fnode*, formula_hash, formula_eq> set;
+      };
+
+      shard& shard_of(const fnode* f)
+      {
+        return shards_[knuth32_hash(formula_hash()(f)) % nshards];
+      }
+
+      // Insert F, or return a clone of the equal formula that is
+      // already in the table.
+      const fnode* insert(const fnode* f)
+      {
+        shard& s = shard_of(f);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto ires = s.set.emplace(f);
+        if (ires.second)
+          return f;
+        return (*ires.first)->clone();
+      }
+
+      template<class Fun>
+      void for_each(Fun fun)
+      {
+        for (auto& s: shards_)
+          for (auto f: s.set)
+            fun(f);
+      }
+
+    private:
+      static constexpr unsigned nshards = 64;
+      shard shards_[nshards];
+    };
+#endif
+
     struct maps_t final
     {
+#if SPOT_CONCURRENT_FORMULAS
+      std::mutex ap_mutex;      // protects name2ap and ap2name
+#endif
       std::map<std::string, const fnode*> name2ap;
       std::map<size_t, std::string> ap2name;
 
+#if SPOT_CONCURRENT_FORMULAS
+      unique_table uniq;
+#else
       std::set<const fnode*, formula_cmp> uniq;
+#endif
     };
     static maps_t m;
 
@@ -124,6 +208,63 @@ namespace spot
     }
   }
 
+#if SPOT_CONCURRENT_FORMULAS
+  const fnode* fnode::unique(const fnode* f)
+  {
+    const fnode* res = m.uniq.insert(f);
+    if (res != f)
+      {
+        for (auto c: *f)
+          c->destroy();
+        delete f;
+      }
+    return res;
+  }
+
+  void
+  fnode::destroy_aux() const
+  {
+    bool ap = is(op::ap);
+    {
+      std::lock_guard<std::mutex> lock(ap ? m.ap_mutex
+                                       : m.uniq.shard_of(this).mutex);
+      // Since we saw that we were holding the last reference,
+      // another thread may have obtained a new one by looking this
+      // formula up.  This can only happen while holding the lock, so
+      // checking again now is enough.
+      uint16_t r = refs_.load(std::memory_order_acquire);
+      while (r)
+        if (r == UINT16_MAX
+            || refs_.compare_exchange_weak(r, r - 1,
+                                           std::memory_order_acq_rel))
+          return;
+      if (SPOT_UNLIKELY(ap))
+        {
+          auto i = m.ap2name.find(id());
+          auto n = m.name2ap.erase(i->second);
+          assert(n == 1);
+          (void)n;
+          m.ap2name.erase(i);
+        }
+      else
+        {
+          auto n = m.uniq.shard_of(this).set.erase(this);
+          assert(n == 1);
+          (void)n;
+        }
+    }
+    for (auto c: *this)
+      c->destroy();
+    delete this;
+  }
+
+  const fnode* fnode::one_star()
+  {
+    static std::once_flag once;
+    std::call_once(once, []() { one_star_ = bunop(op::Star, tt(), 0); });
+    return one_star_;
+  }
+#else
   const fnode* fnode::unique(const fnode* f)
   {
     auto ires = m.uniq.emplace(f);
@@ -160,6 +301,7 @@ namespace spot
       }
     delete this;
   }
+#endif
 
   std::string fnode::kindstr() const
   {
@@ -996,15 +1138,30 @@ namespace spot
   const fnode*
   fnode::ap(const std::string& name)
   {
+#if SPOT_CONCURRENT_FORMULAS
+    std::lock_guard<std::mutex> lock(m.ap_mutex);
+#endif
     auto ires = m.name2ap.emplace(name, nullptr);
     if (!ires.second)
       return ires.first->second->clone();
-    // Name the formula before creating it, because
-    // the constructor will call ap_name().
-    m.ap2name.emplace(next_id_, name);
-    // next_id_ is incremented by setup_props(), called by the
-    // constructor of fnode
-    return ires.first->second = new fnode(op::ap, {});
+    fnode* res = new fnode(op::ap, {});
+    m.ap2name.emplace(res->id(), name);
+    // The properties that depend on the name are set here rather
+    // than in setup_props(): the id of the formula, under which the
+    // name is registered, is only known after construction.
+    //
+    // is_.lbt_atomic_props should be true if the name has the
+    // form pNN where NN is any number of digit.
+    std::string::const_iterator pos = name.begin();
+    bool lbtap = (pos != name.end() && *pos++ == 'p');
+    while (lbtap && pos != name.end())
+      {
+        char l = *pos++;
+        lbtap = (l >= '0' && l <= '9');
+      }
+    res->is_.lbt_atomic_props = lbtap;
+    res->is_.spin_atomic_props = lbtap || is_spin_ap(name.c_str());
+    return ires.first->second = res;
   }
 
   const std::string&
@@ -1012,12 +1169,19 @@ namespace spot
   {
     if (op_ != op::ap)
       throw std::runtime_error("ap_name() called on non-AP formula");
+#if SPOT_CONCURRENT_FORMULAS
+    std::lock_guard<std::mutex> lock(m.ap_mutex);
+#endif
     auto i = m.ap2name.find(id());
     assert(i != m.ap2name.end());
     return i->second;
   }
 
+#if SPOT_CONCURRENT_FORMULAS
+  std::atomic<size_t> fnode::next_id_(0U);
+#else
   size_t fnode::next_id_ = 0U;
+#endif
   const fnode* fnode::ff_ = new fnode(op::ff, {});
   const fnode* fnode::tt_ = new fnode(op::tt, {});
   const fnode* fnode::ew_ = new fnode(op::eword, {});
@@ -1025,13 +1189,19 @@ namespace spot
 
   void fnode::setup_props(op o)
   {
-    id_ = next_id_++;
     // If the counter of formulae ever loops, we want to skip the
     // first three values, because they are permanently associated
     // to constants, and it is convenient to have constants
     // smaller than all other formulas.
+#if SPOT_CONCURRENT_FORMULAS
+    do
+      id_ = next_id_++;
+    while (SPOT_UNLIKELY(id_ < 3) && ew_);
+#else
+    id_ = next_id_++;
     if (SPOT_UNLIKELY(next_id_ == 0))
       next_id_ = 3;
+#endif
 
     switch (o)
       {
@@ -1102,20 +1272,7 @@ namespace spot
         is_.syntactic_persistence = true;
         is_.not_marked = true;
         is_.accepting_eword = false;
-        {
-          // is_.lbt_atomic_props should be true if the name has the
-          // form pNN where NN is any number of digit.
-          const std::string& n = ap_name();
-          std::string::const_iterator pos = n.begin();
-          bool lbtap = (pos != n.end() && *pos++ == 'p');
-          while (lbtap && pos != n.end())
-            {
-              char l = *pos++;
-              lbtap = (l >= '0' && l <= '9');
-            }
-          is_.lbt_atomic_props = lbtap;
-          is_.spin_atomic_props = lbtap || is_spin_ap(n.c_str());
-        }
+        // lbt_atomic_props and spin_atomic_props are set by ap().
         break;
       case op::Not:
         props = children[0]->props;
@@ -1652,13 +1809,21 @@ namespace spot
   bool fnode::instances_check()
   {
     unsigned cnt = 0;
+    auto check = [&cnt](const fnode* i)
+      {
+        if (i->id() > 3 && i != one_star_)
+          {
+            if (!cnt++)
+              std::cerr << "*** m.uniq is not empty ***\n";
+            i->dump(std::cerr) << std::endl;
+          }
+      };
+#if SPOT_CONCURRENT_FORMULAS
+    m.uniq.for_each(check);
+#else
     for (auto i: m.uniq)
-      if (i->id() > 3 && i != one_star_)
-        {
-          if (!cnt++)
-            std::cerr << "*** m.uniq is not empty ***\n";
-          i->dump(std::cerr) << std::endl;
-        }
+      check(i);
+#endif
     return cnt == 0;
   }
 
@@ -41,6 +41,7 @@
 /// \ingroup tl
 
 #include <spot/misc/common.hh>
+#include <spot/misc/_config.h>
 #include <memory>
 #include <cstdint>
 #include <initializer_list>
@@ -54,6 +55,9 @@
 #include <cstddef>
 #include <initializer_list>
 #include <limits>
+#if SPOT_CONCURRENT_FORMULAS
+#include <atomic>
+#endif
 
 namespace spot
 {
@@ -113,10 +117,19 @@ namespace spot
       /// saturates, the fnode will stay permanently allocated.
       const fnode* clone() const
       {
+#if SPOT_CONCURRENT_FORMULAS
+        // Saturate at UINT16_MAX.
+        uint16_t r = refs_.load(std::memory_order_relaxed);
+        while (SPOT_LIKELY(r != UINT16_MAX)
+               && !refs_.compare_exchange_weak(r, r + 1,
+                                               std::memory_order_relaxed))
+          continue;
+#else
         // Saturate.
         ++refs_;
         if (SPOT_UNLIKELY(!refs_))
           saturated_ = 1;
+#endif
         return this;
       }
 
@@ -127,11 +140,23 @@ namespace spot
       /// counder reaches 0 (unless the fnode denotes a constant).
       void destroy() const
       {
+#if SPOT_CONCURRENT_FORMULAS
+        uint16_t r = refs_.load(std::memory_order_acquire);
+        while (r)
+          if (SPOT_UNLIKELY(r == UINT16_MAX) // saturated
+              || refs_.compare_exchange_weak(r, r - 1,
+                                             std::memory_order_acq_rel))
+            return;
+        if (SPOT_LIKELY(id_ > 2))
+          // last reference to a node that is not a constant
+          destroy_aux();
+#else
         if (SPOT_LIKELY(refs_))
           --refs_;
         else if (SPOT_LIKELY(id_ > 2) && SPOT_LIKELY(!saturated_))
           // last reference to a node that is not a constant
           destroy_aux();
+#endif
       }
 
       /// \see formula::unbounded
@@ -311,12 +336,16 @@ namespace spot
       }
 
       /// \see formula::one_star
+#if SPOT_CONCURRENT_FORMULAS
+      static const fnode* one_star();
+#else
       static const fnode* one_star()
       {
         if (!one_star_)
           one_star_ = bunop(op::Star, tt(), 0);
         return one_star_;
       }
+#endif
 
       /// \see formula::ap_name
       const std::string& ap_name() const;
@@ -540,9 +569,15 @@ namespace spot
       uint8_t max_;                // range maximum;
       mutable uint8_t saturated_;
       uint16_t size_;              // number of children
+#if SPOT_CONCURRENT_FORMULAS
+      mutable std::atomic<uint16_t> refs_{0}; // reference count - 1;
+      size_t id_;                  // Also used as hash.
+      static std::atomic<size_t> next_id_;
+#else
       mutable uint16_t refs_ = 0;  // reference count - 1;
       size_t id_;                  // Also used as hash.
       static size_t next_id_;
+#endif
 
       struct ltl_prop
       {
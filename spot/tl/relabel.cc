@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2014, 2015, 2016 Laboratoire de Recherche
-// et Développement de l'Epita (LRDE).
+// Copyright (C) 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// Recherche et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -481,4 +481,15 @@ namespace spot
     bse_relabeler rel(gen, c, m);
     return rel.visit(f);
   }
+
+  formula
+  relabel_apply(formula f, const relabeling_map* m)
+  {
+    if (f.is(op::ap))
+      {
+        auto i = m->find(f);
+        return i == m->end() ? f : i->second;
+      }
+    return f.map([m](formula g) { return relabel_apply(g, m); });
+  }
 }
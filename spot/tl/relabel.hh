@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2015 Laboratoire de Recherche et
+// Copyright (C) 2012, 2013, 2015, 2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -48,4 +48,11 @@ namespace spot
   SPOT_API
   formula relabel_bse(formula f, relabeling_style style,
                       relabeling_map* m = nullptr);
+
+  /// \ingroup tl_rewriting
+  /// \brief Replace the keys of \a m by their values in \a f.
+  ///
+  /// This undoes relabel() and relabel_bse().
+  SPOT_API
+  formula relabel_apply(formula f, const relabeling_map* m);
 }
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2012, 2013, 2014, 2015, 2016 Laboratoire de
+// Copyright (C) 2011-2017 Laboratoire de
 // Recherche et Developpement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -3467,6 +3467,12 @@ namespace spot
     return cache_->dict;
   }
 
+  const tl_simplifier_options&
+  tl_simplifier::options() const
+  {
+    return cache_->options;
+  }
+
   void
   tl_simplifier::print_stats(std::ostream& os) const
   {
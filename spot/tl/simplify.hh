@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2012, 2013, 2014, 2015, 2016 Laboratoire de
+// Copyright (C) 2011-2017 Laboratoire de
 // Recherche et Developpement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -179,6 +179,9 @@ namespace spot
     /// Return the bdd_dict used.
     bdd_dict_ptr get_dict() const;
 
+    /// Return the options used.
+    const tl_simplifier_options& options() const;
+
     /// Cached version of spot::star_normal_form().
     formula star_normal_form(formula f);
 
@@ -33,19 +33,12 @@ namespace spot
 {
   std::ostream& operator<<(std::ostream& os, spot::acc_cond::mark_t m)
   {
-    auto a = m.id;
     os << '{';
-    unsigned level = 0;
     const char* comma = "";
-    while (a)
+    for (unsigned level: m.sets())
       {
-        if (a & 1)
-          {
-            os << comma << level;
-            comma = ",";
-          }
-        a >>= 1;
-        ++level;
+        os << comma << level;
+        comma = ",";
       }
     os << '}';
     return os;
@@ -103,7 +96,7 @@ namespace spot
           SPOT_FALLTHROUGH;
         case acc_cond::acc_op::Inf:
           {
-            auto a = code[pos - 1].mark.id;
+            auto a = code[pos - 1].mark;
             if (a == 0U)
               {
                 os << 't';
@@ -113,21 +106,15 @@ namespace spot
                 if (!top)
                   // Avoid extra parentheses if there is only one set
                   top = code[pos - 1].mark.count() == 1;
-                unsigned level = 0;
                 const char* and_ = "";
                 if (!top)
                   os << '(';
-                while (a)
+                for (unsigned level: a.sets())
                   {
-                    if (a & 1)
-                      {
-                        os << and_ << "Inf(" << negated;
-                        set_printer(os, level);
-                        os << ')';
-                        and_ = html ? "&amp;" : "&";
-                      }
-                    a >>= 1;
-                    ++level;
+                    os << and_ << "Inf(" << negated;
+                    set_printer(os, level);
+                    os << ')';
+                    and_ = html ? "&amp;" : "&";
                   }
                 if (!top)
                   os << ')';
@@ -139,7 +126,7 @@ namespace spot
           SPOT_FALLTHROUGH;
         case acc_cond::acc_op::Fin:
           {
-            auto a = code[pos - 1].mark.id;
+            auto a = code[pos - 1].mark;
             if (a == 0U)
               {
                 os << 'f';
@@ -149,21 +136,15 @@ namespace spot
                 if (!top)
                   // Avoid extra parentheses if there is only one set
                   top = code[pos - 1].mark.count() == 1;
-                unsigned level = 0;
                 const char* or_ = "";
                 if (!top)
                   os << '(';
-                while (a)
+                for (unsigned level: a.sets())
                   {
-                    if (a & 1)
-                      {
-                        os << or_ << "Fin(" << negated;
-                        set_printer(os, level);
-                        os << ')';
-                        or_ = "|";
-                      }
-                    a >>= 1;
-                    ++level;
+                    os << or_ << "Fin(" << negated;
+                    set_printer(os, level);
+                    os << ')';
+                    or_ = "|";
                   }
                 if (!top)
                   os << ')';
@@ -407,7 +388,7 @@ namespace spot
           if (o1 != acc_cond::acc_op::Fin
               || o2 != acc_cond::acc_op::Inf
               || m1.count() != 1
-              || m2.id != (m1.id << 1))
+              || m2 != (m1 << 1U))
             return false;
           seen_fin |= m1;
           seen_inf |= m2;
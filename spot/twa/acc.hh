@@ -23,6 +23,8 @@
 #include <unordered_map>
 #include <sstream>
 #include <vector>
+#include <spot/misc/_config.h>
+#include <spot/misc/bitset.hh>
 #include <spot/tl/defaultenv.hh>
 #include <iostream>
 
@@ -33,7 +35,17 @@ namespace spot
   public:
     struct mark_t
     {
+      /// \brief Storage of the acceptance marks.
+      ///
+      /// This is a plain \c unsigned with the default configuration
+      /// (32 acceptance sets).  When Spot is configured with
+      /// <code>--enable-max-accsets=N</code> for some N > 32, this is
+      /// a spot::internal::bitset of N bits instead.
+#if SPOT_MAX_ACCSETS > 32
+      typedef internal::bitset<SPOT_MAX_ACCSETS / 32> value_t;
+#else
       typedef unsigned value_t;
+#endif
       value_t id;
 
       mark_t() = default;
@@ -43,6 +55,14 @@ namespace spot
       {
       }
 
+#if SPOT_MAX_ACCSETS > 32
+      /// Build a mark from the 32 lowest acceptance sets.
+      mark_t(unsigned id) noexcept
+        : id(id)
+      {
+      }
+#endif
+
       template<class iterator>
       mark_t(const iterator& begin, const iterator& end) noexcept
       {
@@ -56,16 +76,22 @@ namespace spot
       {
       }
 
+      /// The maximal number of acceptance sets that can be stored.
+      static constexpr unsigned max_accsets()
+      {
+        return SPOT_MAX_ACCSETS;
+      }
+
       bool operator==(unsigned o) const
       {
         SPOT_ASSERT(o == 0U);
-        return id == o;
+        return id == value_t(o);
       }
 
       bool operator!=(unsigned o) const
       {
         SPOT_ASSERT(o == 0U);
-        return id != o;
+        return id != value_t(o);
       }
 
       bool operator==(mark_t o) const
@@ -100,22 +126,34 @@ namespace spot
 
       operator bool() const
       {
-        return id != 0;
+        return static_cast<bool>(id);
       }
 
       bool has(unsigned u) const
       {
+#if SPOT_MAX_ACCSETS > 32
+        return id.has(u);
+#else
         return id & (1U << u);
+#endif
       }
 
       void set(unsigned u)
       {
+#if SPOT_MAX_ACCSETS > 32
+        id.set(u);
+#else
         id |= (1U << u);
+#endif
       }
 
       void clear(unsigned u)
       {
+#if SPOT_MAX_ACCSETS > 32
+        id.clear(u);
+#else
         id &= ~(1U << u);
+#endif
       }
 
       mark_t& operator&=(mark_t r)
@@ -196,7 +234,16 @@ namespace spot
         //       001011001000)
         //   ==  10 1  11 100
         //   ==      10111100
-
+#if SPOT_MAX_ACCSETS > 32
+        mark_t res = 0U;
+        for (unsigned b: (*this - y).sets())
+          {
+            // Each bit of y below b shifts b one position down.
+            mark_t below = ~value_t(0U) >> (max_accsets() - b);
+            res.set(b - (y & below).count());
+          }
+        return res;
+#else
         auto xv = id;                // 100101110100
         auto yv = y.id;                // 001011001000
 
@@ -210,12 +257,15 @@ namespace spot
             yv = (yv & lm) >> 1;
           }
         return xv;
+#endif
       }
 
       // Number of bits sets.
       unsigned count() const
       {
-#ifdef __GNUC__
+#if SPOT_MAX_ACCSETS > 32
+        return id.count();
+#elif defined __GNUC__
         return __builtin_popcount(id);
 #else
         unsigned c = 0U;
@@ -234,6 +284,9 @@ namespace spot
       // but if the sets {1,3,8} are used, this returns 9.
       unsigned max_set() const
       {
+#if SPOT_MAX_ACCSETS > 32
+        return id.highest();
+#else
         auto i = id;
         int res = 0;
         while (i)
@@ -242,25 +295,49 @@ namespace spot
             i >>= 1;
           }
         return res;
+#endif
       }
 
       // Return the lowest acceptance mark
       mark_t lowest() const
       {
+#if SPOT_MAX_ACCSETS > 32
+        return id.lowest();
+#else
         return id & -id;
+#endif
       }
 
       // Remove n bits that where set
       mark_t& remove_some(unsigned n)
       {
         while (n--)
+#if SPOT_MAX_ACCSETS > 32
+          id.clear_lowest();
+#else
           id &= id - 1;
+#endif
         return *this;
       }
 
       template<class iterator>
       void fill(iterator here) const
       {
+#if SPOT_MAX_ACCSETS > 32
+        constexpr unsigned wbits = 8 * sizeof(value_t::word_t);
+        for (unsigned w = 0; w < value_t::size() / wbits; ++w)
+          {
+            auto a = id.word(w);
+            unsigned level = w * wbits;
+            while (a)
+              {
+                if (a & 1)
+                  *here++ = level;
+                ++level;
+                a >>= 1;
+              }
+          }
+#else
         auto a = id;
         unsigned level = 0;
         while (a)
@@ -270,6 +347,7 @@ namespace spot
             ++level;
             a >>= 1;
           }
+#endif
       }
 
       // FIXME: Return some iterable object without building a vector.
@@ -496,17 +574,17 @@ namespace spot
 
       static acc_code generalized_buchi(unsigned n)
       {
-        acc_cond::mark_t m = (1U << n) - 1;
-        if (n == 8 * sizeof(mark_t::value_t))
-          m = mark_t(-1U);
+        acc_cond::mark_t m = 0U;
+        if (n > 0)
+          m = ~mark_t::value_t(0U) >> (mark_t::max_accsets() - n);
         return inf(m);
       }
 
       static acc_code generalized_co_buchi(unsigned n)
       {
-        acc_cond::mark_t m = (1U << n) - 1;
-        if (n == 8 * sizeof(mark_t::value_t))
-          m = mark_t(-1U);
+        acc_cond::mark_t m = 0U;
+        if (n > 0)
+          m = ~mark_t::value_t(0U) >> (mark_t::max_accsets() - n);
         return fin(m);
       }
 
@@ -829,7 +907,7 @@ namespace spot
               case acc_cond::acc_op::Fin:
               case acc_cond::acc_op::FinNeg:
                 pos -= 2;
-                (*this)[pos].mark.id <<= sets;
+                (*this)[pos].mark <<= sets;
                 break;
               }
           }
@@ -1117,7 +1195,7 @@ namespace spot
         return -1U;
       unsigned j = num_;
       num_ += num;
-      if (num_ > 8 * sizeof(mark_t::id))
+      if (num_ > mark_t::max_accsets())
         throw std::runtime_error("Too many acceptance sets used.");
       all_ = all_sets_();
       return j;
@@ -1131,12 +1209,12 @@ namespace spot
     mark_t mark(unsigned u) const
     {
       SPOT_ASSERT(u < num_sets());
-      return 1U << u;
+      return mark_t({u});
     }
 
     mark_t comp(mark_t l) const
     {
-      return all_ ^ l.id;
+      return all_ ^ l;
     }
 
     mark_t all_sets() const
@@ -1179,17 +1257,18 @@ namespace spot
     template<class iterator>
     mark_t useless(iterator begin, iterator end) const
     {
-      mark_t::value_t u = 0U;        // The set of useless marks.
+      mark_t u = 0U;        // The set of useless marks.
       for (unsigned x = 0; x < num_; ++x)
         {
           // Skip marks that are already known to be useless.
-          if (u & (1 << x))
+          if (u.has(x))
             continue;
-          unsigned all = all_ ^ (u | (1 << x));
+          mark_t all = all_ - u;
+          all.clear(x);
           for (iterator y = begin; y != end; ++y)
             {
-              auto v = y->id;
-              if (v & (1 << x))
+              mark_t v = *y;
+              if (v.has(x))
                 {
                   all &= v;
                   if (!all)
@@ -1202,15 +1281,15 @@ namespace spot
     }
 
   protected:
-    mark_t::value_t all_sets_() const
+    mark_t all_sets_() const
     {
       if (num_ == 0)
-        return 0;
-      return -1U >> (8 * sizeof(mark_t::value_t) - num_);
+        return 0U;
+      return ~mark_t::value_t(0U) >> (mark_t::max_accsets() - num_);
     }
 
     unsigned num_;
-    mark_t::value_t all_;
+    mark_t all_;
     acc_code code_;
     bool uses_fin_acceptance_ = false;
 
@@ -1227,8 +1306,12 @@ namespace std
   {
     size_t operator()(spot::acc_cond::mark_t m) const
     {
+#if SPOT_MAX_ACCSETS > 32
+      return m.id.hash();
+#else
       std::hash<decltype(m.id)> h;
       return h(m.id);
+#endif
     }
   };
 }
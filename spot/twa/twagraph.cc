@@ -43,6 +43,12 @@ namespace spot
     delete namer;
   }
 
+  void twa_graph::freeze()
+  {
+    if (g_.freeze())
+      set_named_prop("highlight-edges", nullptr);
+  }
+
     /// \brief Merge universal destinations
     ///
     /// If several states have the same universal destination, merge
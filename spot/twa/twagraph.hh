@@ -535,6 +535,20 @@ namespace spot
     /// This is already called by merge_edges().
     void merge_univ_dests();
 
+    /// \brief Compact the automaton for read-only use.
+    ///
+    /// Renumber the edges so that the outgoing edges of each state
+    /// are stored contiguously, and release unused memory.  The
+    /// language, the states, and the order in which out() lists the
+    /// successors of each state are unchanged, but walking through
+    /// the automaton (as product(), scc_info, or the emptiness checks
+    /// do) is faster on large automata whose edges were not created
+    /// state by state.  See digraph::freeze().
+    ///
+    /// If edges are renumbered, the "highlight-edges" property is
+    /// removed.
+    void freeze();
+
     /// \brief Remove all dead states
     ///
     /// Dead states are all the states that cannot be part of
@@ -0,0 +1,750 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "config.h"
+#include <spot/twaalgos/binary.hh>
+#include <spot/twa/twagraph.hh>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace spot
+{
+  namespace
+  {
+    // As in PNG, the first byte is not ASCII, and the end-of-line
+    // characters make it possible to detect files that have been
+    // altered by text-mode conversions.
+    const char magic[8] = { '\x89', 'S', 'P', 'A', '\r', '\n', '\x1a', '\n' };
+    const uint32_t format_version = 1;
+    const uint32_t byte_order = 0x01020304;
+
+    // The header is a sequence of 32-bit integers following the
+    // magic string.
+    enum header_field
+    {
+      h_version,
+      h_byte_order,
+      h_size,                   // Size of the record in bytes.
+      h_aps,
+      h_states,
+      h_edges,
+      h_nodes,                  // Number of BDD nodes.
+      h_dests,                  // Size of the universal destinations.
+      h_init,
+      h_sets,
+      h_mark_words,             // 32-bit words per acceptance mark.
+      h_props,                  // 2 bits per property.
+      h_flags,
+      h_count
+    };
+    enum { has_name = 1, has_state_names = 2 };
+    const size_t header_size = sizeof magic + 4 * h_count;
+
+    // BDD nodes are referred to by 0 (false), 1 (true), or k + 2 for
+    // the k-th node of the pool.  Each node is a triplet (AP number,
+    // low, high), and refers only to nodes that precede it.
+    class node_pool
+    {
+      std::vector<int> ap_of_var_;
+      std::unordered_map<int, uint32_t> ref_;
+    public:
+      std::vector<uint32_t> nodes;
+
+      node_pool(const const_twa_graph_ptr& aut)
+        : ap_of_var_(bdd_varnum(), -1)
+      {
+        auto d = aut->get_dict();
+        int n = 0;
+        for (auto& f: aut->ap())
+          ap_of_var_[d->varnum(f)] = n++;
+      }
+
+      uint32_t encode(const bdd& b)
+      {
+        if (b == bddfalse)
+          return 0;
+        if (b == bddtrue)
+          return 1;
+        auto i = ref_.find(b.id());
+        if (i != ref_.end())
+          return i->second;
+        uint32_t low = encode(bdd_low(b));
+        uint32_t high = encode(bdd_high(b));
+        int ap = ap_of_var_[bdd_var(b)];
+        if (SPOT_UNLIKELY(ap < 0))
+          throw std::runtime_error("print_binary(): the automaton uses "
+                                   "an unregistered atomic proposition");
+        nodes.push_back(ap);
+        nodes.push_back(low);
+        nodes.push_back(high);
+        uint32_t r = nodes.size() / 3 + 1;
+        ref_.emplace(b.id(), r);
+        return r;
+      }
+    };
+
+    void put(std::string& out, uint32_t v)
+    {
+      out.append(reinterpret_cast<const char*>(&v), sizeof v);
+    }
+
+    // Strings are preceded by their size, and padded to a multiple
+    // of 4 bytes, so that all integers are aligned.
+    void put(std::string& out, const std::string& s)
+    {
+      put(out, s.size());
+      out += s;
+      out.append((4 - s.size() % 4) % 4, '\0');
+    }
+
+    void put(std::string& out, acc_cond::mark_t m, unsigned words)
+    {
+#if SPOT_MAX_ACCSETS > 32
+      for (unsigned i = 0; i < words; ++i)
+        put(out, m.id.word(i));
+#else
+      if (words)
+        put(out, m.id);
+#endif
+    }
+
+    acc_cond::mark_t get_mark(const char* array, size_t i, unsigned words)
+    {
+      uint32_t v;
+#if SPOT_MAX_ACCSETS > 32
+      acc_cond::mark_t m(0U);
+      for (unsigned w = 0; w < words; ++w)
+        {
+          memcpy(&v, array + 4 * (i * words + w), sizeof v);
+          for (unsigned bit = 0; v; ++bit, v >>= 1)
+            if (v & 1)
+              m.set(32 * w + bit);
+        }
+      return m;
+#else
+      if (!words)
+        return 0U;
+      memcpy(&v, array + 4 * i, sizeof v);
+      return v;
+#endif
+    }
+
+    bool is_set_op(acc_cond::acc_op op)
+    {
+      return op == acc_cond::acc_op::Inf || op == acc_cond::acc_op::Fin
+        || op == acc_cond::acc_op::InfNeg || op == acc_cond::acc_op::FinNeg;
+    }
+
+    // The acceptance condition is stored in the reverse order of
+    // acc_code, i.e., starting from its root, with operators encoded
+    // as op | size << 16.  The words that follow an Inf, Fin, InfNeg,
+    // or FinNeg operator are a set of acceptance sets.
+    void put(std::string& out, const acc_cond::acc_code& code,
+             unsigned words)
+    {
+      put(out, code.size());
+      bool mark = false;
+      for (unsigned i = code.size(); i-- > 0;)
+        {
+          if (mark)
+            {
+              put(out, code[i].mark, words);
+              mark = false;
+              continue;
+            }
+          auto& s = code[i].sub;
+          put(out, uint32_t(s.op) | uint32_t(s.size) << 16);
+          mark = is_set_op(s.op);
+        }
+    }
+
+    // Check that the subtree rooted at POS is well formed, and return
+    // the position of its first word.
+    int check_acc(const acc_cond::acc_code& code, int pos)
+    {
+      if (pos < 0)
+        return -2;
+      auto& s = code[pos].sub;
+      if (is_set_op(s.op))
+        return (s.size == 1 && pos >= 1) ? pos - 1 : -2;
+      int end = pos - s.size - 1;
+      if (end < -1)
+        return -2;
+      int i = pos - 1;
+      while (i > end)
+        {
+          i = check_acc(code, i);
+          if (i < 0)
+            return -2;
+          --i;
+        }
+      return i == end ? end + 1 : -2;
+    }
+
+    trival get_prop(uint32_t props, unsigned n)
+    {
+      switch ((props >> (2 * n)) & 3)
+        {
+        case 0:
+          return false;
+        case 2:
+          return true;
+        default:
+          return trival::maybe();
+        }
+    }
+
+    class decoder
+    {
+      const char* data_;
+      size_t size_;
+      size_t pos_ = 0;
+
+    public:
+      decoder(const char* data, size_t size)
+        : data_(data), size_(size)
+      {
+      }
+
+      size_t pos() const
+      {
+        return pos_;
+      }
+
+      void need(size_t n) const
+      {
+        if (SPOT_UNLIKELY(size_ - pos_ < n))
+          throw std::runtime_error("read_binary(): truncated input");
+      }
+
+      uint32_t get()
+      {
+        need(4);
+        uint32_t v;
+        memcpy(&v, data_ + pos_, sizeof v);
+        pos_ += 4;
+        return v;
+      }
+
+      // Return a pointer to an array of N integers, and skip it.
+      // The integers are read with at() as the array may not be
+      // aligned.
+      const char* array(size_t n)
+      {
+        need(4 * n);
+        const char* res = data_ + pos_;
+        pos_ += 4 * n;
+        return res;
+      }
+
+      static uint32_t at(const char* array, size_t i)
+      {
+        uint32_t v;
+        memcpy(&v, array + 4 * i, sizeof v);
+        return v;
+      }
+
+      std::string str()
+      {
+        size_t n = get();
+        need(n);
+        std::string res(data_ + pos_, n);
+        pos_ += n + (4 - n % 4) % 4;
+        if (pos_ > size_)
+          pos_ = size_;
+        return res;
+      }
+    };
+
+    void check(bool ok, const char* what)
+    {
+      if (SPOT_UNLIKELY(!ok))
+        throw std::runtime_error(std::string("read_binary(): ") + what);
+    }
+  }
+
+  std::ostream&
+  print_binary(std::ostream& os, const const_twa_graph_ptr& aut)
+  {
+    auto& g = aut->get_graph();
+    unsigned ns = aut->num_states();
+    unsigned sets = aut->num_sets();
+    unsigned words = (sets + 31) / 32;
+
+    trival props[] =
+      {
+        aut->prop_state_acc(),
+        aut->prop_inherently_weak(),
+        aut->prop_weak(),
+        aut->prop_terminal(),
+        aut->prop_very_weak(),
+        aut->prop_deterministic(),
+        aut->prop_unambiguous(),
+        aut->prop_semi_deterministic(),
+        aut->prop_stutter_invariant(),
+      };
+    uint32_t p = 0;
+    unsigned n = 0;
+    for (auto t: props)
+      p |= (t.val() + 1) << (2 * n++);
+
+    auto name = aut->get_named_prop<std::string>("automaton-name");
+    auto sn = aut->get_named_prop<std::vector<std::string>>("state-names");
+    uint32_t flags = (name ? has_name : 0) | (sn ? has_state_names : 0);
+
+    // Gather the edges in the order of the states, and encode their
+    // labels.
+    node_pool pool(aut);
+    std::vector<uint32_t> offsets;
+    offsets.reserve(ns + 1);
+    std::vector<uint32_t> dst;
+    std::vector<uint32_t> cond;
+    dst.reserve(aut->num_edges());
+    cond.reserve(aut->num_edges());
+    std::string acc;
+    acc.reserve(4 * words * aut->num_edges());
+    for (unsigned s = 0; s < ns; ++s)
+      {
+        offsets.push_back(dst.size());
+        for (auto& e: g.out(s))
+          {
+            dst.push_back(e.dst);
+            cond.push_back(pool.encode(e.cond));
+            put(acc, e.acc, words);
+          }
+      }
+    offsets.push_back(dst.size());
+
+    std::string out(magic, sizeof magic);
+    uint32_t header[h_count];
+    header[h_version] = format_version;
+    header[h_byte_order] = byte_order;
+    header[h_size] = 0;         // Filled below.
+    header[h_aps] = aut->ap().size();
+    header[h_states] = ns;
+    header[h_edges] = dst.size();
+    header[h_nodes] = pool.nodes.size() / 3;
+    header[h_dests] = g.dests_vector().size();
+    header[h_init] = ns ? aut->get_init_state_number() : 0;
+    header[h_sets] = sets;
+    header[h_mark_words] = words;
+    header[h_props] = p;
+    header[h_flags] = flags;
+    for (auto h: header)
+      put(out, h);
+    put(out, aut->get_acceptance(), words);
+    if (name)
+      put(out, *name);
+    for (auto& f: aut->ap())
+      put(out, f.ap_name());
+    auto put_vector = [&out](const std::vector<uint32_t>& v)
+      {
+        out.append(reinterpret_cast<const char*>(v.data()), 4 * v.size());
+      };
+    put_vector(pool.nodes);
+    put_vector(offsets);
+    put_vector(dst);
+    put_vector(cond);
+    out += acc;
+    put_vector(g.dests_vector());
+    if (sn)
+      for (unsigned s = 0; s < ns; ++s)
+        put(out, s < sn->size() ? (*sn)[s] : std::string());
+
+    if (SPOT_UNLIKELY(out.size() > 0xffffffffU))
+      throw std::runtime_error("print_binary(): automaton too large");
+    uint32_t size = out.size();
+    memcpy(&out[sizeof magic + 4 * h_size], &size, sizeof size);
+    return os.write(out.data(), out.size());
+  }
+
+  bool
+  is_binary_automaton(const char* data, size_t size)
+  {
+    return size >= sizeof magic && !memcmp(data, magic, sizeof magic);
+  }
+
+  twa_graph_ptr
+  read_binary(const char* data, size_t size, const bdd_dict_ptr& dict,
+              size_t* used, const relabeling_map* relmap)
+  {
+    check(is_binary_automaton(data, size), "not an automaton");
+    decoder in(data + sizeof magic, size - sizeof magic);
+    uint32_t header[h_count];
+    header[h_version] = in.get();
+    if (header[h_version] != format_version)
+      throw std::runtime_error("read_binary(): unsupported version " +
+                               std::to_string(header[h_version]) +
+                               " of the binary format");
+    header[h_byte_order] = in.get();
+    check(header[h_byte_order] == byte_order,
+          "automaton written on a machine with a different byte order");
+    for (unsigned i = h_size; i < h_count; ++i)
+      header[i] = in.get();
+    size_t record = header[h_size];
+    check(record >= header_size, "invalid size");
+    check(record <= size, "truncated input");
+    in = decoder(data + header_size, record - header_size);
+
+    unsigned ns = header[h_states];
+    unsigned ne = header[h_edges];
+    unsigned nn = header[h_nodes];
+    unsigned sets = header[h_sets];
+    unsigned words = header[h_mark_words];
+    check(sets <= acc_cond::mark_t::max_accsets(),
+          "too many acceptance sets for this version of Spot");
+    check(words == (sets + 31) / 32, "invalid header");
+
+    auto aut = make_twa_graph(dict);
+    {
+      acc_cond::acc_code code;
+      uint32_t n = in.get();
+      // Sizes are checked against the size of the input before any
+      // allocation, so that corrupted sizes throw instead of
+      // exhausting the memory.
+      in.need(4 * size_t(n));
+      code.resize(n);
+      bool mark = false;
+      for (unsigned i = code.size(); i-- > 0;)
+        {
+          if (mark)
+            {
+              code[i].mark = get_mark(in.array(words), 0, words);
+              mark = false;
+              continue;
+            }
+          uint32_t w = in.get();
+          auto op = static_cast<acc_cond::acc_op>(w & 0xffff);
+          check(op <= acc_cond::acc_op::Or, "invalid acceptance condition");
+          code[i].sub.op = op;
+          code[i].sub.size = w >> 16;
+          mark = is_set_op(op);
+        }
+      check(code.empty() || check_acc(code, code.size() - 1) == 0,
+            "invalid acceptance condition");
+      check(code.used_sets().max_set() <= sets,
+            "invalid acceptance condition");
+      aut->set_acceptance(sets, code);
+    }
+    if (header[h_flags] & has_name)
+      aut->set_named_prop("automaton-name", new std::string(in.str()));
+
+    std::vector<bdd> vars;
+    in.need(4 * size_t(header[h_aps]));
+    vars.reserve(header[h_aps]);
+    for (unsigned i = 0; i < header[h_aps]; ++i)
+      {
+        formula ap = formula::ap(in.str());
+        if (relmap)
+          {
+            auto it = relmap->find(ap);
+            if (it != relmap->end())
+              ap = it->second;
+          }
+        vars.push_back(bdd_ithvar(aut->register_ap(ap)));
+      }
+
+    // Rebuild the labels, bottom-up.
+    std::vector<bdd> conds;
+    {
+      const char* nodes = in.array(3 * size_t(nn));
+      conds.reserve(size_t(nn) + 2);
+      conds.push_back(bddfalse);
+      conds.push_back(bddtrue);
+      for (unsigned k = 0; k < nn; ++k)
+        {
+          uint32_t ap = decoder::at(nodes, 3 * k);
+          uint32_t low = decoder::at(nodes, 3 * k + 1);
+          uint32_t high = decoder::at(nodes, 3 * k + 2);
+          check(ap < vars.size() && low < k + 2 && high < k + 2,
+                "invalid BDD node");
+          conds.push_back(bdd_ite(vars[ap], conds[high], conds[low]));
+        }
+    }
+
+    const char* offsets = in.array(size_t(ns) + 1);
+    const char* dst = in.array(ne);
+    const char* cond = in.array(ne);
+    const char* acc = in.array(size_t(ne) * words);
+    auto& g = aut->get_graph();
+    std::vector<bool> group_start;
+    {
+      // Allocate only once the size has been checked by array().
+      const char* dests = in.array(header[h_dests]);
+      group_start.resize(header[h_dests], false);
+      g.dests_vector().resize(header[h_dests]);
+      if (header[h_dests])
+        memcpy(g.dests_vector().data(), dests, 4 * header[h_dests]);
+      // Each group of universal destinations is a size followed by
+      // as many states.
+      auto& dv = g.dests_vector();
+      for (size_t i = 0; i < dv.size(); i += dv[i] + 1)
+        {
+          check(dv[i] <= dv.size() - i - 1, "invalid universal edge");
+          group_start[i] = true;
+          for (unsigned j = 1; j <= dv[i]; ++j)
+            check(dv[i + j] < ns, "invalid universal edge");
+        }
+    }
+    auto valid_dst = [&](uint32_t d)
+      {
+        if (int(d) >= 0)
+          return d < ns;
+        unsigned pos = ~d;
+        return pos < group_start.size() && group_start[pos];
+      };
+
+    aut->new_states(ns);
+    g.edge_vector().reserve(size_t(ne) + 1);
+    check(decoder::at(offsets, 0) == 0, "invalid edge offsets");
+    for (unsigned s = 0; s < ns; ++s)
+      {
+        uint32_t b = decoder::at(offsets, s);
+        uint32_t e = decoder::at(offsets, s + 1);
+        check(b <= e && e <= ne, "invalid edge offsets");
+        for (uint32_t i = b; i < e; ++i)
+          {
+            uint32_t d = decoder::at(dst, i);
+            uint32_t c = decoder::at(cond, i);
+            check(valid_dst(d), "invalid destination");
+            check(c < conds.size(), "invalid label");
+            auto m = get_mark(acc, i, words);
+            check(m.max_set() <= sets, "invalid acceptance sets");
+            g.new_edge(s, d, conds[c], m);
+          }
+      }
+    check(decoder::at(offsets, ns) == ne, "invalid edge offsets");
+
+    if (ns)
+      {
+        uint32_t init = header[h_init];
+        check(valid_dst(init), "invalid initial state");
+        if (int(init) >= 0)
+          {
+            aut->set_init_state(init);
+          }
+        else
+          {
+            // Copy the destinations, as set_univ_init_state() will
+            // add them to the vector they come from.
+            auto d = g.univ_dests(init);
+            std::vector<unsigned> v(d.begin(), d.end());
+            aut->set_univ_init_state(v.begin(), v.end());
+          }
+      }
+
+    if (header[h_flags] & has_state_names)
+      {
+        auto sn = new std::vector<std::string>;
+        aut->set_named_prop("state-names", sn);
+        sn->reserve(ns);
+        for (unsigned s = 0; s < ns; ++s)
+          sn->push_back(in.str());
+      }
+
+    uint32_t p = header[h_props];
+    aut->prop_state_acc(get_prop(p, 0));
+    aut->prop_inherently_weak(get_prop(p, 1));
+    aut->prop_weak(get_prop(p, 2));
+    aut->prop_terminal(get_prop(p, 3));
+    aut->prop_very_weak(get_prop(p, 4));
+    aut->prop_deterministic(get_prop(p, 5));
+    aut->prop_unambiguous(get_prop(p, 6));
+    aut->prop_semi_deterministic(get_prop(p, 7));
+    aut->prop_stutter_invariant(get_prop(p, 8));
+
+    check(in.pos() == record - header_size, "invalid size");
+    if (used)
+      *used = record;
+    return aut;
+  }
+
+  binary_aut_reader::binary_aut_reader(const std::string& filename)
+  {
+    if (filename == "-")
+      {
+        // Use stdio, as the caller may have peeked at the input
+        // with getc() and ungetc().
+        file_ = stdin;
+        name_ = "standard input";
+        return;
+      }
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("cannot open " + filename + ": " +
+                               strerror(errno));
+    struct stat s;
+    if (fstat(fd, &s) < 0)
+      {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("cannot stat " + filename + ": " +
+                                 strerror(err));
+      }
+    if (!S_ISREG(s.st_mode))
+      {
+        // The size of pipes and devices is meaningless, and they
+        // cannot be mapped: read them as streams.
+        file_ = fdopen(fd, "r");
+        if (!file_)
+          {
+            int err = errno;
+            close(fd);
+            throw std::runtime_error("cannot open " + filename + ": " +
+                                     strerror(err));
+          }
+        close_file_ = true;
+        name_ = filename;
+        return;
+      }
+    size_ = s.st_size;
+    if (size_)
+      {
+        void* m = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED)
+          {
+            int err = errno;
+            close(fd);
+            throw std::runtime_error("cannot map " + filename + ": " +
+                                     strerror(err));
+          }
+#ifdef MADV_SEQUENTIAL
+        madvise(m, size_, MADV_SEQUENTIAL);
+#endif
+        map_ = m;
+        data_ = static_cast<const char*>(m);
+      }
+    close(fd);
+  }
+
+  binary_aut_reader::binary_aut_reader(FILE* f, const std::string& name,
+                                       bool close)
+    : file_(f), close_file_(close), name_(name)
+  {
+  }
+
+  binary_aut_reader::binary_aut_reader(const char* data, size_t size)
+    : data_(data), size_(size)
+  {
+  }
+
+  binary_aut_reader::~binary_aut_reader()
+  {
+    if (map_)
+      munmap(map_, size_);
+    if (close_file_)
+      fclose(file_);
+  }
+
+  // Append at most n bytes of file_ to buf_, and return the number
+  // of bytes read.  The bytes are read by blocks, so that a corrupted
+  // size does not allocate more memory than the input contains.
+  size_t
+  binary_aut_reader::read_stream(size_t n)
+  {
+    char buf[65536];
+    size_t total = 0;
+    while (total < n)
+      {
+        size_t r = fread(buf, 1, std::min(n - total, sizeof buf), file_);
+        if (r == 0)
+          break;
+        buf_.append(buf, r);
+        total += r;
+      }
+    if (ferror(file_))
+      throw std::runtime_error("cannot read " + name_);
+    return total;
+  }
+
+  // Read the header of the next automaton, and then exactly the rest
+  // of its record, so that it can be decoded without waiting for the
+  // following ones.
+  twa_graph_ptr
+  binary_aut_reader::next_in_stream(const bdd_dict_ptr& dict)
+  {
+    buf_.clear();
+    if (read_stream(header_size) == 0)
+      {
+        eof_ = true;
+        return nullptr;
+      }
+    if (buf_.size() == header_size
+        && is_binary_automaton(buf_.data(), buf_.size()))
+      {
+        uint32_t header[h_size + 1];
+        memcpy(header, buf_.data() + sizeof magic, sizeof header);
+        // Otherwise, read_binary() reports the problem.
+        if (header[h_version] == format_version
+            && header[h_byte_order] == byte_order
+            && header[h_size] > header_size)
+          read_stream(header[h_size] - header_size);
+      }
+    size_t used;
+    auto aut = read_binary(buf_.data(), buf_.size(), dict, &used);
+    pos_ += used;
+    return aut;
+  }
+
+  twa_graph_ptr
+  binary_aut_reader::next(const bdd_dict_ptr& dict)
+  {
+    if (file_)
+      {
+        if (eof_)
+          return nullptr;
+        try
+          {
+            return next_in_stream(dict);
+          }
+        catch (...)
+          {
+            // Do not try to read the rest of the input.
+            eof_ = true;
+            throw;
+          }
+      }
+    if (pos_ == size_)
+      return nullptr;
+    size_t used;
+    try
+      {
+        auto aut = read_binary(data_ + pos_, size_ - pos_, dict, &used);
+        pos_ += used;
+        return aut;
+      }
+    catch (...)
+      {
+        // Do not try to read the rest of the input.
+        pos_ = size_;
+        throw;
+      }
+  }
+}
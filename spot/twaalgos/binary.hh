@@ -0,0 +1,150 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <spot/misc/common.hh>
+#include <spot/twa/fwd.hh>
+#include <spot/twa/bdddict.hh>
+#include <spot/tl/relabel.hh>
+
+namespace spot
+{
+  /// \ingroup twa_io
+  /// \brief Print an automaton in Spot's binary format.
+  ///
+  /// This format is meant to store automata that will be read back
+  /// by Spot quickly, e.g., to cache automata between the stages of
+  /// some pipeline.  Unlike HOA, it is not portable: it depends on
+  /// the byte order of the machine, and it is not guaranteed to be
+  /// readable by other versions of Spot (the version of the format
+  /// is checked when reading).
+  ///
+  /// Each automaton is a record made of a header (starting with a
+  /// magic string and the version of the format), the table of
+  /// atomic propositions, a pool of BDD nodes from which all the
+  /// edge labels are built, the acceptance condition, the offsets
+  /// of the outgoing edges of each state, and three arrays giving
+  /// the destination, label, and acceptance sets of each edge.  The
+  /// properties of the automaton, its name and its state names
+  /// (if any) are also saved.  Records can be concatenated to store
+  /// several automata in a file.
+  ///
+  /// All states are stored, with their numbers, and the outgoing
+  /// edges of each state are stored in the order in which out()
+  /// lists them.
+  SPOT_API std::ostream&
+  print_binary(std::ostream& os, const const_twa_graph_ptr& aut);
+
+  /// \ingroup twa_io
+  /// \brief Whether \a data starts like an automaton output by
+  /// print_binary().
+  SPOT_API bool
+  is_binary_automaton(const char* data, size_t size);
+
+  /// \ingroup twa_io
+  /// \brief Read an automaton output by print_binary().
+  ///
+  /// The automaton is decoded from the \a size bytes at \a data.
+  /// Its edges are added state by state, so that the result is
+  /// frozen (see twa_graph::freeze()).  If \a used is non-null, it
+  /// is set to the number of bytes read, i.e., the offset of the
+  /// next automaton if several have been concatenated.
+  ///
+  /// If \a relmap is non-null, the atomic propositions of the
+  /// automaton that appear as keys in \a relmap are renamed into the
+  /// associated values, which must be atomic propositions.  This is
+  /// how spot::translation_cache stores automata for formulas that
+  /// differ only by the names of their atomic propositions.
+  ///
+  /// A std::runtime_error is thrown if the data is not a valid
+  /// automaton.
+  SPOT_API twa_graph_ptr
+  read_binary(const char* data, size_t size, const bdd_dict_ptr& dict,
+              size_t* used = nullptr,
+              const relabeling_map* relmap = nullptr);
+
+  /// \ingroup twa_io
+  /// \brief Read a sequence of automata output by print_binary().
+  ///
+  /// A regular file is mapped in memory, and the automata are
+  /// decoded directly from the mapping.  Other files, such as pipes,
+  /// and standard input, designated by "-", are read one automaton
+  /// at a time, so that each automaton is returned as soon as it has
+  /// been received.
+  class SPOT_API binary_aut_reader final
+  {
+  public:
+    /// \brief Map \a filename in memory.
+    ///
+    /// A std::runtime_error is thrown if the file cannot be read.
+    binary_aut_reader(const std::string& filename);
+
+    /// \brief Read automata from \a f, one at a time.
+    ///
+    /// The stream is read with stdio, so characters pushed back
+    /// with ungetc() are not lost.  It is closed by the destructor
+    /// if \a close is true.  A std::runtime_error mentioning \a name
+    /// is thrown if it cannot be read.
+    binary_aut_reader(FILE* f, const std::string& name,
+                      bool close = false);
+
+    /// \brief Read automata from \a size bytes at \a data.
+    ///
+    /// The data is not copied, and should outlive the reader.
+    binary_aut_reader(const char* data, size_t size);
+
+    ~binary_aut_reader();
+
+    binary_aut_reader(const binary_aut_reader&) = delete;
+    binary_aut_reader& operator=(const binary_aut_reader&) = delete;
+
+    /// \brief Return the next automaton, or nullptr at the end of
+    /// the input.
+    ///
+    /// A std::runtime_error is thrown if the input is not valid, in
+    /// which case the rest of the input is ignored.
+    twa_graph_ptr next(const bdd_dict_ptr& dict);
+
+    /// The offset, in bytes, of the next automaton.
+    size_t position() const
+    {
+      return pos_;
+    }
+
+  private:
+    size_t read_stream(size_t n);
+    twa_graph_ptr next_in_stream(const bdd_dict_ptr& dict);
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    void* map_ = nullptr;
+    // When reading from a stream, buf_ holds the current automaton.
+    FILE* file_ = nullptr;
+    bool close_file_ = false;
+    bool eof_ = false;
+    std::string name_;
+    std::string buf_;
+  };
+}
@@ -0,0 +1,150 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement
+// de l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <spot/misc/hashfunc.hh>
+
+namespace spot
+{
+  // The table of bit-state hashing shared by the heaps of the
+  // magic_search() and se05() variants.
+  //
+  // The table is an array of 2-bit slots (four per byte) holding
+  // colors, 0 being the color of unvisited states.  Each state is
+  // mapped to \a k slots by double hashing, in the spirit of Bloom
+  // filters: a state is given the smallest color found in its slots,
+  // and setting its color only increases the colors of its slots.
+  // As the searches only increase the colors of states, a collision
+  // can only make a state look more visited than it is, never less.
+  //
+  // Each time a new state is added, the probability that a new state
+  // is mistaken for a visited one is estimated from the fraction of
+  // used slots.  This gives an estimate of the number of states that
+  // have been missed, i.e., of the coverage of the search.
+  class bitstate_table final
+  {
+  public:
+    bitstate_table(size_t size, unsigned k)
+      : size_(size ? size : 1), k_(k ? k : 1)
+    {
+      slots_ = size_ * 4;
+      h_ = new unsigned char[size_];
+      memset(h_, 0, size_);
+    }
+
+    ~bitstate_table()
+    {
+      delete[] h_;
+    }
+
+    bitstate_table(const bitstate_table&) = delete;
+    bitstate_table& operator=(const bitstate_table&) = delete;
+
+    unsigned
+    get(size_t hash) const
+    {
+      unsigned res = 3;
+      size_t step;
+      mix(hash, step);
+      for (unsigned i = 0; i < k_ && res; ++i, hash += step)
+        {
+          size_t s = hash % slots_;
+          unsigned c = (h_[s / 4] >> ((s % 4) * 2)) & 3U;
+          if (c < res)
+            res = c;
+        }
+      return res;
+    }
+
+    void
+    set(size_t hash, unsigned c)
+    {
+      size_t step;
+      mix(hash, step);
+      for (unsigned i = 0; i < k_; ++i, hash += step)
+        {
+          size_t s = hash % slots_;
+          unsigned char* b = h_ + s / 4;
+          unsigned o = (s % 4) * 2;
+          unsigned old = (*b >> o) & 3U;
+          if (old >= c)
+            continue;
+          if (!old)
+            ++used_;
+          *b = (*b & ~(3U << o)) | (c << o);
+        }
+    }
+
+    // Called for each new state.
+    void
+    new_state()
+    {
+      ++states_;
+      double f = static_cast<double>(used_) / slots_;
+      double p = f;
+      for (unsigned i = 1; i < k_; ++i)
+        p *= f;
+      // Before the next new state is found, p/(1-p) states are
+      // expected to be missed.
+      if (p < 1)
+        missed_ += p / (1 - p);
+    }
+
+    // The estimated ratio of the states visited to the states
+    // reachable.
+    double
+    coverage() const
+    {
+      if (!states_)
+        return 1;
+      return states_ / (states_ + missed_);
+    }
+
+    void
+    print_stats(std::ostream& os) const
+    {
+      os << size_ << " bytes used for bit-state hashing with "
+         << k_ << " hash function" << (k_ > 1 ? "s" : "") << '\n';
+      os << used_ * 100.0 / slots_ << "% of the slots used\n";
+      os << coverage() * 100 << "% estimated coverage\n";
+    }
+
+  private:
+    // The hash values of states are not always well distributed
+    // (e.g., they can be addresses), so mix them before computing
+    // the first slot and the distance between slots.
+    static void
+    mix(size_t& hash, size_t& step)
+    {
+      hash = wang32_hash(hash);
+      step = wang32_hash(hash ^ 0x9e3779b9U) | 1;
+    }
+
+    size_t size_;
+    size_t slots_;
+    unsigned k_;
+    unsigned char* h_;
+    size_t used_ = 0;
+    double states_ = 0;
+    double missed_ = 0;
+  };
+}
@@ -24,6 +24,7 @@
 #include <spot/twaalgos/bfssteps.hh>
 #include <spot/twaalgos/emptiness.hh>
 #include <spot/twaalgos/emptiness_stats.hh>
+#include <spot/twaalgos/twaiteration.hxx>
 
 #include <stack>
 
@@ -31,235 +32,6 @@ namespace spot
 {
   namespace
   {
-    using explicit_iterator = twa_graph::graph_t::const_iterator;
-
-    // A proxy class that allows to manipulate an iterator from the
-    // explicit interface as an iterator from the abstract interface.
-    class explicitproxy
-    {
-    public:
-      explicitproxy(explicit_iterator it)
-        : it_(it)
-      {}
-
-      const explicitproxy*
-      operator->() const
-      {
-        return this;
-      }
-
-      explicitproxy*
-      operator->()
-      {
-        return this;
-      }
-
-      bool
-      done() const
-      {
-        return !it_;
-      }
-
-      unsigned
-      dst() const
-      {
-        return it_->dst;
-      }
-
-      acc_cond::mark_t
-      acc() const
-      {
-        return it_->acc;
-      }
-
-      void
-      next()
-      {
-        ++it_;
-      }
-
-    private:
-      explicit_iterator it_;
-    };
-
-    template<bool is_explicit>
-    class twa_iteration
-    {
-    };
-
-    template<>
-    class twa_iteration<false>
-    {
-    public:
-      using state_t = const state*;
-      using iterator_t = twa_succ_iterator*;
-      template<class val>
-      using state_map = state_map<val>;
-
-      template<class val>
-      static
-      std::pair<std::pair<state_t, val>, bool>
-      h_emplace(state_map<val>& h, state_t s, val i)
-      {
-        auto p = h.emplace(s, i);
-        return std::make_pair(*p.first, p.second);
-      }
-
-      static
-      std::pair<state_t, int>
-      h_find(const state_map<int>& h, state_t s)
-      {
-        auto p = h.find(s);
-        if (p == h.end())
-          return std::make_pair(nullptr, 0);
-        else
-          return std::make_pair(p->first, p->second);
-      }
-
-      static
-      unsigned
-      h_count(const state_map<int>& h, const std::function<bool(int)>& p)
-      {
-        unsigned count = 0;
-        for (auto i : h)
-          if (p(i.second))
-            ++count;
-        return count;
-      }
-
-      static
-      state_t
-      initial_state(const const_twa_ptr& twa_p)
-      {
-        return twa_p->get_init_state();
-      }
-
-      static
-      iterator_t
-      succ(const const_twa_ptr& twa_p, state_t s)
-      {
-        auto res = twa_p->succ_iter(s);
-        res->first();
-        return res;
-      }
-
-      static
-      void
-      destroy(state_t s)
-      {
-        s->destroy();
-      }
-
-      static
-      const state*
-      to_state(const const_twa_ptr&, state_t s)
-      {
-        return s;
-      }
-
-      static
-      state_t
-      from_state(const const_twa_ptr&, const state* s)
-      {
-        return s;
-      }
-
-      static
-      void
-      it_destroy(const const_twa_ptr& twa_p, iterator_t it)
-      {
-        twa_p->release_iter(it);
-      }
-    };
-
-    template<>
-    class twa_iteration<true>
-    {
-    public:
-      using state_t = unsigned;
-      using iterator_t = explicitproxy;
-      template<class val>
-      using state_map = std::vector<val>;
-
-      template<class val>
-      static
-      std::pair<std::pair<state_t, val>, bool>
-      h_emplace(state_map<val>& h, state_t s, val i)
-      {
-        if (h[s] == val())
-        {
-          h[s] = i;
-          return std::make_pair(std::make_pair(s, h[s]), true);
-        }
-        else
-        {
-          return std::make_pair(std::make_pair(s, h[s]), false);
-        }
-      }
-
-      static
-      std::pair<state_t, int>
-      h_find(const state_map<int>& h, state_t s)
-      {
-        assert(s < h.size());
-        return std::make_pair(s, h[s]);
-      }
-
-      static
-      unsigned
-      h_count(const state_map<int>& h, const std::function<bool(int)>& p)
-      {
-        unsigned count = 0;
-        for (auto i : h)
-          if (p(i))
-            ++count;
-        return count;
-      }
-
-      static
-      state_t
-      initial_state(const const_twa_graph_ptr& twa_p)
-      {
-        if (!twa_p->is_existential())
-          throw std::runtime_error
-            ("couvreur99_new does not support alternation");
-        return twa_p->get_init_state_number();
-      }
-
-      static
-      iterator_t
-      succ(const const_twa_graph_ptr& twa_p, state_t s)
-      {
-        return explicitproxy(twa_p->out(s).begin());
-      }
-
-      static
-      const state*
-      to_state(const const_twa_graph_ptr& twa_p, state_t s)
-      {
-        return twa_p->state_from_number(s);
-      }
-
-      static
-      state_t
-      from_state(const const_twa_graph_ptr& twa_p, const state* s)
-      {
-        return twa_p->state_number(s);
-      }
-
-      static
-      void
-      destroy(state_t)
-      {
-      }
-
-      static
-      void
-      it_destroy(const const_twa_ptr&, iterator_t)
-      {
-      }
-    };
-
     // A simple struct representing an SCC.
     struct scc
     {
@@ -269,11 +41,6 @@ namespace spot
       acc_cond::mark_t condition;
     };
 
-    template<bool is_explicit>
-    using automaton_ptr = typename std::conditional<is_explicit,
-                                                    const_twa_graph_ptr,
-                                                    const_twa_ptr>::type;
-
     // The status of the emptiness-check on success.
     // It contains everyting needed to build a counter-example:
     // the automaton, the stack of SCCs traversed by the counter-example,
@@ -614,7 +381,7 @@ private:
           if (tag == BOOL)
             return res;
           else
-            return ecr;
+            return bool(ecr);
         }
         operator emptiness_check_result_ptr() const
         {
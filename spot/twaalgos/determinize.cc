@@ -18,15 +18,19 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
-#include <deque>
+#include <mutex>
 #include <stack>
+#include <thread>
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
 #include <set>
 #include <map>
 
 
 #include <spot/misc/bddlt.hh>
+#include <spot/misc/hash.hh>
+#include <spot/misc/hashfunc.hh>
 #include <spot/twaalgos/sccinfo.hh>
 #include <spot/twaalgos/determinize.hh>
 #include <spot/twaalgos/degen.hh>
@@ -46,6 +50,8 @@ namespace spot
                          std::vector<size_t>& nb_braces);
   }
 
+  struct safra_support;
+
   class safra_state final
   {
   public:
@@ -60,34 +66,23 @@ namespace spot
     // Printh the number of states in each brace
     safra_state(state_t state_number, bool init_state = false,
                 bool acceptance_scc = false);
-    // Given a certain transition_label, compute all the successors of that
-    // label, and return that new node.
-    void
-    compute_succs(const const_twa_graph_ptr& aut,
-                  succs_t& res,
-                  const scc_info& scc,
-                  const std::vector<bdd>& implications,
-                  const std::vector<bool>& is_connected,
-                  std::unordered_map<bdd, unsigned, bdd_hash>& bdd2num,
-                  std::vector<bdd>& all_bdds,
-                  bool use_scc,
-                  bool use_simulation,
-                  bool use_stutter) const;
-    // Compute successor for transition ap
-    safra_state
-    compute_succ(const const_twa_graph_ptr& aut,
-                 const bdd& ap,
-                 const scc_info& scc,
-                 const std::vector<bdd>& implications,
-                 const std::vector<bool>& is_connected,
-                 bool use_scc,
-                 bool use_simulation) const;
+    // Compute the successors of this state for all letters at once,
+    // and append them to RES in the order of the letters.
+    void compute_succs(const safra_support& sup, succs_t& res) const;
+    // Compute successor for letter LETTER
+    safra_state compute_succ(const safra_support& sup,
+                             bdd_id_t letter) const;
+    // Add to this successor the node reached from node SRC (with
+    // braces BRACES) by edge T.
+    void add_succ(const safra_support& sup, state_t src,
+                  const std::vector<node_helper::brace_t>& braces,
+                  const twa_graph::edge_storage_t& t);
+    // Called once all the nodes of a successor have been added.
+    void complete_succ(const safra_support& sup);
     // The outermost brace of each node cannot be green
     void ungreenify_last_brace();
     // When a nodes a implies a node b, remove the node a.
-    void merge_redundant_states(const std::vector<bdd>& implications,
-                                const scc_info& scc,
-                                const std::vector<bool>& is_connected);
+    void merge_redundant_states(const safra_support& sup);
     // Used when creating the list of successors
     // A new intermediate node is created with  src's braces and with dst as id
     // A merge is done if dst already existed in *this
@@ -107,9 +102,181 @@ namespace spot
     color_t color_;
   };
 
+  // Everything needed to compute the successors of a safra_state.
+  // Edge labels are replaced by sets of letters, so that successors
+  // can be computed by several threads.  The only BDD operations left
+  // are the implications between states checked by is_redundant().
+  struct safra_support
+  {
+    safra_support(const const_twa_graph_ptr& a, const scc_info& si)
+      : aut(a), scc(si)
+    {
+    }
+
+    const_twa_graph_ptr aut;
+    const scc_info& scc;
+    // The letters of edge number e are letters[edge_letters[e].first]
+    // to letters[edge_letters[e].second - 1], in increasing order.
+    std::vector<safra_state::bdd_id_t> letters;
+    std::vector<std::pair<unsigned, unsigned>> edge_letters;
+    unsigned nb_letters = 0;
+    // With use_simulation, the implications between the states of
+    // aut, and whether there is a path between two of its SCCs.
+    std::vector<bdd> implications;
+    std::vector<bool> is_connected;
+    bool use_scc = false;
+    bool use_simulation = false;
+    bool use_stutter = false;
+
+    // Whether the node of state s1 can be removed from a Safra tree
+    // that contains s2.  Only the pairs of states that appear
+    // together in some tree are checked, and the answers are kept,
+    // in a matrix for small automata, and in a hash table otherwise.
+    // The lock serializes the BDD operations of several threads.
+    bool is_redundant(unsigned s1, unsigned s2) const
+    {
+      std::lock_guard<std::mutex> lock(redundant_mutex_);
+      size_t n = aut->num_states();
+      if (n <= max_matrix_states)
+        {
+          if (redundant_matrix_.empty())
+            redundant_matrix_.resize(n * n, unknown);
+          char& r = redundant_matrix_[n * s1 + s2];
+          if (r == unknown)
+            r = check_redundant(s1, s2);
+          return r;
+        }
+      auto p = redundant_.emplace(std::make_pair(s1, s2), false);
+      if (p.second)
+        p.first->second = check_redundant(s1, s2);
+      return p.first->second;
+    }
+
+  private:
+    bool check_redundant(unsigned s1, unsigned s2) const
+    {
+      // Is there a path from the SCC of s2 to that of s1?
+      size_t idx = size_t(scc.scc_count()) * scc.scc_of(s2) + scc.scc_of(s1);
+      return !is_connected[idx]
+        && bdd_implies(implications[s1], implications[s2]);
+    }
+
+    enum { max_matrix_states = 1024, unknown = 2 };
+    mutable std::vector<char> redundant_matrix_;
+    mutable std::unordered_map<std::pair<unsigned, unsigned>, bool,
+                               pair_hash> redundant_;
+    mutable std::mutex redundant_mutex_;
+  };
+
   namespace
   {
-    using power_set = std::map<safra_state, int>;
+    // All the safra_states built by tgba_determinize(), each stored
+    // once in a flat array, and numbered in the order they are added.
+    // A state is encoded as its number of nodes, followed, for each
+    // node in increasing order, by the node, its number of braces,
+    // and its braces.
+    class safra_store final
+    {
+    public:
+      safra_store()
+        : table_(1024, hasher{this}, equal{this})
+      {
+      }
+
+      safra_store(const safra_store&) = delete;
+      safra_store& operator=(const safra_store&) = delete;
+
+      // Return the number of SS, and whether it has just been added.
+      std::pair<unsigned, bool>
+      insert(const safra_state& ss)
+      {
+        unsigned n = size();
+        data_.emplace_back(ss.nodes_.size());
+        for (auto& node: ss.nodes_)
+          {
+            data_.emplace_back(node.first);
+            data_.emplace_back(node.second.size());
+            data_.insert(data_.end(), node.second.begin(), node.second.end());
+          }
+        begin_.emplace_back(data_.size());
+        auto p = table_.insert(n);
+        if (!p.second)
+          {
+            begin_.pop_back();
+            data_.resize(begin_.back());
+          }
+        return {*p.first, p.second};
+      }
+
+      // Rebuild state number N.  This can be called by several threads
+      // at once, as long as insert() is not called.
+      safra_state
+      get(unsigned n) const
+      {
+        safra_state ss(0);
+        const unsigned* p = data_.data() + begin_[n];
+        unsigned nodes = *p++;
+        auto hint = ss.nodes_.end();
+        for (unsigned i = 0; i < nodes; ++i)
+          {
+            unsigned s = *p++;
+            unsigned nb = *p++;
+            hint = ss.nodes_.emplace_hint(hint, s,
+                                          std::vector<node_helper::brace_t>
+                                          (p, p + nb));
+            for (unsigned j = 0; j < nb; ++j, ++p)
+              {
+                if (*p >= ss.nb_braces_.size())
+                  ss.nb_braces_.resize(*p + 1, 0);
+                ++ss.nb_braces_[*p];
+              }
+          }
+        ss.is_green_.assign(ss.nb_braces_.size(), true);
+        ss.color_ = -1U;
+        return ss;
+      }
+
+      unsigned
+      size() const
+      {
+        return begin_.size() - 1;
+      }
+
+    private:
+      struct hasher
+      {
+        const safra_store* store;
+
+        size_t
+        operator()(unsigned n) const
+        {
+          size_t h = 0;
+          for (size_t i = store->begin_[n]; i < store->begin_[n + 1]; ++i)
+            h = wang32_hash(h ^ store->data_[i]);
+          return h;
+        }
+      };
+
+      struct equal
+      {
+        const safra_store* store;
+
+        bool
+        operator()(unsigned l, unsigned r) const
+        {
+          auto& b = store->begin_;
+          auto d = store->data_.begin();
+          return b[l + 1] - b[l] == b[r + 1] - b[r]
+            && std::equal(d + b[l], d + b[l + 1], d + b[r]);
+        }
+      };
+
+      std::vector<unsigned> data_;
+      // State n is encoded in data_[begin_[n]] to data_[begin_[n+1]-1].
+      std::vector<size_t> begin_ = { 0 };
+      std::unordered_set<unsigned, hasher, equal> table_;
+    };
+
     const char* const sub[10] =
       {
         "\u2080",
@@ -154,8 +321,10 @@ namespace spot
     // Used to remove all acceptance whos value is above and equal max_acc
     void remove_dead_acc(twa_graph_ptr& aut, unsigned max_acc)
     {
-      assert(max_acc < 32);
-      unsigned mask = (1 << max_acc) - 1;
+      assert(max_acc < acc_cond::mark_t::max_accsets());
+      acc_cond::mark_t mask = 0U;
+      for (unsigned i = 0; i < max_acc; ++i)
+        mask.set(i);
       for (auto& t: aut->edges())
         {
           t.acc &= mask;
@@ -235,11 +404,12 @@ namespace spot
     }
 
     std::vector<std::string>*
-    print_debug(std::map<safra_state, int>& states)
+    print_debug(const safra_store& states)
     {
-      auto res = new std::vector<std::string>(states.size());
-      for (auto& p: states)
-        (*res)[p.second] = nodes_to_string(p.first.nodes_);
+      unsigned n = states.size();
+      auto res = new std::vector<std::string>(n);
+      for (unsigned i = 0; i < n; ++i)
+        (*res)[i] = nodes_to_string(states.get(i).nodes_);
       return res;
     }
 
@@ -248,75 +418,86 @@ namespace spot
 
   std::vector<bool> find_scc_paths(const scc_info& scc);
 
+  void
+  safra_state::add_succ(const safra_support& sup, state_t src,
+                        const std::vector<node_helper::brace_t>& braces,
+                        const twa_graph::edge_storage_t& t)
+  {
+    // Check if we are leaving the SCC, if so we delete all the
+    // braces as no cycles can be found with that node
+    if (sup.use_scc && sup.scc.scc_of(src) != sup.scc.scc_of(t.dst))
+      if (sup.scc.is_accepting_scc(sup.scc.scc_of(t.dst)))
+        // Entering accepting SCC so add brace
+        update_succ({ /* no braces */ }, t.dst, { 0 });
+      else
+        // When entering non accepting SCC don't create any braces
+        update_succ({ /* no braces */ }, t.dst, { /* empty */ });
+    else
+      update_succ(braces, t.dst, t.acc);
+    assert(nb_braces_.size() == is_green_.size());
+  }
+
+  void
+  safra_state::complete_succ(const safra_support& sup)
+  {
+    if (sup.use_simulation)
+      merge_redundant_states(sup);
+    ungreenify_last_brace();
+    color_ = finalize_construction();
+  }
+
   safra_state
-  safra_state::compute_succ(const const_twa_graph_ptr& aut,
-                            const bdd& ap,
-                            const scc_info& scc,
-                            const std::vector<bdd>& implications,
-                            const std::vector<bool>& is_connected,
-                            bool use_scc,
-                            bool use_simulation) const
+  safra_state::compute_succ(const safra_support& sup,
+                            bdd_id_t letter) const
   {
     safra_state ss = safra_state(nb_braces_.size());
+    auto lb = sup.letters.begin();
     for (auto& node: nodes_)
-      {
-        for (auto& t: aut->out(node.first))
-          {
-            if (!bdd_implies(ap, t.cond))
-              continue;
-            // Check if we are leaving the SCC, if so we delete all the
-            // braces as no cycles can be found with that node
-            if (use_scc && scc.scc_of(node.first) != scc.scc_of(t.dst))
-              if (scc.is_accepting_scc(scc.scc_of(t.dst)))
-                // Entering accepting SCC so add brace
-                ss.update_succ({ /* no braces */ }, t.dst, { 0 });
-              else
-                // When entering non accepting SCC don't create any braces
-                ss.update_succ({ /* no braces */ }, t.dst, { /* empty */ });
-            else
-              ss.update_succ(node.second, t.dst, t.acc);
-            assert(ss.nb_braces_.size() == ss.is_green_.size());
-          }
-      }
-    if (use_simulation)
-      ss.merge_redundant_states(implications, scc, is_connected);
-    ss.ungreenify_last_brace();
-    ss.color_ = ss.finalize_construction();
+      for (auto& t: sup.aut->out(node.first))
+        {
+          auto& r = sup.edge_letters[sup.aut->get_graph().index_of_edge(t)];
+          if (std::binary_search(lb + r.first, lb + r.second, letter))
+            ss.add_succ(sup, node.first, node.second, t);
+        }
+    ss.complete_succ(sup);
     return ss;
   }
 
   void
-  safra_state::compute_succs(const const_twa_graph_ptr& aut,
-                             succs_t& res,
-                             const scc_info& scc,
-                             const std::vector<bdd>& implications,
-                             const std::vector<bool>& is_connected,
-                             std::unordered_map<bdd, unsigned, bdd_hash>&
-                             bdd2num,
-                             std::vector<bdd>& all_bdds,
-                             bool use_scc,
-                             bool use_simulation,
-                             bool use_stutter) const
+  safra_state::compute_succs(const safra_support& sup, succs_t& res) const
   {
-    for (auto& ap: all_bdds)
+    // Instead of looking for the edges compatible with each letter,
+    // dispatch each edge to the successors of all its letters.  The
+    // nodes of each successor are still added in the same order.
+    std::vector<safra_state> succs(sup.nb_letters,
+                                   safra_state(nb_braces_.size()));
+    for (auto& node: nodes_)
+      for (auto& t: sup.aut->out(node.first))
+        {
+          auto& r = sup.edge_letters[sup.aut->get_graph().index_of_edge(t)];
+          for (unsigned i = r.first; i < r.second; ++i)
+            succs[sup.letters[i]].add_succ(sup, node.first, node.second, t);
+        }
+
+    for (unsigned letter = 0; letter < sup.nb_letters; ++letter)
       {
-        safra_state ss = *this;
+        safra_state& ss = succs[letter];
+        ss.complete_succ(sup);
 
-        if (use_stutter && aut->prop_stutter_invariant())
+        if (sup.use_stutter)
           {
             std::vector<color_t> colors;
             unsigned int counter = 0;
             std::map<safra_state, unsigned int> safra2id;
-            bool stop = false;
-            while (!stop)
+            safra2id.insert({*this, counter++});
+            colors.emplace_back(ss.color_);
+            while (safra2id.find(ss) == safra2id.end())
               {
                 auto pair = safra2id.insert({ss, counter++});
                 // insert should never fail
                 assert(pair.second);
-                ss = ss.compute_succ(aut, ap, scc, implications, is_connected,
-                                     use_scc, use_simulation);
+                ss = ss.compute_succ(sup, letter);
                 colors.emplace_back(ss.color_);
-                stop = safra2id.find(ss) != safra2id.end();
               }
             // Add color of final transition that loops back
             colors.emplace_back(ss.color_);
@@ -328,18 +509,12 @@ namespace spot
               }
             ss.color_ = *std::min_element(colors.begin(), colors.end());
           }
-        else
-          ss = compute_succ(aut, ap, scc, implications, is_connected,
-                            use_scc, use_simulation);
-        unsigned bdd_idx = bdd2num[ap];
-        res.emplace_back(ss, bdd_idx);
+        res.emplace_back(std::move(ss), letter);
       }
   }
 
   void
-  safra_state::merge_redundant_states(const std::vector<bdd>& implications,
-                                      const scc_info& scc,
-                                      const std::vector<bool>& is_connected)
+  safra_state::merge_redundant_states(const safra_support& sup)
   {
     std::vector<int> to_remove;
     for (auto& n1: nodes_)
@@ -347,11 +522,7 @@ namespace spot
         {
           if (n1 == n2)
             continue;
-          // index to see if there is a path from scc2 -> scc1
-          unsigned idx = scc.scc_count() * scc.scc_of(n2.first) +
-            scc.scc_of(n1.first);
-          if (!is_connected[idx] && bdd_implies(implications.at(n1.first),
-                                                implications.at(n2.first)))
+          if (sup.is_redundant(n1.first, n2.first))
             to_remove.emplace_back(n1.first);
         }
     for (auto& n: to_remove)
@@ -577,7 +748,8 @@ namespace spot
   twa_graph_ptr
   tgba_determinize(const const_twa_graph_ptr& a,
                    bool pretty_print, bool use_scc,
-                   bool use_simulation, bool use_stutter)
+                   bool use_simulation, bool use_stutter,
+                   unsigned threads)
   {
     if (!a->is_existential())
       throw std::runtime_error
@@ -594,7 +766,17 @@ namespace spot
         aut = simulation(aut, &implications);
       }
     scc_info scc = scc_info(aut);
-    std::vector<bool> is_connected = find_scc_paths(scc);
+
+    safra_support support(aut, scc);
+    support.use_scc = use_scc;
+    support.use_simulation = use_simulation;
+    support.use_stutter =
+      use_stutter && aut->prop_stutter_invariant().is_true();
+    if (use_simulation)
+      {
+        support.implications = std::move(implications);
+        support.is_connected = find_scc_paths(scc);
+      }
 
     bdd allap = bddtrue;
     {
@@ -611,17 +793,16 @@ namespace spot
     // Used to convert atomic bdd to id
     std::unordered_map<bdd, unsigned, bdd_hash> bdd2num;
     std::vector<bdd> num2bdd;
-    // Nedded for compute succs
-    // Used to convert large bdd to indexes
+    // Used to convert large bdd to ranges of letters
     std::unordered_map<bdd, std::pair<unsigned, unsigned>, bdd_hash> deltas;
-    std::vector<safra_state::bdd_id_t> bddnums;
+    support.edge_letters.resize(aut->edge_vector().size());
     for (auto& t: aut->edges())
       {
         auto it = deltas.find(t.cond);
         if (it == deltas.end())
           {
             bdd all = t.cond;
-            unsigned prev = bddnums.size();
+            unsigned prev = support.letters.size();
             while (all != bddfalse)
               {
                 bdd one = bdd_satoneset(all, allap, bddfalse);
@@ -629,11 +810,16 @@ namespace spot
                 auto p = bdd2num.emplace(one, num2bdd.size());
                 if (p.second)
                   num2bdd.emplace_back(one);
-                bddnums.emplace_back(p.first->second);
+                support.letters.emplace_back(p.first->second);
               }
-            deltas[t.cond] = std::make_pair(prev, bddnums.size());
+            std::sort(support.letters.begin() + prev, support.letters.end());
+            it = deltas.emplace(t.cond, std::make_pair(prev,
+                                                       support.letters.size()))
+              .first;
           }
+        support.edge_letters[aut->get_graph().index_of_edge(t)] = it->second;
       }
+    support.nb_letters = num2bdd.size();
 
     auto res = make_twa_graph(aut->get_dict());
     res->copy_ap_of(aut);
@@ -644,58 +830,82 @@ namespace spot
                        true // stutter inv
                        });
 
-    // Given a safra_state get its associated state in output automata.
-    // Required to create new edges from 2 safra-state
-    power_set seen;
+    // Safra states are numbered as the states of the output automaton.
+    safra_store seen;
     auto init_state = aut->get_init_state_number();
     bool start_accepting =
       !use_scc || scc.is_accepting_scc(scc.scc_of(init_state));
     safra_state init(init_state, true, start_accepting);
     unsigned num = res->new_state();
     res->set_init_state(num);
-    seen.insert(std::make_pair(init, num));
-    std::deque<safra_state> todo;
-    todo.emplace_back(init);
+    seen.insert(init);
     unsigned sets = 0;
+
+    // States are processed in the order they are created.  The
+    // successors of a batch of states of the frontier are computed
+    // (by several threads if the batch is large enough), and then
+    // numbered in order, so that the output does not depend on the
+    // number of threads.
+    if (threads == 0)
+      threads = std::max(1U, std::thread::hardware_concurrency());
+    unsigned max_batch = threads > 1 ? 64 * threads : 1;
     using succs_t = safra_state::succs_t;
-    succs_t succs;
-    while (!todo.empty())
+    std::vector<succs_t> batch;
+    for (unsigned src_num = 0; src_num < seen.size();)
       {
-        safra_state curr = todo.front();
-        unsigned src_num = seen.find(curr)->second;
-        todo.pop_front();
-        curr.compute_succs(aut, succs, scc, implications, is_connected,
-                           bdd2num, num2bdd, use_scc, use_simulation,
-                           use_stutter);
-        for (auto s: succs)
+        unsigned size = std::min(seen.size() - src_num, max_batch);
+        batch.resize(size);
+        unsigned nthreads = std::min(threads, size / 16);
+        if (nthreads > 1)
           {
-            // Don't construct sink state as complete does a better job at this
-            if (s.first.nodes_.empty())
-              continue;
-            auto i = seen.find(s.first);
-            unsigned dst_num;
-            if (i != seen.end())
-              {
-                dst_num = i->second;
-              }
-            else
+            auto worker = [&](unsigned i)
               {
-                dst_num = res->new_state();
-                todo.emplace_back(s.first);
-                seen.insert(std::make_pair(s.first, dst_num));
-              }
-            if (s.first.color_ != -1U)
+                for (unsigned j = i; j < size; j += nthreads)
+                  seen.get(src_num + j).compute_succs(support, batch[j]);
+              };
+            std::vector<std::thread> workers;
+            workers.reserve(nthreads - 1);
+            for (unsigned i = 1; i < nthreads; ++i)
+              workers.emplace_back(worker, i);
+            worker(0);
+            for (auto& w: workers)
+              w.join();
+          }
+        else
+          {
+            for (unsigned j = 0; j < size; ++j)
+              seen.get(src_num + j).compute_succs(support, batch[j]);
+          }
+
+        for (unsigned j = 0; j < size; ++j, ++src_num)
+          {
+            for (auto& s: batch[j])
               {
-                res->new_edge(src_num, dst_num, num2bdd[s.second],
-                              {s.first.color_});
-                // We only care about green acc which are odd
-                if (s.first.color_ % 2 == 1)
-                  sets = std::max(s.first.color_ + 1, sets);
+                // Don't construct sink state as complete does a
+                // better job at this
+                if (s.first.nodes_.empty())
+                  continue;
+                auto p = seen.insert(s.first);
+                unsigned dst_num = p.first;
+                if (p.second)
+                  {
+                    unsigned n = res->new_state();
+                    assert(n == dst_num);
+                    (void)n;
+                  }
+                if (s.first.color_ != -1U)
+                  {
+                    res->new_edge(src_num, dst_num, num2bdd[s.second],
+                                  {s.first.color_});
+                    // We only care about green acc which are odd
+                    if (s.first.color_ % 2 == 1)
+                      sets = std::max(s.first.color_ + 1, sets);
+                  }
+                else
+                  res->new_edge(src_num, dst_num, num2bdd[s.second]);
               }
-            else
-              res->new_edge(src_num, dst_num, num2bdd[s.second]);
+            batch[j].clear();
           }
-        succs.clear();
       }
     remove_dead_acc(res, sets);
     // Acceptance is now min(odd) since we con emit Red on paths 0 with new opti
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2015, 2016 Laboratoire de Recherche et Développement
+// Copyright (C) 2015, 2016, 2017 Laboratoire de Recherche et Développement
 // de l'Epita.
 //
 // This file is part of Spot, a model checking library.
@@ -72,10 +72,17 @@ namespace spot
   ///                    might be worth to call
   ///                    spot::check_stutter_invariance() first if
   ///                    possible.)
+  ///
+  /// \param threads the number of threads used to compute the
+  ///                successors of the states of the frontier.  The
+  ///                default is to use only the calling thread, and 0
+  ///                means one per hardware thread.  The output does
+  ///                not depend on this number.
   SPOT_API twa_graph_ptr
   tgba_determinize(const const_twa_graph_ptr& aut,
                    bool pretty_print = false,
                    bool use_scc = true,
                    bool use_simulation = true,
-                   bool use_stutter = true);
+                   bool use_stutter = true,
+                   unsigned threads = 1);
 }
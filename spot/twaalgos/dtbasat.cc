@@ -776,12 +776,18 @@ namespace spot
       {
         trace << "UNSAT\n";
         max = target;
+        // Larger targets are UNSAT as well.  Recording this as a
+        // clause lets the solver keep what it has learned about this
+        // target for the next ones.
+        solver.add({-(d.nvars + target), 0});
       }
       else
       {
         trace << "SAT\n";
         res = sat_build(solution.second, d, prev, state_based);
         min = d.cand_size - stats_reachable(res).states + 1;
+        // We only look for smaller automata from now on.
+        solver.add({d.nvars + target, 0});
       }
     }
 
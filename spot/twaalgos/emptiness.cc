@@ -32,6 +32,7 @@
 #include <spot/twaalgos/se05.hh>
 #include <spot/twaalgos/tau03.hh>
 #include <spot/twaalgos/tau03opt.hh>
+#include <spot/twaalgos/ufscc.hh>
 #include <spot/twa/bddprint.hh>
 #include <spot/twaalgos/product.hh>
 
@@ -137,6 +138,7 @@ namespace spot
         { "SE05",      se05,                          0,   1 },
         { "Tau03",     explicit_tau03_search,         1, -1U },
         { "Tau03_opt", explicit_tau03_opt_search,     0, -1U },
+        { "UFSCC",     ufscc_check,                   0, -1U },
       };
   }
 
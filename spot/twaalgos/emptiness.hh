@@ -294,40 +294,45 @@ namespace spot
   ///   Cou99(poprem shy group)
   ///   \endcode
   ///
-  /// - `GC04` uses `spot::explicit_gv04_check()` and works on automata
+  /// - `GV04` uses `spot::explicit_gv04_check()` and works on automata
   ///   with Fin-less acceptance conditions using at most one acceptance
-  ///   set.  No options are supported.
+  ///   set.  The only option is `graph` (see below).
   ///
-  ///   Example:
+  ///   Examples:
   ///   \code
-  ///   GC04
+  ///   GV04
+  ///   GV04(graph=0)
   ///   \endcode
   ///
   /// - `CVWY90` uses `spot::magic_search()` and work on automata with
   ///   Fin-less acceptance conditions using at most one acceptance
-  ///   set.  Set option `bsh` to the size of a hash-table if you want
-  ///   to activate bit-state hashing.
+  ///   set.  Set option `bsh` to the size of a hash-table (in bytes)
+  ///   if you want to activate bit-state hashing, and option `k` to
+  ///   the number of hash functions used for each state (1 by
+  ///   default).  With bit-state hashing, print_stats() displays an
+  ///   estimate of the fraction of the state space that was covered.
   ///
   ///   Examples:
   ///   \code
   ///   CVWY90
   ///   CVWY90(bsh=4M)
+  ///   CVWY90(bsh=512M,k=3)
   ///   \endcode
   ///
   /// - `SE05` uses `spot::se05()` and works on work on automata with
   ///   Fin-less acceptance conditions using at most one acceptance
-  ///   set.  Set option `bsh` to the size of a hash-table if you want
-  ///   to activate bit-state hashing.
+  ///   set.  It supports the same `bsh` and `k` options as `CVWY90`.
   ///
   ///   Examples:
   ///   \code
   ///   SE05
   ///   SE05(bsh=4M)
+  ///   SE05(bsh=512M,k=3)
   ///   \endcode
   ///
   /// - `Tau03` uses `spot::explicit_tau03_search()` and work on automata with
   ///   Fin-less acceptance conditions using at least one acceptance
-  ///   set.  No options are supported.
+  ///   set.  The only option is `graph` (see below).
   ///
   ///   Example:
   ///   \code
@@ -358,6 +363,28 @@ namespace spot
   ///   Tau03_opt(condstack !weights)
   ///   Tau03_opt(condstack !redweights)
   ///   \endcode
+  ///
+  /// - `UFSCC` uses `spot::ufscc_check()` and works on automata with
+  ///   any Fin-less acceptance.  It runs several threads that share
+  ///   a union-find structure.  The following options are supported:
+  ///   - `threads` The number of threads to use.  The default (0)
+  ///     uses as many threads as the hardware supports.
+  ///   - `seed` The seed used to randomize the order in which each
+  ///     thread explores the successors of a state.
+  ///
+  ///   Example:
+  ///   \code
+  ///   UFSCC
+  ///   UFSCC(threads=4)
+  ///   UFSCC(threads=8 seed=42)
+  ///   \endcode
+  ///
+  /// When `GV04`, `Tau03`, or `CVWY90` and `SE05` without bit-state
+  /// hashing, are given a spot::twa_graph, they iterate directly over
+  /// its state numbers and edges instead of going through the
+  /// abstract spot::state and spot::twa_succ_iterator interface.
+  /// Setting option `graph=0` disables this specialization, which is
+  /// only useful to measure its effect.
   SPOT_API emptiness_check_instantiator_ptr
   make_emptiness_check_instantiator(const char* name, const char** err);
 
@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2008, 2010, 2011, 2013, 2014, 2015, 2016 Laboratoire de
-// recherche et développement de l'Epita (LRDE).
+// Copyright (C) 2008, 2010, 2011, 2013, 2014, 2015, 2016, 2017
+// Laboratoire de recherche et développement de l'Epita (LRDE).
 // Copyright (C) 2004, 2005 Laboratoire d'Informatique de Paris 6
 // (LIP6), département Systèmes Répartis Coopératifs (SRC), Université
 // Pierre et Marie Curie.
@@ -38,24 +38,65 @@
 #include <spot/twaalgos/emptiness_stats.hh>
 #include <spot/twaalgos/gv04.hh>
 #include <spot/twaalgos/bfssteps.hh>
+#include <spot/twaalgos/twaiteration.hxx>
 
 namespace spot
 {
   namespace
   {
-    struct stack_entry
+    // Release the states stored in the map of visited states.
+    void
+    release_states(state_map<int>& h)
     {
-      const state* s;                  // State stored in stack entry.
-      twa_succ_iterator* lasttr; // Last transition explored from this state.
-      int lowlink;                  // Lowlink value if this entry.
-      int pre;                          // DFS predecessor.
-      int acc;                          // Accepting state link.
-    };
+      auto s = h.begin();
+      while (s != h.end())
+        {
+          // Advance the iterator before deleting the "key" pointer.
+          const state* ptr = s->first;
+          ++s;
+          ptr->destroy();
+        }
+    }
+
+    void
+    release_states(std::vector<int>&)
+    {
+    }
 
+    void
+    init_states(state_map<int>&, const const_twa_ptr&)
+    {
+    }
+
+    void
+    init_states(std::vector<int>& h, const const_twa_graph_ptr& a)
+    {
+      h.resize(a->num_states(), 0);
+    }
+
+    // When is_explicit is set, the automaton is a twa_graph whose
+    // states and edges are accessed directly by their numbers.
+    template<bool is_explicit>
     struct gv04: public emptiness_check, public ec_statistics
     {
-      // Map of visited states.
-      state_map<size_t> h;
+      using T = twa_iteration<is_explicit>;
+      using state_t = typename T::state_t;
+
+      struct stack_entry
+      {
+        state_t s;                  // State stored in stack entry.
+        typename T::iterator_t lasttr; // Last transition explored.
+        bool started;               // Whether lasttr has been explored.
+        int lowlink;                  // Lowlink value if this entry.
+        int pre;                          // DFS predecessor.
+        int acc;                          // Accepting state link.
+      };
+
+      automaton_ptr<is_explicit> aut_;
+
+      // Map of visited states to their position on the stack plus
+      // one (0 for unvisited states).
+      typename T::template state_map<int> h;
 
       // Stack of visited states on the path.
       std::vector<stack_entry> stack;
@@ -64,24 +105,18 @@ namespace spot
       int dftop;                // Top of DFS stack.
       bool violation;                // Whether an accepting run was found.
 
-      gv04(const const_twa_ptr& a, option_map o)
-        : emptiness_check(a, o)
+      gv04(const automaton_ptr<is_explicit>& a, option_map o)
+        : emptiness_check(a, o), aut_(a)
       {
         assert(a->num_sets() <= 1);
+        init_states(h, a);
       }
 
       ~gv04()
       {
         for (auto i: stack)
-          a_->release_iter(i.lasttr);
-        auto s = h.begin();
-        while (s != h.end())
-          {
-            // Advance the iterator before deleting the "key" pointer.
-            const state* ptr = s->first;
-            ++s;
-            ptr->destroy();
-          }
+          T::it_destroy(aut_, i.lasttr);
+        release_states(h);
       }
 
       virtual emptiness_check_result_ptr
@@ -89,60 +124,56 @@ namespace spot
       {
         top = dftop = -1;
         violation = false;
-        push(a_->get_init_state(), false);
+        push(T::initial_state(aut_), false);
 
         while (!violation && dftop >= 0)
           {
             trace << "Main iteration (top = " << top
                   << ", dftop = " << dftop
-                  << ", s = " << a_->format_state(stack[dftop].s)
+                  << ", s = "
+                  << a_->format_state(T::to_state(aut_, stack[dftop].s))
                   << ')' << std::endl;
 
-            twa_succ_iterator* iter = stack[dftop].lasttr;
-            bool cont;
-            if (!iter)
-              {
-                iter = stack[dftop].lasttr = a_->succ_iter(stack[dftop].s);
-                cont = iter->first();
-              }
+            auto& iter = stack[dftop].lasttr;
+            if (stack[dftop].started)
+              iter->next();
             else
-              {
-                cont = iter->next();
-              }
+              stack[dftop].started = true;
 
-            if (!cont)
+            if (iter->done())
               {
                 trace << " No more successors" << std::endl;
                 pop();
               }
             else
               {
-                const state* s_prime = iter->dst();
+                state_t s_prime = iter->dst();
                 bool acc =
                   a_->acc().accepting(iter->acc());
                 inc_transitions();
 
                 trace << " Next successor: s_prime = "
-                      << a_->format_state(s_prime)
+                      << a_->format_state(T::to_state(aut_, s_prime))
                       << (acc ? " (with accepting link)" : "");
 
-                auto i = h.find(s_prime);
+                auto i = T::h_find(h, s_prime);
 
-                if (i == h.end())
+                if (!i.second)
                   {
                     trace << " is a new state." << std::endl;
                     push(s_prime, acc);
                   }
                 else
                   {
-                    if (i->second < stack.size()
-                        && stack[i->second].s->compare(s_prime) == 0)
+                    unsigned pos = i.second - 1;
+                    if (pos < stack.size()
+                        && T::same(stack[pos].s, s_prime))
                       {
                         // s_prime has a clone on stack
                         trace << " is on stack." << std::endl;
                         // This is an addition to GV04 to support TBA.
                         violation |= acc;
-                        lowlinkupdate(dftop, i->second);
+                        lowlinkupdate(dftop, pos);
                       }
                     else
                       {
@@ -150,10 +181,9 @@ namespace spot
                               << std::endl;
                       }
 
-                    s_prime->destroy();
+                    T::destroy(s_prime);
                   }
               }
-            set_states(h.size());
           }
         if (violation)
           return std::make_shared<result>(*this);
@@ -161,14 +191,16 @@ namespace spot
       }
 
       void
-      push(const state* s, bool accepting)
+      push(state_t s, bool accepting)
       {
-        trace << "  push(s = " << a_->format_state(s)
+        trace << "  push(s = " << a_->format_state(T::to_state(aut_, s))
               << ", accepting = " << accepting << ")\n";
 
-        h[s] = ++top;
+        ++top;
+        h[s] = top + 1;
+        inc_states();
 
-        stack_entry ss = { s, nullptr, top, dftop, 0 };
+        stack_entry ss = { s, T::succ(aut_, s), false, top, dftop, 0 };
 
         if (accepting)
           ss.acc = top - 1;        // This differs from GV04 to support TBA.
@@ -198,7 +230,7 @@ namespace spot
             assert(static_cast<unsigned int>(top + 1) == stack.size());
             for (int i = top; i >= dftop; --i)
               {
-                a_->release_iter(stack[i].lasttr);
+                T::it_destroy(aut_, stack[i].lasttr);
                 stack.pop_back();
                 dec_depth();
               }
@@ -228,7 +260,7 @@ namespace spot
       virtual std::ostream&
       print_stats(std::ostream& os) const override
       {
-        os << h.size() << " unique states visited\n";
+        os << states() << " unique states visited\n";
         os << transitions() << " transitions explored\n";
         os << max_depth() << " items max on stack\n";
         return os;
@@ -291,7 +323,8 @@ namespace spot
           for (int i = 0; i <= data.top; ++i)
             {
               trace << "state " << i << " ("
-                    << data.a_->format_state(data.stack[i].s)
+                    << data.a_->format_state(T::to_state(data.aut_,
+                                                         data.stack[i].s))
                     << ") has lowlink = " << data.stack[i].lowlink << std::endl;
             }
 #endif
@@ -308,7 +341,7 @@ namespace spot
             {
               twa_run::step st =
                 {
-                  data.stack[father].s->clone(),
+                  T::to_state(data.aut_, data.stack[father].s)->clone(),
                   data.stack[father].lasttr->cond(),
                   data.stack[father].lasttr->acc()
                 };
@@ -338,22 +371,23 @@ namespace spot
             filter(const state* s) override
             {
               // Do not escape the SCC
-              auto j = data.h.find(s);
+              auto j = T::h_find(data.h, T::from_state(data.aut_, s));
+              unsigned pos = j.second - 1;
               if (// This state was never visited so far.
-                  j == data.h.end()
+                  !j.second
                   // Or it was discarded
-                  || j->second >= data.stack.size()
+                  || pos >= data.stack.size()
                   // Or it was discarded (but its stack slot reused)
-                  || data.stack[j->second].s->compare(s)
+                  || !T::same(data.stack[pos].s, j.first)
                   // Or it is still on the stack but not in the SCC
-                  || data.stack[j->second].lowlink < scc_root)
+                  || data.stack[pos].lowlink < scc_root)
                 {
                   s->destroy();
                   return nullptr;
                 }
               r->inc_ars_cycle_states();
               s->destroy();
-              return j->first;
+              return T::to_state(data.aut_, j.first);
             }
 
             virtual bool
@@ -378,7 +412,8 @@ namespace spot
             }
           };
 
-          const state* bfs_start = data.stack[scc_root].s;
+          const state* bfs_start = T::to_state(data.aut_,
+                                               data.stack[scc_root].s);
           const state* bfs_end = bfs_start;
           if (a_->num_sets() > 0)
             {
@@ -406,6 +441,8 @@ namespace spot
   emptiness_check_ptr
   explicit_gv04_check(const const_twa_ptr& a, option_map o)
   {
-    return std::make_shared<gv04>(a, o);
+    if (auto ag = use_explicit_iteration(a, o))
+      return std::make_shared<gv04<true>>(ag, o);
+    return std::make_shared<gv04<false>>(a, o);
   }
 }
@@ -22,14 +22,18 @@
 
 #include <ostream>
 #include <sstream>
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <unistd.h>
 #include <spot/twa/twa.hh>
 #include <spot/twa/twagraph.hh>
 #include <spot/twaalgos/hoa.hh>
 #include <spot/twaalgos/reachiter.hh>
 #include <spot/misc/escape.hh>
-#include <spot/misc/bddlt.hh>
 #include <spot/misc/minato.hh>
 #include <spot/twa/formula2bdd.hh>
 #include <spot/tl/formula.hh>
@@ -39,10 +43,115 @@ namespace spot
 {
   namespace
   {
+    // Output buffer for print_hoa().  Integers and strings are
+    // formatted directly in the buffer, without the overhead of
+    // std::ostream, and the buffer is flushed either to an
+    // std::ostream or to a file descriptor.
+    class hoa_output final
+    {
+      std::ostream* os_;
+      int fd_;
+      std::unique_ptr<char[]> buf_;
+      size_t size_;
+      size_t len_ = 0;
+
+      void write_out(const char* data, size_t size)
+      {
+        if (os_)
+          {
+            os_->write(data, size);
+            return;
+          }
+        while (size)
+          {
+            ssize_t n = ::write(fd_, data, size);
+            if (n < 0)
+              {
+                if (errno == EINTR)
+                  continue;
+                throw std::runtime_error(std::string("print_hoa(): ")
+                                         + strerror(errno));
+              }
+            data += n;
+            size -= n;
+          }
+      }
+
+    public:
+      hoa_output(std::ostream& os, size_t size)
+        : os_(&os), fd_(-1), buf_(new char[size]), size_(size)
+      {
+      }
+
+      hoa_output(int fd, size_t size)
+        : os_(nullptr), fd_(fd), buf_(new char[size]), size_(size)
+      {
+      }
+
+      void flush()
+      {
+        write_out(buf_.get(), len_);
+        len_ = 0;
+      }
+
+      hoa_output& write(const char* data, size_t size)
+      {
+        if (len_ + size > size_)
+          {
+            flush();
+            if (size > size_)
+              {
+                write_out(data, size);
+                return *this;
+              }
+          }
+        memcpy(buf_.get() + len_, data, size);
+        len_ += size;
+        return *this;
+      }
+
+      hoa_output& operator<<(char c)
+      {
+        if (len_ == size_)
+          flush();
+        buf_[len_++] = c;
+        return *this;
+      }
+
+      hoa_output& operator<<(const char* str)
+      {
+        return write(str, strlen(str));
+      }
+
+      hoa_output& operator<<(const std::string& str)
+      {
+        return write(str.data(), str.size());
+      }
+
+      hoa_output& operator<<(unsigned v)
+      {
+        char tmp[10];
+        char* end = tmp + sizeof tmp;
+        char* p = end;
+        do
+          *--p = '0' + v % 10;
+        while (v /= 10);
+        return write(p, end - p);
+      }
+
+      hoa_output& operator<<(int v)
+      {
+        if (v < 0)
+          return *this << '-' << (0U - static_cast<unsigned>(v));
+        return *this << static_cast<unsigned>(v);
+      }
+    };
+
     struct metadata final
     {
-      // Assign a number to each atomic proposition.
-      typedef std::map<int, unsigned> ap_map;
+      // Assign a number to each atomic proposition, indexed by BDD
+      // variable.
+      typedef std::vector<unsigned> ap_map;
       ap_map ap;
       typedef std::vector<int> vap_t;
       vap_t vap;
@@ -57,8 +166,8 @@ namespace spot
       bdd all_ap;
 
       // Label support: the set of all conditions occurring in the
-      // automaton.
-      typedef std::map<bdd, std::string, bdd_less_than> sup_map;
+      // automaton, indexed by BDD id, with their formatted labels.
+      typedef std::unordered_map<int, std::pair<bdd, std::string>> sup_map;
       sup_map sup;
 
       metadata(const const_twa_graph_ptr& aut, bool implicit,
@@ -70,8 +179,15 @@ namespace spot
         number_all_ap(aut);
       }
 
-      std::ostream&
-      emit_acc(std::ostream& os, acc_cond::mark_t b)
+      const std::string& label(const bdd& cond) const
+      {
+        auto i = sup.find(cond.id());
+        assert(i != sup.end());
+        return i->second.second;
+      }
+
+      hoa_output&
+      emit_acc(hoa_output& os, acc_cond::mark_t b)
       {
         // FIXME: We could use a cache for this.
         if (b == 0U)
@@ -124,7 +240,7 @@ namespace spot
                     else
                       available -= t.cond;
                   }
-                sup.insert(std::make_pair(t.cond, empty));
+                sup.emplace(t.cond.id(), std::make_pair(t.cond, empty));
                 if (st_acc)
                   {
                     if (notfirst && prev != t.acc)
@@ -174,7 +290,7 @@ namespace spot
         // exception rather than using an assert().
         bdd all = bddtrue;
         for (auto& i: sup)
-          all &= bdd_support(i.first);
+          all &= bdd_support(i.second.first);
         all_ap = aut->ap_vars();
         if (bdd_exist(all, all_ap) != bddtrue)
           throw std::runtime_error("print_hoa(): automaton uses "
@@ -185,7 +301,9 @@ namespace spot
           {
             int v = bdd_var(all);
             all = bdd_high(all);
-            ap.insert(std::make_pair(v, vap.size()));
+            if (ap.size() <= static_cast<unsigned>(v))
+              ap.resize(v + 1);
+            ap[v] = vap.size();
             vap.emplace_back(v);
           }
 
@@ -194,18 +312,18 @@ namespace spot
 
         for (auto& i: sup)
           {
-            bdd cond = i.first;
+            bdd cond = i.second.first;
+            std::string& s = i.second.second;
             if (cond == bddtrue)
               {
-                i.second = "t";
+                s = "t";
                 continue;
               }
             if (cond == bddfalse)
               {
-                i.second = "f";
+                s = "f";
                 continue;
               }
-            std::ostringstream s;
             bool notfirstor = false;
 
             minato_isop isop(cond);
@@ -213,29 +331,29 @@ namespace spot
             while ((cube = isop.next()) != bddfalse)
               {
                 if (notfirstor)
-                  s << " | ";
+                  s += " | ";
                 bool notfirstand = false;
                 while (cube != bddtrue)
                   {
                     if (notfirstand)
-                      s << '&';
+                      s += '&';
                     else
                       notfirstand = true;
                     bdd h = bdd_high(cube);
                     if (h == bddfalse)
                       {
-                        s << '!' << ap[bdd_var(cube)];
+                        s += '!';
+                        s += std::to_string(ap[bdd_var(cube)]);
                         cube = bdd_low(cube);
                       }
                     else
                       {
-                        s << ap[bdd_var(cube)];
+                        s += std::to_string(ap[bdd_var(cube)]);
                         cube = h;
                       }
                   }
                 notfirstor = true;
               }
-            i.second = s.str();
           }
       }
     };
@@ -252,10 +370,10 @@ namespace spot
       Hoa_Acceptance_Mixed    /// mix state-based and transition-based
     };
 
-  static std::ostream&
-  print_hoa(std::ostream& os,
-                const const_twa_graph_ptr& aut,
-                const char* opt)
+  static void
+  print_hoa(hoa_output& os,
+            const const_twa_graph_ptr& aut,
+            const char* opt)
   {
     bool newline = true;
     hoa_acceptance acceptance = Hoa_Acceptance_States;
@@ -337,7 +455,7 @@ namespace spot
     os << (v1_1 ? "HOA: v1.1" : "HOA: v1") << nl;
     auto n = aut->get_named_prop<std::string>("automaton-name");
     if (n)
-      escape_str(os << "name: \"", *n) << '"' << nl;
+      os << "name: \"" << escape_str(*n) << '"' << nl;
     unsigned nap = md.vap.size();
     os << "States: " << num_states << nl
        << "Start: ";
@@ -346,7 +464,7 @@ namespace spot
        << "AP: " << nap;
     auto d = aut->get_dict();
     for (auto& i: md.vap)
-      escape_str(os << " \"", d->bdd_map[i].f.ap_name()) << '"';
+      os << " \"" << escape_str(d->bdd_map[i].f.ap_name()) << '"';
     os << nl;
 
     unsigned num_acc = aut->num_sets();
@@ -398,7 +516,8 @@ namespace spot
                 std::vector<unsigned> pairs;
                 if (aut->acc().is_generalized_rabin(pairs))
                   {
-                    os << "acc-name: generalized-Rabin " << pairs.size();
+                    os << "acc-name: generalized-Rabin "
+                       << static_cast<unsigned>(pairs.size());
                     for (auto p: pairs)
                       os << ' ' << p;
                     os << nl;
@@ -420,9 +539,11 @@ namespace spot
               }
           }
       }
-    os << "Acceptance: " << num_acc << ' ';
-    os << acc_c;
-    os << nl;
+    {
+      std::ostringstream s;
+      s << acc_c;
+      os << "Acceptance: " << num_acc << ' ' << s.str() << nl;
+    }
     os << "properties:";
     // Make sure the property line is not too large,
     // otherwise our test cases do not fit in 80 columns...
@@ -587,7 +708,7 @@ namespace spot
             bool output = false;
             for (auto& t: aut->out(i))
               {
-                os << '[' << md.sup[t.cond] << "] ";
+                os << '[' << md.label(t.cond) << "] ";
                 output = true;
                 break;
               }
@@ -614,7 +735,7 @@ namespace spot
 
             for (auto& t: aut->out(i))
               {
-                os << '[' << md.sup[t.cond] << "] ";
+                os << '[' << md.label(t.cond) << "] ";
                 print_dst(t.dst);
                 if (this_acc == Hoa_Acceptance_Transitions)
                   md.emit_acc(os, t.acc);
@@ -687,33 +808,48 @@ namespace spot
           }
       }
     os << "--END--";                // No newline.  Let the caller decide.
-    return os;
   }
 
-  std::ostream&
-  print_hoa(std::ostream& os,
+  static void
+  print_hoa(hoa_output& os,
             const const_twa_ptr& aut,
             const char* opt)
   {
-
     auto a = std::dynamic_pointer_cast<const twa_graph>(aut);
     if (!a)
       a = make_twa_graph(aut, twa::prop_set::all());
 
     // for Kripke structures, automatically append "k" to the options.
-    char* tmpopt = nullptr;
+    std::string tmpopt;
     if (std::dynamic_pointer_cast<const fair_kripke>(aut))
       {
-        unsigned n = opt ? strlen(opt) : 0;
-        tmpopt = new char[n + 2];
         if (opt)
-          strcpy(tmpopt, opt);
-        tmpopt[n] = 'k';
-        tmpopt[n + 1] = 0;
+          tmpopt = opt;
+        tmpopt += 'k';
+        opt = tmpopt.c_str();
       }
-    print_hoa(os, a, tmpopt ? tmpopt : opt);
-    delete[] tmpopt;
+    print_hoa(os, a, opt);
+    os.flush();
+  }
+
+  std::ostream&
+  print_hoa(std::ostream& os,
+            const const_twa_ptr& aut,
+            const char* opt)
+  {
+    hoa_output out(os, 65536);
+    print_hoa(out, aut, opt);
     return os;
   }
 
+  void
+  print_hoa(int fd,
+            const const_twa_ptr& aut,
+            const char* opt,
+            size_t bufsize)
+  {
+    hoa_output out(fd, std::max<size_t>(bufsize, 1));
+    print_hoa(out, aut, opt);
+  }
+
 }
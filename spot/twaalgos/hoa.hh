@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2014, 2015 Laboratoire de Recherche et Développement
+// Copyright (C) 2014, 2015, 2017 Laboratoire de Recherche et Développement
 // de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iosfwd>
 #include <spot/misc/common.hh>
 #include <spot/twa/fwd.hh>
@@ -41,4 +42,18 @@ namespace spot
   print_hoa(std::ostream& os,
             const const_twa_ptr& g,
             const char* opt = nullptr);
+
+  /// \ingroup twa_io
+  /// \brief Print reachable states in Hanoi Omega Automata format
+  /// on a file descriptor.
+  ///
+  /// This is the same output as the above function, but it is
+  /// written on \a fd with write(2), by chunks of \a bufsize bytes,
+  /// without going through an std::ostream.  A std::runtime_error
+  /// is thrown if the output cannot be written.
+  SPOT_API void
+  print_hoa(int fd,
+            const const_twa_ptr& g,
+            const char* opt = nullptr,
+            size_t bufsize = 1 << 20);
 }
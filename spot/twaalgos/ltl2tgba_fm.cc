@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016
-// Laboratoire de Recherche et Développement de l'Epita (LRDE).
+// Copyright (C) 2008, 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016,
+// 2017 Laboratoire de Recherche et Développement de l'Epita (LRDE).
 // Copyright (C) 2003, 2004, 2005, 2006 Laboratoire
 // d'Informatique de Paris 6 (LIP6), département Systèmes Répartis
 // Coopératifs (SRC), Université Pierre et Marie Curie.
@@ -111,6 +111,11 @@ namespace spot
       succ(formula f);
       ~ratexp_to_dfa();
 
+      size_t size() const
+      {
+        return f2a_.size();
+      }
+
     protected:
       typedef std::pair<twa_graph_ptr, const namer*> labelled_aut;
       labelled_aut translate(formula f);
@@ -133,8 +138,8 @@ namespace spot
     {
     public:
 
-      translate_dict(twa_graph_ptr& a, tl_simplifier* ls, bool exprop,
-                     bool single_acc, bool unambiguous)
+      translate_dict(const twa_graph_ptr& a, tl_simplifier* ls, bool exprop,
+                     bool single_acc, bool unambiguous, bool shared = false)
         : a_(a),
           dict(a->get_dict()),
           ls(ls),
@@ -144,8 +149,8 @@ namespace spot
           transdfa(*this),
           exprop(exprop),
           single_acc(single_acc),
-          acc(a->acc()),
-          unambiguous(unambiguous)
+          unambiguous(unambiguous),
+          shared(shared)
       {
       }
 
@@ -154,7 +159,7 @@ namespace spot
         dict->unregister_all_my_variables(this);
       }
 
-      twa_graph_ptr& a_;
+      twa_graph_ptr a_;
       bdd_dict_ptr dict;
       tl_simplifier* ls;
       mark_tools mt;
@@ -172,10 +177,12 @@ namespace spot
       ratexp_to_dfa transdfa;
       bool exprop;
       bool single_acc;
-      acc_cond& acc;
       // Map BDD variables to acceptance marks.
       std::map<int, unsigned> bm;
       bool unambiguous;
+      // Whether this dictionary is kept by an fm_translation_context
+      // to translate several formulas.
+      bool shared;
 
       enum translate_flags
         {
@@ -218,11 +225,42 @@ namespace spot
       typedef
       std::unordered_map<flagged_formula, translated,
                          flagged_formula_hash> flagged_formula_to_bdd_map;
+
+      // An outgoing transition of a state, before its destination is
+      // simplified or canonized.
+      struct successor
+      {
+        formula dest;
+        bdd cond;
+        bdd prom;
+      };
+      // The successors of the states translated so far.  Only shared
+      // dictionaries fill this, so that the states common to several
+      // automata are only expanded once.
+      std::unordered_map<formula, std::vector<successor>> succ_cache;
+
     private:
       flagged_formula_to_bdd_map ltl_bdd_;
 
     public:
 
+      // Prepare a shared dictionary for the translation into A.  The
+      // BDDs of the formulas already translated are kept, but the
+      // acceptance sets of A are created as they are used.
+      void
+      reuse(const twa_graph_ptr& a, tl_simplifier* simpl)
+      {
+        a_ = a;
+        ls = simpl;
+        bm.clear();
+      }
+
+      // The number of translations stored.
+      size_t
+      size() const
+      {
+        return ltl_bdd_.size() + transdfa.size() + succ_cache.size();
+      }
 
       int
       register_proposition(formula f)
@@ -247,7 +285,7 @@ namespace spot
             a = bdd_low(a);
             if (h != bddfalse)
               {
-                t.emplace_back(bm[v]);
+                t.emplace_back(var_to_set(v));
                 if (a == bddfalse)
                   a = h;
               }
@@ -256,6 +294,16 @@ namespace spot
         return acc_cond::mark_t(t.begin(), t.end());
       }
 
+      // The acceptance set of a_ associated to the promise NUM.
+      unsigned
+      var_to_set(int num)
+      {
+        auto p = bm.emplace(num, 0U);
+        if (p.second)
+          p.first->second = a_->acc().add_set();
+        return p.first->second;
+      }
+
       int
       register_a_variable(formula f)
       {
@@ -264,10 +312,7 @@ namespace spot
             int num = dict->register_acceptance_variable
               (formula::tt(), this);
             a_set &= bdd_ithvar(num);
-
-            auto p = bm.emplace(num, 0U);
-            if (p.second)
-              p.first->second = acc.add_set();
+            var_to_set(num);
             return num;
           }
         // A promise of 'x', noted P(x) is pretty much like the F(x)
@@ -311,10 +356,7 @@ namespace spot
                 formula g = formula::And({f[0], f[1]});
                 int num = dict->register_acceptance_variable(g, this);
                 a_set &= bdd_ithvar(num);
-
-                auto p = bm.emplace(num, 0U);
-                if (p.second)
-                  p.first->second = acc.add_set();
+                var_to_set(num);
                 return num;
               }
             else if (f.is(op::F))
@@ -329,11 +371,7 @@ namespace spot
           }
         int num = dict->register_acceptance_variable(f, this);
         a_set &= bdd_ithvar(num);
-
-        auto p = bm.emplace(num, 0U);
-        if (p.second)
-          p.first->second = acc.add_set();
-
+        var_to_set(num);
         return num;
       }
 
@@ -353,8 +391,8 @@ namespace spot
             next_map[f] = num;
             next_formula_map.resize(bdd_varnum());
             next_formula_map[num] = f;
+            next_set &= bdd_ithvar(num);
           }
-        next_set &= bdd_ithvar(num);
         return num;
       }
 
@@ -372,6 +410,40 @@ namespace spot
         return os;
       }
 
+      // Remove the Next variables from the conjunction of literals
+      // CUBE, and return their conjunction.  This computes
+      //   bdd res = bdd_existcomp(cube, next_set);
+      //   cube = bdd_exist(cube, next_set);
+      // in time linear in the size of CUBE, while the cost of the
+      // above depends on the size of next_set, which grows with each
+      // formula when the dictionary is shared.
+      bdd
+      extract_next(bdd& cube) const
+      {
+        if (cube == bddtrue)
+          return bddtrue;
+        int v = bdd_var(cube);
+        bdd lit;
+        bdd rest = bdd_high(cube);
+        if (rest == bddfalse)
+          {
+            lit = bdd_nithvar(v);
+            rest = bdd_low(cube);
+          }
+        else
+          {
+            lit = bdd_ithvar(v);
+          }
+        bdd res = extract_next(rest);
+        if (unsigned(v) < next_formula_map.size() && next_formula_map[v])
+          {
+            cube = rest;
+            return lit & res;
+          }
+        cube = lit & rest;
+        return res;
+      }
+
       formula
       var_to_formula(int var) const
       {
@@ -390,8 +462,23 @@ namespace spot
       boolean_to_bdd(formula f)
       {
         bdd res = ls->as_bdd(f);
-        var_set &= bdd_support(res);
+        bdd sup = bdd_support(res);
+
+        if (shared)
+          {
+            // The atomic propositions of all the formulas translated
+            // so far accumulate in var_set, so they are registered in
+            // the automaton by ltl_to_tgba_fm() once it is built.
+            // Until then, make sure their variables are not released
+            // by their current owners, since our BDDs use them.
+            for (bdd v = bdd_exist(sup, var_set); v != bddtrue;
+                 v = bdd_high(v))
+              dict->register_proposition(var_to_formula(bdd_var(v)), this);
+            var_set &= sup;
+            return res;
+          }
 
+        var_set &= sup;
         bdd all = var_set;
         while (all != bddfalse)
           {
@@ -496,8 +583,8 @@ namespace spot
       bdd cube;
       while ((cube = isop.next()) != bddfalse)
         {
-          bdd label = bdd_exist(cube, d.next_set);
-          bdd dest_bdd = bdd_existcomp(cube, d.next_set);
+          bdd label = cube;
+          bdd dest_bdd = d.extract_next(label);
           formula dest = d.conj_bdd_to_formula(dest_bdd);
           bdd_print_set(std::cerr, d.dict, label) << " => ";
           bdd_print_set(std::cerr, d.dict, dest_bdd) << " = ";
@@ -552,8 +639,8 @@ namespace spot
         bdd out = bddfalse;
         while ((cube = isop.next()) != bddfalse)
           {
-            bdd label = bdd_exist(cube, dict_.next_set);
-            bdd dest_bdd = bdd_existcomp(cube, dict_.next_set);
+            bdd label = cube;
+            bdd dest_bdd = dict_.extract_next(label);
             formula dest = dict_.conj_bdd_to_sere(dest_bdd);
             if (dest.is(op::eword))
               {
@@ -656,8 +743,8 @@ namespace spot
                       res = bddfalse;
                       while ((cube = isop.next()) != bddfalse)
                         {
-                          bdd label = bdd_exist(cube, dict_.next_set);
-                          bdd dest_bdd = bdd_existcomp(cube, dict_.next_set);
+                          bdd label = cube;
+                          bdd dest_bdd = dict_.extract_next(label);
                           formula dest = dict_.conj_bdd_to_sere(dest_bdd);
                           if (dest.is(op::eword))
                             {
@@ -690,8 +777,8 @@ namespace spot
                     }
                   while ((cube = isop.next()) != bddfalse)
                     {
-                      bdd label = bdd_exist(cube, dict_.next_set);
-                      bdd dest_bdd = bdd_existcomp(cube, dict_.next_set);
+                      bdd label = cube;
+                      bdd dest_bdd = dict_.extract_next(label);
                       formula dest = dict_.conj_bdd_to_sere(dest_bdd);
 
                       // The destination is a final state.  Make sure we
@@ -837,8 +924,8 @@ namespace spot
               res = bddfalse;
               while ((cube = isop.next()) != bddfalse)
                 {
-                  bdd label = bdd_exist(cube, dict_.next_set);
-                  bdd dest_bdd = bdd_existcomp(cube, dict_.next_set);
+                  bdd label = cube;
+                  bdd dest_bdd = dict_.extract_next(label);
                   formula dest = dict_.conj_bdd_to_sere(dest_bdd);
 
                   if (dest.accepts_eword())
@@ -1459,8 +1546,8 @@ namespace spot
                   bdd cube;
                   while ((cube = isop.next()) != bddfalse)
                     {
-                      bdd label = bdd_exist(cube, dict_.next_set);
-                      bdd dest_bdd = bdd_existcomp(cube, dict_.next_set);
+                      bdd label = cube;
+                      bdd dest_bdd = dict_.extract_next(label);
                       formula dest = dict_.conj_bdd_to_sere(dest_bdd);
 
                       if (dest.is(op::eword))
@@ -1531,8 +1618,8 @@ namespace spot
                   bdd cube;
                   while ((cube = isop.next()) != bddfalse)
                     {
-                      bdd label = bdd_exist(cube, dict_.next_set);
-                      bdd dest_bdd = bdd_existcomp(cube, dict_.next_set);
+                      bdd label = cube;
+                      bdd dest_bdd = dict_.extract_next(label);
                       formula dest = dict_.conj_bdd_to_sere(dest_bdd);
                       formula dest2 = formula::binop(o, dest, node[1]);
 
@@ -1747,8 +1834,8 @@ namespace spot
                 bdd cube;
                 while ((cube = isop.next()) != bddfalse)
                   {
-                    bdd label = bdd_exist(cube, d_.next_set);
-                    bdd dest_bdd = bdd_existcomp(cube, d_.next_set);
+                    bdd label = cube;
+                    bdd dest_bdd = d_.extract_next(label);
                     formula dest =
                       d_.conj_bdd_to_formula(dest_bdd);
 
@@ -1883,12 +1970,81 @@ namespace spot
     typedef std::vector<transition> dest_map;
   }
 
+  struct fm_translation_context::impl
+  {
+    bdd_dict_ptr dict;
+    // The simplifier used when ltl_to_tgba_fm() is not given one.
+    // It must outlive the dictionaries, since they use it.
+    std::unique_ptr<tl_simplifier> simpl;
+    // One dictionary for each combination of exprop, single_acc,
+    // and unambiguous.
+    std::unique_ptr<translate_dict> dicts[8];
+    unsigned max_entries;
+  };
+
+  fm_translation_context::fm_translation_context(unsigned max_entries)
+    : impl_(new impl)
+  {
+    impl_->max_entries = max_entries;
+  }
+
+  fm_translation_context::~fm_translation_context()
+  {
+    clear();
+  }
+
+  void
+  fm_translation_context::clear()
+  {
+    for (auto& d: impl_->dicts)
+      d.reset();
+    impl_->simpl.reset();
+    impl_->dict = nullptr;
+  }
+
+  size_t
+  fm_translation_context::size() const
+  {
+    size_t res = 0;
+    for (auto& d: impl_->dicts)
+      if (d)
+        res += d->size();
+    return res;
+  }
+
+  unsigned
+  fm_translation_context::max_entries() const
+  {
+    return impl_->max_entries;
+  }
+
+  void
+  fm_translation_context::set_max_entries(unsigned max_entries)
+  {
+    impl_->max_entries = max_entries;
+  }
+
   twa_graph_ptr
   ltl_to_tgba_fm(formula f2, const bdd_dict_ptr& dict,
                  bool exprop, bool symb_merge, bool branching_postponement,
                  bool fair_loop_approx, const atomic_prop_set* unobs,
-                 tl_simplifier* simplifier, bool unambiguous)
+                 tl_simplifier* simplifier, bool unambiguous,
+                 fm_translation_context* context)
   {
+    fm_translation_context::impl* ctx = nullptr;
+    if (context)
+      {
+        ctx = context->impl_.get();
+        // The translations are only valid for the dictionary they
+        // have been built with.  This is also where we enforce the
+        // memory bound.
+        if (ctx->dict != dict || context->size() > ctx->max_entries)
+          context->clear();
+        ctx->dict = dict;
+        if (!simplifier && !ctx->simpl)
+          ctx->simpl.reset(new tl_simplifier(dict));
+      }
+
     tl_simplifier* s = simplifier;
 
     // Simplify the formula, if requested.
@@ -1904,7 +2060,7 @@ namespace spot
         // negations on the atomic propositions.  We also suppress
         // logic abbreviations such as <=>, =>, or XOR, since they
         // would involve negations at the BDD level.
-        s = new tl_simplifier(dict);
+        s = ctx ? ctx->simpl.get() : new tl_simplifier(dict);
         f2 = s->negative_normal_form(f2, false);
       }
     assert(f2.is_in_nenoform());
@@ -1917,8 +2073,26 @@ namespace spot
     twa_graph_ptr a = make_twa_graph(dict);
     auto namer = a->create_namer<formula>();
 
-    translate_dict d(a, s, exprop, f2.is_syntactic_persistence(),
-                     unambiguous);
+    bool single_acc = f2.is_syntactic_persistence();
+    std::unique_ptr<translate_dict> own_d;
+    translate_dict* dp;
+    if (ctx)
+      {
+        auto& shared = ctx->dicts[exprop + 2 * single_acc + 4 * unambiguous];
+        if (shared)
+          shared->reuse(a, s);
+        else
+          shared.reset(new translate_dict(a, s, exprop, single_acc,
+                                          unambiguous, true));
+        dp = shared.get();
+      }
+    else
+      {
+        own_d.reset(new translate_dict(a, s, exprop, single_acc,
+                                       unambiguous));
+        dp = own_d.get();
+      }
+    translate_dict& d = *dp;
 
     // Compute the set of all promises that can possibly occur inside
     // the formula.  These are the right-hand sides of U or F
@@ -1982,6 +2156,11 @@ namespace spot
     formulae_to_translate.insert(f2);
     a->set_init_state(namer->new_state(f2));
 
+    // The successors of a state only depend on the state, unless
+    // they are constrained by the promises or events of the formula.
+    bool cache_succ = ctx && !unobs && !fair_loop_approx;
+    std::vector<translate_dict::successor> own_succs;
+
     dest_map dests;
     while (!formulae_to_translate.empty())
       {
@@ -2035,18 +2214,35 @@ namespace spot
         // outgoing propositions generalizes the above trick.
         dests.clear();
 
+        std::vector<translate_dict::successor>* succs = &own_succs;
+        bool known = false;
+        if (cache_succ)
+          {
+            auto p = d.succ_cache.emplace(now,
+                                          std::vector<translate_dict::
+                                                      successor>{});
+            succs = &p.first->second;
+            known = !p.second;
+          }
+        else
+          {
+            own_succs.clear();
+          }
+
         // Compute all outgoing arcs.
 
         // If EXPROP is set, we will refine the symbolic
         // representation of the successors for all combinations of
         // the atomic properties involved in the formula.
         // VAR_SET is the set of these properties.
-        bdd var_set = bdd_existcomp(bdd_support(res), d.var_set);
+        bdd var_set = known ? bdd(bddtrue)
+          : bdd_existcomp(bdd_support(res), d.var_set);
         // ALL_PROPS is the combinations we have yet to consider.
         // We used to start with `all_props = bddtrue', but it is
         // more efficient to start with the set of all satisfiable
         // variables combinations.
-        bdd all_props = bdd_existcomp(res, d.var_set);
+        bdd all_props =
+          known ? bdd(bddfalse) : bdd_existcomp(res, d.var_set);
         while (all_props != bddfalse)
           {
             bdd one_prop_set = bddtrue;
@@ -2072,28 +2268,35 @@ namespace spot
             bdd cube;
             while ((cube = isop.next()) != bddfalse)
               {
-                bdd label = bdd_exist(cube, d.next_set);
-                bdd dest_bdd = bdd_existcomp(cube, d.next_set);
+                bdd label = cube;
+                bdd dest_bdd = d.extract_next(label);
                 formula dest = d.conj_bdd_to_formula(dest_bdd);
+                // LABEL only has atomic propositions and promises.
+                bdd conds = bdd_existcomp(label, d.var_set);
+                bdd promises = bdd_exist(label, d.var_set);
+                succs->push_back({dest, conds, promises});
+              }
+          }
 
-                // Simplify the formula, if requested.
-                if (simplifier)
-                  {
-                    dest = simplifier->simplify(dest);
-                    // Ignore the arc if the destination reduces to false.
-                    if (dest.is_ff())
-                      continue;
-                  }
-
-                // If we already know a state with the same
-                // successors, use it in lieu of the current one.
-                if (symb_merge)
-                  dest = fc.canonize(dest);
+        for (auto& s: *succs)
+          {
+            formula dest = s.dest;
 
-                bdd conds = bdd_existcomp(label, d.var_set);
-                bdd promises = bdd_existcomp(label, d.a_set);
-                dests.emplace_back(transition(dest, conds, promises));
+            // Simplify the formula, if requested.
+            if (simplifier)
+              {
+                dest = simplifier->simplify(dest);
+                // Ignore the arc if the destination reduces to false.
+                if (dest.is_ff())
+                  continue;
               }
+
+            // If we already know a state with the same
+            // successors, use it in lieu of the current one.
+            if (symb_merge)
+              dest = fc.canonize(dest);
+
+            dests.emplace_back(transition(dest, s.cond, s.prom));
           }
 
         assert(dests.size() > 0);
@@ -2175,6 +2378,36 @@ namespace spot
         }
       }
 
+    if (ctx)
+      {
+        // A shared dictionary does not register the atomic
+        // propositions in the automaton.  Register those of the
+        // formula (and the unobservable ones) in the order of their
+        // BDD variables, as boolean_to_bdd() would have done.
+        std::map<int, formula> vars;
+        std::vector<formula> unknown;
+        auto add = [&](formula ap)
+          {
+            auto i = dict->var_map.find(ap);
+            if (i != dict->var_map.end())
+              vars.emplace(i->second, ap);
+            else
+              unknown.push_back(ap);
+          };
+        auto aps = std::unique_ptr<atomic_prop_set>(atomic_prop_collect(f2));
+        for (auto ap: *aps)
+          add(ap);
+        if (unobs)
+          for (auto ap: *unobs)
+            add(ap);
+        for (auto& p: vars)
+          a->register_ap(p.second);
+        for (auto ap: unknown)
+          a->register_ap(ap);
+        // Do not keep the automaton alive.
+        d.a_ = nullptr;
+      }
+
     auto& acc = a->acc();
     unsigned ns = a->num_states();
     for (unsigned s = 0; s < ns; ++s)
@@ -2199,7 +2432,7 @@ namespace spot
     // Set the following to true to preserve state names.
     a->release_formula_namer(namer, false);
 
-    if (!simplifier)
+    if (!simplifier && !ctx)
       // This should not be deleted before we have registered all propositions.
       delete s;
     return a;
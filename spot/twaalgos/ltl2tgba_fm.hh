@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2010, 2011, 2012, 2013, 2014, 2015 Laboratoire de
-// Recherche et Développement de l'Epita (LRDE).
+// Copyright (C) 2010, 2011, 2012, 2013, 2014, 2015, 2017 Laboratoire
+// de Recherche et Développement de l'Epita (LRDE).
 // Copyright (C) 2003, 2004, 2005, 2006 Laboratoire d'Informatique de
 // Paris 6 (LIP6), département Systèmes Répartis Coopératifs (SRC),
 // Université Pierre et Marie Curie.
@@ -26,9 +26,12 @@
 #include <spot/twa/twagraph.hh>
 #include <spot/tl/apcollect.hh>
 #include <spot/tl/simplify.hh>
+#include <memory>
 
 namespace spot
 {
+  class fm_translation_context;
+
   /// \ingroup twa_ltl
   /// \brief Build a spot::twa_graph_ptr from an LTL formula.
   ///
@@ -138,6 +141,10 @@ namespace spot
       }
       \endverbatim */
   ///
+  /// \param context If non-null, the translations of subformulas
+  /// are looked up in, and saved into, this context, so that they
+  /// can be reused by later calls.  See spot::fm_translation_context.
+  ///
   /// \return A spot::twa_graph that recognizes the language of \a f.
   SPOT_API twa_graph_ptr
   ltl_to_tgba_fm(formula f, const bdd_dict_ptr& dict,
@@ -146,5 +153,67 @@ namespace spot
                  bool fair_loop_approx = false,
                  const atomic_prop_set* unobs = nullptr,
                  tl_simplifier* simplifier = nullptr,
-                 bool unambiguous = false);
+                 bool unambiguous = false,
+                 fm_translation_context* context = nullptr);
+
+  /// \ingroup twa_ltl
+  /// \brief Translations of subformulas shared by several calls to
+  /// ltl_to_tgba_fm().
+  ///
+  /// ltl_to_tgba_fm() rewrites each subformula it encounters into a
+  /// BDD representing its successors, and each SERE into a
+  /// deterministic automaton.  These are normally discarded once
+  /// the automaton has been built.  When several formulas are
+  /// translated with the same context, they are kept, so that the
+  /// subformulas common to these formulas (e.g., the conjuncts of a
+  /// specification, or the mutations of a formula) are only
+  /// expanded once.
+  ///
+  /// The translations are stored separately for each combination of
+  /// the options of ltl_to_tgba_fm() they depend on.  They are only
+  /// valid for one spot::bdd_dict: using the context with another
+  /// dictionary clears it.  The context is also cleared at the
+  /// beginning of a translation whenever size() exceeds
+  /// max_entries().
+  ///
+  /// The automata built with a context recognize the same languages
+  /// as those built without, but since the BDD variables are not
+  /// allocated in the same order, their states, edges, and
+  /// acceptance sets may be numbered differently.
+  class SPOT_API fm_translation_context final
+  {
+  public:
+    /// \brief Create an empty context.
+    ///
+    /// \param max_entries the number of stored translations above
+    /// which the context is cleared.
+    fm_translation_context(unsigned max_entries = 100000);
+    ~fm_translation_context();
+
+    fm_translation_context(const fm_translation_context&) = delete;
+    fm_translation_context&
+    operator=(const fm_translation_context&) = delete;
+
+    /// \brief Forget all translations.
+    ///
+    /// This also releases the BDD variables they use.
+    void clear();
+
+    /// The number of translated subformulas and SERE states stored.
+    size_t size() const;
+
+    unsigned max_entries() const;
+    void set_max_entries(unsigned max_entries);
+
+  private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+
+    friend twa_graph_ptr
+    ltl_to_tgba_fm(formula f, const bdd_dict_ptr& dict, bool exprop,
+                   bool symb_merge, bool branching_postponement,
+                   bool fair_loop_approx, const atomic_prop_set* unobs,
+                   tl_simplifier* simplifier, bool unambiguous,
+                   fm_translation_context* context);
+  };
 }
@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2013, 2014, 2015, 2016 Laboratoire de recherche et
-// développement de l'Epita (LRDE).
+// Copyright (C) 2011, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// recherche et développement de l'Epita (LRDE).
 // Copyright (C) 2004, 2005  Laboratoire d'Informatique de Paris 6 (LIP6),
 // département Systèmes Répartis Coopératifs (SRC), Université Pierre
 // et Marie Curie.
@@ -29,14 +29,18 @@
 #define trace while (0) std::cerr
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <list>
+#include <vector>
 #include <spot/misc/hash.hh>
 #include <spot/twa/twa.hh>
+#include <spot/twaalgos/bitstate.hxx>
 #include <spot/twaalgos/emptiness.hh>
 #include <spot/twaalgos/emptiness_stats.hh>
 #include <spot/twaalgos/magic.hh>
 #include <spot/twaalgos/ndfs_result.hxx>
+#include <spot/twaalgos/twaiteration.hxx>
 
 namespace spot
 {
@@ -46,18 +50,26 @@ namespace spot
 
     /// \brief Emptiness checker on spot::tgba automata having at most one
     /// acceptance condition (i.e. a TBA).
-    template <typename heap>
+    ///
+    /// When \a is_explicit is set, the automaton is a twa_graph whose
+    /// states and edges are accessed directly by their numbers.
+    template <bool is_explicit, typename heap>
     class magic_search_ final : public emptiness_check, public ec_statistics
     {
+      using T = twa_iteration<is_explicit>;
+      using state_t = typename T::state_t;
+      using stack_t = ndfs_stack_type<is_explicit>;
+      using item_t = typename stack_t::value_type;
     public:
       /// \brief Initialize the Magic Search algorithm on the automaton \a a
       ///
       /// \pre The automaton \a a must have at most one acceptance
       /// condition (i.e. it is a TBA).
-      magic_search_(const const_twa_ptr& a, size_t size,
+      magic_search_(const automaton_ptr<is_explicit>& a, size_t size,
                     option_map o = option_map())
         : emptiness_check(a, o),
-          h(size)
+          aut_(a),
+          h(a, size, o)
       {
         assert(a->num_sets() <= 1);
       }
@@ -68,13 +80,13 @@ namespace spot
         while (!st_blue.empty())
           {
             h.pop_notify(st_blue.front().s);
-            a_->release_iter(st_blue.front().it);
+            T::it_destroy(aut_, st_blue.front().it);
             st_blue.pop_front();
           }
         while (!st_red.empty())
           {
             h.pop_notify(st_red.front().s);
-            a_->release_iter(st_red.front().it);
+            T::it_destroy(aut_, st_red.front().it);
             st_red.pop_front();
           }
       }
@@ -94,7 +106,7 @@ namespace spot
         if (st_red.empty())
           {
             assert(st_blue.empty());
-            const state* s0 = a_->get_init_state();
+            state_t s0 = T::initial_state(aut_);
             inc_states();
             h.add_new_state(s0, BLUE);
             push(st_blue, s0, bddfalse, 0U);
@@ -125,6 +137,7 @@ namespace spot
             os << st_blue.size() + st_red.size() - 1
                << " nodes for the counter example" << std::endl;
           }
+        h.print_stats(os);
         return os;
       }
 
@@ -140,55 +153,62 @@ namespace spot
 
       const stack_type& get_st_blue() const
       {
-        return st_blue;
+        return as_stack_type(aut_, st_blue, st_blue_tmp);
       }
 
       const stack_type& get_st_red() const
       {
-        return st_red;
+        return as_stack_type(aut_, st_red, st_red_tmp);
       }
     private:
 
-      void push(stack_type& st, const state* s,
+      void push(stack_t& st, state_t s,
                 const bdd& label, acc_cond::mark_t acc)
       {
         inc_depth();
-        twa_succ_iterator* i = a_->succ_iter(s);
-        i->first();
-        st.emplace_front(s, i, label, acc);
+        st.emplace_front(s, T::succ(aut_, s), label, acc);
       }
 
-      void pop(stack_type& st)
+      void pop(stack_t& st)
       {
         dec_depth();
-        a_->release_iter(st.front().it);
+        T::it_destroy(aut_, st.front().it);
         st.pop_front();
       }
 
+      automaton_ptr<is_explicit> aut_;
+
       /// \brief Stack of the blue dfs.
-      stack_type st_blue;
+      stack_t st_blue;
 
       /// \brief Stack of the red dfs.
-      stack_type st_red;
+      stack_t st_red;
+
+      /// \brief Copies of the stacks given to the results, when
+      /// is_explicit is set.
+      mutable stack_type st_blue_tmp;
+      mutable stack_type st_red_tmp;
 
       /// \brief Map where each visited state is colored
       /// by the last dfs visiting it.
       heap h;
 
       /// State targeted by the red dfs.
-      const state* target;
+      state_t target;
 
       bool dfs_blue()
       {
         while (!st_blue.empty())
           {
-            stack_item& f = st_blue.front();
-            trace << "DFS_BLUE treats: " << a_->format_state(f.s) << std::endl;
+            item_t& f = st_blue.front();
+            trace << "DFS_BLUE treats: "
+                  << a_->format_state(T::to_state(aut_, f.s)) << std::endl;
             if (!f.it->done())
               {
-                const state *s_prime = f.it->dst();
+                state_t s_prime = f.it->dst();
                 trace << "  Visit the successor: "
-                      << a_->format_state(s_prime) << std::endl;
+                      << a_->format_state(T::to_state(aut_, s_prime))
+                      << std::endl;
                 bdd label = f.it->cond();
                 auto acc = f.it->acc();
                 // Go down the edge (f.s, <label, acc>, s_prime)
@@ -230,7 +250,7 @@ namespace spot
             //        (predecessor of f.s in st_blue, <f.label, f.acc>, f.s)
               {
                 trace << "  All the successors have been visited" << std::endl;
-                stack_item f_dest(f);
+                item_t f_dest(f);
                 pop(st_blue);
                 typename heap::color_ref c = h.get_color_ref(f_dest.s);
                 assert(!c.is_white());
@@ -242,7 +262,8 @@ namespace spot
                     // calls to the check method. Without this
                     // functionnality, the test can be ommited.
                     trace << "  It is blue and the arc from "
-                          << a_->format_state(st_blue.front().s)
+                          << a_->format_state(T::to_state(aut_,
+                                                          st_blue.front().s))
                           << " to it is accepting, start a red dfs"
                           << std::endl;
                     target = st_blue.front().s;
@@ -264,18 +285,20 @@ namespace spot
       bool dfs_red()
       {
         assert(!st_red.empty());
-        if (target->compare(st_red.front().s) == 0)
+        if (T::same(target, st_red.front().s))
           return true;
 
         while (!st_red.empty())
           {
-            stack_item& f = st_red.front();
-            trace << "DFS_RED treats: " << a_->format_state(f.s) << std::endl;
+            item_t& f = st_red.front();
+            trace << "DFS_RED treats: "
+                  << a_->format_state(T::to_state(aut_, f.s)) << std::endl;
             if (!f.it->done())
               {
-                const state *s_prime = f.it->dst();
+                state_t s_prime = f.it->dst();
                 trace << "  Visit the successor: "
-                      << a_->format_state(s_prime) << std::endl;
+                      << a_->format_state(T::to_state(aut_, s_prime))
+                      << std::endl;
                 bdd label = f.it->cond();
                 auto acc = f.it->acc();
                 // Go down the edge (f.s, <label, acc>, s_prime)
@@ -292,14 +315,14 @@ namespace spot
                     // to visit white states either if a cycle can be missed
                     // with bit-state hashing search.
                     trace << "  It is white, pop it" << std::endl;
-                    s_prime->destroy();
+                    T::destroy(s_prime);
                   }
                 else if (c.get_color() == BLUE)
                   {
                     trace << "  It is blue, go down" << std::endl;
                     c.set_color(RED);
                     push(st_red, s_prime, label, acc);
-                    if (target->compare(s_prime) == 0)
+                    if (T::same(target, s_prime))
                       return true;
                   }
                 else
@@ -330,8 +353,10 @@ namespace spot
 
         virtual twa_run_ptr accepting_run() override
         {
-          assert(!ms_->st_blue.empty());
-          assert(!ms_->st_red.empty());
+          const stack_type& st_blue = ms_->get_st_blue();
+          const stack_type& st_red = ms_->get_st_red();
+          assert(!st_blue.empty());
+          assert(!st_red.empty());
 
           auto run = std::make_shared<twa_run>(automaton());
 
@@ -340,8 +365,8 @@ namespace spot
 
           l = &run->prefix;
 
-          i = ms_->st_blue.rbegin();
-          end = ms_->st_blue.rend(); --end;
+          i = st_blue.rbegin();
+          end = st_blue.rend(); --end;
           j = i; ++j;
           for (; i != end; ++i, ++j)
             {
@@ -351,12 +376,12 @@ namespace spot
 
           l = &run->cycle;
 
-          j = ms_->st_red.rbegin();
+          j = st_red.rbegin();
           twa_run::step s = { i->s->clone(), j->label, j->acc };
           l->emplace_back(s);
 
           i = j; ++j;
-          end = ms_->st_red.rend(); --end;
+          end = st_red.rend(); --end;
           for (; i != end; ++i, ++j)
             {
               twa_run::step s = { i->s->clone(), j->label, j->acc };
@@ -386,7 +411,7 @@ namespace spot
           if (options()[FROM_STACK])
             computer = new result_from_stack(ms);
           else
-            computer = new ndfs_result<magic_search_<heap>, heap>(ms);
+            computer = new ndfs_result<magic_search_, heap>(ms);
         }
 
         virtual void options_updated(const option_map& old) override
@@ -394,7 +419,7 @@ namespace spot
           if (old[FROM_STACK] && !options()[FROM_STACK])
             {
               delete computer;
-              computer = new ndfs_result<magic_search_<heap>, heap>(ms);
+              computer = new ndfs_result<magic_search_, heap>(ms);
             }
           else if (!old[FROM_STACK] && options()[FROM_STACK])
             {
@@ -452,7 +477,8 @@ namespace spot
         color *p;
       };
 
-      explicit_magic_search_heap(size_t)
+      explicit_magic_search_heap(const const_twa_ptr&, size_t,
+                                 const option_map&)
         {
         }
 
@@ -497,6 +523,10 @@ namespace spot
           return (it != h.end());
         }
 
+      void print_stats(std::ostream&) const
+        {
+        }
+
       enum { Has_Size = 1 };
       int size() const
         {
@@ -507,6 +537,60 @@ namespace spot
       state_map<color> h;
     };
 
+    // Same as explicit_magic_search_heap, for a twa_graph whose states
+    // are numbered.
+    class graph_magic_search_heap final
+    {
+    public:
+      enum { Safe = 1 };
+
+      using color_ref = explicit_magic_search_heap::color_ref;
+
+      graph_magic_search_heap(const const_twa_graph_ptr& a, size_t,
+                              const option_map&)
+        : a_(a), h(a->num_states(), WHITE), count(0)
+        {
+        }
+
+      color_ref get_color_ref(unsigned s)
+        {
+          if (h[s] == WHITE)
+            return color_ref(nullptr);
+          return color_ref(&h[s]);
+        }
+
+      void add_new_state(unsigned s, color c)
+        {
+          assert(h[s] == WHITE);
+          h[s] = c;
+          ++count;
+        }
+
+      void pop_notify(unsigned) const
+        {
+        }
+
+      bool has_been_visited(const state* s) const
+        {
+          return h[a_->state_number(s)] != WHITE;
+        }
+
+      void print_stats(std::ostream&) const
+        {
+        }
+
+      enum { Has_Size = 1 };
+      int size() const
+        {
+          return count;
+        }
+
+    private:
+      const_twa_graph_ptr a_;
+      std::vector<color> h;
+      int count;
+    };
+
     class bsh_magic_search_heap final
     {
     public:
@@ -515,48 +599,42 @@ namespace spot
       class color_ref final
       {
       public:
-        color_ref(unsigned char *b, unsigned char o): base(b), offset(o*2)
+        color_ref(bitstate_table* t, size_t ha): t(t), ha(ha)
           {
           }
         color get_color() const
           {
-            return color(((*base) >> offset) & 3U);
+            return color(t->get(ha));
           }
         void set_color(color c)
           {
-            *base =  (*base & ~(3U << offset)) | (c << offset);
+            t->set(ha, c);
           }
         bool is_white() const
           {
             return get_color() == WHITE;
           }
       private:
-        unsigned char *base;
-        unsigned char offset;
+        bitstate_table* t;
+        size_t ha;
       };
 
-      bsh_magic_search_heap(size_t s)
+      bsh_magic_search_heap(const const_twa_ptr&, size_t s,
+                            const option_map& o)
+        : h(s, std::max(o.get("k", 1), 1))
         {
-          size_ = s;
-          h = new unsigned char[size_];
-          memset(h, WHITE, size_);
-        }
-
-      ~bsh_magic_search_heap()
-        {
-          delete[] h;
         }
 
       color_ref get_color_ref(const state*& s)
         {
-          size_t ha = s->hash();
-          return color_ref(&(h[ha%size_]), ha%4);
+          return color_ref(&h, s->hash());
         }
 
       void add_new_state(const state* s, color c)
         {
           color_ref cr(get_color_ref(s));
           assert(cr.is_white());
+          h.new_state();
           cr.set_color(c);
         }
 
@@ -567,15 +645,18 @@ namespace spot
 
       bool has_been_visited(const state* s) const
         {
-          size_t ha = s->hash();
-          return color((h[ha%size_] >> ((ha%4)*2)) & 3U) != WHITE;
+          return h.get(s->hash()) != WHITE;
+        }
+
+      void print_stats(std::ostream& os) const
+        {
+          h.print_stats(os);
         }
 
       enum { Has_Size = 0 };
 
     private:
-      size_t size_;
-      unsigned char* h;
+      bitstate_table h;
     };
 
   } // anonymous
@@ -583,14 +664,19 @@ namespace spot
   emptiness_check_ptr
   explicit_magic_search(const const_twa_ptr& a, option_map o)
   {
-    return std::make_shared<magic_search_<explicit_magic_search_heap>>(a, 0, o);
+    if (auto ag = use_explicit_iteration(a, o))
+      return std::make_shared<magic_search_<true, graph_magic_search_heap>>
+        (ag, 0, o);
+    return std::make_shared<magic_search_<false, explicit_magic_search_heap>>
+      (a, 0, o);
   }
 
   emptiness_check_ptr
   bit_state_hashing_magic_search(const const_twa_ptr& a,
                                  size_t size, option_map o)
   {
-    return std::make_shared<magic_search_<bsh_magic_search_heap>>(a, size, o);
+    return std::make_shared<magic_search_<false, bsh_magic_search_heap>>
+      (a, size, o);
   }
 
   emptiness_check_ptr
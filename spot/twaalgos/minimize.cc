@@ -26,7 +26,7 @@
 #  define trace while (0) std::cerr
 #endif
 
-#include <queue>
+#include <algorithm>
 #include <deque>
 #include <set>
 #include <list>
@@ -80,36 +80,6 @@ namespace spot
       return s.str();
     }
 
-    // Find all states of an automaton.
-    static void
-    build_state_set(const const_twa_ptr& a, hash_set* seen)
-    {
-      std::queue<const state*> tovisit;
-      // Perform breadth-first traversal.
-      const state* init = a->get_init_state();
-      tovisit.push(init);
-      seen->insert(init);
-      while (!tovisit.empty())
-        {
-          const state* src = tovisit.front();
-          tovisit.pop();
-
-          for (auto sit: a->succ(src))
-            {
-              const state* dst = sit->dst();
-              // Is it a new state ?
-              if (seen->find(dst) == seen->end())
-                {
-                  // Register the successor for later processing.
-                  tovisit.push(dst);
-                  seen->insert(dst);
-                }
-              else
-                dst->destroy();
-            }
-        }
-    }
-
     // From the base automaton and the list of sets, build the minimal
     // resulting automaton
     static twa_graph_ptr
@@ -470,6 +440,307 @@ namespace spot
 
       return res;
     }
+
+    // Above this number of states, minimize_dfa_hopcroft() is used
+    // instead of minimize_dfa().  The latter refines all classes at
+    // each pass, so it may take a quadratic number of passes on large
+    // automata, but it is cheap on small ones.
+    static const unsigned max_moore_states = 512;
+
+    // Minimize DET_A using Hopcroft's partition refinement, as
+    // presented by Valmari and Lehtinen ("Efficient minimization of
+    // DFAs with partial transition functions", STACS'08), but with a
+    // symbolic alphabet.  STATE_CLASS gives the initial class of each
+    // state: 0 for final states, 1 for non-final states, and -1U for
+    // states that should be ignored.
+    //
+    // Edges going to ignored states, and missing edges, are sent to
+    // an additional sink state, so that the transition function is
+    // complete on the partition.  When a splitter block B is
+    // processed, each predecessor p of B is labeled by the union of
+    // the conditions of its edges going to B, and each block is split
+    // according to these labels (states that have no edge going to B
+    // being labeled by false).  Only the parts that are not the
+    // largest need to be added to the work list, so that each state
+    // is processed O(log n) times.
+    //
+    // The states of the result are ordered by the smallest state of
+    // DET_A they contain.
+    static twa_graph_ptr
+    minimize_dfa_hopcroft(const const_twa_graph_ptr& det_a,
+                          const std::vector<unsigned>& state_class)
+    {
+      unsigned ns = det_a->num_states();
+      unsigned sink = ns;
+      unsigned n = ns + 1;
+
+      // Incoming edges of each state, stored contiguously: the
+      // sources (and conditions) of the edges going to state d are
+      // in_src[in_begin[d]...in_begin[d + 1]-1].
+      std::vector<bdd> rest(ns, bddfalse);
+      std::vector<unsigned> in_begin(n + 2, 0);
+      bool has_final = false;
+      for (unsigned s = 0; s < ns; ++s)
+        {
+          if (state_class[s] == -1U)
+            continue;
+          has_final |= state_class[s] == 0;
+          bdd all = bddfalse;
+          for (auto& e: det_a->out(s))
+            if (state_class[e.dst] != -1U)
+              {
+                ++in_begin[e.dst + 2];
+                all |= e.cond;
+              }
+          rest[s] = !all;
+          if (rest[s] != bddfalse)
+            ++in_begin[sink + 2];
+        }
+      ++in_begin[sink + 2];     // The self-loop on the sink.
+      for (unsigned d = 2; d < n + 2; ++d)
+        in_begin[d] += in_begin[d - 1];
+      std::vector<unsigned> in_src(in_begin[n + 1]);
+      std::vector<bdd> in_cond(in_begin[n + 1]);
+      for (unsigned s = 0; s < ns; ++s)
+        {
+          if (state_class[s] == -1U)
+            continue;
+          for (auto& e: det_a->out(s))
+            if (state_class[e.dst] != -1U)
+              {
+                unsigned pos = in_begin[e.dst + 1]++;
+                in_src[pos] = s;
+                in_cond[pos] = e.cond;
+              }
+          if (rest[s] != bddfalse)
+            {
+              unsigned pos = in_begin[sink + 1]++;
+              in_src[pos] = s;
+              in_cond[pos] = rest[s];
+            }
+        }
+      {
+        unsigned pos = in_begin[sink + 1]++;
+        in_src[pos] = sink;
+        in_cond[pos] = bddtrue;
+      }
+      rest.clear();
+
+      // The partition.  The states of block b are
+      // elems[blocks[b].begin...blocks[b].end-1], and loc[s] is the
+      // position of state s in elems.
+      struct block
+      {
+        unsigned begin;
+        unsigned end;
+      };
+      std::vector<block> blocks;
+      std::vector<unsigned> elems;
+      elems.reserve(n);
+      std::vector<unsigned> loc(n, -1U);
+      std::vector<unsigned> block_of(n, -1U);
+      for (unsigned c = 0; c < 2; ++c)
+        {
+          unsigned begin = elems.size();
+          for (unsigned s = 0; s < ns; ++s)
+            if (state_class[s] == c)
+              {
+                loc[s] = elems.size();
+                block_of[s] = blocks.size();
+                elems.push_back(s);
+              }
+          if (begin != elems.size())
+            blocks.push_back({begin, unsigned(elems.size())});
+        }
+      loc[sink] = elems.size();
+      block_of[sink] = blocks.size();
+      elems.push_back(sink);
+      blocks.push_back({unsigned(elems.size()) - 1,
+                        unsigned(elems.size())});
+
+      // Initially, all blocks but the largest are splitters.
+      std::vector<unsigned> work;
+      {
+        unsigned largest = 0;
+        for (unsigned b = 1; b < blocks.size(); ++b)
+          if (blocks[b].end - blocks[b].begin
+              > blocks[largest].end - blocks[largest].begin)
+            largest = b;
+        for (unsigned b = 0; b < blocks.size(); ++b)
+          if (b != largest)
+            work.push_back(b);
+      }
+
+      std::vector<bdd> pre(n, bddfalse);
+      std::vector<unsigned> touched;
+      while (!work.empty())
+        {
+          unsigned b = work.back();
+          work.pop_back();
+
+          // Label all predecessors of B.  This has to be done before
+          // splitting, because B may be split itself.
+          for (unsigned i = blocks[b].begin; i < blocks[b].end; ++i)
+            {
+              unsigned s = elems[i];
+              for (unsigned j = in_begin[s]; j < in_begin[s + 1]; ++j)
+                {
+                  unsigned p = in_src[j];
+                  if (pre[p] == bddfalse)
+                    touched.push_back(p);
+                  pre[p] |= in_cond[j];
+                }
+            }
+
+          // Group the touched states by block, and then by label.
+          std::sort(touched.begin(), touched.end(),
+                    [&](unsigned l, unsigned r)
+                    {
+                      if (block_of[l] != block_of[r])
+                        return block_of[l] < block_of[r];
+                      return pre[l].id() < pre[r].id();
+                    });
+
+          unsigned nt = touched.size();
+          for (unsigned t = 0; t < nt;)
+            {
+              unsigned c = block_of[touched[t]];
+              unsigned tend = t + 1;
+              bool same = true;
+              while (tend < nt && block_of[touched[tend]] == c)
+                {
+                  same &= pre[touched[tend]] == pre[touched[t]];
+                  ++tend;
+                }
+              unsigned begin = blocks[c].begin;
+              unsigned end = blocks[c].end;
+              if (same && tend - t == end - begin)
+                {
+                  // All states of C have the same label.
+                  t = tend;
+                  continue;
+                }
+
+              // Move the touched states at the beginning of C, in
+              // the order of their labels.
+              for (unsigned k = t; k < tend; ++k)
+                {
+                  unsigned p = touched[k];
+                  unsigned pos = begin + k - t;
+                  unsigned q = elems[pos];
+                  elems[loc[p]] = q;
+                  loc[q] = loc[p];
+                  elems[pos] = p;
+                  loc[p] = pos;
+                }
+
+              // Compute the parts of C.
+              std::vector<block> parts;
+              unsigned middle = begin + tend - t;
+              if (middle < end)
+                parts.push_back({middle, end});
+              for (unsigned k = t; k < tend;)
+                {
+                  unsigned kend = k + 1;
+                  while (kend < tend && pre[touched[kend]] == pre[touched[k]])
+                    ++kend;
+                  parts.push_back({begin + k - t, begin + kend - t});
+                  k = kend;
+                }
+              t = tend;
+
+              // C keeps the largest part, so that only the states of
+              // the other parts need to be renumbered.  If C was in
+              // the work list, it is still there and all other parts
+              // should be added.  Otherwise only the parts that are
+              // not the largest should be added.  In both cases, we
+              // add the new blocks.
+              unsigned largest = 0;
+              for (unsigned k = 1; k < parts.size(); ++k)
+                if (parts[k].end - parts[k].begin
+                    > parts[largest].end - parts[largest].begin)
+                  largest = k;
+              blocks[c] = parts[largest];
+              for (unsigned k = 0; k < parts.size(); ++k)
+                {
+                  if (k == largest)
+                    continue;
+                  unsigned nb = blocks.size();
+                  blocks.push_back(parts[k]);
+                  for (unsigned i = parts[k].begin; i < parts[k].end; ++i)
+                    block_of[elems[i]] = nb;
+                  work.push_back(nb);
+                }
+            }
+
+          for (unsigned p: touched)
+            pre[p] = bddfalse;
+          touched.clear();
+        }
+
+      // Build the result.  States are numbered in the order of the
+      // smallest state of each class, and this state is used to
+      // connect the class.
+      auto res = make_twa_graph(det_a->get_dict());
+      res->copy_ap_of(det_a);
+      res->prop_state_acc(true);
+      if (has_final)
+        res->set_buchi();
+      std::vector<unsigned> res_num(blocks.size(), -1U);
+      std::vector<unsigned> repr;
+      for (unsigned s = 0; s < ns; ++s)
+        {
+          if (state_class[s] == -1U)
+            continue;
+          unsigned& r = res_num[block_of[s]];
+          if (r == -1U)
+            {
+              r = res->new_state();
+              repr.push_back(s);
+            }
+        }
+      unsigned rs = repr.size();
+      for (unsigned r = 0; r < rs; ++r)
+        {
+          unsigned s = repr[r];
+          bool accepting = state_class[s] == 0;
+          for (auto& e: det_a->out(s))
+            if (state_class[e.dst] != -1U)
+              res->new_acc_edge(r, res_num[block_of[e.dst]],
+                                e.cond, accepting);
+        }
+      res->merge_edges();
+      if (rs > 0)
+        {
+          unsigned init = det_a->get_init_state_number();
+          res->set_init_state(state_class[init] == -1U
+                              ? 0 : res_num[block_of[init]]);
+        }
+      else
+        {
+          res->set_init_state(res->new_state());
+        }
+      return res;
+    }
+
+    // Minimize DET_A, given the initial class of each of its states,
+    // as in minimize_dfa_hopcroft().
+    static twa_graph_ptr
+    minimize_dfa(const const_twa_graph_ptr& det_a,
+                 const std::vector<unsigned>& state_class)
+    {
+      if (det_a->num_states() > max_moore_states)
+        return minimize_dfa_hopcroft(det_a, state_class);
+
+      hash_set* final = new hash_set;
+      hash_set* non_final = new hash_set;
+      unsigned ns = det_a->num_states();
+      for (unsigned s = 0; s < ns; ++s)
+        if (state_class[s] != -1U)
+          (state_class[s] ? non_final : final)
+            ->insert(det_a->state_from_number(s));
+      return minimize_dfa(det_a, final, non_final);
+    }
   }
 
   twa_graph_ptr minimize_monitor(const const_twa_graph_ptr& a)
@@ -478,14 +749,11 @@ namespace spot
       throw std::runtime_error
         ("minimize_monitor() does not support alternation");
 
-    hash_set* final = new hash_set;
-    hash_set* non_final = new hash_set;
     twa_graph_ptr det_a = tgba_powerset(a);
 
-    // non_final contain all states.
-    // final is empty: there is no acceptance condition
-    build_state_set(det_a, non_final);
-    auto res = minimize_dfa(det_a, final, non_final);
+    // All states are non-final: there is no acceptance condition.
+    std::vector<unsigned> state_class(det_a->num_states(), 1);
+    auto res = minimize_dfa(det_a, state_class);
     res->prop_copy(a, { false, false, false, false, true });
     res->prop_deterministic(true);
     res->prop_weak(true);
@@ -499,10 +767,10 @@ namespace spot
       throw std::runtime_error
         ("minimize_wdba() does not support alternation");
 
-    hash_set* final = new hash_set;
-    hash_set* non_final = new hash_set;
-
     twa_graph_ptr det_a;
+    // 0 for final states, 1 for non-final states, -1U for useless
+    // states.
+    std::vector<unsigned> state_class;
 
     {
       power_map pm;
@@ -520,6 +788,7 @@ namespace spot
       // (i.e., it is not the start of any accepting word).
 
       scc_info sm(det_a);
+      state_class.resize(det_a->num_states(), -1U);
 
       unsigned scc_count = sm.scc_count();
       // SCC that have been marked as useless.
@@ -579,15 +848,12 @@ namespace spot
           useless[m] = is_useless;
 
           if (!is_useless)
-            {
-              hash_set* dest_set = (d[m] & 1) ? non_final : final;
-              for (auto s: sm.states_of(m))
-                dest_set->insert(det_a->state_from_number(s));
-            }
+            for (auto s: sm.states_of(m))
+              state_class[s] = d[m] & 1;
         }
     }
 
-    auto res = minimize_dfa(det_a, final, non_final);
+    auto res = minimize_dfa(det_a, state_class);
     res->prop_copy(a, { false, false, false, false, true });
     res->prop_deterministic(true);
     res->prop_weak(true);
@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016
-// Laboratoire de Recherche et Développement de l'Epita (LRDE).
+// Copyright (C) 2009, 2010, 2011, 2012, 2013, 2014, 2015, 2016,
+// 2017 Laboratoire de Recherche et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
 //
@@ -64,7 +64,9 @@ namespace spot
   /// Deterministic Büchi Automaton, and construct a minimal WDBA for
   /// this language.  This essentially chains three algorithms:
   /// determinization, acceptance adjustment (Löding's coloring
-  /// algorithm), and minimization (using a Moore-like approache).
+  /// algorithm), and minimization (using a Moore-like approach on
+  /// small automata, and Hopcroft's partition refinement on larger
+  /// ones).
   ///
   /// If the input automaton does not represent a WDBA language,
   /// the resulting automaton is still a WDBA, but it will not
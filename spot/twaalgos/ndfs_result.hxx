@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2013, 2014, 2015, 2016 Laboratoire de recherche
+// Copyright (C) 2011, 2013, 2014, 2015, 2016, 2017 Laboratoire de recherche
 // et développement de l'Epita (LRDE).
 // Copyright (C) 2004, 2005, 2006 Laboratoire d'Informatique de Paris
 // 6 (LIP6), département Systèmes Répartis Coopératifs (SRC),
@@ -38,6 +38,7 @@
 #include <spot/twaalgos/emptiness.hh>
 #include <spot/twaalgos/emptiness_stats.hh>
 #include <spot/twaalgos/bfssteps.hh>
+#include <spot/twaalgos/twaiteration.hxx>
 #include <spot/misc/hash.hh>
 
 
@@ -61,6 +62,45 @@ namespace spot
 
   typedef std::list<stack_item> stack_type;
 
+  /// The equivalent of stack_item for searches that iterate directly
+  /// over the edges of a twa_graph (see twaiteration.hxx).
+  struct graph_stack_item
+  {
+    graph_stack_item(unsigned n, explicitproxy i, bdd l, acc_cond::mark_t a)
+      : s(n), it(i), label(l), acc(a) {};
+    unsigned s;
+    explicitproxy it;
+    bdd label;
+    acc_cond::mark_t acc;
+  };
+
+  typedef std::list<graph_stack_item> graph_stack_type;
+
+  template<bool is_explicit>
+  using ndfs_stack_type = typename std::conditional<is_explicit,
+                                                    graph_stack_type,
+                                                    stack_type>::type;
+
+  // ndfs_result and the results built from the stacks of the
+  // searches only know about stack_type.  The stacks of the
+  // searches over a twa_graph are converted (into \a tmp) when a
+  // counterexample is needed.  The iterators are not copied.
+  inline const stack_type&
+  as_stack_type(const const_twa_ptr&, const stack_type& st, stack_type&)
+  {
+    return st;
+  }
+
+  inline const stack_type&
+  as_stack_type(const const_twa_graph_ptr& a, const graph_stack_type& st,
+                stack_type& tmp)
+  {
+    tmp.clear();
+    for (auto& i: st)
+      tmp.emplace_back(a->state_from_number(i.s), nullptr, i.label, i.acc);
+    return tmp;
+  }
+
   namespace
   {
     // The acss_statistics is available only when the heap has a
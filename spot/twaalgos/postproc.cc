@@ -65,6 +65,7 @@ namespace spot
         det_scc_ = opt->get("det-scc", 1);
         det_simul_ = opt->get("det-simul", 1);
         det_stutter_ = opt->get("det-stutter", 1);
+        det_threads_ = opt->get("det-threads", 1);
         simul_ = opt->get("simul", -1);
         scc_filter_ = opt->get("scc-filter", -1);
         ba_simul_ = opt->get("ba-simul", -1);
@@ -382,7 +383,8 @@ namespace spot
     if (PREF_ == Deterministic && type_ == Generic && !dba)
       {
         dba = tgba_determinize(to_generalized_buchi(sim),
-                               false, det_scc_, det_simul_, det_stutter_);
+                               false, det_scc_, det_simul_, det_stutter_,
+                               det_threads_);
         if (level_ != Low)
           dba = simulation(dba);
         sim = nullptr;
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2012, 2013, 2014, 2015, 2016 Laboratoire de Recherche
+// Copyright (C) 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche
 // et Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -184,6 +184,7 @@ namespace spot
     bool det_scc_ = true;
     bool det_simul_ = true;
     bool det_stutter_ = true;
+    unsigned det_threads_ = 1;
     int simul_ = -1;
     int scc_filter_ = -1;
     int ba_simul_ = -1;
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2009-2011, 2013-2016 Laboratoire de Recherche et
+// Copyright (C) 2009-2011, 2013-2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 // Copyright (C) 2004 Laboratoire d'Informatique de Paris 6 (LIP6),
 // département Systèmes Répartis Coopératifs (SRC), Université Pierre
@@ -20,6 +20,7 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <set>
 #include <iterator>
 #include <vector>
@@ -64,10 +65,35 @@ namespace spot
       unsigned ns = in->size();
       for (unsigned pos = 0; pos < ns; ++pos)
         if (in->get(pos))
-          ps.insert(pos);
+          ps.emplace_back(pos);
       return ps;
     }
 
+    // Compare two minterms over the same variables, in the order in
+    // which bdd_satoneset() enumerates them.
+    static bool
+    minterm_less(bdd left, bdd right)
+    {
+      int l = left.id();
+      int r = right.id();
+      while (l != r)
+        {
+          bool lpos = bdd_low(l) == 0;
+          bool rpos = bdd_low(r) == 0;
+          if (lpos != rpos)
+            return rpos;
+          l = lpos ? bdd_high(l) : bdd_low(l);
+          r = rpos ? bdd_high(r) : bdd_low(r);
+        }
+      return false;
+    }
+
+    // Up to this number of atomic propositions, tgba_powerset()
+    // precomputes the successors of each state for each minterm.
+    // Above, the successors of each macro-state are computed by
+    // splitting its outgoing labels.
+    static const unsigned max_enumerated_ap = 8;
+
     struct bv_hash
     {
       size_t operator()(const bitvect* bv) const
@@ -104,49 +130,74 @@ namespace spot
     unsigned init_num = aut->get_init_state_number();
     unsigned ns = aut->num_states();
 
-    if ((-1UL / ns) >> nap == 0)
-      throw std::runtime_error("too many atomic propositions (or states)");
+    bool enumerate = nap <= max_enumerated_ap;
 
     // Build a correspondence between conjunctions of APs and unsigned
     // indexes.
     std::vector<bdd> num2bdd;
-    num2bdd.reserve(1UL << nap);
     std::map<bdd, unsigned, bdd_less_than> bdd2num;
-    bdd all = bddtrue;
-    while (all != bddfalse)
+    std::unique_ptr<bitvect_array> bv;
+    size_t nc = 0;                // number of conditions
+    if (enumerate)
       {
-        bdd one = bdd_satoneset(all, allap, bddfalse);
-        all -= one;
-        bdd2num.emplace(one, num2bdd.size());
-        num2bdd.emplace_back(one);
-      }
+        num2bdd.reserve(1UL << nap);
+        bdd all = bddtrue;
+        while (all != bddfalse)
+          {
+            bdd one = bdd_satoneset(all, allap, bddfalse);
+            all -= one;
+            bdd2num.emplace(one, num2bdd.size());
+            num2bdd.emplace_back(one);
+          }
 
-    size_t nc = num2bdd.size();        // number of conditions
-    assert(nc == (1UL << nap));
+        nc = num2bdd.size();
+        assert(nc == (1UL << nap));
 
-    // An array of bit vectors of size 'ns'.  Each original state is
-    // represented by 'nc' bitvectors representing the possible
-    // destinations for each condition.
-    auto bv = std::unique_ptr<bitvect_array>(make_bitvect_array(ns, ns * nc));
+        // An array of bit vectors of size 'ns'.  Each original state
+        // is represented by 'nc' bitvectors representing the
+        // possible destinations for each condition.
+        bv.reset(make_bitvect_array(ns, ns * nc));
 
-    for (unsigned src = 0; src < ns; ++src)
-      {
-        size_t base = src * nc;
-        for (auto& t: aut->out(src))
+        for (unsigned src = 0; src < ns; ++src)
           {
-            bdd all = t.cond;
-            while (all != bddfalse)
+            size_t base = src * nc;
+            for (auto& t: aut->out(src))
               {
-                bdd one = bdd_satoneset(all, allap, bddfalse);
-                all -= one;
-                unsigned num = bdd2num[one];
-                bv->at(base + num).set(t.dst);
+                bdd all = t.cond;
+                while (all != bddfalse)
+                  {
+                    bdd one = bdd_satoneset(all, allap, bddfalse);
+                    all -= one;
+                    unsigned num = bdd2num[one];
+                    bv->at(base + num).set(t.dst);
+                  }
               }
           }
       }
 
     typedef power_map::power_state power_state;
 
+    // Without enumeration, the letters leaving a macro-state are
+    // partitioned into blocks that have the same successors.
+    // Starting from a single block labeled by true, each block is
+    // split according to the label of the edges leaving the
+    // macro-state.  When edges are merged, it is enough to split
+    // according to the union of the labels leading to each
+    // destination.  The blocks are then sorted by their smallest
+    // minterm, so that the states are numbered as if minterms had
+    // been enumerated.
+    struct block
+    {
+      bdd label;
+      bdd min;
+      bitvect* dst;
+    };
+    std::vector<block> blocks;
+    std::vector<std::pair<bdd, std::vector<unsigned>>> splitters;
+    std::map<bdd, unsigned, bdd_less_than> splitter_of_cond;
+    std::vector<bdd> cond_to_dst(enumerate ? 0 : ns, bddfalse);
+    std::vector<unsigned> dsts;
+
     typedef std::unordered_map<bitvect*, int, bv_hash, bv_equal> power_set;
     power_set seen;
 
@@ -168,23 +219,89 @@ namespace spot
     }
 
     // outgoing map
-    auto om = std::unique_ptr<bitvect_array>(make_bitvect_array(ns, nc));
+    std::unique_ptr<bitvect_array> om;
+    if (enumerate)
+      om.reset(make_bitvect_array(ns, nc));
 
     for (unsigned src_num = 0; src_num < res->num_states(); ++src_num)
       {
-        om->clear_all();
-
         const power_state& src = pm.states_of(src_num);
 
-        for (auto s: src)
+        if (enumerate)
           {
-            size_t base = s * nc;
-            for (unsigned c = 0; c < nc; ++c)
-              om->at(c) |= bv->at(base + c);
+            om->clear_all();
+            for (auto s: src)
+              {
+                size_t base = s * nc;
+                for (unsigned c = 0; c < nc; ++c)
+                  om->at(c) |= bv->at(base + c);
+              }
           }
-        for (unsigned c = 0; c < nc; ++c)
+        else
+          {
+            for (auto& b: blocks)
+              delete b.dst;
+            blocks.clear();
+            splitters.clear();
+            if (merge)
+              {
+                for (auto s: src)
+                  for (auto& t: aut->out(s))
+                    {
+                      if (cond_to_dst[t.dst] == bddfalse)
+                        dsts.emplace_back(t.dst);
+                      cond_to_dst[t.dst] |= t.cond;
+                    }
+                for (auto d: dsts)
+                  {
+                    splitters.emplace_back(cond_to_dst[d],
+                                           std::vector<unsigned>{d});
+                    cond_to_dst[d] = bddfalse;
+                  }
+                dsts.clear();
+              }
+            else
+              {
+                for (auto s: src)
+                  for (auto& t: aut->out(s))
+                    {
+                      auto p = splitter_of_cond.emplace(t.cond,
+                                                        splitters.size());
+                      if (p.second)
+                        splitters.emplace_back(t.cond,
+                                               std::vector<unsigned>{});
+                      splitters[p.first->second].second.emplace_back(t.dst);
+                    }
+                splitter_of_cond.clear();
+              }
+            blocks.push_back({bddtrue, bddfalse, make_bitvect(ns)});
+            for (auto& sp: splitters)
+              for (unsigned b = 0, nb = blocks.size(); b < nb; ++b)
+                {
+                  bdd in = blocks[b].label & sp.first;
+                  if (in == bddfalse)
+                    continue;
+                  bdd out = blocks[b].label - sp.first;
+                  if (out != bddfalse)
+                    blocks.push_back({out, bddfalse,
+                                      blocks[b].dst->clone()});
+                  blocks[b].label = in;
+                  for (auto d: sp.second)
+                    blocks[b].dst->set(d);
+                }
+            for (auto& b: blocks)
+              b.min = bdd_satoneset(b.label, allap, bddfalse);
+            std::sort(blocks.begin(), blocks.end(),
+                      [](const block& l, const block& r)
+                      {
+                        return minterm_less(l.min, r.min);
+                      });
+          }
+
+        unsigned nsucc = enumerate ? nc : blocks.size();
+        for (unsigned c = 0; c < nsucc; ++c)
           {
-            auto dst = &om->at(c);
+            auto dst = enumerate ? &om->at(c) : blocks[c].dst;
             if (dst->is_fully_clear())
               continue;
             auto i = seen.find(dst);
@@ -203,10 +320,13 @@ namespace spot
                 assert(pm.map_.size() == dst_num);
                 pm.map_.emplace_back(std::move(ps));
               }
-            res->new_edge(src_num, dst_num, num2bdd[c]);
+            res->new_edge(src_num, dst_num,
+                          enumerate ? num2bdd[c] : blocks[c].label);
           }
       }
 
+    for (auto& b: blocks)
+      delete b.dst;
     for (auto v: toclean)
       delete v;
     if (merge)
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2013, 2014, 2015 Laboratoire de Recherche et
+// Copyright (C) 2011, 2013, 2014, 2015, 2017 Laboratoire de Recherche et
 // Développement de l'Epita.
 // Copyright (C) 2004 Laboratoire d'Informatique de Paris 6 (LIP6),
 // département Systèmes Répartis Coopératifs (SRC), Université Pierre
@@ -22,7 +22,6 @@
 
 #pragma once
 
-#include <set>
 #include <vector>
 #include <spot/twa/twagraph.hh>
 
@@ -31,7 +30,9 @@ namespace spot
 
   struct SPOT_API power_map
   {
-    typedef std::set<unsigned> power_state;
+    /// The original states of a state of the deterministic automaton,
+    /// in increasing order.
+    typedef std::vector<unsigned> power_state;
     std::vector<power_state> map_;
 
     const power_state&
@@ -53,6 +54,13 @@ namespace spot
   /// associated to each state of the deterministic automaton.
   /// The \a merge argument can be set to false to prevent merging of
   /// transitions.
+  ///
+  /// When the automaton uses few atomic propositions, the successors
+  /// of each state are precomputed for each of the 2^n minterms.
+  /// Otherwise, the letters leaving each state of the deterministic
+  /// automaton are partitioned according to the labels of the
+  /// original edges, so that only the partitions that are reachable
+  /// are computed.  Both methods number the states in the same way.
   //@{
   SPOT_API twa_graph_ptr
   tgba_powerset(const const_twa_graph_ptr& aut,
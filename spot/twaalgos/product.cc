@@ -20,7 +20,8 @@
 #include <spot/twaalgos/product.hh>
 #include <spot/twa/twagraph.hh>
 #include <spot/twaalgos/complete.hh>
-#include <deque>
+#include <algorithm>
+#include <cstdint>
 #include <unordered_map>
 #include <spot/misc/hash.hh>
 
@@ -28,14 +29,139 @@ namespace spot
 {
   namespace
   {
-    typedef std::pair<unsigned, unsigned> product_state;
+    // Open-addressing hash table (with linear probing) associating
+    // pairs of states to the states of the product.
+    class product_table final
+    {
+      struct slot
+      {
+        unsigned left;
+        unsigned right;
+        unsigned num;           // -1U for empty slots.
+      };
+      std::vector<slot> slots_;
+      size_t mask_;
+      size_t size_ = 0;
+
+      static size_t hash(unsigned left, unsigned right)
+      {
+        return wang32_hash(left ^ wang32_hash(right));
+      }
 
-    struct product_state_hash
+      void grow()
+      {
+        std::vector<slot> old(2 * slots_.size(), slot{0, 0, -1U});
+        std::swap(old, slots_);
+        mask_ = slots_.size() - 1;
+        for (auto& s: old)
+          if (s.num != -1U)
+            {
+              size_t i = hash(s.left, s.right) & mask_;
+              while (slots_[i].num != -1U)
+                i = (i + 1) & mask_;
+              slots_[i] = s;
+            }
+      }
+
+    public:
+      product_table()
+        : slots_(256, slot{0, 0, -1U}), mask_(255)
+      {
+      }
+
+      // Return the number of the pair (left, right), and whether
+      // it has just been inserted with number num.
+      std::pair<unsigned, bool>
+      insert(unsigned left, unsigned right, unsigned num)
+      {
+        if (2 * (size_ + 1) > slots_.size())
+          grow();
+        size_t i = hash(left, right) & mask_;
+        for (;;)
+          {
+            slot& s = slots_[i];
+            if (s.num == -1U)
+              {
+                s = slot{left, right, num};
+                ++size_;
+                return {num, true};
+              }
+            if (s.left == left && s.right == right)
+              return {s.num, false};
+            i = (i + 1) & mask_;
+          }
+      }
+    };
+
+    // Atomic propositions that the label of an edge forces to true
+    // (pos) or to false (neg), as bits indexed by proposition.  Two
+    // labels whose literals clash have a false conjunction, which
+    // can then be detected without any BDD operation.
+    struct label_literals
     {
-      size_t
-      operator()(product_state s) const
+      uint64_t pos;
+      uint64_t neg;
+
+      bool compatible(const label_literals& o) const
       {
-        return wang32_hash(s.first ^ wang32_hash(s.second));
+        return !((pos & o.neg) | (neg & o.pos));
+      }
+    };
+
+    // The literals of the labels of the edges of an automaton,
+    // computed the first time the edges of a state are needed.
+    class edge_literals final
+    {
+      const const_twa_graph_ptr& aut_;
+      const std::vector<int>& bit_of_var_;
+      std::vector<label_literals> lits_; // Indexed by edge.
+      std::vector<bool> done_;           // Indexed by state.
+      std::unordered_map<int, label_literals> cache_; // By BDD id.
+
+      label_literals literals(const bdd& cond)
+      {
+        auto p = cache_.emplace(cond.id(), label_literals{0, 0});
+        if (p.second)
+          {
+            bdd sup = bdd_support(cond);
+            while (sup != bddtrue)
+              {
+                int v = bdd_var(sup);
+                sup = bdd_high(sup);
+                int b = bit_of_var_[v];
+                if (b < 0)
+                  continue;
+                if (bdd_implies(cond, bdd_ithvar(v)))
+                  p.first->second.pos |= uint64_t(1) << b;
+                else if (bdd_implies(cond, bdd_nithvar(v)))
+                  p.first->second.neg |= uint64_t(1) << b;
+              }
+          }
+        return p.first->second;
+      }
+
+    public:
+      edge_literals(const const_twa_graph_ptr& aut,
+                    const std::vector<int>& bit_of_var)
+        : aut_(aut), bit_of_var_(bit_of_var),
+          lits_(aut->edge_vector().size()), done_(aut->num_states())
+      {
+      }
+
+      // Compute the literals of the edges leaving s.
+      void prepare(unsigned s)
+      {
+        if (done_[s])
+          return;
+        done_[s] = true;
+        auto& g = aut_->get_graph();
+        for (auto& e: aut_->out(s))
+          lits_[g.index_of_edge(e)] = literals(e.cond);
+      }
+
+      const label_literals& operator[](unsigned edge) const
+      {
+        return lits_[edge];
       }
     };
 
@@ -44,13 +170,12 @@ namespace spot
                               const const_twa_graph_ptr& right,
                               unsigned left_state,
                               unsigned right_state,
-                              bool and_acc)
+                              bool and_acc,
+                              const product_stop_fn& stop)
     {
       if (!(left->is_existential() && right->is_existential()))
         throw std::runtime_error
           ("product() does not support alternating automata");
-      std::unordered_map<product_state, unsigned, product_state_hash> s2n;
-      std::deque<std::pair<product_state, unsigned>> todo;
 
       if (left->get_dict() != right->get_dict())
         throw std::runtime_error("product: left and right automata should "
@@ -69,19 +194,22 @@ namespace spot
       auto v = new product_states;
       res->set_named_prop("product-states", v);
 
+      // States of the product are numbered in the order they are
+      // discovered, so the states that remain to be explored are
+      // simply those numbered from the current one to the last one.
+      product_table s2n;
       auto new_state =
         [&](unsigned left_state, unsigned right_state) -> unsigned
         {
-          product_state x(left_state, right_state);
-          auto p = s2n.emplace(x, 0);
+          auto p = s2n.insert(left_state, right_state, v->size());
           if (p.second)                // This is a new state
             {
-              p.first->second = res->new_state();
-              todo.emplace_back(x, p.first->second);
-              assert(p.first->second == v->size());
-              v->emplace_back(x);
+              unsigned s = res->new_state();
+              (void) s;
+              assert(s == v->size());
+              v->emplace_back(left_state, right_state);
             }
-          return p.first->second;
+          return p.first;
         };
 
       res->set_init_state(new_state(left_state, right_state));
@@ -89,25 +217,58 @@ namespace spot
         // Do not bother doing any work if the resulting acceptance is
         // false.
         return res;
-      while (!todo.empty())
+
+      // Assign a bit to (at most 64) atomic propositions, and compute
+      // the literals forced by each edge label.
+      std::vector<int> bit_of_var(bdd_varnum(), -1);
+      {
+        int bit = 0;
+        bdd all = res->ap_vars();
+        while (all != bddtrue && bit < 64)
+          {
+            bit_of_var[bdd_var(all)] = bit++;
+            all = bdd_high(all);
+          }
+      }
+      edge_literals left_lits(left, bit_of_var);
+      edge_literals right_lits(right, bit_of_var);
+      auto& lg = left->get_graph();
+      auto& rg = right->get_graph();
+
+      // The conjunctions of labels are computed sequentially, in the
+      // order the edges are created, so that the BDD nodes of the
+      // result do not depend on any scheduling.
+      bool stopped = false;
+      for (unsigned n = 0; n < res->num_states() && !stopped; ++n)
         {
-          auto top = todo.front();
-          todo.pop_front();
-          for (auto& l: left->out(top.first.first))
-            for (auto& r: right->out(top.first.second))
-              {
-                auto cond = l.cond & r.cond;
-                if (cond == bddfalse)
-                  continue;
-                auto dst = new_state(l.dst, r.dst);
-                res->new_edge(top.second, dst, cond,
-                              l.acc | (r.acc << left_num));
-                // If right is deterministic, we can abort immediately!
-              }
+          auto p = (*v)[n];
+          left_lits.prepare(p.first);
+          right_lits.prepare(p.second);
+          for (auto& l: left->out(p.first))
+            {
+              auto& ll = left_lits[lg.index_of_edge(l)];
+              for (auto& r: right->out(p.second))
+                {
+                  if (!ll.compatible(right_lits[rg.index_of_edge(r)]))
+                    continue;
+                  bdd cond = l.cond & r.cond;
+                  if (cond == bddfalse)
+                    continue;
+                  res->new_edge(n, new_state(l.dst, r.dst), cond,
+                                l.acc | (r.acc << left_num));
+                }
+            }
+          stopped = stop && stop(res, n);
         }
 
       res->prop_deterministic(left->prop_deterministic()
                               && right->prop_deterministic());
+      res->prop_state_acc(left->prop_state_acc()
+                          && right->prop_state_acc());
+      // The following properties do not necessarily hold for the
+      // part of the product built before the construction stopped.
+      if (stopped)
+        return res;
       res->prop_stutter_invariant(left->prop_stutter_invariant()
                                   && right->prop_stutter_invariant());
       // The product of X!a and Xa, two stutter-sentive formulas,
@@ -120,8 +281,6 @@ namespace spot
                      && right->prop_weak());
       res->prop_terminal(left->prop_terminal()
                          && right->prop_terminal());
-      res->prop_state_acc(left->prop_state_acc()
-                          && right->prop_state_acc());
       return res;
     }
   }
@@ -131,7 +290,8 @@ namespace spot
                         unsigned left_state,
                         unsigned right_state)
   {
-    return product_aux(left, right, left_state, right_state, true);
+    return product_aux(left, right, left_state, right_state, true,
+                       nullptr);
   }
 
   twa_graph_ptr product(const const_twa_graph_ptr& left,
@@ -142,6 +302,15 @@ namespace spot
                    right->get_init_state_number());
   }
 
+  twa_graph_ptr product(const const_twa_graph_ptr& left,
+                        const const_twa_graph_ptr& right,
+                        const product_stop_fn& stop)
+  {
+    return product_aux(left, right,
+                       left->get_init_state_number(),
+                       right->get_init_state_number(), true, stop);
+  }
+
   twa_graph_ptr product_or(const const_twa_graph_ptr& left,
                            const const_twa_graph_ptr& right,
                            unsigned left_state,
@@ -149,7 +318,7 @@ namespace spot
   {
     return product_aux(complete(left),
                        complete(right),
-                       left_state, right_state, false);
+                       left_state, right_state, false, nullptr);
   }
 
   twa_graph_ptr product_or(const const_twa_graph_ptr& left,
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2014, 2015 Laboratoire de Recherche et
+// Copyright (C) 2014, 2015, 2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -21,6 +21,7 @@
 
 #include <spot/misc/common.hh>
 #include <spot/twa/fwd.hh>
+#include <functional>
 #include <vector>
 #include <utility>
 
@@ -40,6 +41,28 @@ namespace spot
                         unsigned left_state,
                         unsigned right_state);
 
+#ifndef SWIG
+  /// \brief Predicate used to stop the construction of a product.
+  ///
+  /// The product is built in breadth-first order.  This predicate
+  /// is called with the automaton being built and the number of a
+  /// state whose successors have just been added.  If it returns
+  /// true, the construction stops, and the states that have not been
+  /// explored yet are left without successors.  For instance, a
+  /// predicate looking for an accepting self-loop on the given
+  /// state can stop the construction as soon as the product is
+  /// known to be non-empty.
+  typedef std::function<bool(const const_twa_graph_ptr&, unsigned)>
+    product_stop_fn;
+
+  /// \brief Build the product of \a left and \a right, from their
+  /// initial states, until \a stop returns true.
+  SPOT_API
+  twa_graph_ptr product(const const_twa_graph_ptr& left,
+                        const const_twa_graph_ptr& right,
+                        const product_stop_fn& stop);
+#endif
+
   SPOT_API
   twa_graph_ptr product_or(const const_twa_graph_ptr& left,
                            const const_twa_graph_ptr& right);
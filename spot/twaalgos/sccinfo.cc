@@ -18,8 +18,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <spot/twaalgos/sccinfo.hh>
-#include <stack>
 #include <algorithm>
+#include <atomic>
 #include <queue>
 #include <spot/twa/bddprint.hh>
 #include <spot/twaalgos/mask.hh>
@@ -45,16 +45,27 @@ namespace spot
       bool trivial = true;        // Whether the SCC has no cycle
       bool accepting = false;        // Necessarily accepting
     };
+
+    static std::atomic<unsigned long> num_constructions(0);
+  }
+
+  unsigned long scc_info::constructions()
+  {
+    return num_constructions;
   }
 
   scc_info::scc_info(const_twa_graph_ptr aut)
     : aut_(aut)
   {
+    ++num_constructions;
     unsigned n = aut->num_states();
     sccof_.resize(n, -1U);
 
-    std::deque<unsigned> live;
-    std::deque<scc> root_;        // Stack of SCC roots.
+    // All stacks are vectors, so that the DFS works on contiguous
+    // memory and does not allocate once they have reached their
+    // maximal size.
+    std::vector<unsigned> live;
+    std::vector<scc> root_;        // Stack of SCC roots.
     std::vector<int> h_(n, 0);
     // Map of visited states.  Values > 0 designate maximal SCC.
     // Values < 0 number states that are part of incomplete SCCs being
@@ -71,7 +82,10 @@ namespace spot
     // the current outgoing transition of STATE, and UNIV_POS is used
     // when the transition is universal to iterate over all possible
     // destinations.
-    std::stack<stack_item> todo_;
+    std::vector<stack_item> todo_;
+    // For each SCC, the last SCC that listed it as a successor.  This
+    // is used to gather the successors of an SCC without duplicates.
+    std::vector<unsigned> succ_of;
     auto& gr = aut->get_graph();
 
     // Setup depth-first search from the initial state.  But we may
@@ -84,22 +98,22 @@ namespace spot
         assert(spi == 0);
         h_[init] = --num_;
         root_.emplace_back(num_, 0U);
-        todo_.emplace(stack_item{init, gr.state_storage(init).succ, 0});
+        todo_.push_back(stack_item{init, gr.state_storage(init).succ, 0});
         live.emplace_back(init);
 
         while (!todo_.empty())
           {
             // We are looking at the next successor in SUCC.
-            unsigned tr_succ = todo_.top().out_edge;
+            unsigned tr_succ = todo_.back().out_edge;
 
             // If there is no more successor, backtrack.
             if (!tr_succ)
               {
                 // We have explored all successors of state CURR.
-                unsigned curr = todo_.top().src;
+                unsigned curr = todo_.back().src;
 
                 // Backtrack TODO_.
-                todo_.pop();
+                todo_.pop_back();
 
                 // When backtracking the root of an SCC, we must also
                 // remove that SCC from the ARC/ROOT stacks.  We must
@@ -111,6 +125,7 @@ namespace spot
                     auto acc = root_.back().acc;
                     bool triv = root_.back().trivial;
                     node_.emplace_back(acc, triv);
+                    succ_of.push_back(-1U);
 
                     // Move all elements of this SCC from the live stack
                     // to the the node.
@@ -121,7 +136,6 @@ namespace spot
                     nbs.insert(nbs.end(), i.base(), live.end());
                     live.erase(i.base(), live.end());
 
-                    std::set<unsigned> dests;
                     unsigned np1 = num + 1;
                     for (unsigned s: nbs)
                       {
@@ -129,18 +143,19 @@ namespace spot
                         h_[s] = np1;
                       }
                     // Gather all successor SCCs
+                    auto& succ = node_.back().succ_;
                     for (unsigned s: nbs)
                       for (auto& t: aut->out(s))
                         for (unsigned d: aut->univ_dests(t))
                           {
                             unsigned n = sccof_[d];
                             assert(n != -1U);
-                            if (n == num)
+                            if (n == num || succ_of[n] == num)
                               continue;
-                            dests.insert(n);
+                            succ_of[n] = num;
+                            succ.push_back(n);
                           }
-                    auto& succ = node_.back().succ_;
-                    succ.insert(succ.end(), dests.begin(), dests.end());
+                    std::sort(succ.begin(), succ.end());
                     bool accept = !triv && root_.back().accepting;
                     node_.back().accepting_ = accept;
                     bool reject = triv || !aut->acc().inf_satisfiable(acc);
@@ -183,24 +198,24 @@ namespace spot
             if ((int) dest < 0)
               {
                 // Iterate over all destinations of an universal edge.
-                if (todo_.top().univ_pos == 0)
-                  todo_.top().univ_pos = ~dest + 1;
+                if (todo_.back().univ_pos == 0)
+                  todo_.back().univ_pos = ~dest + 1;
                 const auto& v = gr.dests_vector();
-                dest = v[todo_.top().univ_pos];
+                dest = v[todo_.back().univ_pos];
                 // Last universal destination?
-                if (~e.dst + v[~e.dst] == todo_.top().univ_pos)
+                if (~e.dst + v[~e.dst] == todo_.back().univ_pos)
                   {
-                    todo_.top().out_edge = e.next_succ;
-                    todo_.top().univ_pos = 0;
+                    todo_.back().out_edge = e.next_succ;
+                    todo_.back().univ_pos = 0;
                   }
                 else
                   {
-                    ++todo_.top().univ_pos;
+                    ++todo_.back().univ_pos;
                   }
               }
             else
               {
-                todo_.top().out_edge = e.next_succ;
+                todo_.back().out_edge = e.next_succ;
               }
 
             auto acc = e.acc;
@@ -213,7 +228,8 @@ namespace spot
                 // for later processing.
                 h_[dest] = --num_;
                 root_.emplace_back(num_, acc);
-                todo_.emplace(stack_item{dest, gr.state_storage(dest).succ, 0});
+                todo_.push_back(stack_item{dest,
+                                           gr.state_storage(dest).succ, 0});
                 live.emplace_back(dest);
                 continue;
               }
@@ -259,8 +275,11 @@ namespace spot
             // Accumulate all acceptance conditions, states, SCC
             // successors, and conditions into the merged SCC.
             root_.back().acc |= acc;
-            root_.back().accepting |= is_accepting
-              || aut->acc().accepting(root_.back().acc);
+            // Evaluating the acceptance condition is costly, so skip
+            // it for SCCs already known to be accepting.
+            if (!root_.back().accepting)
+              root_.back().accepting = is_accepting
+                || aut->acc().accepting(root_.back().acc);
             // This SCC is no longer trivial.
             root_.back().trivial = false;
           }
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Développement de l'Epita.
 //
 // This file is part of Spot, a model checking library.
@@ -226,6 +226,12 @@ namespace spot
     std::vector<bool> weak_sccs() const;
 
     bdd scc_ap_support(unsigned scc) const;
+
+    /// \brief Number of scc_info objects constructed so far.
+    ///
+    /// This is meant to be used by benchmarks that check how often
+    /// algorithms recompute the SCCs of their input.
+    static unsigned long constructions();
   };
 
 
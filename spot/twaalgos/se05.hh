@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013, 2014 Laboratoire de Recherche et Developpement
-// de l'Epita (LRDE).
+// Copyright (C) 2013, 2014, 2017 Laboratoire de Recherche et
+// Developpement de l'Epita (LRDE).
 // Copyright (C) 2004, 2005 Laboratoire d'Informatique de Paris 6
 // (LIP6), département Systèmes Répartis Coopératifs (SRC), Université
 // Pierre et Marie Curie.
@@ -123,7 +123,13 @@ namespace spot
   ///
   /// Consequently, the detection of an acceptence cycle is not ensured.
   ///
-  /// The size of the heap is limited to \n size bytes.
+  /// The size of the heap is limited to \n size bytes.  Each state
+  /// is mapped to as many slots of the heap as the value of the \c
+  /// "k" option of \a o (1 by default): using several hash functions
+  /// reduces the probability of collisions as long as the heap is
+  /// not too full.  The print_stats() method of the result displays
+  /// an estimate of the fraction of the state space that was
+  /// visited.
   ///
   /// The implemented algorithm is the same as the one of
   /// spot::explicit_se05_search.
@@ -18,16 +18,18 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <queue>
-#include <map>
 #include <utility>
 #include <cmath>
 #include <limits>
+#include <list>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
 #include <spot/twaalgos/simulation.hh>
 #include <spot/misc/minato.hh>
 #include <spot/twa/bddprint.hh>
 #include <spot/twaalgos/reachiter.hh>
 #include <spot/twaalgos/sccfilter.hh>
-#include <spot/twaalgos/sccinfo.hh>
 #include <spot/twaalgos/sepsets.hh>
 #include <spot/twaalgos/isdet.hh>
 #include <spot/misc/bddlt.hh>
@@ -47,6 +49,12 @@
 //  correspond to ignored transitions.
 //
 //  See our Spin'13 paper for background on this procedure.
+//
+//  The refinement is incremental: a signature is only recomputed if
+//  the class of one of its destinations has changed, and the
+//  implications between classes are only looked for between classes
+//  whose parents were in implication at the previous iteration,
+//  whenever this is known to be safe (see compute_implications()).
 
 namespace spot
 {
@@ -55,9 +63,11 @@ namespace spot
     // Used to get the signature of the state.
     typedef std::vector<bdd> vector_state_bdd;
 
-    // Get the list of state for each class.
-    typedef std::map<bdd, std::list<unsigned>,
-                     bdd_less_than> map_bdd_lstate;
+    // Get the list of state for each class, with the signature of
+    // that class.  Classes are sorted by signature, as if they were
+    // stored in a std::map<bdd, ..., bdd_less_than>.
+    typedef std::vector<std::pair<bdd, std::vector<unsigned>>>
+      vector_class_lstate;
 
     // This class helps to compare two automata in term of
     // size.
@@ -126,7 +136,6 @@ namespace spot
     class direct_simulation final
     {
     protected:
-      typedef std::map<bdd, bdd, bdd_less_than> map_bdd_bdd;
       int acc_vars;
       acc_cond::mark_t all_inf_;
     public:
@@ -154,6 +163,9 @@ namespace spot
 
       direct_simulation(const const_twa_graph_ptr& in)
         : po_size_(0),
+          prev_implied_(1),
+          prev_dead_(0),
+          monotonic_(true),
           all_class_var_(bddtrue),
           original_(in)
       {
@@ -164,8 +176,6 @@ namespace spot
           throw std::runtime_error
             ("direct_simulation() does not yet support alternation");
 
-        scc_info_.reset(new scc_info(in));
-
         unsigned ns = in->num_states();
         size_a_ = ns;
         unsigned init_state_number = in->get_init_state_number();
@@ -236,6 +246,7 @@ namespace spot
           all_proms_ &= bdd_ithvar(v);
 
         bdd_initial = bdd_ithvar(set_num++);
+        first_class_var_ = set_num;
         bdd init = bdd_ithvar(set_num++);
 
         used_var_.emplace_back(init);
@@ -256,7 +267,10 @@ namespace spot
             all_class_var_ &= bdd_ithvar(i);
           }
 
-        relation_[init] = init;
+        relation_.resize(size_a_ + 1);
+        relation(init) = init;
+        prev_index_.resize(size_a_);
+        edge_label_.resize(a_->edge_vector().size());
       }
 
 
@@ -319,6 +333,15 @@ namespace spot
         return build_result(implications);
       }
 
+      // The implications of a class, i.e., the conjunction of its
+      // variable with those of all the classes it implies.
+      bdd& relation(const bdd& cl)
+      {
+        if (cl == bddfalse)
+          return relation_[0];
+        return relation_[bdd_var(cl) - first_class_var_ + 1];
+      }
+
       // Take a state and compute its signature.
       bdd compute_sig(unsigned src)
       {
@@ -326,12 +349,16 @@ namespace spot
 
         for (auto& t: a_->out(src))
           {
-            bdd acc = mark_to_bdd(t.acc);
+            // The conjunction of the acceptance condition and of the
+            // label of the edge does not change between iterations.
+            bdd& label = edge_label_[a_->get_graph().index_of_edge(t)];
+            if (label == bddfalse)
+              label = mark_to_bdd(t.acc) & t.cond;
 
             // to_add is a conjunction of the acceptance condition,
             // the label of the edge and the class of the
             // destination and all the class it implies.
-            bdd to_add = acc & t.cond & relation_[previous_class_[t.dst]];
+            bdd to_add = label & relation(previous_class_[t.dst]);
 
             res |= to_add;
           }
@@ -347,8 +374,48 @@ namespace spot
 
       void update_sig()
       {
+        // Only the states that have a successor whose implications
+        // have changed since the previous iteration can have a new
+        // signature.
+        bool first = sig_.empty();
+        if (first)
+          {
+            sig_.resize(size_a_);
+            dst_rel_.resize(size_a_);
+          }
+        std::vector<char> changed(size_a_, false);
+        for (unsigned s = 0; s < size_a_; ++s)
+          {
+            const bdd& r = relation(previous_class_[s]);
+            if (r != dst_rel_[s])
+              {
+                dst_rel_[s] = r;
+                changed[s] = true;
+              }
+          }
+        std::vector<char> dirty(size_a_, first);
+        for (auto& t: a_->edges())
+          if (changed[t.dst])
+            dirty[t.src] = true;
+        for (unsigned s = 0; s < size_a_; ++s)
+          if (dirty[s])
+            sig_[s] = compute_sig(s);
+
+        // Group the states by signature.
+        std::unordered_map<int, unsigned> index;
         for (unsigned s = 0; s < size_a_; ++s)
-          bdd_lstate_[compute_sig(s)].emplace_back(s);
+          {
+            auto p = index.emplace(sig_[s].id(), bdd_lstate_.size());
+            if (p.second)
+              bdd_lstate_.emplace_back(sig_[s], std::vector<unsigned>());
+            bdd_lstate_[p.first->second].second.emplace_back(s);
+          }
+        std::sort(bdd_lstate_.begin(), bdd_lstate_.end(),
+                  [](const vector_class_lstate::value_type& l,
+                     const vector_class_lstate::value_type& r)
+                  {
+                    return l.first.id() < r.first.id();
+                  });
       }
 
 
@@ -379,7 +446,7 @@ namespace spot
 
 
         assert((bdd_lstate_.size() == used_var_.size())
-               || (bdd_lstate_.find(bddfalse) != bdd_lstate_.end()
+               || (bdd_lstate_.front().first == bddfalse
                    && bdd_lstate_.size() == used_var_.size() + 1));
 
         // This vector links the tuple "C^(i-1), N^(i-1)" to the
@@ -412,26 +479,138 @@ namespace spot
         // |  | update po if needed
         // |  od
         // od
+        //
+        // except that the implications are computed beforehand.
+        std::vector<std::vector<unsigned>> implied;
+        if (want_implications_)
+          implied = compute_implications(now_to_next);
 
         for (unsigned n = 0; n < sz; ++n)
           {
-            bdd n_sig = now_to_next[n].first;
             bdd n_class = now_to_next[n].second;
             if (want_implications_)
-              for (unsigned m = 0; m < sz; ++m)
+              for (unsigned m: implied[n])
                 {
-                  if (n == m)
-                    continue;
-                  if (bdd_implies(n_sig, now_to_next[m].first))
-                    {
-                      n_class &= now_to_next[m].second;
-                      ++po_size_;
-                    }
+                  n_class &= now_to_next[m].second;
+                  ++po_size_;
                 }
-            relation_[now_to_next[n].second] = n_class;
+            relation(now_to_next[n].second) = n_class;
           }
       }
 
+      // Compute, for each class n, the ordered list of the classes
+      // m != n such that the signature of n implies that of m.
+      //
+      // Let us write s <= t when the signature of s implies that of
+      // t.  This relation can only shrink from one iteration to the
+      // next, provided that it did shrink at the previous iteration,
+      // and that no state got the bddfalse signature: the signature
+      // of s implies that of t iff each edge of s leading to a
+      // non-bddfalse class is matched by an edge of t whose
+      // destination is greater.  When this holds, we only look for
+      // implications between classes whose parents were in
+      // implication.  Otherwise all pairs are tried.
+      //
+      // Since bdd_implies() does not create any node, the pairs can
+      // be tried from several threads if BuDDy allows it.
+      std::vector<std::vector<unsigned>>
+      compute_implications(const std::vector<std::pair<bdd, bdd>>&
+                           now_to_next)
+      {
+        unsigned sz = now_to_next.size();
+        std::vector<std::vector<unsigned>> implied(sz);
+
+        // The class of the previous iteration that each class comes
+        // from, and the classes coming from each previous class.
+        std::vector<unsigned> parent(sz);
+        std::vector<std::vector<unsigned>> children(prev_implied_.size());
+        bool refined = true;
+        unsigned dead = 0;
+        for (unsigned n = 0; n < sz; ++n)
+          {
+            auto& states = bdd_lstate_[n].second;
+            unsigned p = prev_index_[states.front()];
+            for (auto s: states)
+              if (prev_index_[s] != p)
+                refined = false;
+            parent[n] = p;
+            children[p].emplace_back(n);
+            if (now_to_next[n].first == bddfalse)
+              dead = states.size();
+          }
+        bool prune = monotonic_ && refined;
+
+        auto check = [&](unsigned n, std::vector<unsigned>& candidates)
+          {
+            const bdd& n_sig = now_to_next[n].first;
+            if (!prune)
+              {
+                for (unsigned m = 0; m < sz; ++m)
+                  if (n != m && bdd_implies(n_sig, now_to_next[m].first))
+                    implied[n].emplace_back(m);
+                return;
+              }
+            unsigned p = parent[n];
+            candidates = children[p];
+            for (unsigned q: prev_implied_[p])
+              candidates.insert(candidates.end(),
+                                children[q].begin(), children[q].end());
+            std::sort(candidates.begin(), candidates.end());
+            for (unsigned m: candidates)
+              if (n != m && bdd_implies(n_sig, now_to_next[m].first))
+                implied[n].emplace_back(m);
+          };
+
+        unsigned nthreads = 1;
+        if (sz >= 256 && bdd_isthreadsafe())
+          nthreads = std::min(sz / 128,
+                              std::thread::hardware_concurrency());
+        if (nthreads > 1)
+          {
+            auto worker = [&](unsigned i)
+              {
+                std::vector<unsigned> candidates;
+                for (unsigned n = i; n < sz; n += nthreads)
+                  check(n, candidates);
+              };
+            std::vector<std::thread> workers;
+            workers.reserve(nthreads - 1);
+            for (unsigned i = 1; i < nthreads; ++i)
+              workers.emplace_back(worker, i);
+            worker(0);
+            for (auto& w: workers)
+              w.join();
+          }
+        else
+          {
+            std::vector<unsigned> candidates;
+            for (unsigned n = 0; n < sz; ++n)
+              check(n, candidates);
+          }
+
+        // Decide whether the pairs can be pruned at the next
+        // iteration.
+        bool monotonic = refined && dead == prev_dead_;
+        for (unsigned n = 0; monotonic && n < sz; ++n)
+          {
+            auto& pi = prev_implied_[parent[n]];
+            for (unsigned m: implied[n])
+              if (parent[m] != parent[n]
+                  && !std::binary_search(pi.begin(), pi.end(), parent[m]))
+                {
+                  monotonic = false;
+                  break;
+                }
+          }
+        monotonic_ = monotonic;
+        prev_dead_ = dead;
+        for (unsigned n = 0; n < sz; ++n)
+          for (auto s: bdd_lstate_[n].second)
+            prev_index_[s] = n;
+        prev_implied_ = implied;
+        return implied;
+      }
+
       // Build the minimal resulting automaton.
       twa_graph_ptr build_result(std::vector<bdd>* implications = nullptr)
       {
@@ -453,9 +632,9 @@ namespace spot
             // A state may be referred to either by
             // its class, or by all the implied classes.
             auto s = gb->new_state(cl.id());
-            gb->alias_state(s, relation_[cl].id());
+            gb->alias_state(s, relation(cl).id());
             if (implications)
-              (*implications)[s] = relation_[cl];
+              (*implications)[s] = relation(cl);
           }
 
         // Acceptance of states.  Only used if Sba && Cosimulation.
@@ -640,15 +819,25 @@ namespace spot
       // The automaton which is simulated.
       twa_graph_ptr a_;
 
-      // Implications between classes.
-      map_bdd_bdd relation_;
+      // Implications between classes, indexed by the variable of
+      // each class (see relation()).
+      std::vector<bdd> relation_;
+      int first_class_var_;
 
       // Represent the class of each state at the previous iteration.
       vector_state_bdd previous_class_;
 
       // The list of state for each class at the current_iteration.
       // Computed in `update_sig'.
-      map_bdd_lstate bdd_lstate_;
+      vector_class_lstate bdd_lstate_;
+
+      // The signature of each state, and the implications of its
+      // class when the signatures were last computed.
+      vector_state_bdd sig_;
+      vector_state_bdd dst_rel_;
+
+      // The conjunction of the acceptance and the label of each edge.
+      std::vector<bdd> edge_label_;
 
       // The queue of free bdd. They will be used as the identifier
       // for the class.
@@ -663,6 +852,17 @@ namespace spot
       // Used to know when there is no evolution in the partial order.
       unsigned int po_size_;
 
+      // For each state, the index of its class at the previous
+      // iteration, and for each of these classes, the classes it
+      // implied.  Used by compute_implications().
+      std::vector<unsigned> prev_index_;
+      std::vector<std::vector<unsigned>> prev_implied_;
+      // The number of states with a bddfalse signature at the
+      // previous iteration.
+      unsigned prev_dead_;
+      // Whether the implications can only shrink.
+      bool monotonic_;
+
       // Whether to compute implications between classes.  This is costly
       // and useless for deterministic automata.
       bool want_implications_;
@@ -677,8 +877,6 @@ namespace spot
 
       automaton_size stat;
 
-      std::unique_ptr<scc_info> scc_info_;
-
       const const_twa_graph_ptr original_;
     };
 
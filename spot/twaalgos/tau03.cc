@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2013, 2014, 2015, 2016 Laboratoire de Recherche
-// et Developpement de l'Epita (LRDE).
+// Copyright (C) 2011, 2013, 2014, 2015, 2016, 2017 Laboratoire de
+// Recherche et Developpement de l'Epita (LRDE).
 // Copyright (C) 2004, 2005  Laboratoire d'Informatique de Paris 6 (LIP6),
 // département Systèmes Répartis Coopératifs (SRC), Université Pierre
 // et Marie Curie.
@@ -34,12 +34,14 @@
 
 #include <cassert>
 #include <list>
+#include <vector>
 #include <spot/misc/hash.hh>
 #include <spot/twa/twa.hh>
 #include <spot/twaalgos/emptiness.hh>
 #include <spot/twaalgos/emptiness_stats.hh>
 #include <spot/twaalgos/tau03.hh>
 #include <spot/twaalgos/ndfs_result.hxx>
+#include <spot/twaalgos/twaiteration.hxx>
 
 namespace spot
 {
@@ -49,14 +51,23 @@ namespace spot
 
     /// \brief Emptiness checker on spot::tgba automata having at most one
     /// acceptance condition (i.e. a TBA).
-    template <typename heap>
+    ///
+    /// When \a is_explicit is set, the automaton is a twa_graph whose
+    /// states and edges are accessed directly by their numbers.
+    template <bool is_explicit, typename heap>
     class tau03_search final : public emptiness_check, public ec_statistics
     {
+      using T = twa_iteration<is_explicit>;
+      using state_t = typename T::state_t;
+      using stack_t = ndfs_stack_type<is_explicit>;
+      using item_t = typename stack_t::value_type;
     public:
       /// \brief Initialize the search algorithm on the automaton \a a
-      tau03_search(const const_twa_ptr a, size_t size, option_map o)
+      tau03_search(const automaton_ptr<is_explicit>& a, size_t size,
+                   option_map o)
         : emptiness_check(a, o),
-          h(size)
+          aut_(a),
+          h(a, size)
       {
         assert(a->num_sets() > 0);
       }
@@ -67,13 +78,13 @@ namespace spot
         while (!st_blue.empty())
           {
             h.pop_notify(st_blue.front().s);
-            a_->release_iter(st_blue.front().it);
+            T::it_destroy(aut_, st_blue.front().it);
             st_blue.pop_front();
           }
         while (!st_red.empty())
           {
             h.pop_notify(st_red.front().s);
-            a_->release_iter(st_red.front().it);
+            T::it_destroy(aut_, st_red.front().it);
             st_red.pop_front();
           }
       }
@@ -87,14 +98,14 @@ namespace spot
         if (!st_blue.empty())
             return nullptr;
         assert(st_red.empty());
-        const state* s0 = a_->get_init_state();
+        state_t s0 = T::initial_state(aut_);
         inc_states();
         h.add_new_state(s0, BLUE);
         push(st_blue, s0, bddfalse, 0U);
         auto t = std::static_pointer_cast<tau03_search>
           (this->emptiness_check::shared_from_this());
         if (dfs_blue())
-          return std::make_shared<ndfs_result<tau03_search<heap>, heap>>(t);
+          return std::make_shared<ndfs_result<tau03_search, heap>>(t);
         return nullptr;
       }
 
@@ -113,36 +124,41 @@ namespace spot
 
       const stack_type& get_st_blue() const
         {
-          return st_blue;
+          return as_stack_type(aut_, st_blue, st_blue_tmp);
         }
 
       const stack_type& get_st_red() const
         {
-          return st_red;
+          return as_stack_type(aut_, st_red, st_red_tmp);
         }
 
     private:
-      void push(stack_type& st, const state* s,
+      void push(stack_t& st, state_t s,
                 const bdd& label, acc_cond::mark_t acc)
       {
         inc_depth();
-        twa_succ_iterator* i = a_->succ_iter(s);
-        i->first();
-        st.emplace_front(s, i, label, acc);
+        st.emplace_front(s, T::succ(aut_, s), label, acc);
       }
 
-      void pop(stack_type& st)
+      void pop(stack_t& st)
       {
         dec_depth();
-        a_->release_iter(st.front().it);
+        T::it_destroy(aut_, st.front().it);
         st.pop_front();
       }
 
+      automaton_ptr<is_explicit> aut_;
+
       /// \brief Stack of the blue dfs.
-      stack_type st_blue;
+      stack_t st_blue;
 
       /// \brief Stack of the red dfs.
-      stack_type st_red;
+      stack_t st_red;
+
+      /// \brief Copies of the stacks given to the results, when
+      /// is_explicit is set.
+      mutable stack_type st_blue_tmp;
+      mutable stack_type st_red_tmp;
 
       /// \brief Map where each visited state is colored
       /// by the last dfs visiting it.
@@ -152,13 +168,15 @@ namespace spot
       {
         while (!st_blue.empty())
           {
-            stack_item& f = st_blue.front();
-            trace << "DFS_BLUE treats: " << a_->format_state(f.s) << std::endl;
+            item_t& f = st_blue.front();
+            trace << "DFS_BLUE treats: "
+                  << a_->format_state(T::to_state(aut_, f.s)) << std::endl;
             if (!f.it->done())
               {
-                const state *s_prime = f.it->dst();
+                state_t s_prime = f.it->dst();
                 trace << "  Visit the successor: "
-                      << a_->format_state(s_prime) << std::endl;
+                      << a_->format_state(T::to_state(aut_, s_prime))
+                      << std::endl;
                 bdd label = f.it->cond();
                 auto acc = f.it->acc();
                 // Go down the edge (f.s, <label, acc>, s_prime)
@@ -187,13 +205,16 @@ namespace spot
                       << std::endl;
                 typename heap::color_ref c = h.get_color_ref(f.s);
                 assert(!c.is_white());
-                for (auto i: a_->succ(f.s))
+                auto i = T::succ(aut_, f.s);
+                for (; !i->done(); i->next())
                   {
                    inc_transitions();
-                   const state *s_prime = i->dst();
+                   state_t s_prime = i->dst();
                    trace << "DFS_BLUE rescanning the arc from "
-                         << a_->format_state(f.s) << "  to "
-                         << a_->format_state(s_prime) << std::endl;
+                         << a_->format_state(T::to_state(aut_, f.s))
+                         << "  to "
+                         << a_->format_state(T::to_state(aut_, s_prime))
+                         << std::endl;
                     bdd label = i->cond();
                     auto acc = i->acc();
                     typename heap::color_ref c_prime = h.get_color_ref(s_prime);
@@ -208,6 +229,7 @@ namespace spot
                         dfs_red(acu);
                      }
                   }
+                T::it_destroy(aut_, i);
                 if (a_->acc().accepting(c.get_acc()))
                   {
                     trace << "DFS_BLUE propagation is successful, report a"
@@ -232,13 +254,15 @@ namespace spot
 
         while (!st_red.empty())
           {
-            stack_item& f = st_red.front();
-            trace << "DFS_RED treats: " << a_->format_state(f.s) << std::endl;
+            item_t& f = st_red.front();
+            trace << "DFS_RED treats: "
+                  << a_->format_state(T::to_state(aut_, f.s)) << std::endl;
             if (!f.it->done())
               {
-                const state *s_prime = f.it->dst();
+                state_t s_prime = f.it->dst();
                 trace << "  Visit the successor: "
-                      << a_->format_state(s_prime) << std::endl;
+                      << a_->format_state(T::to_state(aut_, s_prime))
+                      << std::endl;
                 bdd label = f.it->cond();
                 auto acc = f.it->acc();
                 // Go down the edge (f.s, <label, acc>, s_prime)
@@ -248,7 +272,7 @@ namespace spot
                 if (c_prime.is_white())
                   {
                     trace << "  It is white, pop it" << std::endl;
-                    s_prime->destroy();
+                    T::destroy(s_prime);
                   }
                 else if ((c_prime.get_acc() & acu) != acu)
                   {
@@ -313,7 +337,7 @@ namespace spot
         acc_cond::mark_t* acc;
       };
 
-      explicit_tau03_search_heap(size_t)
+      explicit_tau03_search_heap(const const_twa_ptr&, size_t)
         {
         }
 
@@ -368,12 +392,64 @@ namespace spot
       state_map<std::pair<color, acc_cond::mark_t>> h;
     };
 
+    // Same as explicit_tau03_search_heap, for a twa_graph whose states
+    // are numbered.
+    class graph_tau03_search_heap final
+    {
+    public:
+      using color_ref = explicit_tau03_search_heap::color_ref;
+
+      graph_tau03_search_heap(const const_twa_graph_ptr& a, size_t)
+        : a_(a), h(a->num_states(), WHITE), acc(a->num_states()), count(0)
+        {
+        }
+
+      color_ref get_color_ref(unsigned s)
+        {
+          if (h[s] == WHITE)
+            return color_ref(nullptr, nullptr);
+          return color_ref(&h[s], &acc[s]);
+        }
+
+      void add_new_state(unsigned s, color c)
+        {
+          assert(h[s] == WHITE);
+          h[s] = c;
+          acc[s] = 0U;
+          ++count;
+        }
+
+      void pop_notify(unsigned) const
+        {
+        }
+
+      bool has_been_visited(const state* s) const
+        {
+          return h[a_->state_number(s)] != WHITE;
+        }
+
+      enum { Has_Size = 1 };
+      int size() const
+        {
+          return count;
+        }
+    private:
+      const_twa_graph_ptr a_;
+      std::vector<color> h;
+      std::vector<acc_cond::mark_t> acc;
+      int count;
+    };
+
   } // anonymous
 
   emptiness_check_ptr
   explicit_tau03_search(const const_twa_ptr& a, option_map o)
   {
-    return std::make_shared<tau03_search<explicit_tau03_search_heap>>(a, 0, o);
+    if (auto ag = use_explicit_iteration(a, o))
+      return std::make_shared<tau03_search<true, graph_tau03_search_heap>>
+        (ag, 0, o);
+    return std::make_shared<tau03_search<false, explicit_tau03_search_heap>>
+      (a, 0, o);
   }
 
 }
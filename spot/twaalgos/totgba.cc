@@ -34,7 +34,7 @@ namespace spot
       acc_cond::mark_t pend;
       unsigned s;
 
-      st2gba_state(unsigned st, acc_cond::mark_t bv = -1U):
+      st2gba_state(unsigned st, acc_cond::mark_t bv = ~acc_cond::mark_t(0U)):
         pend(bv), s(st)
       {
       }
@@ -166,8 +166,8 @@ namespace spot
 
     bool sbacc = in->prop_state_acc().is_true();
 
-    // States of the original automaton are marked with s.pend == -1U.
-    const acc_cond::mark_t orig_copy(-1U);
+    // States of the original automaton are marked with s.pend == ~0U.
+    const acc_cond::mark_t orig_copy = ~acc_cond::mark_t(0U);
 
     while (!todo.empty())
       {
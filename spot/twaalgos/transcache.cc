@@ -0,0 +1,162 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "config.h"
+#include <spot/twaalgos/transcache.hh>
+#include <spot/twaalgos/binary.hh>
+#include <spot/twa/twagraph.hh>
+#include <spot/tl/parse.hh>
+#include <spot/tl/print.hh>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace spot
+{
+  translation_cache::translation_cache(const std::string& dir)
+    : dir_(dir)
+  {
+    if (mkdir(dir.c_str(), 0777) < 0 && errno != EEXIST)
+      throw std::runtime_error("cannot create cache directory " + dir
+                               + ": " + strerror(errno));
+  }
+
+  std::string
+  translation_cache::entry_name(const std::string& key) const
+  {
+    // 64-bit FNV-1a, so that the names do not depend on the
+    // implementation of std::hash.
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c: key)
+      {
+        h ^= c;
+        h *= 1099511628211ULL;
+      }
+    char buf[17];
+    snprintf(buf, sizeof buf, "%016llx", (unsigned long long) h);
+    return dir_ + '/' + buf + ".bin";
+  }
+
+  // An entry is made of the key, the formula, and the automaton,
+  // the first two being terminated by a null character.
+  twa_graph_ptr
+  translation_cache::get(const std::string& key, const bdd_dict_ptr& dict,
+                         const relabeling_map* relmap, formula* f)
+  {
+    std::ifstream in(entry_name(key), std::ios::binary);
+    if (!in)
+      {
+        ++stats_.misses;
+        return nullptr;
+      }
+    std::string data{std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>()};
+    // A different key with the same hash is a miss, not an error.
+    if (data.size() <= key.size() || data[key.size()]
+        || data.compare(0, key.size(), key))
+      {
+        ++stats_.misses;
+        return nullptr;
+      }
+    size_t fpos = key.size() + 1;
+    size_t apos = data.find('\0', fpos);
+    if (apos == std::string::npos)
+      {
+        ++stats_.errors;
+        ++stats_.misses;
+        return nullptr;
+      }
+    ++apos;
+    twa_graph_ptr aut;
+    formula g = nullptr;
+    try
+      {
+        aut = read_binary(data.data() + apos, data.size() - apos, dict,
+                          nullptr, relmap);
+        if (apos - fpos > 1)
+          {
+            parsed_formula pf =
+              parse_infix_psl(data.substr(fpos, apos - fpos - 1));
+            if (!pf.errors.empty())
+              throw std::runtime_error("invalid formula");
+            g = pf.f;
+            if (relmap)
+              g = relabel_apply(g, relmap);
+          }
+      }
+    catch (const std::runtime_error&)
+      {
+        ++stats_.errors;
+        ++stats_.misses;
+        return nullptr;
+      }
+    if (f)
+      *f = g;
+    ++stats_.hits;
+    return aut;
+  }
+
+  bool
+  translation_cache::put(const std::string& key,
+                         const const_twa_graph_ptr& aut, formula f)
+  {
+    std::ostringstream tmp;
+    tmp << dir_ << "/tmp-" << getpid() << '-' << tmp_count_++;
+    std::string tmpname = tmp.str();
+    {
+      std::ofstream out(tmpname, std::ios::binary);
+      out << key << '\0';
+      if (f)
+        print_psl(out, f, true);
+      out << '\0';
+      print_binary(out, aut);
+      out.close();
+      if (!out)
+        {
+          unlink(tmpname.c_str());
+          ++stats_.errors;
+          return false;
+        }
+    }
+    if (rename(tmpname.c_str(), entry_name(key).c_str()) < 0)
+      {
+        unlink(tmpname.c_str());
+        ++stats_.errors;
+        return false;
+      }
+    ++stats_.stores;
+    return true;
+  }
+
+  std::ostream&
+  translation_cache::print_stats(std::ostream& os) const
+  {
+    return os << "translation cache " << dir_ << ": "
+              << stats_.hits << " hits, " << stats_.misses << " misses, "
+              << stats_.stores << " stores, " << stats_.errors << " errors";
+  }
+}
@@ -0,0 +1,110 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <spot/misc/common.hh>
+#include <spot/tl/formula.hh>
+#include <spot/tl/relabel.hh>
+#include <spot/twa/fwd.hh>
+#include <spot/twa/bdddict.hh>
+
+namespace spot
+{
+  /// \ingroup twa_ltl
+  /// \brief A persistent cache of translated formulas.
+  ///
+  /// Each entry is stored in its own file of a directory, in the
+  /// format of print_binary().  An entry is identified by a key
+  /// string; spot::translator builds it from the formula (with
+  /// atomic propositions renamed into p0, p1, ...), its own options,
+  /// and the version of Spot.  The file name is a hash of the key,
+  /// and the key is also saved in the file, so that collisions are
+  /// detected.
+  ///
+  /// Several processes may share the same directory: entries are
+  /// written in a temporary file that is then renamed, so that
+  /// readers never see incomplete entries.  If two processes store
+  /// the same entry, the last one wins, but both have written the
+  /// same automaton.  Invalid entries (e.g., truncated by a full
+  /// disk) are ignored and counted as errors.
+  ///
+  /// Nothing is ever removed from the cache; simply erase the
+  /// directory to clear it.
+  class SPOT_API translation_cache final
+  {
+  public:
+    /// \brief Use \a dir as cache directory.
+    ///
+    /// The directory is created if it does not exist (but its parent
+    /// should).  A std::runtime_error is thrown if it cannot be
+    /// created.
+    translation_cache(const std::string& dir);
+
+    /// \brief Look up an entry.
+    ///
+    /// Return nullptr if \a key is not in the cache.  Otherwise
+    /// return the cached automaton, using \a dict, and with the
+    /// atomic propositions renamed according to \a relmap if it is
+    /// non-null (see read_binary()).  If \a f is non-null, it is set
+    /// to the formula that was stored along with the automaton.
+    twa_graph_ptr get(const std::string& key, const bdd_dict_ptr& dict,
+                      const relabeling_map* relmap = nullptr,
+                      formula* f = nullptr);
+
+    /// \brief Store \a aut, and the formula \a f, for \a key.
+    ///
+    /// Return false if the entry could not be written (this is not
+    /// considered an error, but the entry is counted in
+    /// stats::errors).
+    bool put(const std::string& key, const const_twa_graph_ptr& aut,
+             formula f = nullptr);
+
+    struct stats
+    {
+      unsigned hits = 0;        ///< Successful lookups.
+      unsigned misses = 0;      ///< Lookups of missing entries.
+      unsigned stores = 0;      ///< Entries written.
+      unsigned errors = 0;      ///< Invalid entries or failed writes.
+    };
+
+    /// Statistics about the use of this cache by this process.
+    const stats& get_stats() const
+    {
+      return stats_;
+    }
+
+    /// Print the statistics on one line.
+    std::ostream& print_stats(std::ostream& os) const;
+
+    const std::string& directory() const
+    {
+      return dir_;
+    }
+
+  private:
+    std::string entry_name(const std::string& key) const;
+
+    std::string dir_;
+    stats stats_;
+    unsigned tmp_count_ = 0;
+  };
+}
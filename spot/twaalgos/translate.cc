@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013, 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -20,10 +20,127 @@
 #include <spot/twaalgos/translate.hh>
 #include <spot/twaalgos/ltl2tgba_fm.hh>
 #include <spot/twaalgos/compsusp.hh>
+#include <spot/twaalgos/transcache.hh>
+#include <spot/twaalgos/binary.hh>
 #include <spot/misc/optionmap.hh>
+#include <spot/misc/version.hh>
+#include <spot/tl/relabel.hh>
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
 
 namespace spot
 {
+  namespace
+  {
+    // Print a formula in a way that does not depend on the names of
+    // its atomic propositions, nor on the order in which its
+    // subformulas were created (which decides the order of the
+    // operands of commutative operators, and therefore the numbering
+    // chosen by relabel()).  The operands of commutative operators
+    // are sorted by shape (their printing with all atomic
+    // propositions replaced by "_"), and atomic propositions are then
+    // renamed p0, p1, ... in order of appearance.  Operands of the
+    // same shape may still be printed differently if they were
+    // created in a different order, but this only causes cache
+    // misses.
+    class formula_canonizer final
+    {
+    public:
+      // Fill \a fwd with the renaming of the atomic propositions.
+      std::string key(formula f, relabeling_map& fwd)
+      {
+        std::ostringstream os;
+        print(os, f, fwd);
+        return os.str();
+      }
+
+    private:
+      std::unordered_map<formula, std::string> shapes_;
+
+      static bool commutative(op o)
+      {
+        switch (o)
+          {
+          case op::Xor:
+          case op::Equiv:
+          case op::Or:
+          case op::OrRat:
+          case op::And:
+          case op::AndRat:
+          case op::AndNLM:
+            return true;
+          default:
+            return false;
+          }
+      }
+
+      static void print_op(std::ostream& os, formula f)
+      {
+        os << f.kindstr();
+        if (f.is(op::Star, op::FStar))
+          os << '[' << f.min() << ',' << f.max() << ']';
+      }
+
+      const std::string& shape(formula f)
+      {
+        auto it = shapes_.find(f);
+        if (it != shapes_.end())
+          return it->second;
+        std::string res;
+        if (f.is(op::ap))
+          {
+            res = "_";
+          }
+        else
+          {
+            std::vector<std::string> ops;
+            for (formula c: f)
+              ops.push_back(shape(c));
+            if (commutative(f.kind()))
+              std::sort(ops.begin(), ops.end());
+            std::ostringstream os;
+            print_op(os, f);
+            os << '(';
+            for (auto& s: ops)
+              os << s << ',';
+            os << ')';
+            res = os.str();
+          }
+        return shapes_.emplace(f, res).first->second;
+      }
+
+      void print(std::ostream& os, formula f, relabeling_map& fwd)
+      {
+        if (f.is(op::ap))
+          {
+            auto p = fwd.emplace(f, nullptr);
+            if (p.second)
+              p.first->second =
+                formula::ap("p" + std::to_string(fwd.size() - 1));
+            os << p.first->second.ap_name();
+            return;
+          }
+        std::vector<formula> ops;
+        for (formula c: f)
+          ops.push_back(c);
+        if (commutative(f.kind()))
+          std::stable_sort(ops.begin(), ops.end(),
+                           [this](formula a, formula b)
+                           {
+                             return shape(a) < shape(b);
+                           });
+        print_op(os, f);
+        os << '(';
+        for (formula c: ops)
+          {
+            print(os, c, fwd);
+            os << ',';
+          }
+        os << ')';
+      }
+    };
+  }
 
   void translator::setup_opt(const option_map* opt)
   {
@@ -32,6 +149,10 @@ namespace spot
     if (!opt)
       return;
 
+    int fm_context = opt->get("fm-context", 0);
+    if (fm_context > 0)
+      fm_context_.reset(new fm_translation_context(fm_context));
+
     comp_susp_ = opt->get("comp-susp", 0);
     if (comp_susp_ == 1)
       {
@@ -60,7 +181,7 @@ namespace spot
     simpl_owned_ = simpl_ = new tl_simplifier(options, dict);
   }
 
-  twa_graph_ptr translator::run(formula* f)
+  twa_graph_ptr translator::run_uncached(formula* f)
   {
     bool unambiguous = (pref_ & postprocessor::Unambiguous);
     if (unambiguous && type_ == postprocessor::Monitor)
@@ -95,12 +216,80 @@ namespace spot
         bool exprop = unambiguous || level_ == postprocessor::High;
         aut = ltl_to_tgba_fm(r, simpl_->get_dict(), exprop,
                              true, false, false, nullptr, nullptr,
-                             unambiguous);
+                             unambiguous, fm_context_.get());
       }
     aut = this->postprocessor::run(aut, r);
     return aut;
   }
 
+  std::string translator::cache_key(formula f, relabeling_map& fwd) const
+  {
+    // Some options are set to their default by the first call to
+    // postprocessor::run(): use these defaults, so that the key
+    // does not change after that first call.
+    int simul = simul_ < 0 ? ((level_ == Low) ? 1 : 3) : simul_;
+    int ba_simul = ba_simul_ < 0 ? ((level_ == High) ? 3 : 0) : ba_simul_;
+    int scc_filter = scc_filter_ < 0 ? 1 : scc_filter_;
+    bool state_based =
+      state_based_ || type_ == BA || (pref_ & postprocessor::SBAcc);
+    // run_uncached() adds Deterministic to the preference of
+    // unambiguous monitors.
+    int pref = pref_;
+    if ((pref & postprocessor::Unambiguous) && type_ == postprocessor::Monitor)
+      pref |= postprocessor::Deterministic;
+    // The simplifier may have been supplied by the user, so its
+    // options are part of the key.
+    const tl_simplifier_options& so = simpl_->options();
+    std::ostringstream key;
+    key << "spot " << version() << '\n'
+        << type_ << ' ' << pref << ' ' << level_ << ' '
+        << so.reduce_basics << so.synt_impl << so.event_univ
+        << so.containment_checks << so.containment_checks_stronger
+        << so.nenoform_stop_on_boolean << so.reduce_size_strictly
+        << so.boolean_to_isop << so.favor_event_univ << ' '
+        << comp_susp_ << ' ' << early_susp_ << ' '
+        << skel_wdba_ << ' ' << skel_simul_ << ' '
+        << degen_reset_ << degen_order_ << degen_cache_
+        << degen_lskip_ << degen_lowinit_ << ' '
+        << det_scc_ << det_simul_ << det_stutter_ << ' '
+        << simul << ' ' << scc_filter << ' ' << ba_simul << ' '
+        << tba_determinisation_ << ' ' << sat_minimize_ << ' '
+        << sat_incr_steps_ << ' ' << sat_langmap_ << ' '
+        << sat_acc_ << ' ' << sat_states_ << ' '
+        << state_based << wdba_minimize_ << '\n'
+        << formula_canonizer().key(f, fwd);
+    return key.str();
+  }
+
+  twa_graph_ptr translator::run(formula* f)
+  {
+    if (!cache_)
+      return run_uncached(f);
+
+    relabeling_map fwd;
+    std::string key = cache_key(*f, fwd);
+    formula g = relabel_apply(*f, &fwd);
+    relabeling_map m;
+    for (auto& p: fwd)
+      m.emplace(p.second, p.first);
+    bdd_dict_ptr dict = simpl_->get_dict();
+    formula r;
+    if (twa_graph_ptr aut = cache_->get(key, dict, &m, &r))
+      {
+        *f = r;
+        return aut;
+      }
+    twa_graph_ptr aut = run_uncached(&g);
+    cache_->put(key, aut, g);
+    // Rename the atomic propositions as in a cache hit, so that the
+    // result does not depend on the state of the cache.
+    std::ostringstream s;
+    print_binary(s, aut);
+    std::string data = s.str();
+    *f = relabel_apply(g, &m);
+    return read_binary(data.data(), data.size(), dict, nullptr, &m);
+  }
+
   twa_graph_ptr translator::run(formula f)
   {
     return run(&f);
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2013, 2014, 2015, 2016 Laboratoire de Recherche et
+// Copyright (C) 2013, 2014, 2015, 2016, 2017 Laboratoire de Recherche et
 // Développement de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -20,10 +20,15 @@
 #pragma once
 
 #include <spot/twaalgos/postproc.hh>
+#include <spot/twaalgos/ltl2tgba_fm.hh>
 #include <spot/tl/simplify.hh>
+#include <spot/tl/relabel.hh>
+#include <string>
 
 namespace spot
 {
+  class translation_cache;
+
   /// \ingroup twa_ltl
   /// \brief Translate an LTL formula into an optimized spot::tgba.
   ///
@@ -44,6 +49,14 @@ namespace spot
   /// The semantic of these three methods is inherited from the
   /// spot::postprocessor class, but the optimization level is
   /// additionally used to select which LTL simplifications to enable.
+  ///
+  /// Method set_cache() may be used to store the translations in a
+  /// persistent spot::translation_cache.
+  ///
+  /// If the option "fm-context" of the option_map is set to N>0, the
+  /// translations of subformulas are kept from one call to run() to
+  /// the next in a spot::fm_translation_context holding at most
+  /// about N entries.
   class SPOT_API translator: protected postprocessor
   {
   public:
@@ -104,6 +117,21 @@ namespace spot
         }
     }
 
+    /// \brief Store and retrieve translations from \a cache.
+    ///
+    /// When a cache is set, the atomic propositions of the formula
+    /// are first renamed into p0, p1, ... so that formulas that
+    /// differ only by the names of their atomic propositions share
+    /// an entry.  The cache key also includes all the options of the
+    /// translator and of its tl_simplifier, and the version of Spot.
+    ///
+    /// Use nullptr (the default) to disable the cache.  The cache is
+    /// not owned by the translator.
+    void set_cache(translation_cache* cache)
+    {
+      cache_ = cache;
+    }
+
     /// \brief Convert \a f into an automaton.
     ///
     /// The formula \a f is simplified internally.
@@ -118,8 +146,12 @@ namespace spot
   protected:
     void setup_opt(const option_map* opt);
     void build_simplifier(const bdd_dict_ptr& dict);
+    twa_graph_ptr run_uncached(formula* f);
+    std::string cache_key(formula f, relabeling_map& fwd) const;
 
   private:
+    translation_cache* cache_ = nullptr;
+    std::unique_ptr<fm_translation_context> fm_context_;
     tl_simplifier* simpl_;
     tl_simplifier* simpl_owned_;
     int comp_susp_;
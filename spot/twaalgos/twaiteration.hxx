@@ -0,0 +1,312 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2016, 2017 Laboratoire de Recherche et Développement
+// de l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <spot/misc/hash.hh>
+#include <spot/misc/optionmap.hh>
+#include <spot/twa/twa.hh>
+#include <spot/twa/twagraph.hh>
+
+// This header gathers the two flavors of iteration used by the
+// emptiness checks that are specialized for explicit automata: the
+// abstract one (twa_iteration<false>) works on any twa through
+// state* and twa_succ_iterator*, while the explicit one
+// (twa_iteration<true>) works on the state numbers and the edge
+// storage of a twa_graph, without any allocation or virtual call.
+// The algorithms are written once, as templates over these two
+// classes.
+
+namespace spot
+{
+  using explicit_iterator = twa_graph::graph_t::const_iterator;
+
+  // A proxy class that allows to manipulate an iterator from the
+  // explicit interface as an iterator from the abstract interface.
+  class explicitproxy
+  {
+  public:
+    explicitproxy(explicit_iterator it)
+      : it_(it)
+    {}
+
+    const explicitproxy*
+    operator->() const
+    {
+      return this;
+    }
+
+    explicitproxy*
+    operator->()
+    {
+      return this;
+    }
+
+    bool
+    done() const
+    {
+      return !it_;
+    }
+
+    unsigned
+    dst() const
+    {
+      return it_->dst;
+    }
+
+    bdd
+    cond() const
+    {
+      return it_->cond;
+    }
+
+    acc_cond::mark_t
+    acc() const
+    {
+      return it_->acc;
+    }
+
+    void
+    next()
+    {
+      ++it_;
+    }
+
+  private:
+    explicit_iterator it_;
+  };
+
+  template<bool is_explicit>
+  class twa_iteration
+  {
+  };
+
+  template<>
+  class twa_iteration<false>
+  {
+  public:
+    using state_t = const state*;
+    using iterator_t = twa_succ_iterator*;
+    template<class val>
+    using state_map = state_map<val>;
+
+    template<class val>
+    static
+    std::pair<std::pair<state_t, val>, bool>
+    h_emplace(state_map<val>& h, state_t s, val i)
+    {
+      auto p = h.emplace(s, i);
+      return std::make_pair(*p.first, p.second);
+    }
+
+    static
+    std::pair<state_t, int>
+    h_find(const state_map<int>& h, state_t s)
+    {
+      auto p = h.find(s);
+      if (p == h.end())
+        return std::make_pair(nullptr, 0);
+      else
+        return std::make_pair(p->first, p->second);
+    }
+
+    static
+    unsigned
+    h_count(const state_map<int>& h, const std::function<bool(int)>& p)
+    {
+      unsigned count = 0;
+      for (auto i : h)
+        if (p(i.second))
+          ++count;
+      return count;
+    }
+
+    static
+    state_t
+    initial_state(const const_twa_ptr& twa_p)
+    {
+      return twa_p->get_init_state();
+    }
+
+    static
+    iterator_t
+    succ(const const_twa_ptr& twa_p, state_t s)
+    {
+      auto res = twa_p->succ_iter(s);
+      res->first();
+      return res;
+    }
+
+    static
+    void
+    destroy(state_t s)
+    {
+      s->destroy();
+    }
+
+    static
+    bool
+    same(state_t s1, state_t s2)
+    {
+      return s1->compare(s2) == 0;
+    }
+
+    static
+    const state*
+    to_state(const const_twa_ptr&, state_t s)
+    {
+      return s;
+    }
+
+    static
+    state_t
+    from_state(const const_twa_ptr&, const state* s)
+    {
+      return s;
+    }
+
+    static
+    void
+    it_destroy(const const_twa_ptr& twa_p, iterator_t it)
+    {
+      twa_p->release_iter(it);
+    }
+  };
+
+  template<>
+  class twa_iteration<true>
+  {
+  public:
+    using state_t = unsigned;
+    using iterator_t = explicitproxy;
+    template<class val>
+    using state_map = std::vector<val>;
+
+    template<class val>
+    static
+    std::pair<std::pair<state_t, val>, bool>
+    h_emplace(state_map<val>& h, state_t s, val i)
+    {
+      if (h[s] == val())
+      {
+        h[s] = i;
+        return std::make_pair(std::make_pair(s, h[s]), true);
+      }
+      else
+      {
+        return std::make_pair(std::make_pair(s, h[s]), false);
+      }
+    }
+
+    static
+    std::pair<state_t, int>
+    h_find(const state_map<int>& h, state_t s)
+    {
+      SPOT_ASSERT(s < h.size());
+      return std::make_pair(s, h[s]);
+    }
+
+    static
+    unsigned
+    h_count(const state_map<int>& h, const std::function<bool(int)>& p)
+    {
+      unsigned count = 0;
+      for (auto i : h)
+        if (p(i))
+          ++count;
+      return count;
+    }
+
+    static
+    state_t
+    initial_state(const const_twa_graph_ptr& twa_p)
+    {
+      if (!twa_p->is_existential())
+        throw std::runtime_error
+          ("emptiness check does not support alternating automata");
+      return twa_p->get_init_state_number();
+    }
+
+    static
+    iterator_t
+    succ(const const_twa_graph_ptr& twa_p, state_t s)
+    {
+      return explicitproxy(twa_p->out(s).begin());
+    }
+
+    static
+    const state*
+    to_state(const const_twa_graph_ptr& twa_p, state_t s)
+    {
+      return twa_p->state_from_number(s);
+    }
+
+    static
+    state_t
+    from_state(const const_twa_graph_ptr& twa_p, const state* s)
+    {
+      return twa_p->state_number(s);
+    }
+
+    static
+    void
+    destroy(state_t)
+    {
+    }
+
+    static
+    bool
+    same(state_t s1, state_t s2)
+    {
+      return s1 == s2;
+    }
+
+    static
+    void
+    it_destroy(const const_twa_ptr&, iterator_t)
+    {
+    }
+  };
+
+  template<bool is_explicit>
+  using automaton_ptr = typename std::conditional<is_explicit,
+                                                  const_twa_graph_ptr,
+                                                  const_twa_ptr>::type;
+
+  // Whether the emptiness check constructed with the options \a o
+  // for the automaton \a a should use the explicit iteration.  If it
+  // should, \a a is returned as a twa_graph, otherwise a null
+  // pointer is returned.  The explicit iteration can be disabled by
+  // setting the option "graph" to 0.
+  inline
+  const_twa_graph_ptr
+  use_explicit_iteration(const const_twa_ptr& a, const option_map& o)
+  {
+    if (!o.get("graph", 1))
+      return nullptr;
+    auto ag = std::dynamic_pointer_cast<const twa_graph>(a);
+    if (ag && !ag->is_existential())
+      return nullptr;
+    return ag;
+  }
+}
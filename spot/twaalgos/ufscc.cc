@@ -0,0 +1,513 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <spot/twaalgos/ufscc.hh>
+#include <spot/twaalgos/bfssteps.hh>
+#include <spot/twa/twagraph.hh>
+
+namespace spot
+{
+  namespace
+  {
+    // Number of words needed to store an acceptance mark.
+    static constexpr unsigned acc_words = SPOT_MAX_ACCSETS / 32;
+
+    static unsigned
+    mark_word(acc_cond::mark_t m, unsigned i)
+    {
+#if SPOT_MAX_ACCSETS > 32
+      return m.id.word(i);
+#else
+      (void) i;
+      return m.id;
+#endif
+    }
+
+    // A lock-free union-find over the states of the automaton.
+    //
+    // Each class is represented by its state of smallest number: a
+    // link always goes from a larger number to a smaller one, so
+    // concurrent unions cannot create cycles.  The root of each
+    // class also carries the acceptance marks seen in that class.
+    // Finally each state has a dead flag, set once its SCC has been
+    // fully explored by some worker.
+    class shared_uf
+    {
+    public:
+      shared_uf(unsigned n)
+        : parent_(new std::atomic<unsigned>[n]),
+          acc_(new std::atomic<unsigned>[n * acc_words]),
+          dead_(new std::atomic<bool>[n])
+      {
+        for (unsigned i = 0; i < n; ++i)
+          {
+            parent_[i].store(i, std::memory_order_relaxed);
+            dead_[i].store(false, std::memory_order_relaxed);
+          }
+        for (unsigned i = 0; i < n * acc_words; ++i)
+          acc_[i].store(0U, std::memory_order_relaxed);
+      }
+
+      unsigned
+      find(unsigned x)
+      {
+        unsigned p = parent_[x].load();
+        while (p != x)
+          {
+            // Path halving.
+            unsigned gp = parent_[p].load();
+            if (gp != p)
+              parent_[x].compare_exchange_weak(p, gp);
+            x = gp;
+            p = parent_[x].load();
+          }
+        return x;
+      }
+
+      acc_cond::mark_t
+      acc(unsigned r) const
+      {
+        acc_cond::mark_t res = 0U;
+        for (unsigned i = 0; i < acc_words; ++i)
+          res |= acc_cond::mark_t(acc_cond::mark_t::value_t
+                                  (acc_[r * acc_words + i].load())
+                                  << (32 * i));
+        return res;
+      }
+
+      // Add the marks M to the class of X, and return all the marks
+      // known for this class.
+      acc_cond::mark_t
+      add_acc(unsigned x, acc_cond::mark_t m)
+      {
+        for (;;)
+          {
+            unsigned r = find(x);
+            if (m)
+              for (unsigned i = 0; i < acc_words; ++i)
+                acc_[r * acc_words + i].fetch_or(mark_word(m, i));
+            // If R has been linked to another root in the meantime,
+            // the marks we added might have been missed by the
+            // linking thread: add them again to the new root.
+            if (parent_[r].load() == r)
+              return acc(r);
+            x = r;
+          }
+      }
+
+      // Merge the classes of A and B.
+      void
+      unite(unsigned a, unsigned b)
+      {
+        for (;;)
+          {
+            unsigned ra = find(a);
+            unsigned rb = find(b);
+            if (ra == rb)
+              return;
+            if (ra > rb)
+              std::swap(ra, rb);
+            unsigned expected = rb;
+            if (parent_[rb].compare_exchange_strong(expected, ra))
+              {
+                // Move the marks of RB to the new root.  Any mark
+                // added to RB after this point will be forwarded by
+                // add_acc().
+                add_acc(ra, acc(rb));
+                return;
+              }
+          }
+      }
+
+      bool
+      is_dead(unsigned s) const
+      {
+        return dead_[s].load(std::memory_order_acquire);
+      }
+
+      void
+      set_dead(unsigned s)
+      {
+        dead_[s].store(true, std::memory_order_release);
+      }
+
+    private:
+      std::unique_ptr<std::atomic<unsigned>[]> parent_;
+      std::unique_ptr<std::atomic<unsigned>[]> acc_;
+      std::unique_ptr<std::atomic<bool>[]> dead_;
+    };
+
+    // Everything the workers share.
+    struct ufscc_status
+    {
+      ufscc_status(const const_twa_graph_ptr& a)
+        : aut(a), uf(a->num_states()), stop(false), found(false),
+          seed_state(0)
+      {
+      }
+
+      const_twa_graph_ptr aut;
+      shared_uf uf;
+      std::atomic<bool> stop;
+      bool found;
+      unsigned seed_state;        // A state of the accepting SCC.
+      std::exception_ptr error;
+    };
+
+    typedef std::shared_ptr<ufscc_status> ufscc_status_ptr;
+
+    // One sequential SCC-based emptiness check, publishing what it
+    // learns in the shared union-find.
+    class ufscc_worker
+    {
+      // Local numbering of the visited states: 0 for unvisited
+      // states, and dead for states of popped SCCs.
+      static constexpr unsigned dead = -1U;
+
+      struct root_entry
+      {
+        unsigned index;
+        unsigned state;
+        acc_cond::mark_t condition; // marks seen inside this SCC
+        acc_cond::mark_t arc;       // marks on the edge leading to it
+      };
+
+      struct todo_entry
+      {
+        unsigned state;
+        unsigned start;       // first successor of STATE in succ_
+        unsigned pos;         // next successor of STATE to process
+      };
+
+      ufscc_status& st_;
+      const twa_graph::graph_t& g_;
+      const acc_cond& acc_;
+      bool shuffle_;
+      std::mt19937 rng_;
+      unsigned num_;
+      std::vector<unsigned> h_;
+      std::vector<root_entry> root_;
+      std::vector<todo_entry> todo_;
+      std::vector<unsigned> live_;
+      std::vector<unsigned> succ_;
+
+      void
+      push(unsigned s, acc_cond::mark_t arc)
+      {
+        h_[s] = ++num_;
+        root_.push_back({num_, s, 0U, arc});
+        live_.push_back(s);
+        unsigned start = succ_.size();
+        for (auto& e: g_.out(s))
+          succ_.push_back(g_.index_of_edge(e));
+        if (shuffle_)
+          std::shuffle(succ_.begin() + start, succ_.end(), rng_);
+        todo_.push_back({s, start, start});
+      }
+
+      // Record an accepting SCC, and tell the other workers to stop.
+      void
+      found(unsigned s)
+      {
+        if (!st_.stop.exchange(true))
+          {
+            st_.found = true;
+            st_.seed_state = s;
+          }
+      }
+
+    public:
+      ufscc_worker(ufscc_status& st, unsigned id, unsigned seed)
+        : st_(st), g_(st.aut->get_graph()), acc_(st.aut->acc()),
+          shuffle_(id > 0), rng_(seed + id), num_(0),
+          h_(st.aut->num_states(), 0U)
+      {
+      }
+
+      void
+      run()
+      {
+        push(st_.aut->get_init_state_number(), 0U);
+
+        while (!todo_.empty())
+          {
+            if (st_.stop.load(std::memory_order_relaxed))
+              return;
+
+            todo_entry& t = todo_.back();
+
+            // If there is no more successors, backtrack.
+            if (t.pos == succ_.size())
+              {
+                unsigned curr = t.state;
+                succ_.resize(t.start);
+                todo_.pop_back();
+                if (root_.back().index == h_[curr])
+                  {
+                    // CURR is the root of an SCC that has been fully
+                    // explored and is not accepting.  Make it dead for
+                    // every worker.
+                    unsigned s;
+                    do
+                      {
+                        s = live_.back();
+                        live_.pop_back();
+                        h_[s] = dead;
+                        st_.uf.set_dead(s);
+                      }
+                    while (s != curr);
+                    root_.pop_back();
+                  }
+                continue;
+              }
+
+            auto& e = g_.edge_storage(succ_[t.pos++]);
+            unsigned dst = e.dst;
+            acc_cond::mark_t acc = e.acc;
+
+            if (h_[dst] == dead)
+              continue;
+            // Skip states whose SCC has been handled by another worker.
+            if (st_.uf.is_dead(dst))
+              {
+                if (h_[dst] == 0)
+                  h_[dst] = dead;
+                continue;
+              }
+            if (h_[dst] == 0)
+              {
+                push(dst, acc);
+                continue;
+              }
+
+            // DST is on our stack: merge all SCCs that have been
+            // visited since DST's SCC, in our stack as well as in
+            // the shared union-find.
+            unsigned threshold = h_[dst];
+            while (threshold < root_.back().index)
+              {
+                root_entry& r = root_.back();
+                acc |= r.condition | r.arc;
+                unsigned s = r.state;
+                root_.pop_back();
+                st_.uf.unite(s, root_.back().state);
+              }
+            root_entry& top = root_.back();
+            top.condition |= acc;
+            if (acc_.accepting(st_.uf.add_acc(top.state, top.condition)))
+              {
+                found(top.state);
+                return;
+              }
+          }
+        // All reachable states are dead: the other workers can stop.
+        st_.stop.store(true);
+      }
+    };
+
+    class ufscc_result final: public emptiness_check_result
+    {
+    public:
+      ufscc_result(const ufscc_status_ptr& st)
+        : emptiness_check_result(st->aut), st_(st)
+      {
+      }
+
+      twa_run_ptr
+      accepting_run() override
+      {
+        const_twa_graph_ptr aut = st_->aut;
+        shared_uf& uf = st_->uf;
+        unsigned scc = uf.find(st_->seed_state);
+        auto run = std::make_shared<twa_run>(aut);
+
+        // Compute an accepting cycle inside the SCC, using successive
+        // BFS that are restarted after each edge bringing new
+        // acceptance marks (as in Couvreur's check).
+        acc_cond::mark_t acc_to_traverse =
+          aut->acc().accepting_sets(uf.acc(scc));
+        const state* cycle_seed = aut->state_from_number(st_->seed_state);
+        const state* substart = cycle_seed;
+        do
+          {
+            struct scc_bfs final: bfs_steps
+            {
+              const const_twa_graph_ptr& aut;
+              shared_uf& uf;
+              unsigned scc;
+              const state* cycle_seed;
+              acc_cond::mark_t& acc_to_traverse;
+
+              scc_bfs(const const_twa_graph_ptr& aut, shared_uf& uf,
+                      unsigned scc, const state* cycle_seed,
+                      acc_cond::mark_t& acc_to_traverse)
+                : bfs_steps(aut), aut(aut), uf(uf), scc(scc),
+                  cycle_seed(cycle_seed), acc_to_traverse(acc_to_traverse)
+              {
+              }
+
+              const state*
+              filter(const state* s) override
+              {
+                // Stay in the accepting SCC.
+                if (uf.find(aut->state_number(s)) != scc)
+                  return nullptr;
+                return s;
+              }
+
+              bool
+              match(twa_run::step& st, const state* s) override
+              {
+                acc_cond::mark_t less_acc = acc_to_traverse - st.acc;
+                if (less_acc != acc_to_traverse
+                    || (acc_to_traverse == 0U && s == cycle_seed))
+                  {
+                    acc_to_traverse = less_acc;
+                    return true;
+                  }
+                return false;
+              }
+            } b(aut, uf, scc, cycle_seed, acc_to_traverse);
+
+            substart = b.search(substart, run->cycle);
+            assert(substart);
+          }
+        while (acc_to_traverse != 0U || substart != cycle_seed);
+
+        // Compute the prefix: it is the shortest path from the initial
+        // state of the automaton to any state of the cycle.
+        state_set ss;
+        for (auto& s: run->cycle)
+          ss.insert(s.s);
+        const state* cycle_entry_point = aut->get_init_state();
+        if (ss.find(cycle_entry_point) == ss.end())
+          {
+            struct shortest_path final: bfs_steps
+            {
+              const state_set& target;
+
+              shortest_path(const const_twa_graph_ptr& aut,
+                            const state_set& target)
+                : bfs_steps(aut), target(target)
+              {
+              }
+
+              const state*
+              filter(const state* s) override
+              {
+                return s;
+              }
+
+              bool
+              match(twa_run::step&, const state* dest) override
+              {
+                return target.find(dest) != target.end();
+              }
+            } shpath(aut, ss);
+            cycle_entry_point =
+              shpath.search(cycle_entry_point, run->prefix);
+          }
+
+        // Rotate the cycle so it starts on cycle_entry_point.
+        auto cycle_ep_it = run->cycle.begin();
+        while (cycle_ep_it->s != cycle_entry_point)
+          ++cycle_ep_it;
+        run->cycle.splice(run->cycle.end(), run->cycle,
+                          run->cycle.begin(), cycle_ep_it);
+        return run;
+      }
+
+    private:
+      ufscc_status_ptr st_;
+    };
+
+    class ufscc final: public emptiness_check
+    {
+    public:
+      ufscc(const const_twa_graph_ptr& a, option_map o)
+        : emptiness_check(a, o), aut_(a)
+      {
+      }
+
+      emptiness_check_result_ptr
+      check() override
+      {
+        const acc_cond& acc = aut_->acc();
+        if (acc.is_f())
+          return nullptr;
+        if (acc.uses_fin_acceptance())
+          throw std::runtime_error
+            ("Fin acceptance is not supported by ufscc_check()");
+
+        int threads = o_.get("threads", 0);
+        if (threads <= 0)
+          threads = std::max(1U, std::thread::hardware_concurrency());
+        unsigned seed = o_.get("seed", 0);
+
+        auto st = std::make_shared<ufscc_status>(aut_);
+        auto work = [&st, seed](unsigned id)
+          {
+            try
+              {
+                ufscc_worker(*st, id, seed).run();
+              }
+            catch (...)
+              {
+                if (!st->stop.exchange(true))
+                  st->error = std::current_exception();
+              }
+          };
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (int i = 1; i < threads; ++i)
+          workers.emplace_back(work, i);
+        work(0);
+        for (auto& w: workers)
+          w.join();
+
+        if (st->error)
+          std::rethrow_exception(st->error);
+        if (!st->found)
+          return nullptr;
+        return std::make_shared<ufscc_result>(st);
+      }
+
+    private:
+      const_twa_graph_ptr aut_;
+    };
+  }
+
+  emptiness_check_ptr
+  ufscc_check(const const_twa_ptr& a, option_map o)
+  {
+    auto g = std::dynamic_pointer_cast<const twa_graph>(a);
+    if (!g)
+      g = make_twa_graph(a, twa::prop_set::all());
+    return std::make_shared<ufscc>(g, o);
+  }
+}
@@ -0,0 +1,79 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <spot/misc/optionmap.hh>
+#include <spot/twa/fwd.hh>
+#include <spot/twaalgos/emptiness.hh>
+
+namespace spot
+{
+  /// \ingroup emptiness_check_algorithms
+  /// \brief Multi-threaded emptiness check based on a shared union-find.
+  ///
+  /// Several workers run a Couvreur-like SCC-based emptiness check
+  /// from the initial state, each one exploring the successors of
+  /// a state in its own random order (the first worker uses the
+  /// order of the automaton).  The workers share
+  ///   - a lock-free union-find structure in which they merge the
+  ///     states they have proved to be in the same SCC, together with
+  ///     the acceptance marks seen in that SCC, so that an accepting
+  ///     SCC is detected as soon as the marks collected by all workers
+  ///     cover the acceptance condition, and
+  ///   - a set of dead states, i.e., states whose SCC has been fully
+  ///     explored by some worker and is known not to be accepting;
+  ///     the other workers never enter them again.
+  ///
+  /// This is the approach of the following paper, using Couvreur's
+  /// SCC algorithm in each worker.
+  /** \verbatim
+      @InProceedings{renault.15.tacas,
+        author    = {Etienne Renault and Alexandre Duret-Lutz and Fabrice
+                     Kordon and Denis Poitrenaud},
+        title     = {Parallel Explicit Model Checking for Generalized
+                     {B\"u}chi Automata},
+        booktitle = {Proceedings of the 21st International Conference on
+                     Tools and Algorithms for the Construction and Analysis
+                     of Systems (TACAS'15)},
+        year      = {2015},
+        series    = {Lecture Notes in Computer Science},
+        volume    = {9035},
+        pages     = {613--627},
+        publisher = {Springer}
+      }
+      \endverbatim */
+  ///
+  /// The workers only read the destination and the acceptance marks
+  /// of the edges: BDD labels are never touched concurrently.  The
+  /// counterexample, if requested, is computed sequentially once all
+  /// workers have stopped.
+  ///
+  /// The automaton \a a must use a Fin-less acceptance condition.  If
+  /// \a a is not a twa_graph (e.g., an on-the-fly product), it is first
+  /// copied into one, and the runs returned refer to that copy.
+  ///
+  /// The following options are supported:
+  ///   - `threads` the number of workers (by default, the number of
+  ///     hardware threads).
+  ///   - `seed` the seed used to randomize the exploration order
+  ///     (0 by default).
+  SPOT_API emptiness_check_ptr
+  ufscc_check(const const_twa_ptr& a, option_map o = option_map());
+}
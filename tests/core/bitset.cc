@@ -0,0 +1,117 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#undef NDEBUG
+#include <spot/misc/bitset.hh>
+#include <cassert>
+#include <cstdint>
+
+// Compare a two-word bitset with the equivalent 64-bit arithmetic.
+typedef spot::internal::bitset<2> bs2;
+
+static bs2 make(uint64_t v)
+{
+  bs2 lo = static_cast<unsigned>(v);
+  bs2 hi = static_cast<unsigned>(v >> 32);
+  return lo | (hi << 32);
+}
+
+static uint64_t value(const bs2& b)
+{
+  return uint64_t(b.word(0)) | (uint64_t(b.word(1)) << 32);
+}
+
+static unsigned highest(uint64_t v)
+{
+  unsigned res = 0;
+  while (v)
+    {
+      ++res;
+      v >>= 1;
+    }
+  return res;
+}
+
+static unsigned count(uint64_t v)
+{
+  unsigned res = 0;
+  while (v)
+    {
+      ++res;
+      v &= v - 1;
+    }
+  return res;
+}
+
+int main()
+{
+  uint64_t seed = 1;
+  auto next = [&seed]()
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return seed;
+    };
+
+  for (unsigned i = 0; i < 10000; ++i)
+    {
+      uint64_t a = next();
+      uint64_t c = next();
+      if (i % 3 == 0)
+        a &= next();
+      if (i % 5 == 0)
+        a >>= next() % 64;
+      unsigned s = next() % 70;
+      bs2 x = make(a);
+      bs2 y = make(c);
+      assert(value(x) == a);
+      assert(value(x & y) == (a & c));
+      assert(value(x | y) == (a | c));
+      assert(value(x ^ y) == (a ^ c));
+      assert(value(~x) == ~a);
+      assert(value(x << s) == (s >= 64 ? 0 : a << s));
+      assert(value(x >> s) == (s >= 64 ? 0 : a >> s));
+      assert((x < y) == (a < c));
+      assert((x == y) == (a == c));
+      assert(bool(x) == bool(a));
+      assert(x.count() == count(a));
+      assert(x.highest() == highest(a));
+      assert(value(x.lowest()) == (a & -a));
+      bs2 z = x;
+      z.clear_lowest();
+      assert(value(z) == (a & (a - 1)));
+      assert(x.has(s % 64) == bool((a >> (s % 64)) & 1));
+    }
+
+  spot::internal::bitset<3> b = 0U;
+  assert(!b);
+  assert(b.highest() == 0);
+  b.set(95);
+  b.set(40);
+  b.set(3);
+  assert(b.has(95) && b.has(40) && b.has(3) && !b.has(4));
+  assert(b.count() == 3);
+  assert(b.highest() == 96);
+  b.clear(95);
+  assert(b.highest() == 41);
+  assert((b >> 40).word(0) == 1U);
+  assert((b << 50).has(53) && (b << 50).has(90));
+  assert(b.lowest().has(3) && b.lowest().count() == 1);
+  assert(b.hash() == b.hash());
+  return 0;
+}
@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2008, 2009, 2012, 2014, 2015, 2016 Laboratoire de
-// Recherche et Développement de l'Epita (LRDE).
+// Copyright (C) 2008, 2009, 2012, 2014, 2015, 2016, 2017 Laboratoire
+// de Recherche et Développement de l'Epita (LRDE).
 // Copyright (C) 2003, 2004 Laboratoire d'Informatique de
 // Paris 6 (LIP6), département Systèmes Répartis Coopératifs (SRC),
 // Université Pierre et Marie Curie.
@@ -23,6 +23,7 @@
 #include <iostream>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <spot/tl/parse.hh>
 #include <spot/twaalgos/product.hh>
 #include <spot/twaalgos/ltl2tgba_fm.hh>
@@ -31,7 +32,7 @@
 static void
 syntax(char* prog)
 {
-  std::cerr << prog << " formula1 formula2" << std::endl;
+  std::cerr << prog << " [-s] formula1 formula2" << std::endl;
   exit(2);
 }
 
@@ -40,6 +41,16 @@ main(int argc, char** argv)
 {
   int exit_code = 0;
 
+  // With -s, stop the product on the first state with an accepting
+  // self-loop, and print the number of states explored, and the
+  // number of states of the partial and full products.
+  bool stop = false;
+  if (argc == 4 && !strcmp(argv[1], "-s"))
+    {
+      stop = true;
+      ++argv;
+      --argc;
+    }
   if (argc != 3)
     syntax(argv[0]);
 
@@ -60,7 +71,52 @@ main(int argc, char** argv)
     {
       auto a1 = spot::ltl_to_tgba_fm(f1, dict);
       auto a2 = spot::ltl_to_tgba_fm(f2, dict);
-      spot::print_dot(std::cout, product(a1, a2));
+      if (!stop)
+        {
+          spot::print_dot(std::cout, product(a1, a2));
+        }
+      else
+        {
+          unsigned explored = 0;
+          auto part =
+            product(a1, a2, [&](const spot::const_twa_graph_ptr& p,
+                                unsigned s)
+                    {
+                      assert(s == explored);
+                      ++explored;
+                      for (auto& e: p->out(s))
+                        if (e.dst == s && p->acc().accepting(e.acc))
+                          return true;
+                      return false;
+                    });
+          auto full = product(a1, a2);
+          // The explored states of the partial product should have
+          // the same successors as in the full product.
+          auto ps = part->get_named_prop<spot::product_states>
+            ("product-states");
+          auto fs = full->get_named_prop<spot::product_states>
+            ("product-states");
+          for (unsigned s = 0; s < part->num_states(); ++s)
+            {
+              if ((*ps)[s] != (*fs)[s])
+                exit_code = 1;
+              if (s >= explored)
+                continue;
+              auto fo = full->out(s).begin();
+              for (auto& e: part->out(s))
+                {
+                  if (!(fo != full->out(s).end())
+                      || e.dst != fo->dst || e.cond != fo->cond
+                      || e.acc != fo->acc)
+                    exit_code = 1;
+                  ++fo;
+                }
+              if (fo != full->out(s).end())
+                exit_code = 1;
+            }
+          std::cout << explored << ' ' << part->num_states() << ' '
+                    << full->num_states() << '\n';
+        }
     }
   }
   assert(spot::fnode::instances_check());
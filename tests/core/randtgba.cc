@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2008, 2009, 2010, 2011, 2012, 2014, 2015, 2016 Laboratoire
-// de Recherche et Développement de l'Epita (LRDE).
+// Copyright (C) 2008, 2009, 2010, 2011, 2012, 2014, 2015, 2016, 2017
+// Laboratoire de Recherche et Développement de l'Epita (LRDE).
 // Copyright (C) 2004, 2005 Laboratoire d'Informatique de Paris
 // 6 (LIP6), département Systèmes Répartis Coopératifs (SRC),
 // Université Pierre et Marie Curie.
@@ -69,14 +69,20 @@ const char* default_algos[] = {
   "Cou99abs",
   "CVWY90",
   "CVWY90(bsh=4K)",
+  "CVWY90(graph=0)",
   "GV04",
+  "GV04(graph=0)",
   "SE05",
   "SE05(bsh=4K)",
+  "SE05(graph=0)",
   "Tau03",
+  "Tau03(graph=0)",
   "Tau03_opt",
   "Tau03_opt(condstack)",
   "Tau03_opt(condstack ordering)",
   "Tau03_opt(condstack ordering !weights)",
+  "UFSCC(threads=1)",
+  "UFSCC(threads=4)",
   nullptr
 };
 
@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2015, 2016 Laboratoire de Recherche et Développement
+// Copyright (C) 2015, 2016, 2017 Laboratoire de Recherche et Développement
 // de l'Epita (LRDE).
 //
 // This file is part of Spot, a model checking library.
@@ -44,7 +44,8 @@ static void help()
     "\t-b\treduce result using bisimulation\n"
     "\t--scc_opt\tUse an SCC-based Safra\n"
     "\t--bisim_opt\tUse Simulation info to reduce macro-states size\n"
-    "\t--stutter\tStutter-invarience optimisation\n";
+    "\t--stutter\tStutter-invarience optimisation\n"
+    "\t--threads N\tCompute successors with N threads\n";
   exit(1);
 }
 
@@ -60,6 +61,7 @@ int main(int argc, char* argv[])
   bool pretty_print = false;
   bool complete = false;
   bool use_stutter = false;
+  unsigned threads = 1;
 
   char* input = nullptr;
   if (argc <= 2)
@@ -97,6 +99,12 @@ int main(int argc, char* argv[])
         use_bisim = true;
       else if (!strncmp(argv[i], "--stutter", 9))
         use_stutter = true;
+      else if (!strncmp(argv[i], "--threads", 9))
+        {
+          if (i + 1 >= argc)
+            help();
+          threads = atoi(argv[++i]);
+        }
       else
         {
           std::cerr << "Warning: " << argv[i] << " not used\n";
@@ -118,7 +126,7 @@ int main(int argc, char* argv[])
       trans.set_pref(spot::postprocessor::Deterministic);
       auto tmp = trans.run(pf.f);
       res = spot::tgba_determinize(tmp, pretty_print, scc_opt,
-                                   use_bisim, use_stutter);
+                                   use_bisim, use_stutter, threads);
     }
   else if (in_hoa)
     {
@@ -126,7 +134,7 @@ int main(int argc, char* argv[])
       if (aut->format_errors(std::cerr))
         return 2;
       res = tgba_determinize(aut->aut, pretty_print, scc_opt,
-                             use_bisim, use_stutter);
+                             use_bisim, use_stutter, threads);
     }
   if (sim)
     res = simulation(res);
@@ -0,0 +1,167 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2017 Laboratoire de Recherche et Développement de
+// l'Epita (LRDE).
+//
+// This file is part of Spot, a model checking library.
+//
+// Spot is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Spot is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <string>
+#include <spot/misc/satsolver.hh>
+#include <spot/tl/parse.hh>
+#include <spot/twaalgos/dtwasat.hh>
+#include <spot/twaalgos/translate.hh>
+
+namespace
+{
+  unsigned solves = 0;
+  unsigned assumptions = 0;
+
+  // Count the calls to the solver, and forward them to PicoSAT.
+  class counting_backend final: public spot::sat_backend
+  {
+    std::unique_ptr<spot::sat_backend> solver_ =
+      spot::make_picosat_backend();
+
+  public:
+    std::string signature() const override
+    {
+      return "counting " + solver_->signature();
+    }
+
+    void add(int lit) override
+    {
+      solver_->add(lit);
+    }
+
+    void assume(int lit) override
+    {
+      ++assumptions;
+      solver_->assume(lit);
+    }
+
+    int solve() override
+    {
+      ++solves;
+      return solver_->solve();
+    }
+
+    int val(int var) override
+    {
+      return solver_->val(var);
+    }
+  };
+
+  // The same, seen as an IPASIR solver.
+  const char* ipasir_signature()
+  {
+    return "ipasir";
+  }
+
+  void* ipasir_init()
+  {
+    return new counting_backend;
+  }
+
+  void ipasir_release(void* s)
+  {
+    delete static_cast<counting_backend*>(s);
+  }
+
+  void ipasir_add(void* s, int32_t lit)
+  {
+    static_cast<counting_backend*>(s)->add(lit);
+  }
+
+  void ipasir_assume(void* s, int32_t lit)
+  {
+    static_cast<counting_backend*>(s)->assume(lit);
+  }
+
+  int ipasir_solve(void* s)
+  {
+    return static_cast<counting_backend*>(s)->solve();
+  }
+
+  int32_t ipasir_val(void* s, int32_t lit)
+  {
+    return static_cast<counting_backend*>(s)->val(lit);
+  }
+
+  // Look for a Büchi automaton with at most 3 states with each
+  // method.
+  const char* methods[][2] =
+    {
+      { "dichotomy", "" },
+      { "naive", ",sat-naive" },
+      { "assume", ",sat-incr=1" },
+      { "incr", ",sat-incr=2" },
+      { "incr-naive", ",sat-incr=2,sat-incr-steps=-1" },
+    };
+
+  void run(const spot::twa_graph_ptr& aut, const char* name)
+  {
+    for (auto& m: methods)
+      {
+        solves = assumptions = 0;
+        std::string opt = "max-states=3,acc=\"Inf(0)\"";
+        auto res = spot::sat_minimize(aut, (opt + m[1]).c_str());
+        std::cout << name << ' ' << m[0] << ": ";
+        if (res)
+          std::cout << res->num_states() << " states, ";
+        else
+          std::cout << "no automaton, ";
+        std::cout << (solves > 0 ? "" : "no ") << "solve, "
+                  << (assumptions > 0 ? "" : "no ") << "assumption\n";
+      }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 2)
+    return 2;
+  auto pf = spot::parse_infix_psl(argv[1]);
+  if (pf.format_errors(std::cerr))
+    return 2;
+  spot::translator trans;
+  trans.set_type(spot::postprocessor::TGBA);
+  trans.set_pref(spot::postprocessor::Deterministic);
+  auto aut = trans.run(pf.f);
+
+  run(aut, "picosat");
+  spot::satsolver s1;
+  std::cout << s1.signature() << '\n';
+
+  spot::set_sat_backend([]()
+                        {
+                          return std::unique_ptr<spot::sat_backend>
+                            (new counting_backend);
+                        });
+  run(aut, "factory");
+  spot::satsolver s2;
+  std::cout << s2.signature() << '\n';
+
+  spot::set_sat_backend(spot::ipasir_interface{
+      ipasir_signature, ipasir_init, ipasir_release, ipasir_add,
+      ipasir_assume, ipasir_solve, ipasir_val});
+  run(aut, "ipasir");
+  spot::satsolver s3;
+  std::cout << s3.signature() << '\n';
+
+  spot::set_sat_backend(nullptr);
+  run(aut, "picosat");
+  return 0;
+}
@@ -1,6 +1,6 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2014, 2015, 2016 Laboratoire de Recherche et Développement
-// de l'Epita.
+// Copyright (C) 2014, 2015, 2016, 2017 Laboratoire de Recherche et
+// Développement de l'Epita.
 //
 // This file is part of Spot, a model checking library.
 //
@@ -129,9 +129,44 @@ static void f3()
   spot::print_hoa(std::cout, tg, "1.1") << '\n';
 }
 
+// Freezing an automaton whose edges were added in several passes.
+static void f4()
+{
+  auto d = spot::make_bdd_dict();
+  auto tg = make_twa_graph(d);
+  bdd p1 = bdd_ithvar(tg->register_ap("p1"));
+  tg->set_buchi();
+
+  auto s1 = tg->new_state();
+  auto s2 = tg->new_state();
+  auto s3 = tg->new_state();
+  tg->new_edge(s1, s2, p1);
+  tg->new_edge(s2, s3, p1);
+  tg->new_edge(s3, s1, p1, {0});
+  tg->new_edge(s1, s1, !p1);
+  tg->new_edge(s2, s2, !p1);
+  tg->new_edge(s3, s3, !p1);
+  tg->new_edge(s1, s3, bddtrue);
+  {
+    auto i = tg->get_graph().out_iteraser(s2);
+    ++i;
+    i.erase();
+  }
+  spot::print_hoa(std::cout, tg) << '\n';
+  tg->get_graph().dump_storage(std::cout);
+  tg->freeze();
+  tg->get_graph().dump_storage(std::cout);
+  spot::print_hoa(std::cout, tg) << '\n';
+  // Already frozen.
+  tg->freeze();
+  tg->get_graph().dump_storage(std::cout);
+  assert(tg->num_edges() == 6);
+}
+
 int main()
 {
   f1();
   f2();
   f3();
+  f4();
 }
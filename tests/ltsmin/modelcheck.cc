@@ -1,5 +1,5 @@
 // -*- coding: utf-8 -*-
-// Copyright (C) 2011, 2012, 2013, 2014, 2015, 2016 Laboratoire de
+// Copyright (C) 2011, 2012, 2013, 2014, 2015, 2016, 2017 Laboratoire de
 // Recherche et Developpement de l'Epita (LRDE)
 //
 // This file is part of Spot, a model checking library.
@@ -24,6 +24,7 @@
 #include <spot/twaalgos/translate.hh>
 #include <spot/twaalgos/emptiness.hh>
 #include <spot/twaalgos/postproc.hh>
+#include <spot/twaalgos/stutter.hh>
 #include <spot/twa/twaproduct.hh>
 #include <spot/misc/timer.hh>
 #include <spot/misc/memusage.hh>
@@ -52,6 +53,10 @@ Options:\n\
   -gm    output the model state-space in dot format\n\
   -gK    output the model state-space in Kripke format\n\
   -gp    output the product state-space in dot format\n\
+  -p     use partial-order reduction (if the formula is stutter-invariant)\n\
+  -s     run the emptiness check on compactly stored state numbers\n\
+          (ltsmin_model::intersects(), implies Cou99, incompatible\n\
+          with -C and -p)\n\
   -T     time the different phases of the execution\n\
   -z     compress states to handle larger models\n\
   -Z     compress states (faster) assuming all values in [0 .. 2^28-1]\n\
@@ -71,6 +76,8 @@ checked_main(int argc, char **argv)
   bool accepting_run = false;
   bool expect_counter_example = false;
   bool deterministic = false;
+  bool compact_check = false;
+  bool por = false;
   char *dead = nullptr;
   int compress_states = 0;
 
@@ -124,6 +131,12 @@ checked_main(int argc, char **argv)
                   goto error;
                 }
               break;
+            case 'p':
+              por = true;
+              break;
+            case 's':
+              compact_check = true;
+              break;
             case 'T':
               use_timer = true;
               break;
@@ -156,7 +169,7 @@ checked_main(int argc, char **argv)
   spot::atomic_prop_set ap;
   auto dict = spot::make_bdd_dict();
   spot::const_kripke_ptr model = nullptr;
-  spot::const_twa_ptr prop = nullptr;
+  spot::const_twa_graph_ptr prop = nullptr;
   spot::const_twa_ptr product = nullptr;
   spot::emptiness_check_instantiator_ptr echeck_inst = nullptr;
   int exit_code = 0;
@@ -177,6 +190,13 @@ checked_main(int argc, char **argv)
       deadf = env.require(dead);
     }
 
+  if (compact_check && (accepting_run || por))
+    {
+      std::cerr << "Option -s is incompatible with -C and -p.\n";
+      exit_code = 1;
+      goto safe_exit;
+    }
+
   if (output == EmptinessCheck)
     {
       const char* err;
@@ -213,13 +233,66 @@ checked_main(int argc, char **argv)
 
   atomic_prop_collect(f, &ap);
 
+  if (por && !spot::is_stutter_invariant(f))
+    {
+      std::cerr << "The formula is not stutter-invariant, "
+                << "ignoring option -p.\n";
+      por = false;
+    }
+
+  if (output == EmptinessCheck && compact_check)
+    {
+      spot::ltsmin_check_stats stats;
+      bool res = false;
+      int memused = spot::memusage();
+      tm.start("running emptiness check");
+      try
+        {
+          res = spot::ltsmin_model::load(argv[1]).intersects(prop, deadf,
+                                                             compress_states,
+                                                             &stats);
+        }
+      catch (std::runtime_error& e)
+        {
+          std::cerr << e.what() << '\n';
+          exit_code = 1;
+          goto safe_exit;
+        }
+      catch (std::bad_alloc)
+        {
+          std::cerr << "Out of memory during emptiness check."
+                    << std::endl;
+          if (!compress_states)
+            std::cerr << "Try option -z for state compression." << std::endl;
+          exit_code = 2;
+          exit(exit_code);
+        }
+      tm.stop("running emptiness check");
+      memused = spot::memusage() - memused;
+
+      std::cout << stats.model_states << " model states stored\n"
+                << stats.product_states << " unique states visited\n"
+                << stats.transitions << " transitions explored\n"
+                << stats.memory << " bytes used to store states\n"
+                << memused << " pages allocated for emptiness check"
+                << std::endl;
+      if (expect_counter_example != res)
+        exit_code = 1;
+      if (res)
+        std::cout << "an accepting run exists" << std::endl;
+      else
+        std::cout << "no accepting run found" << std::endl;
+      goto safe_exit;
+    }
+
   if (output != DotFormula)
     {
       tm.start("loading ltsmin model");
       try
         {
           model = spot::ltsmin_model::load(argv[1]).kripke(&ap, dict, deadf,
-                                                           compress_states);
+                                                           compress_states,
+                                                           por);
         }
       catch (std::runtime_error& e)
         {
@@ -0,0 +1,37 @@
+# -*- mode: python; coding: utf-8 -*-
+# Copyright (C) 2017 Laboratoire de Recherche et Développement de
+# l'EPITA.
+#
+# This file is part of Spot, a model checking library.
+#
+# Spot is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# Spot is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+# License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Printing an automaton on a file descriptor should give the same
+# output as printing it on a stream, whatever the size of the buffer.
+
+import os
+import spot
+
+auts = [spot.translate('GFa & GFb & (c U d)'),
+        spot.translate('a U b', 'deterministic', 'complete'),
+        spot.translate('F(a & X(!b U c))', 'monitor')]
+for aut in auts:
+    for opt in [None, 't', 'm', 'k', 'i', 'l', 'v', '1.1']:
+        expected = aut.to_str('hoa', opt)
+        for bufsize in [1, 7, 1 << 20]:
+            r, w = os.pipe()
+            spot.print_hoa(w, aut, opt, bufsize)
+            os.close(w)
+            with os.fdopen(r) as f:
+                assert f.read() == expected